@@ -17,14 +17,22 @@ int main() {
 #include <inttypes.h>
 #include <sys/types.h>
 #include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <vector>
 
+#include "monitoring/histogram.h"
 #include "port/port.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "util/gflags_compat.h"
+#include "util/memory_allocator.h"
 #include "util/mutexlock.h"
 #include "util/random.h"
+#include "util/string_util.h"
 
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 
@@ -34,6 +42,10 @@ DEFINE_int32(threads, 16, "Number of concurrent threads to run.");
 DEFINE_int64(cache_size, 8 * KB * KB,
              "Number of bytes to use as a cache of uncompressed data.");
 DEFINE_int32(num_shard_bits, 4, "shard_bits.");
+DEFINE_string(num_shard_bits_sweep, "",
+              "Comma-separated list of num_shard_bits values. If set, the "
+              "benchmark runs once with a new cache for each of them instead "
+              "of --num_shard_bits.");
 
 DEFINE_int64(max_key, 1 * KB * KB * KB, "Max number of key to place in cache");
 DEFINE_uint64(ops_per_thread, 1200000, "Number of operations per thread.");
@@ -46,7 +58,54 @@ DEFINE_int32(lookup_percent, 50,
 DEFINE_int32(erase_percent, 10,
              "Ratio of erase to total workload (expressed as a percentage)");
 
+DEFINE_string(key_distribution, "uniform",
+              "Distribution of the keys of the operations. uniform: all of "
+              "--max_key alike. zipf: the key of rank r is accessed with a "
+              "probability proportional to 1/r^zipf_alpha. hotset: "
+              "--hot_op_percent of the operations are on the first "
+              "--hot_key_percent of the keys.");
+DEFINE_double(zipf_alpha, 0.99, "Skew of --key_distribution=zipf.");
+DEFINE_int32(hot_key_percent, 10,
+             "Percentage of the keys in the hot set of "
+             "--key_distribution=hotset.");
+DEFINE_int32(hot_op_percent, 90,
+             "Percentage of the operations on the hot set of "
+             "--key_distribution=hotset.");
+
+DEFINE_string(trace_file, "",
+              "If set, replay the block cache accesses of this file instead "
+              "of the random operations. Each line is an access, "
+              "\"<key in hex> <charge>\", that looks the key up and inserts "
+              "it with the charge on a miss. The threads share the accesses, "
+              "and --ops_per_thread, the percentages and --key_distribution "
+              "are ignored.");
+
+DEFINE_bool(histograms, false,
+            "Print the latency histograms of each type of operation.");
+
 DEFINE_bool(use_clock_cache, false, "");
+DEFINE_bool(frequency_based_admission, false,
+            "Use TinyLFU admission in the LRU cache, see "
+            "LRUCacheOptions::frequency_based_admission.");
+
+DEFINE_int32(value_bytes, 0,
+             "If positive, values of this many bytes are allocated through "
+             "the memory allocator of the cache, charged by their size and "
+             "read on every hit, like cached blocks. Otherwise values are "
+             "10 bytes charged as 1.");
+DEFINE_int32(max_value_bytes, 0,
+             "If greater than --value_bytes, the value of each key has a "
+             "size between --value_bytes and this, like blocks of varying "
+             "size. The size of a key does not change between inserts.");
+DEFINE_bool(huge_page_allocator, false,
+            "Allocate the values from huge pages with NewHugePageAllocator(). "
+            "Requires --value_bytes.");
+DEFINE_bool(explicit_huge_pages, false,
+            "With --huge_page_allocator, use the reserved huge pages "
+            "(vm.nr_hugepages) before transparent ones.");
+DEFINE_bool(numa_aware_allocator, false,
+            "With --huge_page_allocator, allocate the values from the memory "
+            "of the NUMA node of the inserting thread.");
 
 namespace rocksdb {
 
@@ -56,6 +115,110 @@ void deleter(const Slice& /*key*/, void* value) {
     delete reinterpret_cast<char *>(value);
 }
 
+MemoryAllocator* value_allocator = nullptr;
+
+void ValueDeleter(const Slice& /*key*/, void* value) {
+  CacheAllocationPtr owned(static_cast<char*>(value), value_allocator);
+}
+
+enum OpType : int { kInsert = 0, kLookup, kErase, kNumOpTypes };
+
+const char* const kOpTypeNames[kNumOpTypes] = {"Insert", "Lookup", "Erase"};
+
+// An access of --trace_file.
+struct TraceRecord {
+  std::string key;
+  size_t charge;
+};
+
+// Parses s, which must only hold decimal digits. Unlike ParseSizeT(), never
+// throws.
+bool ParseDecimal(const std::string& s, uint64_t* value) {
+  // 19 digits always fit in 64 bits.
+  if (s.empty() || s.size() > 19 ||
+      s.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  *value = std::stoull(s);
+  return true;
+}
+
+// Draws ranks 1..n with a probability proportional to 1/rank^alpha, by
+// rejection-inversion (W. Hormann and G. Derflinger, "Rejection-inversion
+// to generate variates from monotone discrete distributions"), which does
+// not need the normalization constant and so works for any n.
+class ZipfGenerator {
+ public:
+  ZipfGenerator(uint64_t n, double alpha)
+      : n_(static_cast<double>(n)),
+        alpha_(alpha),
+        h_integral_x1_(HIntegral(1.5) - 1.0),
+        h_integral_n_(HIntegral(n_ + 0.5)),
+        s_(2.0 - HIntegralInverse(HIntegral(2.5) - H(2.0))) {}
+
+  // Returns a rank in [1, n].
+  template <typename Rand>
+  uint64_t Next(Rand* rnd) const {
+    while (true) {
+      double u = h_integral_n_ +
+                 UniformDouble(rnd) * (h_integral_x1_ - h_integral_n_);
+      double x = HIntegralInverse(u);
+      double k = std::floor(x + 0.5);
+      if (k < 1.0) {
+        k = 1.0;
+      } else if (k > n_) {
+        k = n_;
+      }
+      if (k - x <= s_ || u >= HIntegral(k + 0.5) - H(k)) {
+        return static_cast<uint64_t>(k);
+      }
+    }
+  }
+
+  template <typename Rand>
+  static double UniformDouble(Rand* rnd) {
+    return static_cast<double>(rnd->Next() >> 11) * (1.0 / (1ull << 53));
+  }
+
+ private:
+  double H(double x) const { return std::exp(-alpha_ * std::log(x)); }
+
+  double HIntegral(double x) const {
+    double log_x = std::log(x);
+    return Helper2((1.0 - alpha_) * log_x) * log_x;
+  }
+
+  double HIntegralInverse(double x) const {
+    double t = x * (1.0 - alpha_);
+    if (t < -1.0) {
+      t = -1.0;
+    }
+    return std::exp(Helper1(t) * x);
+  }
+
+  // log(1 + x) / x, accurate near 0
+  static double Helper1(double x) {
+    if (std::fabs(x) > 1e-8) {
+      return std::log1p(x) / x;
+    }
+    return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+  }
+
+  // (exp(x) - 1) / x, accurate near 0
+  static double Helper2(double x) {
+    if (std::fabs(x) > 1e-8) {
+      return std::expm1(x) / x;
+    }
+    return 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+  }
+
+  const double n_;
+  const double alpha_;
+  const double h_integral_x1_;
+  const double h_integral_n_;
+  const double s_;
+};
+
 // State shared by all concurrent executions of the same benchmark.
 class SharedState {
  public:
@@ -65,6 +228,9 @@ class SharedState {
         num_initialized_(0),
         start_(false),
         num_done_(0),
+        ops_(0),
+        lookups_(0),
+        hits_(0),
         cache_bench_(cache_bench) {
   }
 
@@ -106,6 +272,28 @@ class SharedState {
     return start_;
   }
 
+  void AddOps(uint64_t ops, uint64_t lookups, uint64_t hits) {
+    ops_ += ops;
+    lookups_ += lookups;
+    hits_ += hits;
+  }
+
+  uint64_t Ops() const { return ops_; }
+
+  double HitRate() const {
+    return lookups_ == 0 ? 0.0 : 100.0 * hits_ / lookups_;
+  }
+
+  void MergeLatencies(const HistogramImpl* latencies) {
+    for (int i = 0; i < kNumOpTypes; i++) {
+      latencies_[i].Merge(latencies[i]);
+    }
+  }
+
+  const HistogramImpl& Latencies(OpType type) const {
+    return latencies_[type];
+  }
+
  private:
   port::Mutex mu_;
   port::CondVar cv_;
@@ -114,6 +302,11 @@ class SharedState {
   uint64_t num_initialized_;
   bool start_;
   uint64_t num_done_;
+  uint64_t ops_;
+  uint64_t lookups_;
+  uint64_t hits_;
+  // In nanoseconds, with --histograms
+  HistogramImpl latencies_[kNumOpTypes];
 
   CacheBench* cache_bench_;
 };
@@ -121,17 +314,33 @@ class SharedState {
 // Per-thread state for concurrent executions of the same benchmark.
 struct ThreadState {
   uint32_t tid;
-  Random rnd;
+  Random64 rnd;
   SharedState* shared;
+  uint64_t ops;
+  uint64_t lookups;
+  uint64_t hits;
+  // Sum of the bytes read from the values, so that the reads are kept.
+  uint64_t value_sum;
+  HistogramImpl latencies[kNumOpTypes];
 
   ThreadState(uint32_t index, SharedState* _shared)
-      : tid(index), rnd(1000 + index), shared(_shared) {}
+      : tid(index),
+        rnd(1000 + index),
+        shared(_shared),
+        ops(0),
+        lookups(0),
+        hits(0),
+        value_sum(0) {}
 };
 }  // namespace
 
 class CacheBench {
  public:
-  CacheBench() : num_threads_(FLAGS_threads) {
+  explicit CacheBench(const std::vector<TraceRecord>* trace)
+      : num_threads_(FLAGS_threads),
+        zipf_(FLAGS_max_key, FLAGS_zipf_alpha),
+        trace_(trace),
+        next_trace_record_(0) {
     if (FLAGS_use_clock_cache) {
       cache_ = NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits);
       if (!cache_) {
@@ -139,20 +348,38 @@ class CacheBench {
         exit(1);
       }
     } else {
-      cache_ = NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits);
+      LRUCacheOptions options(FLAGS_cache_size, FLAGS_num_shard_bits,
+                              false /*strict_capacity_limit*/,
+                              0.0 /*high_pri_pool_ratio*/);
+      options.frequency_based_admission = FLAGS_frequency_based_admission;
+      if (FLAGS_huge_page_allocator) {
+        HugePageAllocatorOptions allocator_options;
+        // Room for the rounding up to size classes.
+        allocator_options.capacity = FLAGS_cache_size + FLAGS_cache_size / 4;
+        allocator_options.use_explicit_huge_pages = FLAGS_explicit_huge_pages;
+        allocator_options.numa_aware = FLAGS_numa_aware_allocator;
+        Status s = NewHugePageAllocator(allocator_options,
+                                        &options.memory_allocator);
+        if (!s.ok()) {
+          fprintf(stderr, "Huge page allocator: %s\n", s.ToString().c_str());
+          exit(1);
+        }
+      }
+      cache_ = NewLRUCache(options);
     }
+    value_allocator = cache_->memory_allocator();
   }
 
   ~CacheBench() {}
 
   void PopulateCache() {
-    Random rnd(1);
+    Random64 rnd(1);
     for (int64_t i = 0; i < FLAGS_cache_size; i++) {
       uint64_t rand_key = rnd.Next() % FLAGS_max_key;
       // Cast uint64* to be char*, data would be copied to cache
       Slice key(reinterpret_cast<char*>(&rand_key), 8);
       // do insert
-      cache_->Insert(key, new char[10], 1, &deleter);
+      Insert(key, ValueSize(rand_key));
     }
   }
 
@@ -187,8 +414,22 @@ class CacheBench {
       uint64_t end_time = env->NowMicros();
       double elapsed = static_cast<double>(end_time - start_time) * 1e-6;
       uint32_t qps = static_cast<uint32_t>(
-          static_cast<double>(FLAGS_threads * FLAGS_ops_per_thread) / elapsed);
+          static_cast<double>(shared.Ops()) / elapsed);
       fprintf(stdout, "Complete in %.3f s; QPS = %u\n", elapsed, qps);
+      fprintf(stdout, "Lookup hit rate: %.2f%%\n", shared.HitRate());
+      if (FLAGS_histograms) {
+        for (int i = 0; i < kNumOpTypes; i++) {
+          const HistogramImpl& latencies =
+              shared.Latencies(static_cast<OpType>(i));
+          if (!latencies.Empty()) {
+            fprintf(stdout, "%s latency (ns):\n%s", kOpTypeNames[i],
+                    latencies.ToString().c_str());
+          }
+        }
+      }
+    }
+    for (auto* thread : threads) {
+      delete thread;
     }
     return true;
   }
@@ -196,6 +437,10 @@ class CacheBench {
  private:
   std::shared_ptr<Cache> cache_;
   uint32_t num_threads_;
+  const ZipfGenerator zipf_;
+  // With --trace_file, the accesses and the next one to replay.
+  const std::vector<TraceRecord>* trace_;
+  std::atomic<size_t> next_trace_record_;
 
   static void ThreadBody(void* v) {
     ThreadState* thread = reinterpret_cast<ThreadState*>(v);
@@ -211,10 +456,16 @@ class CacheBench {
         shared->GetCondVar()->Wait();
       }
     }
-    thread->shared->GetCacheBench()->OperateCache(thread);
+    if (thread->shared->GetCacheBench()->trace_ != nullptr) {
+      thread->shared->GetCacheBench()->ReplayTrace(thread);
+    } else {
+      thread->shared->GetCacheBench()->OperateCache(thread);
+    }
 
     {
       MutexLock l(shared->GetMutex());
+      shared->AddOps(thread->ops, thread->lookups, thread->hits);
+      shared->MergeLatencies(thread->latencies);
       shared->IncDone();
       if (shared->AllDone()) {
         shared->GetCondVar()->SignalAll();
@@ -222,44 +473,194 @@ class CacheBench {
     }
   }
 
+  uint64_t NextKey(ThreadState* thread) const {
+    if (FLAGS_key_distribution == "zipf") {
+      return zipf_.Next(&thread->rnd) - 1;
+    } else if (FLAGS_key_distribution == "hotset") {
+      uint64_t hot_keys = std::max<uint64_t>(
+          1, static_cast<uint64_t>(FLAGS_max_key) * FLAGS_hot_key_percent /
+                 100);
+      if (static_cast<int32_t>(thread->rnd.Uniform(100)) <
+              FLAGS_hot_op_percent ||
+          hot_keys >= static_cast<uint64_t>(FLAGS_max_key)) {
+        return thread->rnd.Uniform(hot_keys);
+      }
+      return hot_keys + thread->rnd.Uniform(FLAGS_max_key - hot_keys);
+    }
+    return thread->rnd.Next() % FLAGS_max_key;
+  }
+
+  // The charge of the value of a key. It is fixed per key, so that the
+  // entries of the cache do not change size, like blocks.
+  static size_t ValueSize(uint64_t key) {
+    if (FLAGS_value_bytes <= 0) {
+      return 1;
+    }
+    if (FLAGS_max_value_bytes <= FLAGS_value_bytes) {
+      return FLAGS_value_bytes;
+    }
+    uint64_t range = FLAGS_max_value_bytes - FLAGS_value_bytes + 1;
+    return FLAGS_value_bytes +
+           static_cast<size_t>(((key * 0x9E3779B97F4A7C15ull) >> 32) % range);
+  }
+
   void OperateCache(ThreadState* thread) {
+    Env* env = Env::Default();
     for (uint64_t i = 0; i < FLAGS_ops_per_thread; i++) {
-      uint64_t rand_key = thread->rnd.Next() % FLAGS_max_key;
+      uint64_t rand_key = NextKey(thread);
       // Cast uint64* to be char*, data would be copied to cache
       Slice key(reinterpret_cast<char*>(&rand_key), 8);
-      int32_t prob_op = thread->rnd.Uniform(100);
-      if (prob_op >= 0 && prob_op < FLAGS_insert_percent) {
+      int32_t prob_op = static_cast<int32_t>(thread->rnd.Uniform(100));
+      OpType type;
+      if (prob_op < FLAGS_insert_percent) {
+        type = kInsert;
+      } else if (prob_op < FLAGS_insert_percent + FLAGS_lookup_percent) {
+        type = kLookup;
+      } else if (prob_op < FLAGS_insert_percent + FLAGS_lookup_percent +
+                               FLAGS_erase_percent) {
+        type = kErase;
+      } else {
+        continue;
+      }
+      uint64_t start = FLAGS_histograms ? env->NowNanos() : 0;
+      if (type == kInsert) {
         // do insert
-        cache_->Insert(key, new char[10], 1, &deleter);
-      } else if (prob_op -= FLAGS_insert_percent &&
-                 prob_op < FLAGS_lookup_percent) {
+        Insert(key, ValueSize(rand_key));
+      } else if (type == kLookup) {
         // do lookup
-        auto handle = cache_->Lookup(key);
-        if (handle) {
-          cache_->Release(handle);
-        }
-      } else if (prob_op -= FLAGS_lookup_percent &&
-                 prob_op < FLAGS_erase_percent) {
+        Lookup(thread, key);
+      } else {
         // do erase
         cache_->Erase(key);
       }
+      if (FLAGS_histograms) {
+        thread->latencies[type].Add(env->NowNanos() - start);
+      }
+      thread->ops++;
+    }
+  }
+
+  void ReplayTrace(ThreadState* thread) {
+    Env* env = Env::Default();
+    while (true) {
+      size_t index = next_trace_record_.fetch_add(1, std::memory_order_relaxed);
+      if (index >= trace_->size()) {
+        break;
+      }
+      const TraceRecord& record = (*trace_)[index];
+      uint64_t start = FLAGS_histograms ? env->NowNanos() : 0;
+      bool hit = Lookup(thread, record.key);
+      if (FLAGS_histograms) {
+        uint64_t now = env->NowNanos();
+        thread->latencies[kLookup].Add(now - start);
+        start = now;
+      }
+      if (!hit) {
+        Insert(record.key, record.charge);
+        if (FLAGS_histograms) {
+          thread->latencies[kInsert].Add(env->NowNanos() - start);
+        }
+      }
+      thread->ops++;
+    }
+  }
+
+  // Looks key up and reads its value on a hit.
+  bool Lookup(ThreadState* thread, const Slice& key) {
+    auto handle = cache_->Lookup(key);
+    thread->lookups++;
+    if (handle == nullptr) {
+      return false;
+    }
+    thread->hits++;
+    if (FLAGS_value_bytes > 0) {
+      // The value was allocated with the charge of whichever access inserted
+      // it, which may differ from the charge of this one in a trace.
+      const char* value = static_cast<const char*>(cache_->Value(handle));
+      size_t value_size = cache_->GetUsage(handle);
+      for (size_t j = 0; j < value_size; j += 64) {
+        thread->value_sum += static_cast<unsigned char>(value[j]);
+      }
+    }
+    cache_->Release(handle);
+    return true;
+  }
+
+  void Insert(const Slice& key, size_t charge) {
+    if (FLAGS_value_bytes > 0) {
+      CacheAllocationPtr value = AllocateBlock(charge, value_allocator);
+      memset(value.get(), static_cast<int>(key[0]), charge);
+      cache_->Insert(key, value.release(), charge, &ValueDeleter);
+    } else {
+      cache_->Insert(key, new char[10], charge, &deleter);
     }
   }
 
   void PrintEnv() const {
     printf("RocksDB version     : %d.%d\n", kMajorVersion, kMinorVersion);
     printf("Number of threads   : %d\n", FLAGS_threads);
-    printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
     printf("Cache size          : %" PRIu64 "\n", FLAGS_cache_size);
     printf("Num shard bits      : %d\n", FLAGS_num_shard_bits);
-    printf("Max key             : %" PRIu64 "\n", FLAGS_max_key);
-    printf("Populate cache      : %d\n", FLAGS_populate_cache);
-    printf("Insert percentage   : %d%%\n", FLAGS_insert_percent);
-    printf("Lookup percentage   : %d%%\n", FLAGS_lookup_percent);
-    printf("Erase percentage    : %d%%\n", FLAGS_erase_percent);
+    if (trace_ != nullptr) {
+      printf("Trace file          : %s\n", FLAGS_trace_file.c_str());
+      printf("Trace accesses      : %" ROCKSDB_PRIszt "\n", trace_->size());
+    } else {
+      printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
+      printf("Max key             : %" PRIu64 "\n", FLAGS_max_key);
+      printf("Key distribution    : %s\n", FLAGS_key_distribution.c_str());
+      if (FLAGS_key_distribution == "zipf") {
+        printf("Zipf alpha          : %.3f\n", FLAGS_zipf_alpha);
+      } else if (FLAGS_key_distribution == "hotset") {
+        printf("Hot set             : %d%% of ops on %d%% of keys\n",
+               FLAGS_hot_op_percent, FLAGS_hot_key_percent);
+      }
+      printf("Populate cache      : %d\n", FLAGS_populate_cache);
+      printf("Insert percentage   : %d%%\n", FLAGS_insert_percent);
+      printf("Lookup percentage   : %d%%\n", FLAGS_lookup_percent);
+      printf("Erase percentage    : %d%%\n", FLAGS_erase_percent);
+    }
+    printf("Frequency admission : %d\n", FLAGS_frequency_based_admission);
+    printf("Value bytes         : %d\n", FLAGS_value_bytes);
+    if (FLAGS_max_value_bytes > FLAGS_value_bytes) {
+      printf("Max value bytes     : %d\n", FLAGS_max_value_bytes);
+    }
+    printf("Huge page allocator : %d\n", FLAGS_huge_page_allocator);
     printf("----------------------------\n");
   }
 };
+
+// Reads the accesses of --trace_file.
+Status LoadTrace(const std::string& fname, std::vector<TraceRecord>* trace) {
+  std::string data;
+  Status s = ReadFileToString(Env::Default(), fname, &data);
+  if (!s.ok()) {
+    return s;
+  }
+  for (const std::string& line : StringSplit(data, '\n')) {
+    if (line.empty()) {
+      continue;
+    }
+    size_t space = line.find(' ');
+    TraceRecord record;
+    uint64_t charge;
+    if (space == std::string::npos ||
+        !Slice(line.data(), space).DecodeHex(&record.key) ||
+        !ParseDecimal(line.substr(space + 1), &charge)) {
+      return Status::Corruption("Bad trace line", line);
+    }
+    record.charge = static_cast<size_t>(charge);
+    trace->push_back(std::move(record));
+  }
+  return Status::OK();
+}
+
+bool RunBenchmark(const std::vector<TraceRecord>* trace) {
+  CacheBench bench(trace);
+  if (FLAGS_populate_cache && trace == nullptr) {
+    bench.PopulateCache();
+  }
+  return bench.Run();
+}
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -269,16 +670,59 @@ int main(int argc, char** argv) {
     fprintf(stderr, "threads number <= 0\n");
     exit(1);
   }
+  if (FLAGS_huge_page_allocator && FLAGS_value_bytes <= 0) {
+    fprintf(stderr, "--huge_page_allocator requires --value_bytes\n");
+    exit(1);
+  }
+  if (FLAGS_key_distribution != "uniform" &&
+      FLAGS_key_distribution != "zipf" && FLAGS_key_distribution != "hotset") {
+    fprintf(stderr, "Unknown --key_distribution %s\n",
+            FLAGS_key_distribution.c_str());
+    exit(1);
+  }
+  if (FLAGS_zipf_alpha <= 0) {
+    fprintf(stderr, "--zipf_alpha must be positive\n");
+    exit(1);
+  }
+  if (FLAGS_hot_key_percent <= 0 || FLAGS_hot_key_percent > 100 ||
+      FLAGS_hot_op_percent < 0 || FLAGS_hot_op_percent > 100) {
+    fprintf(stderr, "--hot_key_percent and --hot_op_percent must be "
+                    "percentages\n");
+    exit(1);
+  }
 
-  rocksdb::CacheBench bench;
-  if (FLAGS_populate_cache) {
-    bench.PopulateCache();
+  std::vector<rocksdb::TraceRecord> trace;
+  if (!FLAGS_trace_file.empty()) {
+    rocksdb::Status s = rocksdb::LoadTrace(FLAGS_trace_file, &trace);
+    if (!s.ok()) {
+      fprintf(stderr, "Loading trace: %s\n", s.ToString().c_str());
+      exit(1);
+    }
+  }
+  const std::vector<rocksdb::TraceRecord>* trace_ptr =
+      FLAGS_trace_file.empty() ? nullptr : &trace;
+
+  if (FLAGS_num_shard_bits_sweep.empty()) {
+    return rocksdb::RunBenchmark(trace_ptr) ? 0 : 1;
   }
-  if (bench.Run()) {
-    return 0;
-  } else {
-    return 1;
+  std::vector<int> shard_bits_sweep;
+  for (const std::string& bits :
+       rocksdb::StringSplit(FLAGS_num_shard_bits_sweep, ',')) {
+    uint64_t value;
+    if (!rocksdb::ParseDecimal(bits, &value) || value >= 20) {
+      fprintf(stderr, "Bad --num_shard_bits_sweep entry %s\n", bits.c_str());
+      exit(1);
+    }
+    shard_bits_sweep.push_back(static_cast<int>(value));
+  }
+  for (int bits : shard_bits_sweep) {
+    FLAGS_num_shard_bits = bits;
+    if (!rocksdb::RunBenchmark(trace_ptr)) {
+      return 1;
+    }
+    printf("\n");
   }
+  return 0;
 }
 
 #endif  // GFLAGS
@@ -0,0 +1,72 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/cache_reservation_manager.h"
+
+#include <string.h>
+
+namespace rocksdb {
+
+const size_t CacheReservationManager::kSizeDummyEntry;
+const size_t CacheReservationManager::kCacheKeyPrefix;
+
+CacheReservationManager::CacheReservationManager(std::shared_ptr<Cache> cache)
+    : cache_(cache), cache_allocated_size_(0) {
+  assert(cache_ != nullptr);
+  // Construct the cache key using the pointer to this.
+  memset(cache_key_, 0, kCacheKeyPrefix);
+  size_t pointer_size = sizeof(const void*);
+  assert(pointer_size <= kCacheKeyPrefix);
+  memcpy(cache_key_, static_cast<const void*>(this), pointer_size);
+}
+
+CacheReservationManager::~CacheReservationManager() {
+  for (auto* handle : dummy_handles_) {
+    cache_->Release(handle, true);
+  }
+}
+
+Slice CacheReservationManager::GetNextCacheKey() {
+  memset(cache_key_ + kCacheKeyPrefix, 0, kMaxVarint64Length);
+  char* end =
+      EncodeVarint64(cache_key_ + kCacheKeyPrefix, next_cache_key_id_++);
+  return Slice(cache_key_, static_cast<size_t>(end - cache_key_));
+}
+
+void CacheReservationManager::UpdateCacheReservation(size_t new_mem_used) {
+  size_t allocated = cache_allocated_size_.load(std::memory_order_relaxed);
+  while (new_mem_used > allocated) {
+    // Expand size by at least kSizeDummyEntry.
+    // Add a dummy record to the cache
+    Cache::Handle* handle = nullptr;
+    Status s = cache_->Insert(GetNextCacheKey(), nullptr, kSizeDummyEntry,
+                              nullptr, &handle);
+    if (!s.ok() || handle == nullptr) {
+      break;
+    }
+    dummy_handles_.push_back(handle);
+    allocated += kSizeDummyEntry;
+  }
+  // Gradually shrink memory costed in the cache if the actual usage is less
+  // than 3/4 of what we reserve from the cache.
+  // We do this because:
+  // 1. we don't pay the cost of the cache immediately memory is freed, as
+  //    cache insert is expensive;
+  // 2. eventually, if we walk away from a temporary memory increase, we make
+  //    sure shrink the memory costed in cache over time.
+  // In this way, we only shrink costed memory showly even there is enough
+  // margin.
+  if (new_mem_used < mem_used_ && new_mem_used < allocated / 4 * 3 &&
+      allocated - kSizeDummyEntry > new_mem_used) {
+    assert(!dummy_handles_.empty());
+    cache_->Release(dummy_handles_.back(), true);
+    dummy_handles_.pop_back();
+    allocated -= kSizeDummyEntry;
+  }
+  cache_allocated_size_.store(allocated, std::memory_order_relaxed);
+  mem_used_ = new_mem_used;
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,68 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "rocksdb/cache.h"
+#include "util/coding.h"
+
+namespace rocksdb {
+
+// CacheReservationManager charges memory allocated outside of a cache to the
+// cache, by inserting dummy entries of kSizeDummyEntry bytes into it. The
+// entries stay referenced, so they count in the usage of the cache and it
+// evicts other entries to make room for them.
+//
+// Not thread safe: the caller serializes the calls.
+class CacheReservationManager {
+ public:
+  static const size_t kSizeDummyEntry = 1024 * 1024;
+
+  explicit CacheReservationManager(std::shared_ptr<Cache> cache);
+  // Releases the dummy entries
+  ~CacheReservationManager();
+
+  // Adjusts the reservation to new_mem_used bytes of memory. It grows right
+  // away, in steps of kSizeDummyEntry. It only shrinks when the memory went
+  // down since the last call and is less than 3/4 of the reservation, and by
+  // one step per call, so that usage going up and down does not insert and
+  // release entries every time. It stops
+  // growing when the cache rejects an entry, as a full cache with
+  // strict_capacity_limit does.
+  void UpdateCacheReservation(size_t new_mem_used);
+
+  // Total charge of the dummy entries
+  size_t GetTotalReservedCacheSize() const {
+    return cache_allocated_size_.load(std::memory_order_relaxed);
+  }
+
+  Cache* cache() const { return cache_.get(); }
+
+ private:
+  // The key will be longer than keys for blocks in SST files so they won't
+  // conflict.
+  static const size_t kCacheKeyPrefix = kMaxVarint64Length * 4 + 1;
+
+  Slice GetNextCacheKey();
+
+  std::shared_ptr<Cache> cache_;
+  std::atomic<size_t> cache_allocated_size_;
+  // The non-prefix part will be updated according to the ID to use.
+  char cache_key_[kCacheKeyPrefix + kMaxVarint64Length];
+  uint64_t next_cache_key_id_ = 0;
+  // new_mem_used of the last call
+  size_t mem_used_ = 0;
+  std::vector<Cache::Handle*> dummy_handles_;
+
+  // No copying allowed
+  CacheReservationManager(const CacheReservationManager&) = delete;
+  CacheReservationManager& operator=(const CacheReservationManager&) = delete;
+};
+
+}  // namespace rocksdb
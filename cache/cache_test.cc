@@ -9,6 +9,7 @@
 
 #include "rocksdb/cache.h"
 
+#include <atomic>
 #include <forward_list>
 #include <functional>
 #include <iostream>
@@ -16,7 +17,9 @@
 #include <vector>
 #include "cache/clock_cache.h"
 #include "cache/lru_cache.h"
+#include "port/port.h"
 #include "util/coding.h"
+#include "util/random.h"
 #include "util/string_util.h"
 #include "util/testharness.h"
 
@@ -671,6 +674,52 @@ TEST_P(CacheTest, ApplyToAllCacheEntiresTest) {
   ASSERT_TRUE(inserted == callback_state);
 }
 
+TEST_P(CacheTest, ConcurrentLookup) {
+  // Few shards and a small capacity, so that entries are evicted and their
+  // handles re-used for other keys while lookups are going on.
+  std::shared_ptr<Cache> cache = NewCache(200, 1, false);
+  const int kNumThreads = 8;
+  const int kNumKeys = 1000;
+  const int kOpsPerThread = 20000;
+  std::atomic<int> mismatches(0);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      Random rnd(301 + t);
+      for (int i = 0; i < kOpsPerThread; i++) {
+        int key = rnd.Uniform(kNumKeys);
+        int op = rnd.Uniform(10);
+        if (op < 4) {
+          cache->Insert(EncodeKey(key), EncodeValue(key * 2 + 1), 1,
+                        &dumbDeleter);
+        } else if (op < 9) {
+          Cache::Handle* handle = cache->Lookup(EncodeKey(key));
+          if (handle != nullptr) {
+            if (DecodeValue(cache->Value(handle)) != key * 2 + 1) {
+              mismatches++;
+            }
+            cache->Release(handle);
+          }
+        } else {
+          cache->Erase(EncodeKey(key));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, mismatches.load());
+  ASSERT_EQ(0U, cache->GetPinnedUsage());
+  ASSERT_LE(cache->GetUsage(), 200U);
+
+  // Everything left in the cache can still be found.
+  for (int key = 0; key < kNumKeys; key++) {
+    int value = Lookup(cache, key);
+    ASSERT_TRUE(value == -1 || value == key * 2 + 1);
+  }
+}
+
 TEST_P(CacheTest, DefaultShardBits) {
   // test1: set the flag to false. Insert more keys than capacity. See if they
   // all go through.
@@ -26,13 +26,8 @@ std::shared_ptr<Cache> NewClockCache(size_t /*capacity*/, int /*num_shard_bits*/
 #include <assert.h>
 #include <atomic>
 #include <deque>
-
-// "tbb/concurrent_hash_map.h" requires RTTI if exception is enabled.
-// Disable it so users can chooose to disable RTTI.
-#ifndef ROCKSDB_USE_RTTI
-#define TBB_USE_EXCEPTIONS 0
-#endif
-#include "tbb/concurrent_hash_map.h"
+#include <memory>
+#include <vector>
 
 #include "cache/sharded_cache.h"
 #include "port/port.h"
@@ -59,9 +54,9 @@ namespace {
 // to be re-use. This is to avoid memory dealocation, which is hard to deal
 // with in concurrent environment.
 //
-// The cache also maintains a concurrent hash map for lookup. Any concurrent
-// hash map implementation should do the work. We currently use
-// tbb::concurrent_hash_map because it supports concurrent erase.
+// The cache also maintains a hash table for lookup. It is an open-addressing
+// table of handle pointers with linear probing (see ClockHandleTable below).
+// Readers probe it without any lock; writers hold the shard mutex.
 //
 // Each cache handle has the following flags and counters, which are squeeze
 // in an atomic interger, to make sure the handle always be in a consistent
@@ -136,7 +131,7 @@ namespace {
 // A global mutex guards the circular list, the head, and the recycle bin.
 // We additionally require that modifying the hash map needs to hold the mutex.
 // As such, Modifying the cache (such as Insert() and Erase()) require to
-// hold the mutex. Lookup() only access the hash map and the flags associated
+// hold the mutex. Lookup() only access the hash table and the flags associated
 // with each handle, and don't require explicit locking. Release() has to
 // acquire the mutex only when it releases the last reference to the entry and
 // the entry has been erased from cache explicitly. A future improvement could
@@ -204,25 +199,154 @@ struct CacheHandle {
   }
 };
 
-// Key of hash map. We store hash value with the key for convenience.
-struct CacheKey {
-  Slice key;
-  uint32_t hash_value;
-
-  CacheKey() = default;
+// Hash table mapping keys to in-cache handles. It is an open-addressing table
+// with linear probing, storing the hash value alongside each handle pointer
+// so that probing doesn't need to touch the handles.
+//
+// Writers (Insert(), Remove() and Clear()) have to hold the shard mutex.
+// Find() can be called concurrently with them without locking, and is safe
+// because handles are never freed while the cache is alive: a slot always
+// points either to nothing or to a valid CacheHandle. The handle might have
+// been erased and re-used for another key by the time Find() looks at it, so
+// lock-free callers have to Ref() the handle and check its key again.
+//
+// Remove() uses backward-shift deletion instead of tombstones, so a probe
+// always ends at the first empty slot. A lock-free Find() racing with a
+// Remove() or Insert() can miss an entry being moved, which is fine for a
+// cache. When the table grows, the old slot array is kept until the table
+// is destroyed, since concurrent readers may still be probing it. Arrays
+// double in size, so the retired ones take no more space than the current.
+class ClockHandleTable {
+ public:
+  ClockHandleTable() : array_(nullptr), count_(0) { Resize(kInitialSize); }
+
+  // Probe for handles with the given hash, and return the first one for
+  // which match returns true, or nullptr.
+  template <typename Match>
+  CacheHandle* Find(uint32_t hash, const Match& match) const {
+    const SlotArray* array = array_.load(std::memory_order_acquire);
+    for (size_t i = 0, pos = hash & array->mask; i <= array->mask;
+         i++, pos = (pos + 1) & array->mask) {
+      const Slot& slot = array->slots[pos];
+      CacheHandle* handle = slot.handle.load(std::memory_order_acquire);
+      if (handle == nullptr) {
+        break;
+      }
+      if (slot.hash.load(std::memory_order_relaxed) == hash &&
+          match(handle)) {
+        return handle;
+      }
+    }
+    return nullptr;
+  }
 
-  CacheKey(const Slice& k, uint32_t h) {
-    key = k;
-    hash_value = h;
+  // Add the handle to the table. The key of the handle must not be in the
+  // table already.
+  void Insert(CacheHandle* handle) {
+    SlotArray* array = array_.load(std::memory_order_relaxed);
+    if ((count_ + 1) * 2 > array->mask + 1) {
+      Resize((array->mask + 1) * 2);
+      array = array_.load(std::memory_order_relaxed);
+    }
+    InsertInto(array, handle);
+    count_++;
+  }
+
+  // Remove the handle from the table. Return false if it is not there.
+  bool Remove(CacheHandle* handle) {
+    SlotArray* array = array_.load(std::memory_order_relaxed);
+    size_t mask = array->mask;
+    size_t pos = handle->hash & mask;
+    while (true) {
+      CacheHandle* h = array->slots[pos].handle.load(std::memory_order_relaxed);
+      if (h == nullptr) {
+        return false;
+      }
+      if (h == handle) {
+        break;
+      }
+      pos = (pos + 1) & mask;
+    }
+    // Shift back following entries of the probe sequence which may take the
+    // free slot, so that no entry is separated from its home by a hole.
+    for (size_t next = (pos + 1) & mask;; next = (next + 1) & mask) {
+      Slot& slot = array->slots[next];
+      CacheHandle* h = slot.handle.load(std::memory_order_relaxed);
+      if (h == nullptr) {
+        break;
+      }
+      uint32_t hash = slot.hash.load(std::memory_order_relaxed);
+      size_t home = hash & mask;
+      if (((next - home) & mask) >= ((next - pos) & mask)) {
+        array->slots[pos].hash.store(hash, std::memory_order_relaxed);
+        array->slots[pos].handle.store(h, std::memory_order_release);
+        pos = next;
+      }
+    }
+    array->slots[pos].handle.store(nullptr, std::memory_order_release);
+    count_--;
+    return true;
   }
 
-  static bool equal(const CacheKey& a, const CacheKey& b) {
-    return a.hash_value == b.hash_value && a.key == b.key;
+  void Clear() {
+    SlotArray* array = array_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i <= array->mask; i++) {
+      array->slots[i].handle.store(nullptr, std::memory_order_release);
+    }
+    count_ = 0;
   }
 
-  static size_t hash(const CacheKey& a) {
-    return static_cast<size_t>(a.hash_value);
+ private:
+  static const size_t kInitialSize = 16;
+
+  struct Slot {
+    std::atomic<uint32_t> hash;
+    std::atomic<CacheHandle*> handle;
+
+    Slot() : hash(0), handle(nullptr) {}
+  };
+
+  struct SlotArray {
+    size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    explicit SlotArray(size_t size) : mask(size - 1), slots(new Slot[size]) {}
+  };
+
+  static void InsertInto(SlotArray* array, CacheHandle* handle) {
+    size_t pos = handle->hash & array->mask;
+    while (array->slots[pos].handle.load(std::memory_order_relaxed) !=
+           nullptr) {
+      pos = (pos + 1) & array->mask;
+    }
+    array->slots[pos].hash.store(handle->hash, std::memory_order_relaxed);
+    array->slots[pos].handle.store(handle, std::memory_order_release);
+  }
+
+  void Resize(size_t size) {
+    SlotArray* old_array = array_.load(std::memory_order_relaxed);
+    arrays_.emplace_back(new SlotArray(size));
+    SlotArray* array = arrays_.back().get();
+    if (old_array != nullptr) {
+      for (size_t i = 0; i <= old_array->mask; i++) {
+        CacheHandle* handle =
+            old_array->slots[i].handle.load(std::memory_order_relaxed);
+        if (handle != nullptr) {
+          InsertInto(array, handle);
+        }
+      }
+    }
+    array_.store(array, std::memory_order_release);
   }
+
+  // The slot array in use.
+  std::atomic<SlotArray*> array_;
+
+  // All slot arrays ever allocated, the one in use being the last.
+  std::vector<std::unique_ptr<SlotArray>> arrays_;
+
+  // Number of handles in the table.
+  size_t count_;
 };
 
 struct CleanupContext {
@@ -236,9 +360,6 @@ struct CleanupContext {
 // A cache shard which maintains its own CLOCK cache.
 class ClockCacheShard : public CacheShard {
  public:
-  // Hash map type.
-  typedef tbb::concurrent_hash_map<CacheKey, CacheHandle*, CacheKey> HashTable;
-
   ClockCacheShard();
   ~ClockCacheShard();
 
@@ -266,6 +387,10 @@ class ClockCacheShard : public CacheShard {
   virtual void EraseUnRefEntries() override;
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) override;
+  virtual void ApplyToAllCacheKeys(
+      const std::function<void(const Slice&, size_t, Cache::Priority)>&
+          callback,
+      bool thread_safe) override;
 
  private:
   static const uint32_t kInCacheBit = 1;
@@ -318,6 +443,11 @@ class ClockCacheShard : public CacheShard {
   // Has to hold mutex_ before being called.
   bool EvictFromCache(size_t charge, CleanupContext* context);
 
+  // Find the in-cache handle of the key.
+  //
+  // Has to hold mutex_ before being called.
+  CacheHandle* FindLocked(const Slice& key, uint32_t hash);
+
   CacheHandle* Insert(const Slice& key, uint32_t hash, void* value,
                       size_t change,
                       void (*deleter)(const Slice& key, void* value),
@@ -356,8 +486,8 @@ class ClockCacheShard : public CacheShard {
   // Whether allow insert into cache if cache is full.
   std::atomic<bool> strict_capacity_limit_;
 
-  // Hash table (tbb::concurrent_hash_map) for lookup.
-  HashTable table_;
+  // Hash table for lookup.
+  ClockHandleTable table_;
 };
 
 ClockCacheShard::ClockCacheShard()
@@ -401,6 +531,24 @@ void ClockCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
   }
 }
 
+void ClockCacheShard::ApplyToAllCacheKeys(
+    const std::function<void(const Slice&, size_t, Cache::Priority)>& callback,
+    bool thread_safe) {
+  if (thread_safe) {
+    mutex_.Lock();
+  }
+  for (auto& handle : list_) {
+    uint32_t flags = handle.flags.load(std::memory_order_relaxed);
+    if (InCache(flags)) {
+      // Priorities are not kept.
+      callback(handle.key, handle.charge, Cache::Priority::LOW);
+    }
+  }
+  if (thread_safe) {
+    mutex_.Unlock();
+  }
+}
+
 void ClockCacheShard::RecycleHandle(CacheHandle* handle,
                                     CleanupContext* context) {
   mutex_.AssertHeld();
@@ -447,7 +595,11 @@ bool ClockCacheShard::Ref(Cache::Handle* h) {
 
 bool ClockCacheShard::Unref(CacheHandle* handle, bool set_usage,
                             CleanupContext* context) {
-  if (set_usage) {
+  // Skip the read-modify-write if the usage bit is already set, which is
+  // the common case for hot entries, to keep their cache line shared among
+  // readers.
+  if (set_usage &&
+      !HasUsage(handle->flags.load(std::memory_order_relaxed))) {
     handle->flags.fetch_or(kUsageBit, std::memory_order_relaxed);
   }
   // Use acquire-release semantics as previous operations on the cache entry
@@ -487,8 +639,7 @@ bool ClockCacheShard::TryEvict(CacheHandle* handle, CleanupContext* context) {
   uint32_t flags = kInCacheBit;
   if (handle->flags.compare_exchange_strong(flags, 0, std::memory_order_acquire,
                                             std::memory_order_relaxed)) {
-    bool erased __attribute__((__unused__)) =
-        table_.erase(CacheKey(handle->key, handle->hash));
+    bool erased __attribute__((__unused__)) = table_.Remove(handle);
     assert(erased);
     RecycleHandle(handle, context);
     return true;
@@ -568,15 +719,16 @@ CacheHandle* ClockCacheShard::Insert(
   handle->value = value;
   handle->charge = charge;
   handle->deleter = deleter;
+  // Use release semantics so that a lock-free Lookup() which gets a
+  // reference to the handle sees the fields filled above.
   uint32_t flags = hold_reference ? kInCacheBit + kOneRef : kInCacheBit;
-  handle->flags.store(flags, std::memory_order_relaxed);
-  HashTable::accessor accessor;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* existing_handle = accessor->second;
-    table_.erase(accessor);
+  handle->flags.store(flags, std::memory_order_release);
+  CacheHandle* existing_handle = FindLocked(key, hash);
+  if (existing_handle != nullptr) {
+    table_.Remove(existing_handle);
     UnsetInCache(existing_handle, context);
   }
-  table_.insert(HashTable::value_type(CacheKey(key, hash), handle));
+  table_.Insert(handle);
   if (hold_reference) {
     pinned_usage_.fetch_add(charge, std::memory_order_relaxed);
   }
@@ -590,7 +742,6 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                                Cache::Handle** out_handle,
                                Cache::Priority /*priority*/) {
   CleanupContext context;
-  HashTable::accessor accessor;
   char* key_data = new char[key.size()];
   memcpy(key_data, key.data(), key.size());
   Slice key_copy(key_data, key.size());
@@ -608,28 +759,32 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   return s;
 }
 
+CacheHandle* ClockCacheShard::FindLocked(const Slice& key, uint32_t hash) {
+  mutex_.AssertHeld();
+  return table_.Find(hash, [&](CacheHandle* handle) {
+    return handle->hash == hash && handle->key == key;
+  });
+}
+
 Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  HashTable::const_accessor accessor;
-  if (!table_.find(accessor, CacheKey(key, hash))) {
-    return nullptr;
-  }
-  CacheHandle* handle = accessor->second;
-  accessor.release();
-  // Ref() could fail if another thread sneak in and evict/erase the cache
-  // entry before we are able to hold reference.
-  if (!Ref(reinterpret_cast<Cache::Handle*>(handle))) {
-    return nullptr;
-  }
-  // Double check the key since the handle may now representing another key
-  // if other threads sneak in, evict/erase the entry and re-used the handle
-  // for another cache entry.
-  if (hash != handle->hash || key != handle->key) {
-    CleanupContext context;
-    Unref(handle, false, &context);
-    // It is possible Unref() delete the entry, so we need to cleanup.
-    Cleanup(context);
-    return nullptr;
-  }
+  CacheHandle* handle = table_.Find(hash, [&](CacheHandle* candidate) {
+    // Ref() could fail if another thread sneak in and evict/erase the cache
+    // entry before we are able to hold reference.
+    if (!Ref(reinterpret_cast<Cache::Handle*>(candidate))) {
+      return false;
+    }
+    // Check the key only after holding a reference, since the handle may now
+    // representing another key if other threads sneak in, evict/erase the
+    // entry and re-used the handle for another cache entry.
+    if (hash != candidate->hash || key != candidate->key) {
+      CleanupContext context;
+      Unref(candidate, false, &context);
+      // It is possible Unref() delete the entry, so we need to cleanup.
+      Cleanup(context);
+      return false;
+    }
+    return true;
+  });
   return reinterpret_cast<Cache::Handle*>(handle);
 }
 
@@ -653,11 +808,10 @@ void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
 bool ClockCacheShard::EraseAndConfirm(const Slice& key, uint32_t hash,
                                       CleanupContext* context) {
   MutexLock l(&mutex_);
-  HashTable::accessor accessor;
   bool erased = false;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* handle = accessor->second;
-    table_.erase(accessor);
+  CacheHandle* handle = FindLocked(key, hash);
+  if (handle != nullptr) {
+    table_.Remove(handle);
     erased = UnsetInCache(handle, context);
   }
   return erased;
@@ -667,7 +821,7 @@ void ClockCacheShard::EraseUnRefEntries() {
   CleanupContext context;
   {
     MutexLock l(&mutex_);
-    table_.clear();
+    table_.Clear();
     for (auto& handle : list_) {
       UnsetInCache(&handle, &context);
     }
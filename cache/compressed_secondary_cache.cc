@@ -0,0 +1,144 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/compressed_secondary_cache.h"
+
+#include <string.h>
+#include <string>
+
+#include "util/compression.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Entries carry the size prefix of compression format version 2, so that
+// they can be uncompressed without keeping the size separately.
+const uint32_t kCompressFormatVersion = 2;
+
+struct SecondaryEntry {
+  CompressionType type;
+  std::string data;
+};
+
+void DeleteSecondaryEntry(const Slice& /*key*/, void* value) {
+  delete reinterpret_cast<SecondaryEntry*>(value);
+}
+
+bool Compress(const CompressionContext& ctx, const Slice& raw,
+              std::string* output) {
+  switch (ctx.type()) {
+    case kSnappyCompression:
+      return Snappy_Compress(ctx, raw.data(), raw.size(), output);
+    case kZlibCompression:
+      return Zlib_Compress(ctx, kCompressFormatVersion, raw.data(), raw.size(),
+                           output);
+    case kLZ4Compression:
+      return LZ4_Compress(ctx, kCompressFormatVersion, raw.data(), raw.size(),
+                          output);
+    case kLZ4HCCompression:
+      return LZ4HC_Compress(ctx, kCompressFormatVersion, raw.data(),
+                            raw.size(), output);
+    case kZSTD:
+      return ZSTD_Compress(ctx, raw.data(), raw.size(), output);
+    default:
+      return false;
+  }
+}
+
+bool Uncompress(CompressionType type, const std::string& input,
+                std::unique_ptr<char[]>* data, size_t* size) {
+  UncompressionContext ctx(type);
+  CacheAllocationPtr output;
+  int output_size = 0;
+  switch (type) {
+    case kSnappyCompression: {
+      if (!Snappy_GetUncompressedLength(input.data(), input.size(), size)) {
+        return false;
+      }
+      data->reset(new char[*size]);
+      return Snappy_Uncompress(input.data(), input.size(), data->get());
+    }
+    case kZlibCompression:
+      output = Zlib_Uncompress(ctx, input.data(), input.size(), &output_size,
+                               kCompressFormatVersion);
+      break;
+    case kLZ4Compression:
+    case kLZ4HCCompression:
+      output = LZ4_Uncompress(ctx, input.data(), input.size(), &output_size,
+                              kCompressFormatVersion);
+      break;
+    case kZSTD:
+      output = ZSTD_Uncompress(ctx, input.data(), input.size(), &output_size);
+      break;
+    default:
+      return false;
+  }
+  if (!output) {
+    return false;
+  }
+  // Allocated with new[] since no allocator was given.
+  data->reset(output.release());
+  *size = static_cast<size_t>(output_size);
+  return true;
+}
+
+}  // namespace
+
+CompressedSecondaryCache::CompressedSecondaryCache(
+    size_t capacity, int num_shard_bits, CompressionType compression_type)
+    : cache_(NewLRUCache(capacity, num_shard_bits)),
+      compression_type_(compression_type) {
+  if (!CompressionTypeSupported(compression_type_)) {
+    compression_type_ = kNoCompression;
+  }
+}
+
+CompressedSecondaryCache::~CompressedSecondaryCache() {}
+
+Status CompressedSecondaryCache::Insert(const Slice& key, const Slice& data) {
+  SecondaryEntry* entry = new SecondaryEntry();
+  entry->type = kNoCompression;
+  if (compression_type_ != kNoCompression) {
+    CompressionContext ctx(compression_type_);
+    // Same threshold as the table builder's GoodCompressionRatio().
+    if (Compress(ctx, data, &entry->data) &&
+        entry->data.size() < data.size() - (data.size() / 8u)) {
+      entry->type = compression_type_;
+      entry->data.shrink_to_fit();
+    }
+  }
+  if (entry->type == kNoCompression) {
+    entry->data.assign(data.data(), data.size());
+  }
+  size_t charge = sizeof(SecondaryEntry) + entry->data.size();
+  return cache_->Insert(key, entry, charge, &DeleteSecondaryEntry);
+}
+
+bool CompressedSecondaryCache::Lookup(const Slice& key,
+                                      std::unique_ptr<char[]>* data,
+                                      size_t* size) {
+  Cache::Handle* handle = cache_->Lookup(key);
+  if (handle == nullptr) {
+    return false;
+  }
+  SecondaryEntry* entry =
+      reinterpret_cast<SecondaryEntry*>(cache_->Value(handle));
+  bool found;
+  if (entry->type == kNoCompression) {
+    *size = entry->data.size();
+    data->reset(new char[*size]);
+    memcpy(data->get(), entry->data.data(), *size);
+    found = true;
+  } else {
+    found = Uncompress(entry->type, entry->data, data, size);
+  }
+  // The caller puts the entry back into the primary cache, so don't keep a
+  // second copy here.
+  cache_->Release(handle, true /* force_erase */);
+  return found;
+}
+
+}  // namespace rocksdb
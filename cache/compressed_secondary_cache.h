@@ -0,0 +1,45 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/compression_type.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+// The secondary tier of an LRUCache (see
+// LRUCacheOptions::compressed_secondary_cache_capacity). It keeps the saved
+// contents of entries evicted from the cache, compressed, in an LRUCache of
+// its own, charging each entry with its compressed size.
+class CompressedSecondaryCache {
+ public:
+  CompressedSecondaryCache(size_t capacity, int num_shard_bits,
+                           CompressionType compression_type);
+  ~CompressedSecondaryCache();
+
+  // Compress data and keep it under key, replacing any older entry of key.
+  // Data is kept uncompressed if it does not compress by at least 1/8.
+  Status Insert(const Slice& key, const Slice& data);
+
+  // If key is present, remove it and return its data uncompressed.
+  bool Lookup(const Slice& key, std::unique_ptr<char[]>* data, size_t* size);
+
+  size_t GetUsage() const { return cache_->GetUsage(); }
+  size_t GetCapacity() const { return cache_->GetCapacity(); }
+  CompressionType compression_type() const { return compression_type_; }
+
+ private:
+  std::shared_ptr<Cache> cache_;
+
+  // kNoCompression if the configured type is not supported.
+  CompressionType compression_type_;
+};
+
+}  // namespace rocksdb
@@ -0,0 +1,116 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace rocksdb {
+
+// A count-min sketch estimating how many times each key hash was recorded
+// recently, used for TinyLFU admission in LRUCacheShard. It has four rows of
+// width counters saturating at 15. Once 10 * width increments have been
+// recorded, all counters are halved, so that keys which were popular a long
+// time ago lose their advantage over keys which are popular now.
+//
+// Not thread safe.
+class FrequencySketch {
+ public:
+  explicit FrequencySketch(uint32_t width) { Reset(width); }
+
+  // Forget all counts. width is rounded up to a power of two, and should be
+  // at least the number of distinct keys to be told apart.
+  void Reset(uint32_t width) {
+    width_bits_ = 4;
+    while ((uint32_t{1} << width_bits_) < width && width_bits_ < 31) {
+      width_bits_++;
+    }
+    counters_.assign(size_t{kDepth} << width_bits_, 0);
+    additions_ = 0;
+    sample_size_ = size_t{10} << width_bits_;
+  }
+
+  // Widen the sketch to at least width counters per row, keeping the counts
+  // recorded so far. A wider row splits each counter into several, which
+  // all start at half of its count, as if the sketch had just aged.
+  void Grow(uint32_t width) {
+    int old_bits = width_bits_;
+    while ((uint32_t{1} << width_bits_) < width && width_bits_ < 31) {
+      width_bits_++;
+    }
+    if (width_bits_ == old_bits) {
+      return;
+    }
+    // Index() takes the top bits of the same product, so the new counters of
+    // a key are among those its old counter is split into.
+    int shift = width_bits_ - old_bits;
+    std::vector<uint8_t> counters(size_t{kDepth} << width_bits_);
+    for (size_t i = 0; i < counters.size(); i++) {
+      size_t row = i >> width_bits_;
+      size_t column = (i & ((size_t{1} << width_bits_) - 1)) >> shift;
+      counters[i] = counters_[(row << old_bits) + column] >> 1;
+    }
+    counters_.swap(counters);
+    additions_ /= 2;
+    sample_size_ = size_t{10} << width_bits_;
+  }
+
+  uint32_t width() const { return uint32_t{1} << width_bits_; }
+
+  void Increment(uint32_t hash) {
+    bool added = false;
+    for (int row = 0; row < kDepth; row++) {
+      uint8_t& counter = counters_[Index(hash, row)];
+      if (counter < kMaxCount) {
+        counter++;
+        added = true;
+      }
+    }
+    if (added && ++additions_ >= sample_size_) {
+      Age();
+    }
+  }
+
+  uint32_t Estimate(uint32_t hash) const {
+    uint32_t estimate = kMaxCount;
+    for (int row = 0; row < kDepth; row++) {
+      uint32_t counter = counters_[Index(hash, row)];
+      if (counter < estimate) {
+        estimate = counter;
+      }
+    }
+    return estimate;
+  }
+
+ private:
+  static const int kDepth = 4;
+  static const uint8_t kMaxCount = 15;
+
+  // The cache hashes of one shard share their top bits, so each row takes
+  // the top bits of the hash multiplied by a different odd constant.
+  size_t Index(uint32_t hash, int row) const {
+    static const uint64_t kMultipliers[kDepth] = {
+        0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull,
+        0xD6E8FEB86659FD93ull};
+    uint64_t h = (static_cast<uint64_t>(hash) << 32 | hash) * kMultipliers[row];
+    return (static_cast<size_t>(row) << width_bits_) +
+           static_cast<size_t>(h >> (64 - width_bits_));
+  }
+
+  void Age() {
+    for (auto& counter : counters_) {
+      counter >>= 1;
+    }
+    additions_ /= 2;
+  }
+
+  std::vector<uint8_t> counters_;
+  int width_bits_;
+  size_t additions_;
+  size_t sample_size_;
+};
+
+}  // namespace rocksdb
@@ -16,6 +16,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <string>
 
 #include "util/mutexlock.h"
@@ -106,6 +107,8 @@ LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
       strict_capacity_limit_(strict_capacity_limit),
       high_pri_pool_ratio_(high_pri_pool_ratio),
       high_pri_pool_capacity_(0),
+      secondary_cache_(nullptr),
+      has_reservations_(false),
       usage_(0),
       lru_usage_(0) {
   // Make empty circular linked list
@@ -130,16 +133,7 @@ void LRUCacheShard::EraseUnRefEntries() {
   {
     MutexLock l(&mutex_);
     while (lru_.next != &lru_) {
-      LRUHandle* old = lru_.next;
-      assert(old->InCache());
-      assert(old->refs ==
-             1);  // LRU list contains elements which may be evicted
-      LRU_Remove(old);
-      table_.Remove(old->key(), old->hash);
-      old->SetInCache(false);
-      Unref(old);
-      usage_ -= old->charge;
-      last_reference_list.push_back(old);
+      EvictEntry(lru_.next, &last_reference_list);
     }
   }
 
@@ -160,6 +154,21 @@ void LRUCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
   }
 }
 
+void LRUCacheShard::ApplyToAllCacheKeys(
+    const std::function<void(const Slice&, size_t, Cache::Priority)>& callback,
+    bool thread_safe) {
+  if (thread_safe) {
+    mutex_.Lock();
+  }
+  table_.ApplyToAllCacheEntries([&callback](LRUHandle* h) {
+    callback(h->key(), h->charge,
+             h->IsHighPri() ? Cache::Priority::HIGH : Cache::Priority::LOW);
+  });
+  if (thread_safe) {
+    mutex_.Unlock();
+  }
+}
+
 void LRUCacheShard::TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri) {
   *lru = &lru_;
   *lru_low_pri = lru_low_pri_;
@@ -194,6 +203,20 @@ void LRUCacheShard::LRU_Remove(LRUHandle* e) {
     assert(high_pri_pool_usage_ >= e->charge);
     high_pri_pool_usage_ -= e->charge;
   }
+  if (e->quota_group != Cache::kNoQuotaGroup) {
+    QuotaGroup& group = quota_groups_[e->quota_group];
+    if (e->prev_in_group != nullptr) {
+      e->prev_in_group->next_in_group = e->next_in_group;
+    } else {
+      group.oldest = e->next_in_group;
+    }
+    if (e->next_in_group != nullptr) {
+      e->next_in_group->prev_in_group = e->prev_in_group;
+    } else {
+      group.newest = e->prev_in_group;
+    }
+    e->prev_in_group = e->next_in_group = nullptr;
+  }
 }
 
 void LRUCacheShard::LRU_Insert(LRUHandle* e) {
@@ -208,6 +231,17 @@ void LRUCacheShard::LRU_Insert(LRUHandle* e) {
     e->SetInHighPriPool(true);
     high_pri_pool_usage_ += e->charge;
     MaintainPoolSize();
+  } else if (e->OnProbation() && !e->HasHit()) {
+    // Insert "e" to the tail of LRU list, so that it is evicted first unless
+    // it gets hit.
+    e->next = lru_.next;
+    e->prev = &lru_;
+    e->prev->next = e;
+    e->next->prev = e;
+    e->SetInHighPriPool(false);
+    if (lru_low_pri_ == &lru_) {
+      lru_low_pri_ = e;
+    }
   } else {
     // Insert "e" to the head of low-pri pool. Note that when
     // high_pri_pool_ratio is 0, head of low-pri pool is also head of LRU list.
@@ -219,6 +253,50 @@ void LRUCacheShard::LRU_Insert(LRUHandle* e) {
     lru_low_pri_ = e;
   }
   lru_usage_ += e->charge;
+  if (e->quota_group != Cache::kNoQuotaGroup) {
+    // Entries on probation are evicted first within the group too.
+    QuotaGroup& group = quota_groups_[e->quota_group];
+    if (group.oldest == nullptr) {
+      group.oldest = group.newest = e;
+    } else if (e->OnProbation() && !e->HasHit()) {
+      e->next_in_group = group.oldest;
+      group.oldest->prev_in_group = e;
+      group.oldest = e;
+    } else {
+      e->prev_in_group = group.newest;
+      group.newest->next_in_group = e;
+      group.newest = e;
+    }
+  }
+}
+
+void LRUCacheShard::AddUsage(LRUHandle* e) {
+  usage_ += e->charge;
+  for (uint32_t g = e->quota_group; g != Cache::kNoQuotaGroup;
+       g = quota_groups_[g].parent) {
+    quota_groups_[g].usage += e->charge;
+  }
+}
+
+void LRUCacheShard::SubtractUsage(LRUHandle* e) {
+  usage_ -= e->charge;
+  for (uint32_t g = e->quota_group; g != Cache::kNoQuotaGroup;
+       g = quota_groups_[g].parent) {
+    assert(quota_groups_[g].usage >= e->charge);
+    quota_groups_[g].usage -= e->charge;
+  }
+}
+
+void LRUCacheShard::EvictEntry(LRUHandle* e,
+                               autovector<LRUHandle*>* deleted) {
+  assert(e->InCache());
+  assert(e->refs == 1);  // LRU list contains elements which may be evicted
+  LRU_Remove(e);
+  table_.Remove(e->key(), e->hash);
+  e->SetInCache(false);
+  Unref(e);
+  SubtractUsage(e);
+  deleted->push_back(e);
 }
 
 void LRUCacheShard::MaintainPoolSize() {
@@ -233,17 +311,92 @@ void LRUCacheShard::MaintainPoolSize() {
 
 void LRUCacheShard::EvictFromLRU(size_t charge,
                                  autovector<LRUHandle*>* deleted) {
+  // Bytes of reserved entries moved to the head of the list, to stop once
+  // nothing but reserved entries is left.
+  size_t skipped = 0;
   while (usage_ + charge > capacity_ && lru_.next != &lru_) {
     LRUHandle* old = lru_.next;
-    assert(old->InCache());
-    assert(old->refs == 1);  // LRU list contains elements which may be evicted
-    LRU_Remove(old);
-    table_.Remove(old->key(), old->hash);
-    old->SetInCache(false);
-    Unref(old);
-    usage_ -= old->charge;
-    deleted->push_back(old);
+    if (has_reservations_ && IsReserved(old)) {
+      if (skipped >= lru_usage_) {
+        break;
+      }
+      skipped += old->charge;
+      LRU_Remove(old);
+      LRU_Insert(old);
+      continue;
+    }
+    EvictEntry(old, deleted);
+  }
+}
+
+bool LRUCacheShard::OverLimit(uint32_t group, size_t charge) const {
+  for (uint32_t g = group; g != Cache::kNoQuotaGroup;
+       g = quota_groups_[g].parent) {
+    const QuotaGroup& quota_group = quota_groups_[g];
+    if (quota_group.limit > 0 &&
+        quota_group.usage + charge > quota_group.limit) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LRUCacheShard::IsReserved(const LRUHandle* e) const {
+  for (uint32_t g = e->quota_group; g != Cache::kNoQuotaGroup;
+       g = quota_groups_[g].parent) {
+    const QuotaGroup& quota_group = quota_groups_[g];
+    if (quota_group.reservation > 0 &&
+        quota_group.usage <= quota_group.reservation) {
+      return true;
+    }
   }
+  return false;
+}
+
+void LRUCacheShard::EvictOverLimit(uint32_t group, size_t charge,
+                                   autovector<LRUHandle*>* deleted) {
+  for (uint32_t over = group; over != Cache::kNoQuotaGroup;
+       over = quota_groups_[over].parent) {
+    if (quota_groups_[over].limit == 0) {
+      continue;
+    }
+    EvictFromQuotaGroup(group, over, charge, deleted);
+    if (over != group) {
+      EvictFromQuotaGroup(over, over, charge, deleted);
+    }
+    for (uint32_t child : quota_groups_[over].children) {
+      if (child != group) {
+        EvictFromQuotaGroup(child, over, charge, deleted);
+      }
+    }
+  }
+}
+
+void LRUCacheShard::EvictFromQuotaGroup(uint32_t from, uint32_t over,
+                                        size_t charge,
+                                        autovector<LRUHandle*>* deleted) {
+  while (quota_groups_[over].usage + charge > quota_groups_[over].limit &&
+         quota_groups_[from].oldest != nullptr) {
+    EvictEntry(quota_groups_[from].oldest, deleted);
+  }
+}
+
+bool LRUCacheShard::Admit(uint32_t hash, size_t charge) {
+  if (sketch_ == nullptr) {
+    return true;
+  }
+  sketch_->Increment(hash);
+  if (usage_ + charge <= capacity_ || lru_.next == &lru_) {
+    return true;
+  }
+  return sketch_->Estimate(hash) > sketch_->Estimate(lru_.next->hash);
+}
+
+void LRUCacheShard::FreeEvicted(LRUHandle* e) {
+  if (secondary_cache_ != nullptr && e->save_cb != nullptr) {
+    secondary_cache_->Insert(e->key(), (*e->save_cb)(e->value));
+  }
+  e->Free();
 }
 
 void LRUCacheShard::SetCapacity(size_t capacity) {
@@ -257,10 +410,15 @@ void LRUCacheShard::SetCapacity(size_t capacity) {
   // we free the entries here outside of mutex for
   // performance reasons
   for (auto entry : last_reference_list) {
-    entry->Free();
+    FreeEvicted(entry);
   }
 }
 
+void LRUCacheShard::EnableFrequencyBasedAdmission() {
+  MutexLock l(&mutex_);
+  sketch_.reset(new FrequencySketch(table_.NumElements()));
+}
+
 void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
   MutexLock l(&mutex_);
   strict_capacity_limit_ = strict_capacity_limit;
@@ -268,6 +426,9 @@ void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
 
 Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
   MutexLock l(&mutex_);
+  if (sketch_ != nullptr) {
+    sketch_->Increment(hash);
+  }
   LRUHandle* e = table_.Lookup(key, hash);
   if (e != nullptr) {
     assert(e->InCache());
@@ -303,24 +464,29 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
   }
   LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
   bool last_reference = false;
+  bool evicted = false;
   {
     MutexLock l(&mutex_);
     last_reference = Unref(e);
     if (last_reference) {
-      usage_ -= e->charge;
+      SubtractUsage(e);
     }
     if (e->refs == 1 && e->InCache()) {
       // The item is still in cache, and nobody else holds a reference to it
-      if (usage_ > capacity_ || force_erase) {
-        // the cache is full
-        // The LRU list must be empty since the cache is full
-        assert(!(usage_ > capacity_) || lru_.next == &lru_);
+      if (usage_ > capacity_ || force_erase ||
+          OverLimit(e->quota_group, 0)) {
+        // the cache is full, or the quota group of the item is
+        // The LRU list must be empty since the cache is full, unless it only
+        // holds reserved entries
+        assert(!(usage_ > capacity_) || lru_.next == &lru_ ||
+               has_reservations_);
         // take this opportunity and remove the item
         table_.Remove(e->key(), e->hash);
         e->SetInCache(false);
         Unref(e);
-        usage_ -= e->charge;
+        SubtractUsage(e);
         last_reference = true;
+        evicted = !force_erase;
       } else {
         // put the item on the list to be potentially freed
         LRU_Insert(e);
@@ -329,7 +495,9 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
   }
 
   // free outside of mutex
-  if (last_reference) {
+  if (evicted) {
+    FreeEvicted(e);
+  } else if (last_reference) {
     e->Free();
   }
   return last_reference;
@@ -339,6 +507,15 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                              size_t charge,
                              void (*deleter)(const Slice& key, void* value),
                              Cache::Handle** handle, Cache::Priority priority) {
+  return InsertSaveable(key, hash, value, charge, deleter, nullptr, handle,
+                        priority);
+}
+
+Status LRUCacheShard::InsertSaveable(
+    const Slice& key, uint32_t hash, void* value, size_t charge,
+    void (*deleter)(const Slice& key, void* value),
+    Slice (*save_cb)(void* value), Cache::Handle** handle,
+    Cache::Priority priority, uint32_t quota_group) {
   // Allocate the memory here outside of the mutex
   // If the cache is full, we'll have to release it
   // It shouldn't happen very often though.
@@ -346,17 +523,21 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
       new char[sizeof(LRUHandle) - 1 + key.size()]);
   Status s;
   autovector<LRUHandle*> last_reference_list;
+  size_t num_evicted = 0;
 
   e->value = value;
   e->deleter = deleter;
+  e->save_cb = save_cb;
   e->charge = charge;
   e->key_length = key.size();
   e->flags = 0;
+  e->quota_group = static_cast<uint16_t>(quota_group);
   e->hash = hash;
   e->refs = (handle == nullptr
                  ? 1
                  : 2);  // One from LRUCache, one for the returned handle
   e->next = e->prev = nullptr;
+  e->next_in_group = e->prev_in_group = nullptr;
   e->SetInCache(true);
   e->SetPriority(priority);
   memcpy(e->key_data, key.data(), key.size());
@@ -364,12 +545,33 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   {
     MutexLock l(&mutex_);
 
-    // Free the space following strict LRU policy until enough space
-    // is freed or the lru list is empty
-    EvictFromLRU(charge, &last_reference_list);
+    // TinyLFU admission: an entry used less often than the eviction victim
+    // is dropped right away, or if the caller keeps a handle to it, put on
+    // probation at the tail of the LRU list once released.
+    bool admitted = Admit(hash, charge);
+    if (!admitted && handle != nullptr) {
+      e->SetOnProbation();
+    }
 
-    if (usage_ - lru_usage_ + charge > capacity_ &&
-        (strict_capacity_limit_ || handle == nullptr)) {
+    // Free the space following strict LRU policy until enough space
+    // is freed or the lru list is empty, making room within the quota of the
+    // entry first
+    assert(quota_group < std::max<size_t>(quota_groups_.size(), 1));
+    if (admitted || handle != nullptr) {
+      if (quota_group != Cache::kNoQuotaGroup) {
+        EvictOverLimit(quota_group, charge, &last_reference_list);
+      }
+      EvictFromLRU(charge, &last_reference_list);
+    }
+    num_evicted = last_reference_list.size();
+
+    if (handle == nullptr &&
+        (!admitted || OverLimit(quota_group, charge))) {
+      // Don't insert the entry but still return ok, as if the entry inserted
+      // into cache and get evicted immediately.
+      last_reference_list.push_back(e);
+    } else if (usage_ - lru_usage_ + charge > capacity_ &&
+               (strict_capacity_limit_ || handle == nullptr)) {
       if (handle == nullptr) {
         // Don't insert the entry but still return ok, as if the entry inserted
         // into cache and get evicted immediately.
@@ -384,11 +586,11 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
       // note that the cache might get larger than its capacity if not enough
       // space was freed
       LRUHandle* old = table_.Insert(e);
-      usage_ += e->charge;
+      AddUsage(e);
       if (old != nullptr) {
         old->SetInCache(false);
         if (Unref(old)) {
-          usage_ -= old->charge;
+          SubtractUsage(old);
           // old is on LRU because it's in cache and its reference count
           // was just 1 (Unref returned 0)
           LRU_Remove(old);
@@ -400,14 +602,23 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
       } else {
         *handle = reinterpret_cast<Cache::Handle*>(e);
       }
+      if (sketch_ != nullptr && table_.NumElements() > sketch_->width()) {
+        // Keep the sketch about as wide as the number of entries.
+        sketch_->Grow(2 * table_.NumElements());
+      }
       s = Status::OK();
     }
   }
 
   // we free the entries here outside of mutex for
-  // performance reasons
-  for (auto entry : last_reference_list) {
-    entry->Free();
+  // performance reasons. Entries after the evicted ones were rejected or
+  // replaced rather than evicted.
+  for (size_t i = 0; i < last_reference_list.size(); i++) {
+    if (i < num_evicted) {
+      FreeEvicted(last_reference_list[i]);
+    } else {
+      last_reference_list[i]->Free();
+    }
   }
 
   return s;
@@ -422,7 +633,7 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
     if (e != nullptr) {
       last_reference = Unref(e);
       if (last_reference) {
-        usage_ -= e->charge;
+        SubtractUsage(e);
       }
       if (last_reference && e->InCache()) {
         LRU_Remove(e);
@@ -449,13 +660,54 @@ size_t LRUCacheShard::GetPinnedUsage() const {
   return usage_ - lru_usage_;
 }
 
+Status LRUCacheShard::SetQuota(uint32_t group, uint32_t parent,
+                               size_t reservation, size_t limit) {
+  autovector<LRUHandle*> last_reference_list;
+  {
+    MutexLock l(&mutex_);
+    if (group >= quota_groups_.size()) {
+      assert(group == std::max<size_t>(quota_groups_.size(), 1));
+      assert(parent < group);
+      quota_groups_.resize(group + 1);
+      quota_groups_[group].parent = parent;
+      if (parent != Cache::kNoQuotaGroup) {
+        quota_groups_[parent].children.push_back(group);
+      }
+    } else if (quota_groups_[group].parent != parent) {
+      // Only a group without entries gets a parent, so the usage of the
+      // parent does not change.
+      assert(quota_groups_[group].parent == Cache::kNoQuotaGroup);
+      assert(quota_groups_[group].usage == 0);
+      assert(quota_groups_[group].children.empty());
+      quota_groups_[group].parent = parent;
+      quota_groups_[parent].children.push_back(group);
+    }
+    QuotaGroup& quota_group = quota_groups_[group];
+    quota_group.reservation = reservation;
+    quota_group.limit = limit;
+    has_reservations_ = has_reservations_ || reservation > 0;
+    EvictOverLimit(group, 0, &last_reference_list);
+  }
+  for (auto entry : last_reference_list) {
+    FreeEvicted(entry);
+  }
+  return Status::OK();
+}
+
+size_t LRUCacheShard::GetQuotaUsage(uint32_t group) const {
+  MutexLock l(&mutex_);
+  return group < quota_groups_.size() ? quota_groups_[group].usage : 0;
+}
+
 std::string LRUCacheShard::GetPrintableOptions() const {
   const int kBufferSize = 200;
   char buffer[kBufferSize];
   {
     MutexLock l(&mutex_);
-    snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
-             high_pri_pool_ratio_);
+    snprintf(buffer, kBufferSize,
+             "    high_pri_pool_ratio: %.3lf\n"
+             "    frequency_based_admission: %d\n",
+             high_pri_pool_ratio_, sketch_ != nullptr);
   }
   return std::string(buffer);
 }
@@ -520,6 +772,43 @@ void LRUCache::DisownData() {
 #endif  // __clang__
 }
 
+Status LRUCache::InsertSaveable(const Slice& key, void* value, size_t charge,
+                                void (*deleter)(const Slice& key, void* value),
+                                Slice (*save_cb)(void* value), Handle** handle,
+                                Priority priority, uint32_t quota_group) {
+  if (secondary_cache_ == nullptr && quota_group == kNoQuotaGroup) {
+    // Go through Insert(), which subclasses may override.
+    return Insert(key, value, charge, deleter, handle, priority);
+  }
+  uint32_t hash = HashSlice(key);
+  return shards_[Shard(hash)].InsertSaveable(key, hash, value, charge, deleter,
+                                             save_cb, handle, priority,
+                                             quota_group);
+}
+
+bool LRUCache::LookupSecondary(const Slice& key, std::unique_ptr<char[]>* data,
+                               size_t* size) {
+  if (secondary_cache_ == nullptr) {
+    return false;
+  }
+  return secondary_cache_->Lookup(key, data, size);
+}
+
+void LRUCache::SetCompressedSecondaryCache(size_t capacity,
+                                           CompressionType compression_type) {
+  secondary_cache_.reset(new CompressedSecondaryCache(
+      capacity, GetNumShardBits(), compression_type));
+  for (int i = 0; i < num_shards_; i++) {
+    shards_[i].SetSecondaryCache(secondary_cache_.get());
+  }
+}
+
+void LRUCache::EnableFrequencyBasedAdmission() {
+  for (int i = 0; i < num_shards_; i++) {
+    shards_[i].EnableFrequencyBasedAdmission();
+  }
+}
+
 size_t LRUCache::TEST_GetLRUSize() {
   size_t lru_size_of_all_shards = 0;
   for (int i = 0; i < num_shards_; i++) {
@@ -537,10 +826,20 @@ double LRUCache::GetHighPriPoolRatio() {
 }
 
 std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
-  return NewLRUCache(cache_opts.capacity, cache_opts.num_shard_bits,
-                     cache_opts.strict_capacity_limit,
-                     cache_opts.high_pri_pool_ratio,
-                     cache_opts.memory_allocator);
+  std::shared_ptr<Cache> cache = NewLRUCache(
+      cache_opts.capacity, cache_opts.num_shard_bits,
+      cache_opts.strict_capacity_limit, cache_opts.high_pri_pool_ratio,
+      cache_opts.memory_allocator);
+  if (cache != nullptr && cache_opts.compressed_secondary_cache_capacity > 0) {
+    static_cast<LRUCache*>(cache.get())
+        ->SetCompressedSecondaryCache(
+            cache_opts.compressed_secondary_cache_capacity,
+            cache_opts.compressed_secondary_cache_compression);
+  }
+  if (cache != nullptr && cache_opts.frequency_based_admission) {
+    static_cast<LRUCache*>(cache.get())->EnableFrequencyBasedAdmission();
+  }
+  return cache;
 }
 
 std::shared_ptr<Cache> NewLRUCache(
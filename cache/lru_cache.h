@@ -8,8 +8,12 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "cache/compressed_secondary_cache.h"
+#include "cache/frequency_sketch.h"
 #include "cache/sharded_cache.h"
 
 #include "port/port.h"
@@ -46,9 +50,14 @@ namespace rocksdb {
 struct LRUHandle {
   void* value;
   void (*deleter)(const Slice&, void* value);
+  // Returns the contents kept in the secondary tier on eviction, if any.
+  Slice (*save_cb)(void* value);
   LRUHandle* next_hash;
   LRUHandle* next;
   LRUHandle* prev;
+  // Neighbours on the LRU list of the quota group of the entry, if any.
+  LRUHandle* next_in_group;
+  LRUHandle* prev_in_group;
   size_t charge;  // TODO(opt): Only allow uint32_t?
   size_t key_length;
   uint32_t refs;     // a number of refs to this entry
@@ -58,8 +67,14 @@ struct LRUHandle {
   //   in_cache:    whether this entry is referenced by the hash table.
   //   is_high_pri: whether this entry is high priority entry.
   //   in_high_pri_pool: whether this entry is in high-pri pool.
+  //   has_hit:     whether this entry has been looked up since insertion.
+  //   on_probation: whether the admission filter found this entry less
+  //                 frequent than the one it displaced.
   char flags;
 
+  // The quota group the entry is charged to, see Cache::GetQuotaGroup().
+  uint16_t quota_group;
+
   uint32_t hash;     // Hash of key(); used for fast sharding and comparisons
 
   char key_data[1];  // Beginning of key
@@ -78,6 +93,7 @@ struct LRUHandle {
   bool IsHighPri() { return flags & 2; }
   bool InHighPriPool() { return flags & 4; }
   bool HasHit() { return flags & 8; }
+  bool OnProbation() { return flags & 16; }
 
   void SetInCache(bool in_cache) {
     if (in_cache) {
@@ -105,6 +121,8 @@ struct LRUHandle {
 
   void SetHit() { flags |= 8; }
 
+  void SetOnProbation() { flags |= 16; }
+
   void Free() {
     assert((refs == 1 && InCache()) || (refs == 0 && !InCache()));
     if (deleter) {
@@ -128,6 +146,8 @@ class LRUHandleTable {
   LRUHandle* Insert(LRUHandle* h);
   LRUHandle* Remove(const Slice& key, uint32_t hash);
 
+  uint32_t NumElements() const { return elems_; }
+
   template <typename T>
   void ApplyToAllCacheEntries(T func) {
     for (uint32_t i = 0; i < length_; i++) {
@@ -180,6 +200,12 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
                         void (*deleter)(const Slice& key, void* value),
                         Cache::Handle** handle,
                         Cache::Priority priority) override;
+  Status InsertSaveable(const Slice& key, uint32_t hash, void* value,
+                        size_t charge,
+                        void (*deleter)(const Slice& key, void* value),
+                        Slice (*save_cb)(void* value), Cache::Handle** handle,
+                        Cache::Priority priority,
+                        uint32_t quota_group = Cache::kNoQuotaGroup);
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
   virtual bool Ref(Cache::Handle* handle) override;
   virtual bool Release(Cache::Handle* handle,
@@ -195,11 +221,19 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
 
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) override;
+  virtual void ApplyToAllCacheKeys(
+      const std::function<void(const Slice&, size_t, Cache::Priority)>&
+          callback,
+      bool thread_safe) override;
 
   virtual void EraseUnRefEntries() override;
 
   virtual std::string GetPrintableOptions() const override;
 
+  virtual Status SetQuota(uint32_t group, uint32_t parent, size_t reservation,
+                          size_t limit) override;
+  virtual size_t GetQuotaUsage(uint32_t group) const override;
+
   void TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri);
 
   //  Retrieves number of elements in LRU, for unit test purpose only
@@ -209,10 +243,42 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   //  Retrives high pri pool ratio
   double GetHighPriPoolRatio();
 
+  // Set the tier receiving entries evicted for lack of space, which were
+  // inserted with a save_cb. Call it before using the shard.
+  void SetSecondaryCache(CompressedSecondaryCache* secondary_cache) {
+    secondary_cache_ = secondary_cache;
+  }
+
+  // Turn on TinyLFU admission, see LRUCacheOptions::frequency_based_admission.
+  // Call it before using the shard.
+  void EnableFrequencyBasedAdmission();
+
  private:
+  // Per-shard state of a quota group.
+  struct QuotaGroup {
+    uint32_t parent = Cache::kNoQuotaGroup;
+    size_t reservation = 0;
+    size_t limit = 0;
+    size_t usage = 0;
+    // Entries of the group on the LRU list, from the least recently used.
+    LRUHandle* oldest = nullptr;
+    LRUHandle* newest = nullptr;
+    // Groups having this one as parent.
+    std::vector<uint32_t> children;
+  };
+
   void LRU_Remove(LRUHandle* e);
   void LRU_Insert(LRUHandle* e);
 
+  // Add or subtract the charge of e to usage_ and the usage of its quota
+  // groups.
+  void AddUsage(LRUHandle* e);
+  void SubtractUsage(LRUHandle* e);
+
+  // Remove e, which must be on the LRU list, from the cache and append it to
+  // deleted.
+  void EvictEntry(LRUHandle* e, autovector<LRUHandle*>* deleted);
+
   // Overflow the last entry in high-pri pool to low-pri pool until size of
   // high-pri pool is no larger than the size specify by high_pri_pool_pct.
   void MaintainPoolSize();
@@ -227,6 +293,38 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   // holding the mutex_
   void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted);
 
+  // Whether charge more bytes in group would take it or its parent past its
+  // limit.
+  bool OverLimit(uint32_t group, size_t charge) const;
+
+  // Whether e belongs to a group, or the parent of one, that is within its
+  // reservation, so that e should not be evicted for other groups.
+  bool IsReserved(const LRUHandle* e) const;
+
+  // Evict entries on the LRU list until charge more bytes in group fit the
+  // limits of the group and its parent, or no entry that would help is left.
+  // Room is taken from group itself first.
+  void EvictOverLimit(uint32_t group, size_t charge,
+                      autovector<LRUHandle*>* deleted);
+  // Evict entries of group "from" until charge more bytes fit the limit of
+  // group "over", which is "from", its parent or one of its children.
+  void EvictFromQuotaGroup(uint32_t from, uint32_t over, size_t charge,
+                           autovector<LRUHandle*>* deleted);
+
+  // Record an access to hash in sketch_. If inserting charge more bytes needs
+  // an eviction, return whether hash was accessed more often than the entry
+  // that would be evicted first; otherwise return true. Always true when
+  // frequency based admission is off.
+  //
+  // Not thread safe, needs to be called while holding mutex_.
+  bool Admit(uint32_t hash, size_t charge);
+
+  // Free an entry evicted for lack of space, first handing its contents to
+  // secondary_cache_ if it has a save_cb.
+  //
+  // Not necessary to hold mutex_ before being called.
+  void FreeEvicted(LRUHandle* e);
+
   // Initialized before use.
   size_t capacity_;
 
@@ -243,6 +341,19 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   // Remember the value to avoid recomputing each time.
   double high_pri_pool_capacity_;
 
+  // Not owned. nullptr if the cache has no secondary tier.
+  CompressedSecondaryCache* secondary_cache_;
+
+  // Access frequencies for the admission filter. nullptr if frequency based
+  // admission is off.
+  std::unique_ptr<FrequencySketch> sketch_;
+
+  // Indexed by quota group id. Empty until a group is created.
+  std::vector<QuotaGroup> quota_groups_;
+
+  // Whether any quota group has a reservation.
+  bool has_reservations_;
+
   // Dummy head of LRU list.
   // lru.prev is newest entry, lru.next is oldest entry.
   // LRU contains items which can be evicted, ie reference only by cache
@@ -289,6 +400,29 @@ class LRUCache : public ShardedCache {
   virtual size_t GetCharge(Handle* handle) const override;
   virtual uint32_t GetHash(Handle* handle) const override;
   virtual void DisownData() override;
+  virtual Status InsertSaveable(const Slice& key, void* value, size_t charge,
+                                void (*deleter)(const Slice& key, void* value),
+                                Slice (*save_cb)(void* value),
+                                Handle** handle = nullptr,
+                                Priority priority = Priority::LOW,
+                                uint32_t quota_group = kNoQuotaGroup) override;
+  virtual bool LookupSecondary(const Slice& key,
+                               std::unique_ptr<char[]>* data,
+                               size_t* size) override;
+
+  // Give the cache a compressed secondary tier, see
+  // LRUCacheOptions::compressed_secondary_cache_capacity. Call it before
+  // using the cache.
+  void SetCompressedSecondaryCache(size_t capacity,
+                                   CompressionType compression_type);
+  // Turn on TinyLFU admission in all shards, see
+  // LRUCacheOptions::frequency_based_admission. Call it before using the
+  // cache.
+  void EnableFrequencyBasedAdmission();
+
+  CompressedSecondaryCache* TEST_GetSecondaryCache() {
+    return secondary_cache_.get();
+  }
 
   //  Retrieves number of elements in LRU, for unit test purpose only
   size_t TEST_GetLRUSize();
@@ -298,6 +432,7 @@ class LRUCache : public ShardedCache {
  private:
   LRUCacheShard* shards_ = nullptr;
   int num_shards_ = 0;
+  std::unique_ptr<CompressedSecondaryCache> secondary_cache_;
 };
 
 }  // namespace rocksdb
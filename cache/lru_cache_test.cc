@@ -8,6 +8,8 @@
 #include <string>
 #include <vector>
 #include "port/port.h"
+#include "util/compression.h"
+#include "util/string_util.h"
 #include "util/testharness.h"
 
 namespace rocksdb {
@@ -188,6 +190,303 @@ TEST_F(LRUCacheTest, EntriesWithPriority) {
   ValidateLRUList({"e", "f", "g", "Z", "d"}, 2);
 }
 
+namespace {
+void DeleteString(const Slice& /*key*/, void* value) {
+  delete reinterpret_cast<std::string*>(value);
+}
+
+Slice SaveString(void* value) {
+  return Slice(*reinterpret_cast<std::string*>(value));
+}
+}  // namespace
+
+TEST(LRUCacheSecondaryTest, EvictedEntriesMoveToSecondary) {
+  LRUCacheOptions options(3, 0, false, 0.0);
+  options.compressed_secondary_cache_capacity = 1 << 20;
+  options.compressed_secondary_cache_compression = kZlibCompression;
+  std::shared_ptr<Cache> cache = NewLRUCache(options);
+  CompressedSecondaryCache* secondary =
+      static_cast<LRUCache*>(cache.get())->TEST_GetSecondaryCache();
+  ASSERT_NE(nullptr, secondary);
+
+  const std::string contents(4096, 'x');
+  ASSERT_OK(cache->InsertSaveable("a", new std::string(contents), 1,
+                                  &DeleteString, &SaveString));
+  ASSERT_OK(cache->InsertSaveable("b", new std::string(contents), 1,
+                                  &DeleteString, &SaveString));
+  ASSERT_OK(cache->Insert("c", new std::string(contents), 1, &DeleteString));
+  ASSERT_EQ(0U, secondary->GetUsage());
+
+  // Inserting three more entries evicts "a", "b" and "c". Only the first two
+  // move to the secondary tier, as "c" was inserted without a save_cb. An
+  // erased entry doesn't move there either.
+  ASSERT_OK(cache->InsertSaveable("d", new std::string(contents), 1,
+                                  &DeleteString, &SaveString));
+  ASSERT_OK(cache->InsertSaveable("e", new std::string(contents), 1,
+                                  &DeleteString, &SaveString));
+  ASSERT_OK(cache->Insert("f", new std::string(contents), 1, &DeleteString));
+  cache->Erase("e");
+  ASSERT_EQ(nullptr, cache->Lookup("a"));
+  ASSERT_LT(0U, secondary->GetUsage());
+  if (CompressionTypeSupported(kZlibCompression)) {
+    ASSERT_LT(secondary->GetUsage(), contents.size());
+  }
+
+  std::unique_ptr<char[]> data;
+  size_t size = 0;
+  ASSERT_TRUE(cache->LookupSecondary("a", &data, &size));
+  ASSERT_EQ(contents, std::string(data.get(), size));
+  // A hit moves the entry out of the secondary tier.
+  ASSERT_FALSE(cache->LookupSecondary("a", &data, &size));
+  ASSERT_TRUE(cache->LookupSecondary("b", &data, &size));
+  ASSERT_EQ(contents, std::string(data.get(), size));
+  ASSERT_FALSE(cache->LookupSecondary("c", &data, &size));
+  ASSERT_FALSE(cache->LookupSecondary("e", &data, &size));
+  ASSERT_EQ(0U, secondary->GetUsage());
+}
+
+TEST(LRUCacheAdmissionTest, FrequencyBasedAdmission) {
+  LRUCacheOptions options(3, 0, false, 0.0);
+  options.frequency_based_admission = true;
+  std::shared_ptr<Cache> cache = NewLRUCache(options);
+  auto insert = [&](const std::string& key) {
+    ASSERT_OK(cache->Insert(key, nullptr, 1, nullptr));
+  };
+  auto lookup = [&](const std::string& key) {
+    Cache::Handle* handle = cache->Lookup(key);
+    if (handle != nullptr) {
+      cache->Release(handle);
+    }
+    return handle != nullptr;
+  };
+
+  insert("a");
+  insert("b");
+  insert("c");
+  for (const char* key : {"a", "a", "b", "b", "c", "c"}) {
+    ASSERT_TRUE(lookup(key));
+  }
+
+  // "x" was seen once, less often than "a", which it would evict.
+  insert("x");
+  ASSERT_FALSE(lookup("x"));
+  ASSERT_TRUE(lookup("a"));
+  ASSERT_TRUE(lookup("b"));
+  ASSERT_TRUE(lookup("c"));
+
+  // After enough misses, "y" is admitted in place of "a".
+  for (int i = 0; i < 5; i++) {
+    ASSERT_FALSE(lookup("y"));
+  }
+  insert("y");
+  ASSERT_TRUE(lookup("y"));
+  ASSERT_FALSE(lookup("a"));
+
+  // With a handle, "z" has to be inserted, evicting "b". Once released it
+  // becomes the next entry to evict.
+  Cache::Handle* handle = nullptr;
+  ASSERT_OK(cache->Insert("z", nullptr, 1, nullptr, &handle));
+  ASSERT_NE(nullptr, handle);
+  cache->Release(handle);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_FALSE(lookup("v"));
+  }
+  insert("v");
+  ASSERT_FALSE(lookup("z"));
+  ASSERT_FALSE(lookup("b"));
+  ASSERT_TRUE(lookup("c"));
+  ASSERT_TRUE(lookup("y"));
+  ASSERT_TRUE(lookup("v"));
+}
+
+TEST(LRUCacheAdmissionTest, FrequencySketchGrowKeepsCounts) {
+  FrequencySketch sketch(16);
+  const uint32_t kHashes[] = {0x12345678, 0x9abcdef0, 0xdeadbeef};
+  for (uint32_t hash : kHashes) {
+    for (int i = 0; i < 8; i++) {
+      sketch.Increment(hash);
+    }
+  }
+  sketch.Grow(1024);
+  ASSERT_EQ(1024U, sketch.width());
+  // The counts are halved, not lost, so frequent keys keep their advantage
+  // over new ones when the cache grows.
+  for (uint32_t hash : kHashes) {
+    ASSERT_GE(sketch.Estimate(hash), 4U);
+  }
+  ASSERT_EQ(0U, sketch.Estimate(0x0badf00d));
+}
+
+namespace {
+size_t QuotaUsage(Cache* cache, const std::string& group) {
+  CacheQuota quota;
+  size_t usage = 0;
+  EXPECT_TRUE(cache->GetQuota(group, &quota, &usage));
+  return usage;
+}
+}  // namespace
+
+TEST(LRUCacheQuotaTest, Limit) {
+  std::shared_ptr<Cache> cache = NewLRUCache(10, 0);
+  uint32_t scan = cache->GetQuotaGroup("scan");
+  ASSERT_NE(Cache::kNoQuotaGroup, scan);
+  ASSERT_EQ(scan, cache->GetQuotaGroup("scan"));
+  ASSERT_OK(cache->SetQuota("scan", CacheQuota(0, 3)));
+  auto insert = [&](const std::string& key, uint32_t group,
+                    Cache::Handle** handle = nullptr) {
+    ASSERT_OK(cache->InsertSaveable(key, nullptr, 1, nullptr, nullptr, handle,
+                                    Cache::Priority::LOW, group));
+  };
+  auto lookup = [&](const std::string& key) {
+    Cache::Handle* handle = cache->Lookup(key);
+    if (handle != nullptr) {
+      cache->Release(handle);
+    }
+    return handle != nullptr;
+  };
+
+  for (int i = 0; i < 5; i++) {
+    insert("h" + ToString(i), Cache::kNoQuotaGroup);
+  }
+  // The scan only evicts its own entries, although the cache has room.
+  for (int i = 0; i < 6; i++) {
+    insert("s" + ToString(i), scan);
+  }
+  ASSERT_EQ(3, QuotaUsage(cache.get(), "scan"));
+  ASSERT_EQ(8, cache->GetUsage());
+  ASSERT_FALSE(lookup("s2"));
+  ASSERT_TRUE(lookup("s3"));
+  for (int i = 0; i < 5; i++) {
+    ASSERT_TRUE(lookup("h" + ToString(i)));
+  }
+
+  // Entries in use cannot be evicted, so the group can go past its limit.
+  // The entry released first while it is over the limit is dropped.
+  std::vector<Cache::Handle*> handles(4);
+  for (int i = 0; i < 4; i++) {
+    insert("p" + ToString(i), scan, &handles[i]);
+  }
+  ASSERT_EQ(4, QuotaUsage(cache.get(), "scan"));
+  for (int i = 3; i >= 0; i--) {
+    cache->Release(handles[i]);
+  }
+  ASSERT_EQ(3, QuotaUsage(cache.get(), "scan"));
+  ASSERT_FALSE(lookup("p3"));
+  ASSERT_TRUE(lookup("p0"));
+
+  // Lowering the limit evicts down to it.
+  ASSERT_OK(cache->SetQuota("scan", CacheQuota(0, 1)));
+  ASSERT_EQ(1, QuotaUsage(cache.get(), "scan"));
+  ASSERT_EQ(6, cache->GetUsage());
+}
+
+TEST(LRUCacheQuotaTest, Reservation) {
+  std::shared_ptr<Cache> cache = NewLRUCache(6, 0);
+  ASSERT_OK(cache->SetQuota("index", CacheQuota(3, 0)));
+  uint32_t index = cache->GetQuotaGroup("index");
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(cache->InsertSaveable("i" + ToString(i), nullptr, 1, nullptr,
+                                    nullptr, nullptr, Cache::Priority::LOW,
+                                    index));
+  }
+  // Other entries cannot evict the reserved ones, however often they are
+  // inserted.
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(cache->Insert("d" + ToString(i), nullptr, 1, nullptr));
+  }
+  ASSERT_EQ(6, cache->GetUsage());
+  ASSERT_EQ(3, QuotaUsage(cache.get(), "index"));
+  for (int i = 0; i < 3; i++) {
+    Cache::Handle* handle = cache->Lookup("i" + ToString(i));
+    ASSERT_NE(nullptr, handle);
+    cache->Release(handle);
+  }
+  Cache::Handle* handle = cache->Lookup("d6");
+  ASSERT_EQ(nullptr, handle);
+  handle = cache->Lookup("d9");
+  ASSERT_NE(nullptr, handle);
+  cache->Release(handle);
+}
+
+TEST(LRUCacheQuotaTest, ParentLimit) {
+  std::shared_ptr<Cache> cache = NewLRUCache(100, 0);
+  ASSERT_OK(cache->SetQuota("cf", CacheQuota(0, 4)));
+  uint32_t cf = cache->GetQuotaGroup("cf");
+  uint32_t index = cache->GetQuotaGroup("cf.index", cf);
+  uint32_t data = cache->GetQuotaGroup("cf.data", cf);
+  // Groups nest only one level deep.
+  ASSERT_EQ(Cache::kNoQuotaGroup, cache->GetQuotaGroup("cf.data.x", data));
+  auto insert = [&](const std::string& key, uint32_t group) {
+    ASSERT_OK(cache->InsertSaveable(key, nullptr, 1, nullptr, nullptr, nullptr,
+                                    Cache::Priority::LOW, group));
+  };
+  auto contains = [&](const std::string& key) {
+    Cache::Handle* handle = cache->Lookup(key);
+    if (handle != nullptr) {
+      cache->Release(handle);
+    }
+    return handle != nullptr;
+  };
+
+  insert("x0", index);
+  insert("x1", index);
+  // Data blocks make room at the expense of older data blocks first.
+  for (int i = 0; i < 5; i++) {
+    insert("y" + ToString(i), data);
+  }
+  ASSERT_EQ(4, QuotaUsage(cache.get(), "cf"));
+  ASSERT_EQ(2, QuotaUsage(cache.get(), "cf.index"));
+  ASSERT_EQ(2, QuotaUsage(cache.get(), "cf.data"));
+  ASSERT_TRUE(contains("x0"));
+  ASSERT_TRUE(contains("x1"));
+  ASSERT_FALSE(contains("y2"));
+  ASSERT_TRUE(contains("y3"));
+
+  insert("x2", index);
+  ASSERT_FALSE(contains("x0"));
+  ASSERT_TRUE(contains("x2"));
+  ASSERT_TRUE(contains("y3"));
+
+  // Once a group has nothing left to evict, its siblings make room.
+  cache->Erase("x1");
+  cache->Erase("x2");
+  insert("y5", data);
+  insert("y6", data);
+  insert("x3", index);
+  ASSERT_EQ(4, QuotaUsage(cache.get(), "cf"));
+  ASSERT_TRUE(contains("x3"));
+  // "y3" was looked up after "y4".
+  ASSERT_FALSE(contains("y4"));
+  ASSERT_TRUE(contains("y3"));
+}
+
+TEST(LRUCacheQuotaTest, ParentOfExistingGroup) {
+  std::shared_ptr<Cache> cache = NewLRUCache(100, 0);
+  // The subgroup is given its quota before its parent exists.
+  ASSERT_OK(cache->SetQuota("cf.data", CacheQuota(0, 2)));
+  uint32_t cf = cache->GetQuotaGroup("cf");
+  uint32_t other = cache->GetQuotaGroup("other");
+  uint32_t data = cache->GetQuotaGroup("cf.data", cf);
+  ASSERT_NE(Cache::kNoQuotaGroup, data);
+  ASSERT_EQ(data, cache->GetQuotaGroup("cf.data", cf));
+  // Once handed out, the group keeps its parent.
+  ASSERT_EQ(Cache::kNoQuotaGroup, cache->GetQuotaGroup("cf.data"));
+  ASSERT_EQ(Cache::kNoQuotaGroup, cache->GetQuotaGroup("cf.data", other));
+  ASSERT_EQ(Cache::kNoQuotaGroup, cache->GetQuotaGroup("cf", other));
+
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(cache->InsertSaveable("y" + ToString(i), nullptr, 1, nullptr,
+                                    nullptr, nullptr, Cache::Priority::LOW,
+                                    data));
+  }
+  CacheQuota quota;
+  size_t usage = 0;
+  ASSERT_TRUE(cache->GetQuota("cf.data", &quota, &usage));
+  ASSERT_EQ(2, quota.limit);
+  ASSERT_EQ(2, usage);
+  ASSERT_EQ(2, QuotaUsage(cache.get(), "cf"));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
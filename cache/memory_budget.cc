@@ -0,0 +1,62 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/memory_budget.h"
+
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+const char* MemoryBudget::CategoryName(Category category) {
+  switch (category) {
+    case kTableReaders:
+      return "table-readers";
+    case kIteratorBlocks:
+      return "iterator-blocks";
+    case kCompactionBuffers:
+      return "compaction-buffers";
+    default:
+      assert(false);
+      return "unknown";
+  }
+}
+
+MemoryBudget::MemoryBudget(std::shared_ptr<Cache> cache)
+    : total_usage_(0), reservation_(cache) {
+  for (int i = 0; i < kNumCategories; i++) {
+    usage_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void MemoryBudget::Charge(Category category, size_t mem) {
+  usage_[category].fetch_add(mem, std::memory_order_relaxed);
+  size_t total = total_usage_.fetch_add(mem, std::memory_order_relaxed) + mem;
+  // Most charges fit in the current reservation and do not need the mutex.
+  if (total > reservation_.GetTotalReservedCacheSize()) {
+    UpdateReservation();
+  }
+}
+
+void MemoryBudget::Release(Category category, size_t mem) {
+  usage_[category].fetch_sub(mem, std::memory_order_relaxed);
+  size_t total = total_usage_.fetch_sub(mem, std::memory_order_relaxed) - mem;
+  if (total < reservation_.GetTotalReservedCacheSize() / 4 * 3) {
+    UpdateReservation();
+  }
+}
+
+void MemoryBudget::UpdateReservation() {
+  MutexLock l(&mutex_);
+  // Read the usage under the mutex so that the last update wins.
+  reservation_.UpdateCacheReservation(
+      total_usage_.load(std::memory_order_relaxed));
+}
+
+void MemoryBudget::ReleaseIteratorBlock(void* arg1, void* arg2) {
+  reinterpret_cast<MemoryBudget*>(arg1)->Release(
+      kIteratorBlocks, static_cast<size_t>(reinterpret_cast<uintptr_t>(arg2)));
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,76 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "cache/cache_reservation_manager.h"
+#include "port/port.h"
+#include "rocksdb/cache.h"
+
+namespace rocksdb {
+
+// MemoryBudget charges the memory a DB allocates outside of its block cache
+// to a cache, usually that block cache, so that the capacity of the cache
+// bounds both. The memory is charged per category, as dummy entries of the
+// cache; see DBOptions::memory_budget_cache. Memtables are charged by the
+// WriteBufferManager instead.
+//
+// Thread safe.
+class MemoryBudget {
+ public:
+  enum Category : int {
+    // Index and filter blocks held by table readers, and the readers
+    // themselves
+    kTableReaders = 0,
+    // Blocks read outside of the block cache and held by iterators, including
+    // the ones pinned by a PinnedIteratorsManager
+    kIteratorBlocks,
+    // Readahead and output buffers of running compactions
+    kCompactionBuffers,
+    kNumCategories,
+  };
+
+  // Name of the category in the rocksdb.memory-budget property
+  static const char* CategoryName(Category category);
+
+  explicit MemoryBudget(std::shared_ptr<Cache> cache);
+
+  void Charge(Category category, size_t mem);
+  void Release(Category category, size_t mem);
+
+  size_t GetUsage(Category category) const {
+    return usage_[category].load(std::memory_order_relaxed);
+  }
+  size_t GetTotalUsage() const {
+    return total_usage_.load(std::memory_order_relaxed);
+  }
+  // Total charge of the dummy entries in the cache
+  size_t GetReserved() const {
+    return reservation_.GetTotalReservedCacheSize();
+  }
+  Cache* cache() const { return reservation_.cache(); }
+
+  // Cleanup function for Cleanable::RegisterCleanup() that releases a
+  // kIteratorBlocks charge. arg1 is the MemoryBudget and arg2 the charge,
+  // cast to a pointer.
+  static void ReleaseIteratorBlock(void* arg1, void* arg2);
+
+ private:
+  void UpdateReservation();
+
+  std::atomic<size_t> usage_[kNumCategories];
+  std::atomic<size_t> total_usage_;
+  port::Mutex mutex_;
+  CacheReservationManager reservation_;
+
+  // No copying allowed
+  MemoryBudget(const MemoryBudget&) = delete;
+  MemoryBudget& operator=(const MemoryBudget&) = delete;
+};
+
+}  // namespace rocksdb
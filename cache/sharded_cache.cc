@@ -19,6 +19,9 @@
 
 namespace rocksdb {
 
+const uint32_t Cache::kNoQuotaGroup;
+const uint32_t ShardedCache::kMaxQuotaGroups;
+
 ShardedCache::ShardedCache(size_t capacity, int num_shard_bits,
                            bool strict_capacity_limit,
                            std::shared_ptr<MemoryAllocator> allocator)
@@ -26,7 +29,8 @@ ShardedCache::ShardedCache(size_t capacity, int num_shard_bits,
       num_shard_bits_(num_shard_bits),
       capacity_(capacity),
       strict_capacity_limit_(strict_capacity_limit),
-      last_id_(1) {}
+      last_id_(1),
+      quota_groups_(1) {}
 
 void ShardedCache::SetCapacity(size_t capacity) {
   int num_shards = 1 << num_shard_bits_;
@@ -121,6 +125,15 @@ void ShardedCache::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
   }
 }
 
+void ShardedCache::ApplyToAllCacheKeys(
+    const std::function<void(const Slice&, size_t, Priority)>& callback,
+    bool thread_safe) {
+  int num_shards = 1 << num_shard_bits_;
+  for (int s = 0; s < num_shards; s++) {
+    GetShard(s)->ApplyToAllCacheKeys(callback, thread_safe);
+  }
+}
+
 void ShardedCache::EraseUnRefEntries() {
   int num_shards = 1 << num_shard_bits_;
   for (int s = 0; s < num_shards; s++) {
@@ -128,6 +141,115 @@ void ShardedCache::EraseUnRefEntries() {
   }
 }
 
+uint32_t ShardedCache::GetQuotaGroup(const std::string& name,
+                                     uint32_t parent) {
+  MutexLock l(&quota_mutex_);
+  uint32_t id;
+  auto iter = quota_group_ids_.find(name);
+  if (iter == quota_group_ids_.end()) {
+    id = CreateQuotaGroup(name, parent);
+    if (id == kNoQuotaGroup) {
+      return kNoQuotaGroup;
+    }
+  } else {
+    id = iter->second;
+    QuotaGroup& group = quota_groups_[id];
+    if (group.parent != parent) {
+      // Only a group that SetQuota() created, and that nothing can refer to
+      // yet, takes the parent it is asked for.
+      if (group.handed_out || group.parent != kNoQuotaGroup ||
+          parent == id || parent >= quota_groups_.size() ||
+          quota_groups_[parent].parent != kNoQuotaGroup) {
+        return kNoQuotaGroup;
+      }
+      group.parent = parent;
+      if (!ApplyQuota(id).ok()) {
+        return kNoQuotaGroup;
+      }
+    }
+  }
+  quota_groups_[id].handed_out = true;
+  return id;
+}
+
+uint32_t ShardedCache::CreateQuotaGroup(const std::string& name,
+                                        uint32_t parent) {
+  quota_mutex_.AssertHeld();
+  if (quota_groups_.size() > kMaxQuotaGroups ||
+      (parent != kNoQuotaGroup &&
+       (parent >= quota_groups_.size() ||
+        quota_groups_[parent].parent != kNoQuotaGroup))) {
+    return kNoQuotaGroup;
+  }
+  uint32_t id = static_cast<uint32_t>(quota_groups_.size());
+  int num_shards = 1 << num_shard_bits_;
+  for (int s = 0; s < num_shards; s++) {
+    if (!GetShard(s)->SetQuota(id, parent, 0, 0).ok()) {
+      // All shards are alike, so the first one failed.
+      assert(s == 0);
+      return kNoQuotaGroup;
+    }
+  }
+  quota_groups_.push_back({parent, CacheQuota(), false /* handed_out */});
+  quota_group_ids_.emplace(name, id);
+  return id;
+}
+
+Status ShardedCache::ApplyQuota(uint32_t id) {
+  quota_mutex_.AssertHeld();
+  const QuotaGroup& group = quota_groups_[id];
+  int num_shards = 1 << num_shard_bits_;
+  const size_t reservation_per_shard =
+      (group.quota.reservation + (num_shards - 1)) / num_shards;
+  const size_t limit_per_shard =
+      (group.quota.limit + (num_shards - 1)) / num_shards;
+  for (int s = 0; s < num_shards; s++) {
+    Status st = GetShard(s)->SetQuota(id, group.parent, reservation_per_shard,
+                                      limit_per_shard);
+    if (!st.ok()) {
+      return st;
+    }
+  }
+  return Status::OK();
+}
+
+Status ShardedCache::SetQuota(const std::string& name,
+                              const CacheQuota& quota) {
+  MutexLock l(&quota_mutex_);
+  uint32_t id;
+  auto iter = quota_group_ids_.find(name);
+  if (iter == quota_group_ids_.end()) {
+    id = CreateQuotaGroup(name, kNoQuotaGroup);
+    if (id == kNoQuotaGroup) {
+      return Status::NotSupported("Cannot create quota group " + name);
+    }
+  } else {
+    id = iter->second;
+  }
+  quota_groups_[id].quota = quota;
+  return ApplyQuota(id);
+}
+
+bool ShardedCache::GetQuota(const std::string& name, CacheQuota* quota,
+                            size_t* usage) const {
+  uint32_t id;
+  {
+    MutexLock l(&quota_mutex_);
+    auto iter = quota_group_ids_.find(name);
+    if (iter == quota_group_ids_.end()) {
+      return false;
+    }
+    id = iter->second;
+    *quota = quota_groups_[id].quota;
+  }
+  int num_shards = 1 << num_shard_bits_;
+  *usage = 0;
+  for (int s = 0; s < num_shards; s++) {
+    *usage += GetShard(s)->GetQuotaUsage(id);
+  }
+  return true;
+}
+
 std::string ShardedCache::GetPrintableOptions() const {
   std::string ret;
   ret.reserve(20000);
@@ -11,6 +11,8 @@
 
 #include <atomic>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "port/port.h"
 #include "rocksdb/cache.h"
@@ -38,8 +40,24 @@ class CacheShard {
   virtual size_t GetPinnedUsage() const = 0;
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) = 0;
+  virtual void ApplyToAllCacheKeys(
+      const std::function<void(const Slice&, size_t, Cache::Priority)>&
+          callback,
+      bool thread_safe) = 0;
   virtual void EraseUnRefEntries() = 0;
   virtual std::string GetPrintableOptions() const { return ""; }
+
+  // Create quota group "group" under "parent" if the shard does not know it
+  // yet, then set its per-shard reservation and limit. Groups are created in
+  // order of id. A group without a parent that no entry was charged to may
+  // be given one. See Cache::GetQuotaGroup(). The default implementation
+  // does not support quotas.
+  virtual Status SetQuota(uint32_t /*group*/, uint32_t /*parent*/,
+                          size_t /*reservation*/, size_t /*limit*/) {
+    return Status::NotSupported("Quotas are not supported by this cache.");
+  }
+  // Memory size of the entries of quota group "group" in the shard.
+  virtual size_t GetQuotaUsage(uint32_t /*group*/) const { return 0; }
 };
 
 // Generic cache interface which shards cache by hash of keys. 2^num_shard_bits
@@ -76,12 +94,24 @@ class ShardedCache : public Cache {
   virtual size_t GetPinnedUsage() const override;
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) override;
+  virtual void ApplyToAllCacheKeys(
+      const std::function<void(const Slice&, size_t, Priority)>& callback,
+      bool thread_safe) override;
   virtual void EraseUnRefEntries() override;
   virtual std::string GetPrintableOptions() const override;
+  virtual uint32_t GetQuotaGroup(const std::string& name,
+                                 uint32_t parent = kNoQuotaGroup) override;
+  virtual Status SetQuota(const std::string& name,
+                          const CacheQuota& quota) override;
+  virtual bool GetQuota(const std::string& name, CacheQuota* quota,
+                        size_t* usage) const override;
 
   int GetNumShardBits() const { return num_shard_bits_; }
 
- private:
+  // Quota group ids fit in 16 bits.
+  static const uint32_t kMaxQuotaGroups = 65535;
+
+ protected:
   static inline uint32_t HashSlice(const Slice& s) {
     return Hash(s.data(), s.size(), 0);
   }
@@ -91,11 +121,35 @@ class ShardedCache : public Cache {
     return (num_shard_bits_ > 0) ? (hash >> (32 - num_shard_bits_)) : 0;
   }
 
+ private:
+  struct QuotaGroup {
+    uint32_t parent;
+    CacheQuota quota;
+    // The id was returned by GetQuotaGroup(), so entries may be charged to
+    // the group and it may be the parent of others. Until then, the group was
+    // only created by SetQuota() and can still be given a parent.
+    bool handed_out;
+  };
+
+  // Returns the id of a new group "name" under parent, or kNoQuotaGroup if it
+  // cannot be created.
+  // REQUIRES: quota_mutex_ is held.
+  uint32_t CreateQuotaGroup(const std::string& name, uint32_t parent);
+  // Pass the parent and the quota of group id to the shards.
+  // REQUIRES: quota_mutex_ is held.
+  Status ApplyQuota(uint32_t id);
+
   int num_shard_bits_;
   mutable port::Mutex capacity_mutex_;
   size_t capacity_;
   bool strict_capacity_limit_;
   std::atomic<uint64_t> last_id_;
+
+  // quota_mutex_ protects the following state.
+  mutable port::Mutex quota_mutex_;
+  std::unordered_map<std::string, uint32_t> quota_group_ids_;
+  // Indexed by id. The first one stands for kNoQuotaGroup.
+  std::vector<QuotaGroup> quota_groups_;
 };
 
 extern int GetDefaultCacheShardBits(size_t capacity);
@@ -264,6 +264,9 @@ class ColumnFamilyData {
                          SequenceNumber earliest_seq);
 
   TableCache* table_cache() const { return table_cache_.get(); }
+  WriteBufferManager* write_buffer_mgr() const {
+    return write_buffer_manager_;
+  }
 
   // See documentation in compaction_picker.h
   // REQUIRES: DB mutex held
@@ -24,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "cache/memory_budget.h"
 #include "db/builder.h"
 #include "db/db_impl.h"
 #include "db/db_iter.h"
@@ -813,6 +814,26 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   std::unique_ptr<InternalIterator> input(versions_->MakeInputIterator(
       sub_compact->compaction, &range_del_agg, env_optiosn_for_read_));
 
+  // Charge the readahead buffers of the input files read at the same time,
+  // which are all the L0 files but only one file of the other levels, and
+  // the buffer of the output file.
+  MemoryBudget* memory_budget = cfd->ioptions()->memory_budget.get();
+  size_t memory_budget_charge = 0;
+  if (memory_budget != nullptr) {
+    const Compaction* c = sub_compact->compaction;
+    size_t concurrent_inputs = 0;
+    for (size_t i = 0; i < c->num_input_levels(); i++) {
+      size_t num_files = c->num_input_files(i);
+      concurrent_inputs +=
+          c->level(i) == 0 ? num_files : std::min<size_t>(num_files, 1);
+    }
+    memory_budget_charge =
+        env_options_.writable_file_max_buffer_size +
+        concurrent_inputs * env_optiosn_for_read_.compaction_readahead_size;
+    memory_budget->Charge(MemoryBudget::kCompactionBuffers,
+                          memory_budget_charge);
+  }
+
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_PROCESS_KV);
 
@@ -1123,6 +1144,10 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
 
   sub_compact->c_iter.reset();
   input.reset();
+  if (memory_budget != nullptr) {
+    memory_budget->Release(MemoryBudget::kCompactionBuffers,
+                           memory_budget_charge);
+  }
   sub_compact->status = status;
 }
 
@@ -62,6 +62,23 @@ bool FindIntraL0Compaction(const std::vector<FileMetaData*>& level_files,
 
   if (span_len >= min_files_to_compact &&
       compact_bytes_per_del_file < max_compact_bytes_per_del_file) {
+    // Take in the older files whose seqnos interleave with the span, such as
+    // the rest of a partitioned flush, so that the output is not older than
+    // any of the files left behind.
+    SequenceNumber smallest_seqno = kMaxSequenceNumber;
+    for (size_t i = 0; i < span_len; ++i) {
+      smallest_seqno =
+          std::min(smallest_seqno, level_files[i]->fd.smallest_seqno);
+    }
+    for (; span_len < level_files.size() &&
+           level_files[span_len]->fd.largest_seqno >= smallest_seqno;
+         ++span_len) {
+      if (level_files[span_len]->being_compacted) {
+        return false;
+      }
+      smallest_seqno =
+          std::min(smallest_seqno, level_files[span_len]->fd.smallest_seqno);
+    }
     assert(comp_inputs != nullptr);
     comp_inputs->level = 0;
     for (size_t i = 0; i < span_len; ++i) {
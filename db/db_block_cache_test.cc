@@ -250,7 +250,217 @@ TEST_F(DBBlockCacheTest, TestWithCompressedBlockCache) {
 }
 #endif  // SNAPPY
 
+TEST_F(DBBlockCacheTest, CompressedSecondaryCache) {
+  auto table_options = GetTableOptions();
+  auto options = GetOptions(table_options);
+  InitTable(options);
+
+  // With zero capacity, every block is evicted into the secondary tier as
+  // soon as it is released.
+  LRUCacheOptions cache_options(0, 0, false, 0.0);
+  cache_options.compressed_secondary_cache_capacity = 1 << 20;
+  std::shared_ptr<Cache> cache = NewLRUCache(cache_options);
+  table_options.block_cache = cache;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  std::string value(kValueSize, 'a');
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_SECONDARY_HIT));
+  uint64_t misses = TestGetTickerCount(options, BLOCK_CACHE_MISS);
+
+  // The blocks come back from the secondary tier instead of the file.
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(kNumBlocks,
+            TestGetTickerCount(options, BLOCK_CACHE_SECONDARY_HIT));
+  ASSERT_EQ(misses + kNumBlocks, TestGetTickerCount(options, BLOCK_CACHE_MISS));
+  ASSERT_EQ(0, cache->GetUsage());
+
+  // Reads that don't fill the cache leave the secondary tier alone.
+  ReadOptions no_fill;
+  no_fill.fill_cache = false;
+  std::string result;
+  ASSERT_OK(db_->Get(no_fill, "0", &result));
+  ASSERT_EQ(value, result);
+  ASSERT_EQ(kNumBlocks,
+            TestGetTickerCount(options, BLOCK_CACHE_SECONDARY_HIT));
+  ASSERT_EQ(value, Get("0"));
+  ASSERT_EQ(kNumBlocks + 1,
+            TestGetTickerCount(options, BLOCK_CACHE_SECONDARY_HIT));
+}
+
+TEST_F(DBBlockCacheTest, WarmUpFromDumpOnOpen) {
+  auto table_options = GetTableOptions();
+  table_options.block_cache = NewLRUCache(1 << 20);
+  auto options = GetOptions(table_options);
+  options.block_cache_dump_path = dbname_ + "_block_cache_dump";
+  options.block_cache_warmup_rate_bytes_per_sec = 1 << 20;
+  env_->DeleteFile(options.block_cache_dump_path);
+  Reopen(options);
+  InitTable(options);
+  ASSERT_OK(Flush());
+
+  // Only the first half of the blocks is read before the restart.
+  table_options.block_cache = NewLRUCache(1 << 20);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+  std::string value(kValueSize, 'a');
+  for (size_t i = 0; i < kNumBlocks / 2; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+
+  // The new cache gets those blocks back before they are read.
+  table_options.block_cache = NewLRUCache(1 << 20);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+  ASSERT_OK(env_->FileExists(options.block_cache_dump_path));
+  dbfull()->TEST_WaitForBlockCacheWarmUp();
+  uint64_t misses = TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+  for (size_t i = 0; i < kNumBlocks / 2; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(misses, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  for (size_t i = kNumBlocks / 2; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(misses + kNumBlocks / 2,
+            TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  Close();
+  env_->DeleteFile(options.block_cache_dump_path);
+}
+
 #ifndef ROCKSDB_LITE
+TEST_F(DBBlockCacheTest, QuotaGroups) {
+  auto table_options = GetTableOptions();
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.block_cache_quota_group = "default";
+  std::shared_ptr<Cache> cache = NewLRUCache(1 << 20, 0);
+  table_options.block_cache = cache;
+  auto options = GetOptions(table_options);
+  Reopen(options);
+  InitTable(options);
+  ASSERT_OK(Flush());
+
+  // Each data block is charged more than 512 bytes.
+  ASSERT_OK(cache->SetQuota("default.data", CacheQuota(0, 1024)));
+  std::string value(kValueSize, 'a');
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+
+  std::map<std::string, std::string> quotas;
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kBlockCacheQuota, &quotas));
+  ASSERT_EQ(12, quotas.size());
+  ASSERT_EQ("1024", quotas["data.limit"]);
+  ASSERT_EQ("0", quotas["data.reservation"]);
+  uint64_t data_usage = ParseUint64(quotas["data.usage"]);
+  ASSERT_GT(data_usage, 0);
+  ASSERT_LE(data_usage, 1024);
+  ASSERT_GT(ParseUint64(quotas["index.usage"]), 0);
+  ASSERT_EQ(ParseUint64(quotas["usage"]),
+            ParseUint64(quotas["index.usage"]) +
+                ParseUint64(quotas["filter.usage"]) + data_usage);
+  ASSERT_EQ(cache->GetUsage(), ParseUint64(quotas["usage"]));
+
+  std::string text;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kBlockCacheQuota, &text));
+  ASSERT_NE(std::string::npos,
+            text.find("default.data usage: " + quotas["data.usage"] +
+                      " reservation: 0 limit: 1024\n"));
+
+  // Without a quota group, there is nothing to report.
+  table_options.block_cache_quota_group.clear();
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+  ASSERT_FALSE(db_->GetProperty(DB::Properties::kBlockCacheQuota, &text));
+}
+
+#ifndef ROCKSDB_LITE
+TEST_F(DBBlockCacheTest, MemoryBudget) {
+  auto table_options = GetTableOptions();
+  table_options.no_block_cache = true;
+  auto options = GetOptions(table_options);
+  std::shared_ptr<Cache> cache = NewLRUCache(64 << 20, 0);
+  options.memory_budget_cache = cache;
+  Reopen(options);
+  InitTable(options);
+
+  std::map<std::string, std::string> budget;
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kMemoryBudget, &budget));
+  ASSERT_EQ(7, budget.size());
+  ASSERT_GT(ParseUint64(budget["memtables"]), 0);
+  ASSERT_EQ("0", budget["table-readers"]);
+  ASSERT_EQ("0", budget["reserved"]);
+  // The memtables are charged by the WriteBufferManager.
+  ASSERT_GE(cache->GetUsage(), ParseUint64(budget["memtables"]));
+
+  ASSERT_OK(Flush());
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kMemoryBudget, &budget));
+  uint64_t table_readers = ParseUint64(budget["table-readers"]);
+  ASSERT_GT(table_readers, 0);
+  ASSERT_EQ("0", budget["iterator-blocks"]);
+  ASSERT_EQ("0", budget["compaction-buffers"]);
+  ASSERT_GE(ParseUint64(budget["reserved"]), table_readers);
+  ASSERT_GE(cache->GetUsage(), ParseUint64(budget["reserved"]));
+  ASSERT_EQ(ToString(cache->GetUsage()), budget["cache-usage"]);
+
+  // Blocks read outside of the block cache are charged while an iterator
+  // holds them.
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->Seek(ToString(0));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kMemoryBudget, &budget));
+  ASSERT_GT(ParseUint64(budget["iterator-blocks"]), 0);
+  iter.reset();
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kMemoryBudget, &budget));
+  ASSERT_EQ("0", budget["iterator-blocks"]);
+
+  // Compaction buffers are charged while the compaction runs.
+  std::atomic<size_t> compaction_buffers(0);
+  SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::Run():Inprogress", [&](void* /*arg*/) {
+        std::map<std::string, std::string> props;
+        ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kMemoryBudget, &props));
+        compaction_buffers = ParseUint64(props["compaction-buffers"]);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  InitTable(options);
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_GT(compaction_buffers, 0);
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kMemoryBudget, &budget));
+  ASSERT_EQ("0", budget["compaction-buffers"]);
+
+  std::string text;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kMemoryBudget, &text));
+  ASSERT_NE(std::string::npos,
+            text.find("table-readers: " + budget["table-readers"] + "\n"));
+
+  // The column families share the budget that the DB built.
+  CreateColumnFamilies({"pikachu"}, options);
+  MemoryBudget* memory_budget =
+      dbfull()->immutable_db_options().memory_budget.get();
+  ASSERT_NE(nullptr, memory_budget);
+  for (auto* handle : {db_->DefaultColumnFamily(), handles_[0]}) {
+    auto* cfd = reinterpret_cast<ColumnFamilyHandleImpl*>(handle)->cfd();
+    ASSERT_EQ(memory_budget, cfd->ioptions()->memory_budget.get());
+  }
+
+  // The reservation is released with the table readers.
+  Close();
+  ASSERT_EQ(0, cache->GetUsage());
+
+  options.memory_budget_cache.reset();
+  ReopenWithColumnFamilies({kDefaultColumnFamilyName, "pikachu"}, options);
+  ASSERT_FALSE(db_->GetProperty(DB::Properties::kMemoryBudget, &text));
+}
+#endif  // ROCKSDB_LITE
 
 // Make sure that when options.block_cache is set, after a new table is
 // created its index/filter blocks are added to block cache.
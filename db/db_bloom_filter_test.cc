@@ -787,6 +787,55 @@ TEST_F(DBBloomFilterTest, PrefixExtractorBlockFilter) {
 }
 
 #ifndef ROCKSDB_LITE
+TEST_F(DBBloomFilterTest, MemtableWholeKeyBloomFilter) {
+  Options options = CurrentOptions();
+  options.memtable_prefix_bloom_size_ratio =
+      8.0 * 1024.0 / static_cast<double>(options.write_buffer_size);
+  options.memtable_whole_key_filtering = true;
+  // Keep two immutable memtables around.
+  options.max_write_buffer_number = 4;
+  options.min_write_buffer_number_to_merge = 3;
+  DestroyAndReopen(options);
+  get_perf_context()->Reset();
+
+  ASSERT_OK(Put("key1", "val1"));
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+  ASSERT_OK(Put("key2", "val2"));
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+  ASSERT_OK(Put("key3", "val3"));
+
+  // Without a prefix extractor, a miss is filtered in every memtable.
+  ASSERT_EQ("NOT_FOUND", Get("key4"));
+  ASSERT_EQ(3, get_perf_context()->bloom_memtable_miss_count);
+  ASSERT_EQ(0, get_perf_context()->bloom_memtable_hit_count);
+  // The lookup stops at the memtable holding the key.
+  ASSERT_EQ("val1", Get("key1"));
+  ASSERT_EQ(5, get_perf_context()->bloom_memtable_miss_count);
+  ASSERT_EQ(1, get_perf_context()->bloom_memtable_hit_count);
+
+  // With a prefix extractor, keys sharing the prefix of a present key are
+  // still filtered.
+  options.prefix_extractor.reset(NewFixedPrefixTransform(3));
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("key1", "val1"));
+  get_perf_context()->Reset();
+  ASSERT_EQ("NOT_FOUND", Get("key4"));
+  ASSERT_EQ(1, get_perf_context()->bloom_memtable_miss_count);
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->Seek("key");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("val1", iter->value().ToString());
+
+  // The option only applies to the memtables created after it changes.
+  ASSERT_OK(dbfull()->SetOptions({{"memtable_whole_key_filtering", "false"}}));
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+  ASSERT_OK(Put("key5", "val5"));
+  get_perf_context()->Reset();
+  ASSERT_EQ("NOT_FOUND", Get("key4"));
+  ASSERT_EQ(1, get_perf_context()->bloom_memtable_miss_count);
+  ASSERT_EQ(1, get_perf_context()->bloom_memtable_hit_count);
+}
+
 class BloomStatsTestWithParam
     : public DBBloomFilterTest,
       public testing::WithParamInterface<std::tuple<bool, bool, bool>> {
@@ -290,6 +290,60 @@ TEST_F(DBFlushTest, ManualFlushFailsInReadOnlyMode) {
   Close();
 }
 
+#ifndef ROCKSDB_LITE
+TEST_F(DBFlushTest, PartitionedFlush) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.write_buffer_size = 64 << 20;
+  options.max_flush_partitions = 4;
+  Reopen(options);
+
+  // About 8MB of memtable, enough for four partitions of at least 1MB.
+  const int kNumKeys = 8000;
+  Random rnd(301);
+  std::vector<std::string> values(kNumKeys);
+  for (int i = 0; i < kNumKeys; i++) {
+    int k = (i * 7919) % kNumKeys;
+    values[k] = RandomString(&rnd, 1000);
+    ASSERT_OK(Put(Key(k), values[k]));
+  }
+  // Versions of a user key all go to the same file.
+  for (int k = 0; k < kNumKeys; k += 100) {
+    values[k] = "new" + ToString(k);
+    ASSERT_OK(Put(Key(k), values[k]));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ(4, NumTableFilesAtLevel(0));
+
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  std::sort(files.begin(), files.end(),
+            [](const LiveFileMetaData& a, const LiveFileMetaData& b) {
+              return a.smallestkey < b.smallestkey;
+            });
+  for (size_t i = 1; i < files.size(); i++) {
+    ASSERT_LT(files[i - 1].largestkey, files[i].smallestkey);
+  }
+  for (int k = 0; k < kNumKeys; k++) {
+    ASSERT_EQ(values[k], Get(Key(k)));
+  }
+
+  // A flush with range deletions writes a single file.
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(0), Key(10)));
+  for (int k = 0; k < kNumKeys; k += 2) {
+    ASSERT_OK(Put(Key(k), values[k]));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ(5, NumTableFilesAtLevel(0));
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  for (int k = 0; k < kNumKeys; k++) {
+    ASSERT_EQ(k < 10 && k % 2 == 1 ? "NOT_FOUND" : values[k], Get(Key(k)));
+  }
+}
+#endif  // ROCKSDB_LITE
+
 TEST_P(DBAtomicFlushTest, ManualAtomicFlush) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
@@ -27,6 +27,7 @@
 #include <utility>
 #include <vector>
 
+#include "cache/memory_budget.h"
 #include "db/builder.h"
 #include "db/compaction_job.h"
 #include "db/db_info_dumper.h"
@@ -135,6 +136,15 @@ void DumpSupportInfo(Logger* logger) {
 }
 
 int64_t kDefaultLowPriThrottledRate = 2 * 1024 * 1024;
+
+std::shared_ptr<MemoryBudget> NewMemoryBudget(const DBOptions& options) {
+#ifndef ROCKSDB_LITE
+  if (options.memory_budget_cache) {
+    return std::make_shared<MemoryBudget>(options.memory_budget_cache);
+  }
+#endif  // ROCKSDB_LITE
+  return nullptr;
+}
 }  // namespace
 
 DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
@@ -143,7 +153,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       dbname_(dbname),
       own_info_log_(options.info_log == nullptr),
       initial_db_options_(SanitizeOptions(dbname, options)),
-      immutable_db_options_(initial_db_options_),
+      immutable_db_options_(initial_db_options_,
+                            NewMemoryBudget(initial_db_options_)),
       mutable_db_options_(initial_db_options_),
       stats_(immutable_db_options_.statistics.get()),
       db_lock_(nullptr),
@@ -156,6 +167,14 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       log_empty_(true),
       default_cf_handle_(nullptr),
       log_sync_cv_(&mutex_),
+      wal_sync_done_cv_(&wal_sync_mutex_),
+      wal_sync_requested_(0),
+      wal_sync_scheduled_(false),
+      wal_synced_(0),
+      wal_sync_failed_(0),
+      persist_block_cache_(false),
+      block_cache_warming_up_(false),
+      block_cache_warmup_shutdown_(false),
       total_log_size_(0),
       max_total_in_memory_state_(0),
       is_snapshot_supported_(true),
@@ -397,6 +416,12 @@ void DBImpl::CancelAllBackgroundWork(bool wait) {
     mutex_.Lock();
     thread_dump_stats_.reset();
   }
+  if (thread_dump_block_cache_ != nullptr) {
+    mutex_.Unlock();
+    thread_dump_block_cache_->cancel();
+    mutex_.Lock();
+    thread_dump_block_cache_.reset();
+  }
   if (!shutting_down_.load(std::memory_order_acquire) &&
       has_unpersisted_data_.load(std::memory_order_relaxed) &&
       !mutable_db_options_.avoid_flush_during_shutdown) {
@@ -429,6 +454,15 @@ void DBImpl::CancelAllBackgroundWork(bool wait) {
 }
 
 Status DBImpl::CloseHelper() {
+  // Writes are expected to be finished, this only waits for the WAL sync job
+  // to exit.
+  WaitForWALSyncJob();
+
+  StopBlockCacheWarmUp();
+  if (persist_block_cache_) {
+    DumpBlockCache();
+  }
+
   // Guarantee that there is no background error recovery in progress before
   // continuing with the shutdown
   mutex_.Lock();
@@ -630,6 +664,14 @@ void DBImpl::StartTimedTasks() {
             stats_dump_period_sec * 1000000));
       }
     }
+    unsigned int block_cache_dump_period_sec =
+        immutable_db_options_.block_cache_dump_period_sec;
+    if (persist_block_cache_ && block_cache_dump_period_sec > 0 &&
+        !thread_dump_block_cache_) {
+      thread_dump_block_cache_.reset(new rocksdb::RepeatableThread(
+          [this]() { DumpBlockCache(); }, "dump_bc", env_,
+          block_cache_dump_period_sec * 1000000ull));
+    }
   }
 }
 
@@ -1014,6 +1056,82 @@ void DBImpl::MarkLogsSynced(uint64_t up_to, bool synced_dir,
   log_sync_cv_.SignalAll();
 }
 
+void DBImpl::RequestWALSync(SequenceNumber sequence) {
+  InstrumentedMutexLock l(&wal_sync_mutex_);
+  if (sequence <= wal_sync_requested_) {
+    return;
+  }
+  wal_sync_requested_ = sequence;
+  if (!wal_sync_scheduled_) {
+    wal_sync_scheduled_ = true;
+    // Like flushes, fall back to the low-pri pool if the high-pri one is
+    // empty.
+    Env::Priority pri = env_->GetBackgroundThreads(Env::Priority::HIGH) > 0
+                            ? Env::Priority::HIGH
+                            : Env::Priority::LOW;
+    env_->Schedule(&DBImpl::BGWorkWALSync, this, pri, nullptr);
+  }
+}
+
+Status DBImpl::WaitForWALSync(SequenceNumber sequence) {
+  InstrumentedMutexLock l(&wal_sync_mutex_);
+  assert(sequence <= wal_sync_requested_);
+  while (wal_synced_ < sequence && wal_sync_failed_ < sequence) {
+    wal_sync_done_cv_.Wait();
+  }
+  return wal_synced_ >= sequence ? Status::OK() : wal_sync_status_;
+}
+
+void DBImpl::BGWorkWALSync(void* db) {
+  reinterpret_cast<DBImpl*>(db)->BackgroundCallWALSync();
+}
+
+void DBImpl::BackgroundCallWALSync() {
+  InstrumentedMutexLock l(&wal_sync_mutex_);
+  assert(wal_sync_scheduled_);
+  while (wal_sync_requested_ > std::max(wal_synced_, wal_sync_failed_)) {
+    // Every request up to wal_sync_requested_ was made after its data was
+    // written to the WAL, so one sync covers all of them.
+    SequenceNumber target = wal_sync_requested_;
+    wal_sync_mutex_.Unlock();
+    TEST_SYNC_POINT("DBImpl::BackgroundCallWALSync:BeforeSync");
+    Status s;
+    {
+      StopWatch sw(env_, stats_, WAL_FILE_SYNC_MICROS);
+      s = FlushWAL(true /* sync */);
+    }
+    TEST_SYNC_POINT_CALLBACK("DBImpl::BackgroundCallWALSync:AfterSync", &s);
+    if (s.ok()) {
+      default_cf_internal_stats_->AddDBStats(InternalStats::WAL_FILE_SYNCED, 1,
+                                             true /* concurrent */);
+    } else {
+      ROCKS_LOG_ERROR(immutable_db_options_.info_log,
+                      "Background WAL sync error %s", s.ToString().c_str());
+      // The writes waiting for the sync are already in the memtable, so the
+      // DB must stop whether or not paranoid_checks is set.
+      InstrumentedMutexLock db_lock(&mutex_);
+      error_handler_.SetBGError(s, BackgroundErrorReason::kWALSync);
+    }
+    wal_sync_mutex_.Lock();
+    if (s.ok()) {
+      wal_synced_ = target;
+    } else {
+      wal_sync_failed_ = target;
+      wal_sync_status_ = s;
+    }
+    wal_sync_done_cv_.SignalAll();
+  }
+  wal_sync_scheduled_ = false;
+  wal_sync_done_cv_.SignalAll();
+}
+
+void DBImpl::WaitForWALSyncJob() {
+  InstrumentedMutexLock l(&wal_sync_mutex_);
+  while (wal_sync_scheduled_) {
+    wal_sync_done_cv_.Wait();
+  }
+}
+
 SequenceNumber DBImpl::GetLatestSequenceNumber() const {
   return versions_->LastSequence();
 }
@@ -2115,6 +2233,11 @@ bool DBImpl::GetPropertyHandleOptionsStatistics(std::string* value) {
   return true;
 }
 
+bool DBImpl::GetPropertyHandleEnvIOStats(std::string* value) {
+  assert(value != nullptr);
+  return env_->GetIOStats(value).ok();
+}
+
 #ifndef ROCKSDB_LITE
 Status DBImpl::ResetStats() {
   InstrumentedMutexLock l(&mutex_);
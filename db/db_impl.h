@@ -461,6 +461,9 @@ class DBImpl : public DB {
 
   Cache* TEST_table_cache() { return table_cache_.get(); }
 
+  // Waits until the block cache warm-up started by DB::Open is over.
+  void TEST_WaitForBlockCacheWarmUp();
+
   WriteController& TEST_write_controler() { return write_controller_; }
 
   uint64_t TEST_FindMinLogContainingOutstandingPrep();
@@ -1144,6 +1147,32 @@ class DBImpl : public DB {
   // helper function to call after some of the logs_ were synced
   void MarkLogsSynced(uint64_t up_to, bool synced_dir, const Status& status);
 
+  // Used with background_wal_sync once a group with synced writes is in the
+  // WAL. Asks for the WAL to be made durable up to sequence, by a job on the
+  // HIGH priority pool, or the LOW one if it is empty, that is scheduled
+  // unless one is already running.
+  void RequestWALSync(SequenceNumber sequence);
+  // Blocks until a sync requested with RequestWALSync() covers sequence and
+  // returns its status.
+  Status WaitForWALSync(SequenceNumber sequence);
+  static void BGWorkWALSync(void* db);
+  void BackgroundCallWALSync();
+  // Waits for the WAL sync job to finish the pending syncs.
+  void WaitForWALSyncJob();
+
+  // Saves the keys of the blocks of this DB in its block caches to
+  // block_cache_dump_path, unless the caches are still being warmed up from
+  // it.
+  Status DumpBlockCache();
+  // Starts a thread reading the blocks listed in block_cache_dump_path back
+  // into the block caches, if the file exists. Called by DB::Open.
+  void StartBlockCacheWarmUp();
+  void BackgroundCallBlockCacheWarmUp();
+  Status WarmUpBlockCache(uint64_t* num_blocks, uint64_t* bytes_read,
+                          bool* interrupted);
+  // Interrupts the warm-up and joins its thread.
+  void StopBlockCacheWarmUp();
+
   SnapshotImpl* GetSnapshotImpl(bool is_write_conflict_boundary);
 
   uint64_t GetMaxTotalWalSize() const;
@@ -1260,6 +1289,30 @@ class DBImpl : public DB {
   std::deque<LogWriterNumber> logs_;
   // Signaled when getting_synced becomes false for some of the logs_.
   InstrumentedCondVar log_sync_cv_;
+  // State of the WAL sync job used with background_wal_sync, protected by
+  // wal_sync_mutex_. Syncs are identified by the last sequence number written
+  // to the WAL before they started.
+  InstrumentedMutex wal_sync_mutex_;
+  // Signaled when a sync finishes and when the job exits.
+  InstrumentedCondVar wal_sync_done_cv_;
+  SequenceNumber wal_sync_requested_;
+  // The WAL sync job is scheduled or running.
+  bool wal_sync_scheduled_;
+  // The WAL is durable up to this sequence.
+  SequenceNumber wal_synced_;
+  // The last sync that failed and its status.
+  SequenceNumber wal_sync_failed_;
+  Status wal_sync_status_;
+  // State of the block cache persistence to block_cache_dump_path. It is
+  // only saved on close if this DB was opened by DB::Open.
+  bool persist_block_cache_;
+  // Serializes the dumps.
+  port::Mutex block_cache_dump_mutex_;
+  port::Thread block_cache_warmup_thread_;
+  // Set until the warm-up is over, so that no dump replaces the file that
+  // is still being read. Stays set if the warm-up is interrupted by close.
+  std::atomic<bool> block_cache_warming_up_;
+  std::atomic<bool> block_cache_warmup_shutdown_;
   // This is the app-level state that is written to the WAL but will be used
   // only during recovery. Using this feature enables not writing the state to
   // memtable on normal writes and hence improving the throughput. Each new
@@ -1530,6 +1583,7 @@ class DBImpl : public DB {
   // handle for scheduling jobs at fixed intervals
   // REQUIRES: mutex locked
   std::unique_ptr<rocksdb::RepeatableThread> thread_dump_stats_;
+  std::unique_ptr<rocksdb::RepeatableThread> thread_dump_block_cache_;
 
   // No copying allowed
   DBImpl(const DBImpl&);
@@ -1562,6 +1616,7 @@ class DBImpl : public DB {
                               const DBPropertyInfo& property_info,
                               bool is_locked, uint64_t* value);
   bool GetPropertyHandleOptionsStatistics(std::string* value);
+  bool GetPropertyHandleEnvIOStats(std::string* value);
 
   bool HasPendingManualCompaction();
   bool HasExclusiveManualCompaction();
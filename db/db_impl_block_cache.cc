@@ -0,0 +1,367 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/db_impl.h"
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "db/column_family.h"
+#include "db/table_cache.h"
+#include "db/version_set.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/rate_limiter.h"
+#include "rocksdb/table.h"
+#include "table/block_based_table_factory.h"
+#include "table/table_reader.h"
+#include "util/coding.h"
+#include "util/mutexlock.h"
+#include "util/sync_point.h"
+
+// The block cache dump is a text file with a header line followed by one
+// line per cached block: "<file number> <offset> <H|L>", the last field being
+// the priority of the block in the cache.
+
+namespace rocksdb {
+
+namespace {
+const char* kBlockCacheDumpHeader = "# rocksdb block cache dump v1";
+
+Cache* GetBlockCache(ColumnFamilyData* cfd) {
+  auto* table_factory = cfd->ioptions()->table_factory;
+  if (table_factory == nullptr ||
+      BlockBasedTableFactory::kName != table_factory->Name()) {
+    return nullptr;
+  }
+  auto* table_options =
+      reinterpret_cast<BlockBasedTableOptions*>(table_factory->GetOptions());
+  if (table_options == nullptr || table_options->no_block_cache) {
+    return nullptr;
+  }
+  return table_options->block_cache.get();
+}
+
+struct DumpedFile {
+  bool has_high_pri_blocks = false;
+  std::vector<uint64_t> offsets;
+};
+
+// A live file whose blocks are to be read back into the cache.
+struct WarmUpFile {
+  ColumnFamilyData* cfd;
+  FileMetaData* meta;
+  int level;
+  std::shared_ptr<const SliceTransform> prefix_extractor;
+  DumpedFile* blocks;
+};
+}  // namespace
+
+Status DBImpl::DumpBlockCache() {
+  const std::string& path = immutable_db_options_.block_cache_dump_path;
+  MutexLock dump_lock(&block_cache_dump_mutex_);
+  if (block_cache_warming_up_.load(std::memory_order_acquire)) {
+    // The cache only holds part of the blocks listed in the existing dump.
+    return Status::OK();
+  }
+
+  // Cache key prefix of each live table, by block cache.
+  std::unordered_map<Cache*, std::unordered_map<std::string, uint64_t>>
+      prefixes;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      Cache* block_cache = GetBlockCache(cfd);
+      if (cfd->IsDropped() || !cfd->initialized() || block_cache == nullptr) {
+        continue;
+      }
+      auto& cache_prefixes = prefixes[block_cache];
+      VersionStorageInfo* vstorage = cfd->current()->storage_info();
+      for (int level = 0; level < vstorage->num_levels(); level++) {
+        for (FileMetaData* f : vstorage->LevelFiles(level)) {
+          TableReader* reader = f->fd.table_reader;
+          Cache::Handle* handle = nullptr;
+          if (reader == nullptr) {
+            // Tables that are not open have no blocks in the cache.
+            Status s = cfd->table_cache()->FindTable(
+                env_options_, cfd->internal_comparator(), f->fd, &handle,
+                nullptr /* prefix_extractor */, true /* no_io */);
+            if (!s.ok()) {
+              continue;
+            }
+            reader = cfd->table_cache()->GetTableReaderFromHandle(handle);
+          }
+          Slice prefix = reader->GetBlockCacheKeyPrefix();
+          if (!prefix.empty()) {
+            cache_prefixes[prefix.ToString()] = f->fd.GetNumber();
+          }
+          if (handle != nullptr) {
+            cfd->table_cache()->ReleaseHandle(handle);
+          }
+        }
+      }
+    }
+  }
+
+  std::string data = kBlockCacheDumpHeader;
+  data.push_back('\n');
+  uint64_t num_blocks = 0;
+  for (auto& cache_prefixes : prefixes) {
+    std::vector<size_t> prefix_sizes;
+    for (auto& prefix : cache_prefixes.second) {
+      if (std::find(prefix_sizes.begin(), prefix_sizes.end(),
+                    prefix.first.size()) == prefix_sizes.end()) {
+        prefix_sizes.push_back(prefix.first.size());
+      }
+    }
+    // Only copy the keys out while the shards are locked, and match them
+    // against the table prefixes after.
+    std::string keys;
+    std::vector<std::pair<size_t, Cache::Priority>> key_ends;
+    cache_prefixes.first->ApplyToAllCacheKeys(
+        [&](const Slice& key, size_t /*charge*/, Cache::Priority priority) {
+          keys.append(key.data(), key.size());
+          key_ends.emplace_back(keys.size(), priority);
+        },
+        true /* thread_safe */);
+    size_t key_start = 0;
+    for (auto& key_end : key_ends) {
+      Slice key(keys.data() + key_start, key_end.first - key_start);
+      key_start = key_end.first;
+      for (size_t prefix_size : prefix_sizes) {
+        if (key.size() <= prefix_size) {
+          continue;
+        }
+        auto it =
+            cache_prefixes.second.find(std::string(key.data(), prefix_size));
+        if (it == cache_prefixes.second.end()) {
+          continue;
+        }
+        // Other keys sharing the prefix, e.g. the placeholders charged for
+        // blocks read without fill_cache, are not "<prefix><offset>".
+        Slice rest(key.data() + prefix_size, key.size() - prefix_size);
+        uint64_t offset;
+        if (GetVarint64(&rest, &offset) && rest.empty()) {
+          char line[64];
+          snprintf(line, sizeof(line), "%" PRIu64 " %" PRIu64 " %c\n",
+                   it->second, offset,
+                   key_end.second == Cache::Priority::HIGH ? 'H' : 'L');
+          data.append(line);
+          num_blocks++;
+        }
+        break;
+      }
+    }
+  }
+
+  // Replace the previous dump only once the new one is complete.
+  const std::string tmp_path = path + ".tmp";
+  Status s = WriteStringToFile(env_, data, tmp_path, true /* should_sync */);
+  if (s.ok()) {
+    s = env_->RenameFile(tmp_path, path);
+  }
+  if (s.ok()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Saved the keys of %" PRIu64 " cached blocks to %s",
+                   num_blocks, path.c_str());
+  } else {
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Failed to save the block cache keys to %s: %s",
+                   path.c_str(), s.ToString().c_str());
+  }
+  return s;
+}
+
+void DBImpl::StartBlockCacheWarmUp() {
+  const std::string& path = immutable_db_options_.block_cache_dump_path;
+  if (path.empty()) {
+    return;
+  }
+  persist_block_cache_ = true;
+  if (env_->FileExists(path).ok()) {
+    block_cache_warming_up_.store(true, std::memory_order_release);
+    block_cache_warmup_thread_ =
+        port::Thread([this]() { BackgroundCallBlockCacheWarmUp(); });
+  }
+}
+
+void DBImpl::StopBlockCacheWarmUp() {
+  block_cache_warmup_shutdown_.store(true, std::memory_order_release);
+  if (block_cache_warmup_thread_.joinable()) {
+    block_cache_warmup_thread_.join();
+  }
+}
+
+void DBImpl::BackgroundCallBlockCacheWarmUp() {
+  uint64_t num_blocks = 0;
+  uint64_t bytes_read = 0;
+  bool interrupted = false;
+  Status s = WarmUpBlockCache(&num_blocks, &bytes_read, &interrupted);
+  if (s.ok()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Block cache warm-up read %" PRIu64 " blocks (%" PRIu64
+                   " bytes)",
+                   num_blocks, bytes_read);
+  } else {
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Block cache warm-up stopped after %" PRIu64
+                   " blocks: %s",
+                   num_blocks, s.ToString().c_str());
+  }
+  if (!interrupted) {
+    // Otherwise the dump is kept for the next open.
+    block_cache_warming_up_.store(false, std::memory_order_release);
+  }
+  TEST_SYNC_POINT("DBImpl::BackgroundCallBlockCacheWarmUp:Done");
+}
+
+Status DBImpl::WarmUpBlockCache(uint64_t* num_blocks, uint64_t* bytes_read,
+                                bool* interrupted) {
+  std::string data;
+  Status s = ReadFileToString(
+      env_, immutable_db_options_.block_cache_dump_path, &data);
+  if (!s.ok()) {
+    return s;
+  }
+  std::unordered_map<uint64_t, DumpedFile> dumped;
+  size_t pos = 0;
+  bool header = true;
+  while (pos < data.size()) {
+    size_t end = data.find('\n', pos);
+    if (end == std::string::npos) {
+      end = data.size();
+    }
+    std::string line = data.substr(pos, end - pos);
+    pos = end + 1;
+    if (header) {
+      if (line != kBlockCacheDumpHeader) {
+        return Status::Corruption("Unknown block cache dump format", line);
+      }
+      header = false;
+      continue;
+    }
+    uint64_t number;
+    uint64_t offset;
+    char priority;
+    if (sscanf(line.c_str(), "%" SCNu64 " %" SCNu64 " %c", &number, &offset,
+               &priority) != 3) {
+      return Status::Corruption("Malformed block cache dump line", line);
+    }
+    DumpedFile& file = dumped[number];
+    file.has_high_pri_blocks |= priority == 'H';
+    file.offsets.push_back(offset);
+  }
+
+  std::vector<WarmUpFile> files;
+  std::vector<std::pair<ColumnFamilyData*, Version*>> referenced;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped() || !cfd->initialized() ||
+          GetBlockCache(cfd) == nullptr) {
+        continue;
+      }
+      Version* version = cfd->current();
+      VersionStorageInfo* vstorage = version->storage_info();
+      for (int level = 0; level < vstorage->num_levels(); level++) {
+        for (FileMetaData* f : vstorage->LevelFiles(level)) {
+          auto it = dumped.find(f->fd.GetNumber());
+          if (it == dumped.end()) {
+            continue;
+          }
+          if (referenced.empty() || referenced.back().second != version) {
+            // Keep the files alive while their blocks are read.
+            cfd->Ref();
+            version->Ref();
+            referenced.emplace_back(cfd, version);
+          }
+          files.push_back(WarmUpFile{
+              cfd, f, level,
+              cfd->GetLatestMutableCFOptions()->prefix_extractor,
+              &it->second});
+        }
+      }
+    }
+  }
+  // Tables with blocks of high priority first, as those are likely index
+  // and filter blocks that every read of the table needs.
+  std::stable_sort(files.begin(), files.end(),
+                   [](const WarmUpFile& a, const WarmUpFile& b) {
+                     return a.blocks->has_high_pri_blocks &&
+                            !b.blocks->has_high_pri_blocks;
+                   });
+
+  std::unique_ptr<RateLimiter> rate_limiter;
+  if (immutable_db_options_.block_cache_warmup_rate_bytes_per_sec > 0) {
+    rate_limiter.reset(NewGenericRateLimiter(
+        static_cast<int64_t>(
+            immutable_db_options_.block_cache_warmup_rate_bytes_per_sec),
+        100 * 1000 /* refill_period_us */, 10 /* fairness */,
+        RateLimiter::Mode::kReadsOnly));
+  }
+  auto before_read = [&](uint64_t block_size) {
+    if (block_cache_warmup_shutdown_.load(std::memory_order_acquire)) {
+      *interrupted = true;
+      return false;
+    }
+    if (rate_limiter != nullptr) {
+      size_t left = static_cast<size_t>(block_size);
+      while (left > 0) {
+        left -= rate_limiter->RequestToken(left, 0 /* alignment */,
+                                           Env::IO_LOW, nullptr /* stats */,
+                                           RateLimiter::OpType::kRead);
+      }
+    }
+    *num_blocks += 1;
+    *bytes_read += block_size;
+    return true;
+  };
+
+  for (auto& file : files) {
+    if (block_cache_warmup_shutdown_.load(std::memory_order_acquire)) {
+      *interrupted = true;
+    }
+    if (!s.ok() || *interrupted) {
+      break;
+    }
+    std::vector<uint64_t>& offsets = file.blocks->offsets;
+    std::sort(offsets.begin(), offsets.end());
+    TableCache* table_cache = file.cfd->table_cache();
+    Cache::Handle* handle = nullptr;
+    s = table_cache->FindTable(env_options_, file.cfd->internal_comparator(),
+                               file.meta->fd, &handle,
+                               file.prefix_extractor.get(), false /* no_io */,
+                               true /* record_read_stats */,
+                               nullptr /* file_read_hist */,
+                               false /* skip_filters */, file.level);
+    if (s.ok()) {
+      s = table_cache->GetTableReaderFromHandle(handle)
+              ->LoadDataBlocksIntoCache(offsets, before_read);
+      table_cache->ReleaseHandle(handle);
+    }
+    if (s.IsNotSupported()) {
+      s = Status::OK();
+    }
+  }
+
+  InstrumentedMutexLock l(&mutex_);
+  for (auto& cfd_version : referenced) {
+    cfd_version.second->Unref();
+    if (cfd_version.first->Unref()) {
+      delete cfd_version.first;
+    }
+  }
+  return s;
+}
+
+}  // namespace rocksdb
@@ -214,6 +214,14 @@ Status DBImpl::FlushMemTableToOutputFile(
     // may temporarily unlock and lock the mutex.
     NotifyOnFlushCompleted(cfd, &file_meta, mutable_cf_options,
                            job_context->job_id, flush_job.GetTableProperties());
+    // A partitioned flush writes several files.
+    std::vector<FileMetaData> extra_file_meta =
+        flush_job.GetExtraFileMetaData();
+    for (size_t i = 0; i < extra_file_meta.size(); i++) {
+      NotifyOnFlushCompleted(cfd, &extra_file_meta[i], mutable_cf_options,
+                             job_context->job_id,
+                             flush_job.GetExtraTableProperties()[i]);
+    }
     auto sfm = static_cast<SstFileManagerImpl*>(
         immutable_db_options_.sst_file_manager.get());
     if (sfm) {
@@ -221,6 +229,10 @@ Status DBImpl::FlushMemTableToOutputFile(
       std::string file_path = MakeTableFileName(
           cfd->ioptions()->cf_paths[0].path, file_meta.fd.GetNumber());
       sfm->OnAddFile(file_path);
+      for (const FileMetaData& meta : extra_file_meta) {
+        sfm->OnAddFile(MakeTableFileName(cfd->ioptions()->cf_paths[0].path,
+                                         meta.fd.GetNumber()));
+      }
       if (sfm->IsMaxAllowedSpaceReached()) {
         Status new_bg_error = Status::SpaceLimit("Max allowed space was reached");
         TEST_SYNC_POINT_CALLBACK(
@@ -163,6 +163,12 @@ void DBImpl::TEST_EndWrite(void* w) {
   delete writer;
 }
 
+void DBImpl::TEST_WaitForBlockCacheWarmUp() {
+  if (block_cache_warmup_thread_.joinable()) {
+    block_cache_warmup_thread_.join();
+  }
+}
+
 size_t DBImpl::TEST_LogsToFreeSize() {
   InstrumentedMutexLock l(&mutex_);
   return logs_to_free_.size();
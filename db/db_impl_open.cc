@@ -52,8 +52,10 @@ DBOptions SanitizeOptions(const std::string& dbname, const DBOptions& src) {
   }
 
   if (!result.write_buffer_manager) {
-    result.write_buffer_manager.reset(
-        new WriteBufferManager(result.db_write_buffer_size));
+    // Memtables are charged to the memory budget through the
+    // WriteBufferManager.
+    result.write_buffer_manager.reset(new WriteBufferManager(
+        result.db_write_buffer_size, result.memory_budget_cache));
   }
   auto bg_job_limits = DBImpl::GetBGJobLimits(
       result.max_background_flushes, result.max_background_compactions,
@@ -1323,6 +1325,7 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
     }
   }
   if (s.ok()) {
+    impl->StartBlockCacheWarmUp();
     impl->StartTimedTasks();
   }
   if (!s.ok()) {
@@ -176,7 +176,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
       *seq_used = w.sequence;
     }
     // write is complete and leader has updated sequence
-    return w.FinalStatus();
+    status = w.FinalStatus();
+    return status;
   }
   // else we are the leader of the write batch group
   assert(w.state == WriteThread::STATE_GROUP_LEADER);
@@ -189,6 +190,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   WriteThread::WriteGroup write_group;
   bool in_parallel_group = false;
   uint64_t last_sequence = kMaxSequenceNumber;
+  // The sequence the WAL must be synced up to before the group is published.
+  SequenceNumber wal_sync_sequence = kMaxSequenceNumber;
   if (!two_write_queues_) {
     last_sequence = versions_->LastSequence();
   }
@@ -196,6 +199,15 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   mutex_.Lock();
 
   bool need_log_sync = write_options.sync;
+  // With background WAL sync the WAL is written as if no sync was needed and
+  // the sync is requested once the group is in the WAL.
+  const bool background_log_sync =
+      need_log_sync && immutable_db_options_.background_wal_sync &&
+      !two_write_queues_ &&
+      logs_.back().writer->file()->writable_file()->IsSyncThreadSafe();
+  if (background_log_sync) {
+    need_log_sync = false;
+  }
   bool need_log_dir_sync = need_log_sync && !log_dir_synced_;
   if (!two_write_queues_ || !disable_memtable) {
     // With concurrent writes we do preprocess only in the write thread that
@@ -292,6 +304,11 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         PERF_TIMER_GUARD(write_wal_time);
         status = WriteToWAL(write_group, log_writer, log_used, need_log_sync,
                             need_log_dir_sync, last_sequence + 1);
+        if (background_log_sync && status.ok()) {
+          // Start the sync now so that it overlaps with the memtable inserts.
+          wal_sync_sequence = last_sequence + seq_inc;
+          RequestWALSync(wal_sync_sequence);
+        }
       }
     } else {
       if (status.ok() && !write_options.disableWAL) {
@@ -380,6 +397,19 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     }
   }
 
+  Status wal_sync_status;
+  if (wal_sync_sequence != kMaxSequenceNumber) {
+    // Nothing of the group is published or returned before the WAL is synced.
+    // The parallel followers cannot exit the group before the leader is done
+    // either. On failure the memtable inserts are still published below, so
+    // that their sequence numbers are not reused, and the group fails.
+    wal_sync_status = WaitForWALSync(wal_sync_sequence);
+    if (!wal_sync_status.ok() && in_parallel_group) {
+      std::lock_guard<std::mutex> guard(w.StateMutex());
+      write_group.status = wal_sync_status;
+    }
+  }
+
   bool should_exit_batch_group = true;
   if (in_parallel_group) {
     // CompleteParallelWorker returns true if this thread should
@@ -402,9 +432,15 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
       versions_->SetLastSequence(last_sequence);
     }
     MemTableInsertStatusCheck(w.status);
+    if (status.ok()) {
+      status = wal_sync_status;
+    }
     write_thread_.ExitAsBatchGroupLeader(write_group, status);
   }
 
+  if (status.ok()) {
+    status = wal_sync_status;
+  }
   if (status.ok()) {
     status = w.FinalStatus();
   }
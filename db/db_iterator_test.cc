@@ -1982,6 +1982,40 @@ TEST_P(DBIteratorTest, ReadAhead) {
   delete iter;
 }
 
+// Files that cannot warm a cache on Prefetch() get their readahead from a
+// buffer owned by the iterator.
+TEST_P(DBIteratorTest, ReadAheadWithoutPrefetch) {
+  Options options;
+  env_->count_random_reads_ = true;
+  env_->prefetch_not_supported_ = true;
+  options.env = env_;
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  std::string value(1024, 'a');
+  for (int i = 0; i < 100; i++) {
+    Put(Key(i), value);
+  }
+  ASSERT_OK(Flush());
+
+  env_->random_read_counter_.Reset();
+  auto* iter = NewIterator(ReadOptions());
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(value, iter->value());
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  delete iter;
+  ASSERT_EQ(100, count);
+  // One read per data block would take about 100 reads.
+  ASSERT_LT(env_->random_read_counter_.Read(), 20);
+}
+
 // Insert a key, create a snapshot iterator, overwrite key lots of times,
 // seek to a smaller key. Expect DBIter to fall back to a seek instead of
 // going through all the overwrites linearly.
@@ -5,6 +5,8 @@
 
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "db/db_test_util.h"
 #include "db/memtable.h"
@@ -264,6 +266,166 @@ TEST_F(DBMemTableTest, ColumnFamilyId) {
   }
 }
 
+#ifndef ROCKSDB_LITE
+TEST_F(DBMemTableTest, ConcurrentWriteHashMemTable) {
+  // Several writers share each prefix, and the link list buckets are
+  // converted to skip lists while they write.
+  const int kNumThreads = 4;
+  const int kNumPrefixes = 8;
+  const int kKeysPerThread = 512;
+  for (int rep = 0; rep < 3; rep++) {
+    Options options = CurrentOptions();
+    options.allow_concurrent_memtable_write = true;
+    options.enable_write_thread_adaptive_yield = true;
+    options.prefix_extractor.reset(NewFixedPrefixTransform(4));
+    if (rep == 0) {
+      options.memtable_factory.reset(NewHashSkipListRepFactory(4));
+    } else if (rep == 1) {
+      // Higher than the buckets can be, so it is clamped.
+      options.memtable_factory.reset(NewHashSkipListRepFactory(4, 100, 2));
+    } else {
+      options.memtable_factory.reset(
+          NewHashLinkListRepFactory(4, 0, 0, true, 16));
+    }
+    DestroyAndReopen(options);
+
+    std::vector<port::Thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&, t]() {
+        WriteOptions wo;
+        for (int i = 0; i < kKeysPerThread; i++) {
+          char key[20];
+          snprintf(key, sizeof(key), "p%03d%04d%d", i % kNumPrefixes, i, t);
+          ASSERT_OK(db_->Put(wo, key, key));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (int t = 0; t < kNumThreads; t++) {
+      for (int i = 0; i < kKeysPerThread; i++) {
+        char key[20];
+        snprintf(key, sizeof(key), "p%03d%04d%d", i % kNumPrefixes, i, t);
+        ASSERT_EQ(key, Get(key));
+      }
+    }
+    for (int p = 0; p < kNumPrefixes; p++) {
+      char prefix[5];
+      snprintf(prefix, sizeof(prefix), "p%03d", p);
+      std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+      int count = 0;
+      std::string last;
+      for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix);
+           iter->Next()) {
+        ASSERT_LT(last, iter->key().ToString());
+        last = iter->key().ToString();
+        count++;
+      }
+      ASSERT_EQ(kNumThreads * kKeysPerThread / kNumPrefixes, count);
+    }
+  }
+}
+
+TEST_F(DBMemTableTest, AdaptiveRadixTreeMemTable) {
+  // Writers overwrite each other's keys, so most user keys have several
+  // versions, while a reader scans the memtable.
+  const int kNumThreads = 4;
+  const int kNumKeys = 2000;
+  Options options = CurrentOptions();
+  options.allow_concurrent_memtable_write = true;
+  options.enable_write_thread_adaptive_yield = true;
+  options.memtable_factory.reset(new AdaptiveRadixTreeRepFactory());
+  DestroyAndReopen(options);
+
+  std::atomic<bool> done(false);
+  port::Thread reader([&]() {
+    while (!done.load()) {
+      std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+      std::string last;
+      for (iter->Seek("k"); iter->Valid(); iter->Next()) {
+        ASSERT_LT(last, iter->key().ToString());
+        last = iter->key().ToString();
+      }
+    }
+  });
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      WriteOptions wo;
+      for (int i = 0; i < kNumKeys; i++) {
+        int k = (i * 7 + t * 13) % kNumKeys;
+        ASSERT_OK(db_->Put(wo, "k" + ToString(k), ToString(t)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  done.store(true);
+  reader.join();
+
+  ASSERT_OK(Delete("k7"));
+  for (int k = 0; k < kNumKeys; k++) {
+    std::string value = Get("k" + ToString(k));
+    if (k == 7) {
+      ASSERT_EQ("NOT_FOUND", value);
+    } else {
+      ASSERT_EQ(1U, value.size());
+    }
+  }
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int count = 0;
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    count++;
+  }
+  ASSERT_EQ(kNumKeys - 1, count);
+  ASSERT_OK(Flush());
+  ASSERT_EQ("NOT_FOUND", Get("k7"));
+  ASSERT_EQ(1U, Get("k8").size());
+}
+
+TEST_F(DBMemTableTest, VectorRepParallelSort) {
+  // Large enough for the immutable memtable to be sorted by four threads.
+  const int kNumKeys = 40000;
+  Options options = CurrentOptions();
+  options.allow_concurrent_memtable_write = false;
+  options.write_buffer_size = 64 << 20;
+  options.max_write_buffer_number = 4;
+  options.memtable_factory.reset(new VectorRepFactory(0, 4));
+  DestroyAndReopen(options);
+
+  auto key = [](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%08d", i);
+    return std::string(buf);
+  };
+  for (int i = 0; i < kNumKeys; i++) {
+    int k = static_cast<int>((i * 7919LL) % kNumKeys);
+    ASSERT_OK(Put(key(k), ToString(k)));
+  }
+  ASSERT_OK(Put(key(5), "new"));
+
+  // Read from the immutable memtable, then from the flushed file.
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+  for (int pass = 0; pass < 2; pass++) {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    int i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+      ASSERT_EQ(key(i), iter->key().ToString());
+      ASSERT_EQ(i == 5 ? "new" : ToString(i), iter->value().ToString());
+    }
+    ASSERT_EQ(kNumKeys, i);
+    ASSERT_EQ("new", Get(key(5)));
+    ASSERT_EQ(ToString(kNumKeys - 1), Get(key(kNumKeys - 1)));
+    if (pass == 0) {
+      ASSERT_OK(Flush());
+    }
+  }
+}
+#endif  // ROCKSDB_LITE
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -1688,6 +1688,30 @@ TEST_F(DBPropertiesTest, BlockCacheProperties) {
   ASSERT_EQ(0, value);
 }
 
+TEST_F(DBPropertiesTest, EnvIOStats) {
+  class IOStatsEnv : public EnvWrapper {
+   public:
+    explicit IOStatsEnv(Env* target) : EnvWrapper(target) {}
+    Status GetIOStats(std::string* stats) override {
+      *stats = "pread count 42";
+      return Status::OK();
+    }
+  };
+
+  Options options = CurrentOptions();
+  std::string value;
+  // The default env does not collect I/O stats.
+  Reopen(options);
+  ASSERT_FALSE(db_->GetProperty(DB::Properties::kEnvIOStats, &value));
+
+  std::unique_ptr<IOStatsEnv> io_stats_env(new IOStatsEnv(env_));
+  options.env = io_stats_env.get();
+  Reopen(options);
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kEnvIOStats, &value));
+  ASSERT_EQ("pread count 42", value);
+  Close();
+}
+
 #endif  // ROCKSDB_LITE
 }  // namespace rocksdb
 
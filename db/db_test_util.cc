@@ -27,6 +27,7 @@ SpecialEnv::SpecialEnv(Env* base)
   no_space_.store(false, std::memory_order_release);
   non_writable_.store(false, std::memory_order_release);
   count_random_reads_ = false;
+  prefetch_not_supported_ = false;
   count_sequential_reads_ = false;
   manifest_sync_error_.store(false, std::memory_order_release);
   manifest_write_error_.store(false, std::memory_order_release);
@@ -343,7 +344,6 @@ Options DBTestBase::GetOptions(
     case kHashSkipList:
       options.prefix_extractor.reset(NewFixedPrefixTransform(1));
       options.memtable_factory.reset(NewHashSkipListRepFactory(16));
-      options.allow_concurrent_memtable_write = false;
       break;
     case kPlainTableFirstBytePrefix:
       options.table_factory.reset(new PlainTableFactory());
@@ -381,7 +381,6 @@ Options DBTestBase::GetOptions(
       options.prefix_extractor.reset(NewFixedPrefixTransform(1));
       options.memtable_factory.reset(
           NewHashLinkListRepFactory(4, 0, 3, true, 4));
-      options.allow_concurrent_memtable_write = false;
       break;
     case kHashCuckoo:
       options.memtable_factory.reset(
@@ -426,10 +426,11 @@ class SpecialEnv : public EnvWrapper {
      public:
       CountingFile(std::unique_ptr<RandomAccessFile>&& target,
                    anon::AtomicCounter* counter,
-                   std::atomic<size_t>* bytes_read)
+                   std::atomic<size_t>* bytes_read, bool prefetch_supported)
           : target_(std::move(target)),
             counter_(counter),
-            bytes_read_(bytes_read) {}
+            bytes_read_(bytes_read),
+            prefetch_supported_(prefetch_supported) {}
       virtual Status Read(uint64_t offset, size_t n, Slice* result,
                           char* scratch) const override {
         counter_->Increment();
@@ -437,18 +438,26 @@ class SpecialEnv : public EnvWrapper {
         *bytes_read_ += result->size();
         return s;
       }
+      virtual Status Prefetch(uint64_t offset, size_t n) override {
+        if (!prefetch_supported_) {
+          return Status::NotSupported("Prefetch");
+        }
+        return target_->Prefetch(offset, n);
+      }
 
      private:
       std::unique_ptr<RandomAccessFile> target_;
       anon::AtomicCounter* counter_;
       std::atomic<size_t>* bytes_read_;
+      bool prefetch_supported_;
     };
 
     Status s = target()->NewRandomAccessFile(f, r, soptions);
     random_file_open_counter_++;
     if (s.ok() && count_random_reads_) {
       r->reset(new CountingFile(std::move(*r), &random_read_counter_,
-                                &random_read_bytes_counter_));
+                                &random_read_bytes_counter_,
+                                !prefetch_not_supported_));
     }
     if (s.ok() && soptions.compaction_readahead_size > 0) {
       compaction_readahead_size_ = soptions.compaction_readahead_size;
@@ -554,6 +563,9 @@ class SpecialEnv : public EnvWrapper {
   std::atomic<int> num_open_wal_file_;
 
   bool count_random_reads_;
+  // Make counted random access files report Prefetch() as not supported,
+  // like files on remote storage.
+  bool prefetch_not_supported_;
   anon::AtomicCounter random_read_counter_;
   std::atomic<size_t> random_read_bytes_counter_;
   std::atomic<int> random_file_open_counter_;
@@ -140,6 +140,71 @@ TEST_P(DBWriteTest, IOErrorOnWALWriteTriggersReadOnlyMode) {
   Close();
 }
 
+TEST_P(DBWriteTest, BackgroundWALSync) {
+  Options options = GetOptions();
+  options.background_wal_sync = true;
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+  if (options.enable_pipelined_write || options.two_write_queues) {
+    // The option is ignored on these write paths.
+    return;
+  }
+
+  // The synced write must not be visible, nor return, before its sync.
+  std::atomic<bool> put_returned{false};
+  std::atomic<bool> visible_before_sync{false};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCallWALSync:BeforeSync", [&](void*) {
+        std::string value;
+        Status s = db_->Get(ReadOptions(), "synced", &value);
+        if (put_returned || !s.IsNotFound()) {
+          visible_before_sync = true;
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  WriteOptions write_options;
+  write_options.sync = true;
+  ASSERT_OK(dbfull()->Put(write_options, "synced", "v1"));
+  put_returned = true;
+  ASSERT_OK(Put("unsynced", "v2"));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_FALSE(visible_before_sync);
+  ASSERT_GE(options.statistics->getTickerCount(WAL_FILE_SYNCED), 1U);
+  Reopen(options);
+  ASSERT_EQ("v1", Get("synced"));
+  ASSERT_EQ("v2", Get("unsynced"));
+}
+
+TEST_P(DBWriteTest, BackgroundWALSyncError) {
+  Options options = GetOptions();
+  options.background_wal_sync = true;
+  options.paranoid_checks = false;
+  Reopen(options);
+  if (options.enable_pipelined_write || options.two_write_queues) {
+    return;
+  }
+
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCallWALSync:AfterSync", [&](void* arg) {
+        *reinterpret_cast<Status*>(arg) = Status::IOError("injected");
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  WriteOptions write_options;
+  write_options.sync = true;
+  ASSERT_TRUE(dbfull()->Put(write_options, "synced", "v1").IsIOError());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // The failure stops the DB even without paranoid_checks.
+  Status s = Put("unsynced", "v2");
+  ASSERT_TRUE(s.IsIOError());
+  ASSERT_EQ(Status::Severity::kHardError, s.severity());
+  Close();
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
@@ -118,6 +118,11 @@ std::map<std::tuple<BackgroundErrorReason, bool>, Status::Severity>
           Status::Severity::kFatalError},
         {std::make_tuple(BackgroundErrorReason::kMemTable, false),
           Status::Severity::kFatalError},
+        // Errors during background WAL sync
+        {std::make_tuple(BackgroundErrorReason::kWALSync, true),
+          Status::Severity::kHardError},
+        {std::make_tuple(BackgroundErrorReason::kWALSync, false),
+          Status::Severity::kHardError},
 };
 
 void ErrorHandler::CancelErrorRecovery() {
@@ -86,6 +86,61 @@ const char* GetFlushReasonString (FlushReason flush_reason) {
   }
 }
 
+namespace {
+
+// Flushes of less memtable than this per partition are not split further.
+const size_t kMinFlushPartitionBytes = 1 << 20;
+// Keys sampled from each memtable per partition, to pick the boundaries.
+const size_t kFlushSamplesPerPartition = 16;
+
+// Iterates over the entries of iter whose user keys are in [lower, upper),
+// where a null bound leaves that side of the range open. It only supports
+// the forward iteration that BuildTable does.
+class FlushPartitionIterator : public InternalIterator {
+ public:
+  FlushPartitionIterator(InternalIterator* iter, const Comparator* ucmp,
+                         const std::string* lower, const std::string* upper)
+      : iter_(iter), ucmp_(ucmp), lower_(lower), upper_(upper) {}
+
+  virtual bool Valid() const override {
+    return iter_->Valid() &&
+           (upper_ == nullptr ||
+            ucmp_->Compare(ExtractUserKey(iter_->key()), *upper_) < 0);
+  }
+  virtual void SeekToFirst() override {
+    if (lower_ == nullptr) {
+      iter_->SeekToFirst();
+    } else {
+      InternalKey target(*lower_, kMaxSequenceNumber, kValueTypeForSeek);
+      iter_->Seek(target.Encode());
+    }
+  }
+  virtual void SeekToLast() override { assert(false); }
+  virtual void Seek(const Slice& /*target*/) override { assert(false); }
+  virtual void SeekForPrev(const Slice& /*target*/) override { assert(false); }
+  virtual void Next() override { iter_->Next(); }
+  virtual void Prev() override { assert(false); }
+  virtual Slice key() const override { return iter_->key(); }
+  virtual Slice value() const override { return iter_->value(); }
+  virtual Status status() const override { return iter_->status(); }
+  virtual void SetPinnedItersMgr(
+      PinnedIteratorsManager* pinned_iters_mgr) override {
+    iter_->SetPinnedItersMgr(pinned_iters_mgr);
+  }
+  virtual bool IsKeyPinned() const override { return iter_->IsKeyPinned(); }
+  virtual bool IsValuePinned() const override {
+    return iter_->IsValuePinned();
+  }
+
+ private:
+  InternalIterator* iter_;
+  const Comparator* ucmp_;
+  const std::string* lower_;
+  const std::string* upper_;
+};
+
+}  // namespace
+
 FlushJob::FlushJob(const std::string& dbname, ColumnFamilyData* cfd,
                    const ImmutableDBOptions& db_options,
                    const MutableCFOptions& mutable_cf_options,
@@ -327,6 +382,17 @@ Status FlushJob::WriteLevel0Table() {
         << total_memory_usage << "flush_reason"
         << GetFlushReasonString(cfd_->GetFlushReason());
 
+    std::vector<std::string> boundaries;
+    if (range_del_iters.empty()) {
+      PickPartitionBoundaries(total_memory_usage, &boundaries);
+    }
+    // Partition i > 0 of a partitioned flush is written to extra_metas_[i-1].
+    extra_metas_.resize(boundaries.size());
+    extra_table_properties_.resize(boundaries.size());
+    for (auto& meta : extra_metas_) {
+      meta.fd = FileDescriptor(versions_->NewFileNumber(), 0, 0);
+    }
+
     {
       ScopedArenaIterator iter(
           NewMergingIterator(&cfd_->internal_comparator(), &memtables[0],
@@ -335,6 +401,13 @@ Status FlushJob::WriteLevel0Table() {
                      "[%s] [JOB %d] Level-0 flush table #%" PRIu64 ": started",
                      cfd_->GetName().c_str(), job_context_->job_id,
                      meta_.fd.GetNumber());
+      if (!boundaries.empty()) {
+        ROCKS_LOG_INFO(db_options_.info_log,
+                       "[%s] [JOB %d] Flush split into %" ROCKSDB_PRIszt
+                       " partitions",
+                       cfd_->GetName().c_str(), job_context_->job_id,
+                       boundaries.size() + 1);
+      }
 
       TEST_SYNC_POINT_CALLBACK("FlushJob::WriteLevel0Table:output_compression",
                                &output_compression_);
@@ -353,18 +426,49 @@ Status FlushJob::WriteLevel0Table() {
       uint64_t oldest_key_time =
           mems_.front()->ApproximateOldestKeyTime();
 
-      s = BuildTable(
-          dbname_, db_options_.env, *cfd_->ioptions(), mutable_cf_options_,
-          env_options_, cfd_->table_cache(), iter.get(),
-          std::move(range_del_iters), &meta_, cfd_->internal_comparator(),
-          cfd_->int_tbl_prop_collector_factories(), cfd_->GetID(),
-          cfd_->GetName(), existing_snapshots_,
-          earliest_write_conflict_snapshot_, snapshot_checker_,
-          output_compression_, cfd_->ioptions()->compression_opts,
-          mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
-          TableFileCreationReason::kFlush, event_logger_, job_context_->job_id,
-          Env::IO_HIGH, &table_properties_, 0 /* level */, current_time,
-          oldest_key_time, write_hint);
+      // Like subcompactions, the partitions after the first are written by
+      // threads of their own, each with its own iterators.
+      const Comparator* ucmp = cfd_->user_comparator();
+      std::vector<Status> partition_status(boundaries.size());
+      std::vector<port::Thread> threads;
+      for (size_t i = 1; i <= boundaries.size(); i++) {
+        threads.emplace_back([&, i]() {
+          Arena partition_arena;
+          std::vector<InternalIterator*> partition_memtables;
+          for (MemTable* m : mems_) {
+            partition_memtables.push_back(m->NewIterator(ro, &partition_arena));
+          }
+          ScopedArenaIterator partition_iter(NewMergingIterator(
+              &cfd_->internal_comparator(), &partition_memtables[0],
+              static_cast<int>(partition_memtables.size()), &partition_arena));
+          FlushPartitionIterator bounded_iter(
+              partition_iter.get(), ucmp, &boundaries[i - 1],
+              i < boundaries.size() ? &boundaries[i] : nullptr);
+          partition_status[i - 1] = BuildOutputTable(
+              &bounded_iter, {}, &extra_metas_[i - 1],
+              &extra_table_properties_[i - 1], current_time, oldest_key_time,
+              write_hint);
+        });
+      }
+      if (boundaries.empty()) {
+        s = BuildOutputTable(iter.get(), std::move(range_del_iters), &meta_,
+                             &table_properties_, current_time, oldest_key_time,
+                             write_hint);
+      } else {
+        FlushPartitionIterator bounded_iter(iter.get(), ucmp, nullptr,
+                                            &boundaries[0]);
+        s = BuildOutputTable(&bounded_iter, std::move(range_del_iters), &meta_,
+                             &table_properties_, current_time, oldest_key_time,
+                             write_hint);
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      for (const Status& partition_s : partition_status) {
+        if (s.ok()) {
+          s = partition_s;
+        }
+      }
       LogFlush(db_options_.info_log);
     }
     ROCKS_LOG_INFO(db_options_.info_log,
@@ -375,6 +479,14 @@ Status FlushJob::WriteLevel0Table() {
                    meta_.fd.GetNumber(), meta_.fd.GetFileSize(),
                    s.ToString().c_str(),
                    meta_.marked_for_compaction ? " (needs compaction)" : "");
+    for (const FileMetaData& meta : extra_metas_) {
+      ROCKS_LOG_INFO(db_options_.info_log,
+                     "[%s] [JOB %d] Level-0 flush table #%" PRIu64 ": %" PRIu64
+                     " bytes%s",
+                     cfd_->GetName().c_str(), job_context_->job_id,
+                     meta.fd.GetNumber(), meta.fd.GetFileSize(),
+                     meta.marked_for_compaction ? " (needs compaction)" : "");
+    }
 
     if (s.ok() && output_file_directory_ != nullptr && sync_output_directory_) {
       s = output_file_directory_->Fsync();
@@ -397,17 +509,98 @@ Status FlushJob::WriteLevel0Table() {
                    meta_.fd.smallest_seqno, meta_.fd.largest_seqno,
                    meta_.marked_for_compaction);
   }
+  uint64_t bytes_written = meta_.fd.GetFileSize();
+
+  // The other files of a partitioned flush go to L0 in the same edit. Their
+  // key ranges do not overlap each other nor meta_.
+  size_t num_extra_files = 0;
+  for (size_t i = 0; i < extra_metas_.size(); i++) {
+    const FileMetaData& meta = extra_metas_[i];
+    if (!s.ok() || meta.fd.GetFileSize() == 0) {
+      continue;
+    }
+    edit_->AddFile(0 /* level */, meta.fd.GetNumber(), meta.fd.GetPathId(),
+                   meta.fd.GetFileSize(), meta.smallest, meta.largest,
+                   meta.fd.smallest_seqno, meta.fd.largest_seqno,
+                   meta.marked_for_compaction);
+    bytes_written += meta.fd.GetFileSize();
+    extra_metas_[num_extra_files] = meta;
+    extra_table_properties_[num_extra_files] = extra_table_properties_[i];
+    num_extra_files++;
+  }
+  extra_metas_.resize(num_extra_files);
+  extra_table_properties_.resize(num_extra_files);
 
   // Note that here we treat flush as level 0 compaction in internal stats
   InternalStats::CompactionStats stats(CompactionReason::kFlush, 1);
   stats.micros = db_options_.env->NowMicros() - start_micros;
-  stats.bytes_written = meta_.fd.GetFileSize();
+  stats.bytes_written = bytes_written;
   MeasureTime(stats_, FLUSH_TIME, stats.micros);
   cfd_->internal_stats()->AddCompactionStats(0 /* level */, stats);
   cfd_->internal_stats()->AddCFStats(InternalStats::BYTES_FLUSHED,
-                                     meta_.fd.GetFileSize());
+                                     bytes_written);
   RecordFlushIOStats();
   return s;
 }
 
+void FlushJob::PickPartitionBoundaries(size_t memory_usage,
+                                       std::vector<std::string>* boundaries) {
+  // Atomic flushes add their files to the LSM tree outside of the job, and
+  // the other compaction styles expect the seqno ranges of L0 files not to
+  // interleave.
+  if (db_options_.max_flush_partitions <= 1 || !write_manifest_ ||
+      cfd_->ioptions()->compaction_style != kCompactionStyleLevel) {
+    return;
+  }
+  size_t num_partitions =
+      std::min(static_cast<size_t>(db_options_.max_flush_partitions),
+               memory_usage / kMinFlushPartitionBytes);
+  if (num_partitions <= 1) {
+    return;
+  }
+  std::vector<std::string> samples;
+  for (MemTable* m : mems_) {
+    m->SampleUserKeys(num_partitions * kFlushSamplesPerPartition, &samples);
+  }
+  if (samples.empty()) {
+    return;
+  }
+  const Comparator* ucmp = cfd_->user_comparator();
+  std::sort(samples.begin(), samples.end(),
+            [ucmp](const std::string& a, const std::string& b) {
+              return ucmp->Compare(a, b) < 0;
+            });
+  // The boundaries are user keys and partitions are half-open ranges, so
+  // all the versions of a key go to the same file.
+  for (size_t i = 1; i < num_partitions; i++) {
+    const std::string& key = samples[i * samples.size() / num_partitions];
+    const std::string& prev =
+        boundaries->empty() ? samples[0] : boundaries->back();
+    if (ucmp->Compare(key, prev) > 0) {
+      boundaries->push_back(key);
+    }
+  }
+}
+
+Status FlushJob::BuildOutputTable(
+    InternalIterator* iter,
+    std::vector<std::unique_ptr<FragmentedRangeTombstoneIterator>>
+        range_del_iters,
+    FileMetaData* meta, TableProperties* table_properties,
+    uint64_t current_time, uint64_t oldest_key_time,
+    Env::WriteLifeTimeHint write_hint) {
+  return BuildTable(
+      dbname_, db_options_.env, *cfd_->ioptions(), mutable_cf_options_,
+      env_options_, cfd_->table_cache(), iter, std::move(range_del_iters),
+      meta, cfd_->internal_comparator(),
+      cfd_->int_tbl_prop_collector_factories(), cfd_->GetID(),
+      cfd_->GetName(), existing_snapshots_, earliest_write_conflict_snapshot_,
+      snapshot_checker_, output_compression_,
+      cfd_->ioptions()->compression_opts,
+      mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
+      TableFileCreationReason::kFlush, event_logger_, job_context_->job_id,
+      Env::IO_HIGH, table_properties, 0 /* level */, current_time,
+      oldest_key_time, write_hint);
+}
+
 }  // namespace rocksdb
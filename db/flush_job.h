@@ -79,6 +79,14 @@ class FlushJob {
              FileMetaData* file_meta = nullptr);
   void Cancel();
   TableProperties GetTableProperties() const { return table_properties_; }
+  // The files that a partitioned flush wrote besides the one returned by
+  // Run(), and their table properties.
+  const std::vector<FileMetaData>& GetExtraFileMetaData() const {
+    return extra_metas_;
+  }
+  const std::vector<TableProperties>& GetExtraTableProperties() const {
+    return extra_table_properties_;
+  }
   const autovector<MemTable*>& GetMemTables() const { return mems_; }
 
  private:
@@ -86,6 +94,18 @@ class FlushJob {
   void ReportFlushInputSize(const autovector<MemTable*>& mems);
   void RecordFlushIOStats();
   Status WriteLevel0Table();
+  // Picks the user keys at which a flush of memory_usage bytes of memtables
+  // is split into partitions, from keys sampled from the memtables. Leaves
+  // boundaries empty if the flush is not split.
+  void PickPartitionBoundaries(size_t memory_usage,
+                               std::vector<std::string>* boundaries);
+  Status BuildOutputTable(
+      InternalIterator* iter,
+      std::vector<std::unique_ptr<FragmentedRangeTombstoneIterator>>
+          range_del_iters,
+      FileMetaData* meta, TableProperties* table_properties,
+      uint64_t current_time, uint64_t oldest_key_time,
+      Env::WriteLifeTimeHint write_hint);
 
   const std::string& dbname_;
   ColumnFamilyData* cfd_;
@@ -133,6 +153,9 @@ class FlushJob {
 
   // Variables below are set by PickMemTable():
   FileMetaData meta_;
+  // Set by WriteLevel0Table() when the flush is partitioned.
+  std::vector<FileMetaData> extra_metas_;
+  std::vector<TableProperties> extra_table_properties_;
   autovector<MemTable*> mems_;
   VersionEdit* edit_;
   Version* base_;
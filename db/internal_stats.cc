@@ -19,8 +19,10 @@
 #include <utility>
 #include <vector>
 
+#include "cache/memory_budget.h"
 #include "db/column_family.h"
 #include "db/db_impl.h"
+#include "rocksdb/utilities/sim_cache.h"
 #include "table/block_based_table_factory.h"
 #include "util/string_util.h"
 
@@ -251,7 +253,12 @@ static const std::string estimate_oldest_key_time = "estimate-oldest-key-time";
 static const std::string block_cache_capacity = "block-cache-capacity";
 static const std::string block_cache_usage = "block-cache-usage";
 static const std::string block_cache_pinned_usage = "block-cache-pinned-usage";
+static const std::string block_cache_miss_ratio_curve =
+    "block-cache-miss-ratio-curve";
+static const std::string block_cache_quota = "block-cache-quota";
+static const std::string memory_budget = "memory-budget";
 static const std::string options_statistics = "options-statistics";
+static const std::string env_io_stats = "env-io-stats";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
     rocksdb_prefix + num_files_at_level_prefix;
@@ -337,8 +344,15 @@ const std::string DB::Properties::kBlockCacheUsage =
     rocksdb_prefix + block_cache_usage;
 const std::string DB::Properties::kBlockCachePinnedUsage =
     rocksdb_prefix + block_cache_pinned_usage;
+const std::string DB::Properties::kBlockCacheMissRatioCurve =
+    rocksdb_prefix + block_cache_miss_ratio_curve;
+const std::string DB::Properties::kBlockCacheQuota =
+    rocksdb_prefix + block_cache_quota;
+const std::string DB::Properties::kMemoryBudget =
+    rocksdb_prefix + memory_budget;
 const std::string DB::Properties::kOptionsStatistics =
     rocksdb_prefix + options_statistics;
+const std::string DB::Properties::kEnvIOStats = rocksdb_prefix + env_io_stats;
 
 const std::unordered_map<std::string, DBPropertyInfo>
     InternalStats::ppt_name_to_info = {
@@ -472,9 +486,21 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kBlockCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlockCachePinnedUsage, nullptr,
           nullptr}},
+        {DB::Properties::kBlockCacheMissRatioCurve,
+         {false, &InternalStats::HandleBlockCacheMissRatioCurve, nullptr,
+          &InternalStats::HandleBlockCacheMissRatioCurveMap, nullptr}},
+        {DB::Properties::kBlockCacheQuota,
+         {false, &InternalStats::HandleBlockCacheQuota, nullptr,
+          &InternalStats::HandleBlockCacheQuotaMap, nullptr}},
+        {DB::Properties::kMemoryBudget,
+         {false, &InternalStats::HandleMemoryBudget, nullptr,
+          &InternalStats::HandleMemoryBudgetMap, nullptr}},
         {DB::Properties::kOptionsStatistics,
          {false, nullptr, nullptr, nullptr,
           &DBImpl::GetPropertyHandleOptionsStatistics}},
+        {DB::Properties::kEnvIOStats,
+         {false, nullptr, nullptr, nullptr,
+          &DBImpl::GetPropertyHandleEnvIOStats}},
 };
 
 const DBPropertyInfo* GetPropertyInfo(const Slice& property) {
@@ -939,6 +965,162 @@ bool InternalStats::HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* /*db*/,
   return true;
 }
 
+bool InternalStats::HandleBlockCacheMissRatioCurve(std::string* value,
+                                                   Slice /*suffix*/) {
+  std::vector<std::pair<size_t, double>> curve;
+  if (!GetBlockCacheMissRatioCurve(&curve)) {
+    return false;
+  }
+  char buf[64];
+  value->clear();
+  for (const auto& point : curve) {
+    snprintf(buf, sizeof(buf), "%" ROCKSDB_PRIszt " %.4f\n", point.first,
+             point.second);
+    value->append(buf);
+  }
+  return true;
+}
+
+bool InternalStats::HandleBlockCacheMissRatioCurveMap(
+    std::map<std::string, std::string>* value) {
+  std::vector<std::pair<size_t, double>> curve;
+  if (!GetBlockCacheMissRatioCurve(&curve)) {
+    return false;
+  }
+  char buf[32];
+  for (const auto& point : curve) {
+    snprintf(buf, sizeof(buf), "%.4f", point.second);
+    (*value)[ToString(point.first)] = buf;
+  }
+  return true;
+}
+
+bool InternalStats::GetBlockCacheMissRatioCurve(
+    std::vector<std::pair<size_t, double>>* curve) {
+  Cache* block_cache;
+  bool ok = HandleBlockCacheStat(&block_cache);
+  if (!ok || strcmp(block_cache->Name(), "SimCache") != 0) {
+    return false;
+  }
+  auto* sim_cache = static_cast<SimCache*>(block_cache);
+  // From an eighth to eight times the capacity in use.
+  static const double kCapacityRatios[] = {0.125, 0.25, 0.5, 0.75, 1.0,
+                                           1.25,  1.5,  2.0, 4.0,  8.0};
+  size_t capacity = sim_cache->GetCapacity();
+  for (double ratio : kCapacityRatios) {
+    size_t point = static_cast<size_t>(capacity * ratio);
+    curve->emplace_back(point, sim_cache->GetEstimatedMissRatio(point));
+  }
+  return true;
+}
+
+namespace {
+// Suffixes of the quota groups of a column family, see
+// BlockBasedTableOptions::block_cache_quota_group.
+const char* const kBlockCacheQuotaGroupSuffixes[] = {"", "index", "filter",
+                                                     "data"};
+}  // namespace
+
+bool InternalStats::GetBlockCacheQuotaGroup(Cache** block_cache,
+                                            std::string* group) {
+  if (!HandleBlockCacheStat(block_cache)) {
+    return false;
+  }
+  auto* table_options = reinterpret_cast<BlockBasedTableOptions*>(
+      cfd_->ioptions()->table_factory->GetOptions());
+  *group = table_options->block_cache_quota_group;
+  return !group->empty();
+}
+
+bool InternalStats::HandleBlockCacheQuota(std::string* value,
+                                          Slice /*suffix*/) {
+  Cache* block_cache;
+  std::string group;
+  if (!GetBlockCacheQuotaGroup(&block_cache, &group)) {
+    return false;
+  }
+  char buf[200];
+  value->clear();
+  for (const char* suffix : kBlockCacheQuotaGroupSuffixes) {
+    std::string name = *suffix == '\0' ? group : group + "." + suffix;
+    CacheQuota quota;
+    size_t usage = 0;
+    if (!block_cache->GetQuota(name, &quota, &usage)) {
+      continue;
+    }
+    snprintf(buf, sizeof(buf),
+             "%s usage: %" ROCKSDB_PRIszt " reservation: %" ROCKSDB_PRIszt
+             " limit: %" ROCKSDB_PRIszt "\n",
+             name.c_str(), usage, quota.reservation, quota.limit);
+    value->append(buf);
+  }
+  return true;
+}
+
+bool InternalStats::HandleBlockCacheQuotaMap(
+    std::map<std::string, std::string>* value) {
+  Cache* block_cache;
+  std::string group;
+  if (!GetBlockCacheQuotaGroup(&block_cache, &group)) {
+    return false;
+  }
+  for (const char* suffix : kBlockCacheQuotaGroupSuffixes) {
+    std::string name = group;
+    std::string prefix;
+    if (*suffix != '\0') {
+      name.append(".").append(suffix);
+      prefix.append(suffix).append(".");
+    }
+    CacheQuota quota;
+    size_t usage = 0;
+    if (!block_cache->GetQuota(name, &quota, &usage)) {
+      continue;
+    }
+    (*value)[prefix + "usage"] = ToString(usage);
+    (*value)[prefix + "reservation"] = ToString(quota.reservation);
+    (*value)[prefix + "limit"] = ToString(quota.limit);
+  }
+  return true;
+}
+
+bool InternalStats::HandleMemoryBudget(std::string* value, Slice /*suffix*/) {
+  std::map<std::string, std::string> budget;
+  if (!HandleMemoryBudgetMap(&budget)) {
+    return false;
+  }
+  value->clear();
+  for (const auto& entry : budget) {
+    value->append(entry.first).append(": ").append(entry.second).append("\n");
+  }
+  return true;
+}
+
+bool InternalStats::HandleMemoryBudgetMap(
+    std::map<std::string, std::string>* value) {
+  MemoryBudget* budget = cfd_->ioptions()->memory_budget.get();
+  if (budget == nullptr) {
+    return false;
+  }
+  // Memtables are charged by the WriteBufferManager, which only tracks them
+  // when it costs them to a cache.
+  WriteBufferManager* write_buffer_manager = cfd_->write_buffer_mgr();
+  uint64_t memtables = 0;
+  if (write_buffer_manager != nullptr &&
+      write_buffer_manager->cost_to_cache()) {
+    memtables = write_buffer_manager->memory_usage();
+  }
+  (*value)["memtables"] = ToString(memtables);
+  for (int i = 0; i < MemoryBudget::kNumCategories; i++) {
+    auto category = static_cast<MemoryBudget::Category>(i);
+    (*value)[MemoryBudget::CategoryName(category)] =
+        ToString(budget->GetUsage(category));
+  }
+  (*value)["reserved"] = ToString(budget->GetReserved());
+  (*value)["cache-capacity"] = ToString(budget->cache()->GetCapacity());
+  (*value)["cache-usage"] = ToString(budget->cache()->GetUsage());
+  return true;
+}
+
 void InternalStats::DumpDBStats(std::string* value) {
   char buf[1000];
   // DB-level stats, only available from default column family
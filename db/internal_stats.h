@@ -380,6 +380,13 @@ class InternalStats {
   void DumpCFFileHistogram(std::string* value);
 
   bool HandleBlockCacheStat(Cache** block_cache);
+  // Estimated miss ratios of the block cache for a range of capacities,
+  // if it is a SimCache.
+  bool GetBlockCacheMissRatioCurve(
+      std::vector<std::pair<size_t, double>>* curve);
+  // The block cache and the name of the quota group the tables of the column
+  // family are charged to, if any.
+  bool GetBlockCacheQuotaGroup(Cache** block_cache, std::string* group);
 
   // Per-DB stats
   std::atomic<uint64_t> db_stats_[INTERNAL_DB_STATS_ENUM_MAX];
@@ -544,6 +551,13 @@ class InternalStats {
   bool HandleBlockCacheUsage(uint64_t* value, DBImpl* db, Version* version);
   bool HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* db,
                                    Version* version);
+  bool HandleBlockCacheMissRatioCurve(std::string* value, Slice suffix);
+  bool HandleBlockCacheMissRatioCurveMap(
+      std::map<std::string, std::string>* value);
+  bool HandleBlockCacheQuota(std::string* value, Slice suffix);
+  bool HandleBlockCacheQuotaMap(std::map<std::string, std::string>* value);
+  bool HandleMemoryBudget(std::string* value, Slice suffix);
+  bool HandleMemoryBudgetMap(std::map<std::string, std::string>* value);
   // Total number of background errors encountered. Every time a flush task
   // or compaction task fails, this counter is incremented. The failure can
   // be caused by any possible reason, including file system errors, out of
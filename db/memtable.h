@@ -40,6 +40,7 @@ struct ImmutableMemTableOptions {
                                     const MutableCFOptions& mutable_cf_options);
   size_t arena_block_size;
   uint32_t memtable_prefix_bloom_bits;
+  bool memtable_whole_key_filtering;
   size_t memtable_huge_page_size;
   bool inplace_update_support;
   size_t inplace_update_num_locks;
@@ -84,6 +85,9 @@ class MemTable {
                            const char* prefix_len_key2) const override;
     virtual int operator()(const char* prefix_len_key,
                            const DecodedType& key) const override;
+    virtual const Comparator* user_comparator() const override {
+      return comparator.user_comparator();
+    }
   };
 
   // MemTables are reference counted.  The initial reference count
@@ -267,10 +271,10 @@ class MemTable {
 
   // Dynamically change the memtable's capacity. If set below the current usage,
   // the next key added will trigger a flush. Can only increase size when
-  // memtable prefix bloom is disabled, since we can't easily allocate more
+  // memtable bloom is disabled, since we can't easily allocate more
   // space.
   void UpdateWriteBufferSize(size_t new_write_buffer_size) {
-    if (prefix_bloom_ == nullptr ||
+    if (bloom_filter_ == nullptr ||
         new_write_buffer_size < write_buffer_size_) {
       write_buffer_size_.store(new_write_buffer_size,
                                std::memory_order_relaxed);
@@ -366,6 +370,11 @@ class MemTable {
   MemTableStats ApproximateStats(const Slice& start_ikey,
                                  const Slice& end_ikey);
 
+  // Appends about count user keys, spread evenly over the memtable, to keys
+  // in order. Appends none if the memtable representation cannot sample its
+  // entries without reading all of them.
+  void SampleUserKeys(size_t count, std::vector<std::string>* keys) const;
+
   // Get the lock associated for the key
   port::RWMutex* GetLock(const Slice& key);
 
@@ -448,7 +457,9 @@ class MemTable {
   std::vector<port::RWMutex> locks_;
 
   const SliceTransform* const prefix_extractor_;
-  std::unique_ptr<DynamicBloom> prefix_bloom_;
+  // Holds the prefixes of the keys if prefix_extractor_ is set, and the
+  // whole user keys if moptions_.memtable_whole_key_filtering is.
+  std::unique_ptr<DynamicBloom> bloom_filter_;
 
   std::atomic<FlushStateEnum> flush_state_;
 
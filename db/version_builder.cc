@@ -162,6 +162,17 @@ class VersionBuilder::Rep {
             abort();
           }
 
+          // The seqno ranges of L0 files whose key ranges do not overlap,
+          // such as the files of a partitioned flush, may interleave.
+          const Comparator* ucmp =
+              vstorage->InternalComparator()->user_comparator();
+          if (ucmp->Compare(f1->largest.user_key(), f2->smallest.user_key()) <
+                  0 ||
+              ucmp->Compare(f2->largest.user_key(), f1->smallest.user_key()) <
+                  0) {
+            continue;
+          }
+
           if (f2->fd.smallest_seqno == f2->fd.largest_seqno) {
             // This is an external file that we ingested
             SequenceNumber external_file_seqno = f2->fd.smallest_seqno;
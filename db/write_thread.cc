@@ -595,9 +595,9 @@ void WriteThread::ExitAsBatchGroupFollower(Writer* w) {
   auto* write_group = w->write_group;
 
   assert(w->state == STATE_PARALLEL_MEMTABLE_WRITER);
-  assert(write_group->status.ok());
+  // Not ok if the background WAL sync of the group failed.
   ExitAsBatchGroupLeader(*write_group, write_group->status);
-  assert(w->status.ok());
+  assert(w->status == write_group->status);
   assert(w->state == STATE_COMPLETED);
   SetState(write_group->leader, STATE_COMPLETED);
 }
@@ -246,6 +246,48 @@ TEST_P(EnvBasicTestWithParam, ReadWrite) {
   ASSERT_TRUE(rand_file->Read(1000, 5, &result, scratch).ok());
 }
 
+TEST_P(EnvBasicTestWithParam, MultiRead) {
+  const size_t kFileSize = 64 * 1024;
+  std::string data;
+  for (size_t i = 0; i < kFileSize; ++i) {
+    data.push_back(static_cast<char>('a' + (i * 7) % 26));
+  }
+  std::unique_ptr<WritableFile> writable_file;
+  ASSERT_OK(env_->NewWritableFile(test_dir_ + "/f", &writable_file, soptions_));
+  ASSERT_OK(writable_file->Append(data));
+  ASSERT_OK(writable_file->Close());
+  writable_file.reset();
+
+  std::unique_ptr<RandomAccessFile> rand_file;
+  ASSERT_OK(env_->NewRandomAccessFile(test_dir_ + "/f", &rand_file, soptions_));
+
+  // More requests than an env is likely to serve at once, issued from the
+  // end of the file backwards. The last one starts past the end.
+  const size_t kNumReqs = 32;
+  const size_t kLen = 1000;
+  std::vector<std::unique_ptr<char[]>> scratches;
+  ReadRequest reqs[kNumReqs];
+  for (size_t i = 0; i < kNumReqs; ++i) {
+    scratches.emplace_back(new char[kLen]);
+    reqs[i].offset = kFileSize - 500 - i * 2000;
+    reqs[i].len = kLen;
+    reqs[i].scratch = scratches.back().get();
+  }
+  reqs[kNumReqs - 1].offset = kFileSize + 100;
+  ASSERT_OK(rand_file->MultiRead(reqs, kNumReqs));
+
+  for (size_t i = 0; i < kNumReqs; ++i) {
+    ASSERT_OK(reqs[i].status);
+    if (reqs[i].offset >= kFileSize) {
+      ASSERT_EQ(0U, reqs[i].result.size());
+      continue;
+    }
+    size_t offset = static_cast<size_t>(reqs[i].offset);
+    size_t expected_len = std::min(kLen, kFileSize - offset);
+    ASSERT_EQ(Slice(data.data() + offset, expected_len), reqs[i].result);
+  }
+}
+
 TEST_P(EnvBasicTestWithParam, Misc) {
   std::unique_ptr<WritableFile> writable_file;
   ASSERT_OK(env_->NewWritableFile(test_dir_ + "/b", &writable_file, soptions_));
@@ -0,0 +1,443 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#if !defined(ROCKSDB_LITE) && !defined(OS_WIN)
+
+#include "env/env_local_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/status.h"
+#include "rocksdb/threadpool.h"
+#include "util/coding.h"
+#include "util/filename.h"
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Size of the reads and writes used to copy a file into the cache.
+const size_t kFillBufferSize = 1024 * 1024;
+
+// Longest unique ID kept for a cached copy. Enough for the IDs of the
+// built-in envs, which the block cache uses as key prefixes.
+const size_t kMaxUniqueIdSize = kMaxVarint64Length * 3 + 1;
+
+// A table file known to the cache. Entries are shared with the files opened
+// on them so that open handles notice when the local copy becomes usable.
+struct CacheEntry {
+  CacheEntry(const std::string& _fname, const std::string& _local_path)
+      : fname(_fname),
+        local_path(_local_path),
+        size(0),
+        filling(true),
+        dropped(false),
+        lru_stamp(0),
+        ready(false),
+        last_access(0) {}
+
+  // Path in the base env.
+  const std::string fname;
+  const std::string local_path;
+  // Unique ID of the file in the base env. Set before ready is and not
+  // changed afterwards.
+  std::string unique_id;
+  // The fields below are protected by LocalCacheEnv::mutex_.
+  uint64_t size;
+  bool filling;
+  // Removed from the cache while the copy was in flight.
+  bool dropped;
+  // Position in LocalCacheEnv::lru_ while ready, and the value of
+  // last_access when the entry was put there.
+  std::list<std::shared_ptr<CacheEntry>>::iterator lru_pos;
+  uint64_t lru_stamp;
+
+  // True once the local copy is complete and until it is evicted.
+  std::atomic<bool> ready;
+  // NowMicros() of the local env at the last read, for LRU eviction.
+  std::atomic<uint64_t> last_access;
+};
+
+class LocalCacheRandomAccessFile : public RandomAccessFile {
+ public:
+  LocalCacheRandomAccessFile(std::unique_ptr<RandomAccessFile>&& remote,
+                             std::unique_ptr<RandomAccessFile>&& local,
+                             std::shared_ptr<CacheEntry> entry, Env* local_env)
+      : remote_(std::move(remote)),
+        local_(std::move(local)),
+        local_opened_(local_ != nullptr),
+        entry_(std::move(entry)),
+        local_env_(local_env) {
+    assert(remote_ != nullptr || local_ != nullptr);
+  }
+
+  virtual Status Read(uint64_t offset, size_t n, Slice* result,
+                      char* scratch) const override {
+    return Current()->Read(offset, n, result, scratch);
+  }
+
+  virtual Status MultiRead(ReadRequest* reqs, size_t num_reqs) override {
+    return Current()->MultiRead(reqs, num_reqs);
+  }
+
+  virtual Status Prefetch(uint64_t offset, size_t n) override {
+    return Current()->Prefetch(offset, n);
+  }
+
+  // The local copy has a different identity than the remote file and may be
+  // evicted and replaced at any time, so only the remote ID is stable. When
+  // the file was opened on the local copy, the ID recorded by the fill is
+  // used instead.
+  virtual size_t GetUniqueId(char* id, size_t max_size) const override {
+    if (remote_ != nullptr) {
+      return remote_->GetUniqueId(id, max_size);
+    }
+    const std::string& unique_id = entry_->unique_id;
+    if (unique_id.empty() || unique_id.size() > max_size) {
+      return 0;
+    }
+    memcpy(id, unique_id.data(), unique_id.size());
+    return unique_id.size();
+  }
+
+  virtual void Hint(AccessPattern pattern) override {
+    Current()->Hint(pattern);
+  }
+
+ private:
+  RandomAccessFile* Current() const {
+    // Only stores when the stamp is stale, so that concurrent readers of a
+    // file don't keep bouncing its cache line.
+    uint64_t now = local_env_->NowMicros();
+    if (entry_->last_access.load(std::memory_order_relaxed) < now) {
+      entry_->last_access.store(now, std::memory_order_relaxed);
+    }
+    if (local_opened_.load(std::memory_order_acquire)) {
+      return local_.get();
+    }
+    if (entry_->ready.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!local_opened_.load(std::memory_order_relaxed) && !local_failed_) {
+        EnvOptions local_options;
+        local_options.use_mmap_reads = false;
+        Status s = local_env_->NewRandomAccessFile(entry_->local_path, &local_,
+                                                   local_options);
+        if (s.ok()) {
+          local_opened_.store(true, std::memory_order_release);
+          return local_.get();
+        }
+        // Evicted in the meantime, keep reading remotely.
+        local_failed_ = true;
+      } else if (local_opened_.load(std::memory_order_relaxed)) {
+        return local_.get();
+      }
+    }
+    return remote_.get();
+  }
+
+  std::unique_ptr<RandomAccessFile> remote_;
+  mutable std::unique_ptr<RandomAccessFile> local_;
+  mutable std::atomic<bool> local_opened_;
+  mutable bool local_failed_ = false;
+  mutable std::mutex mutex_;
+  std::shared_ptr<CacheEntry> entry_;
+  Env* local_env_;
+};
+
+bool IsTableFile(const std::string& fname) {
+  size_t slash = fname.find_last_of('/');
+  std::string base =
+      (slash == std::string::npos) ? fname : fname.substr(slash + 1);
+  uint64_t number;
+  FileType type;
+  return ParseFileName(base, &number, &type) && type == kTableFile;
+}
+
+}  // namespace
+
+class LocalCacheEnv : public EnvWrapper {
+ public:
+  LocalCacheEnv(Env* base_env, const LocalCacheEnvOptions& options)
+      : EnvWrapper(base_env),
+        local_dir_(options.local_dir),
+        capacity_(options.capacity),
+        local_env_(options.local_env != nullptr ? options.local_env
+                                                : Env::Default()),
+        usage_(0),
+        fill_pool_(NewThreadPool(options.fill_threads)) {
+    // Leftovers of a previous instance may be stale, start from scratch.
+    local_env_->CreateDirIfMissing(local_dir_);
+    std::vector<std::string> children;
+    if (local_env_->GetChildren(local_dir_, &children).ok()) {
+      for (const auto& child : children) {
+        if (child != "." && child != "..") {
+          local_env_->DeleteFile(local_dir_ + "/" + child);
+        }
+      }
+    }
+  }
+
+  ~LocalCacheEnv() {
+    // Drops queued copies and waits for the running ones.
+    fill_pool_->JoinAllThreads();
+  }
+
+  virtual Status NewRandomAccessFile(const std::string& fname,
+                                     std::unique_ptr<RandomAccessFile>* result,
+                                     const EnvOptions& options) override {
+    if (capacity_ == 0 || !IsTableFile(fname)) {
+      return EnvWrapper::NewRandomAccessFile(fname, result, options);
+    }
+
+    std::shared_ptr<CacheEntry> entry;
+    bool start_fill = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = files_.find(fname);
+      if (it == files_.end()) {
+        entry = std::make_shared<CacheEntry>(fname, LocalPath(fname));
+        files_[fname] = entry;
+        start_fill = true;
+      } else {
+        entry = it->second;
+      }
+    }
+    if (start_fill) {
+      fill_pool_->SubmitJob([this, fname, entry]() { Fill(fname, entry); });
+    }
+
+    std::unique_ptr<RandomAccessFile> local;
+    if (entry->ready.load(std::memory_order_acquire)) {
+      EnvOptions local_options;
+      local_options.use_mmap_reads = false;
+      if (!local_env_->NewRandomAccessFile(entry->local_path, &local,
+                                           local_options)
+               .ok()) {
+        local.reset();
+      }
+    }
+    std::unique_ptr<RandomAccessFile> remote;
+    if (local == nullptr) {
+      Status s = EnvWrapper::NewRandomAccessFile(fname, &remote, options);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    result->reset(new LocalCacheRandomAccessFile(
+        std::move(remote), std::move(local), entry, local_env_));
+    return Status::OK();
+  }
+
+  virtual Status NewWritableFile(const std::string& fname,
+                                 std::unique_ptr<WritableFile>* result,
+                                 const EnvOptions& options) override {
+    Drop(fname);
+    return EnvWrapper::NewWritableFile(fname, result, options);
+  }
+
+  virtual Status ReuseWritableFile(const std::string& fname,
+                                   const std::string& old_fname,
+                                   std::unique_ptr<WritableFile>* result,
+                                   const EnvOptions& options) override {
+    Drop(fname);
+    Drop(old_fname);
+    return EnvWrapper::ReuseWritableFile(fname, old_fname, result, options);
+  }
+
+  virtual Status DeleteFile(const std::string& fname) override {
+    Drop(fname);
+    return EnvWrapper::DeleteFile(fname);
+  }
+
+  virtual Status RenameFile(const std::string& src,
+                            const std::string& target) override {
+    Drop(src);
+    Drop(target);
+    return EnvWrapper::RenameFile(src, target);
+  }
+
+ private:
+  std::string LocalPath(const std::string& fname) const {
+    size_t slash = fname.find_last_of('/');
+    std::string base =
+        (slash == std::string::npos) ? fname : fname.substr(slash + 1);
+    // Table files of different DBs share names, so qualify them with a hash
+    // of the full path.
+    return local_dir_ + "/" + ToString(std::hash<std::string>()(fname)) + "_" +
+           base;
+  }
+
+  // Copies fname into the cache. Runs on fill_pool_.
+  void Fill(const std::string& fname, std::shared_ptr<CacheEntry> entry) {
+    uint64_t size = 0;
+    Status s = EnvWrapper::GetFileSize(fname, &size);
+    if (s.ok()) {
+      s = Reserve(entry, size);
+    }
+    const std::string tmp_path = entry->local_path + ".tmp";
+    if (s.ok()) {
+      s = CopyToLocal(fname, tmp_path, size, &entry->unique_id);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry->filling = false;
+    if (s.ok() && !entry->dropped) {
+      // Publish under the lock so the copy is never visible without being
+      // ready.
+      s = local_env_->RenameFile(tmp_path, entry->local_path);
+    }
+    if (s.ok() && !entry->dropped) {
+      entry->lru_stamp = local_env_->NowMicros();
+      entry->last_access.store(entry->lru_stamp, std::memory_order_relaxed);
+      entry->lru_pos = lru_.insert(lru_.end(), entry);
+      entry->ready.store(true, std::memory_order_release);
+      return;
+    }
+    // Failed or no longer wanted: release the space and forget the entry so
+    // a later open can try again.
+    usage_ -= entry->size;
+    entry->size = 0;
+    local_env_->DeleteFile(tmp_path);
+    auto it = files_.find(fname);
+    if (it != files_.end() && it->second == entry) {
+      files_.erase(it);
+    }
+  }
+
+  // Makes room for size more bytes by evicting the least recently read
+  // copies, and charges them to entry.
+  //
+  // Reads only stamp last_access, so lru_ is ordered by the stamp each entry
+  // had when it was queued. An entry at the front that was read since then
+  // is requeued at the back instead of being evicted.
+  Status Reserve(const std::shared_ptr<CacheEntry>& entry, uint64_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size > capacity_) {
+      return Status::NoSpace("file larger than local cache");
+    }
+    // Bounds the requeues when every copy keeps being read.
+    size_t requeues_left = lru_.size();
+    while (usage_ + size > capacity_) {
+      if (lru_.empty()) {
+        // Everything else is still being copied.
+        return Status::NoSpace("local cache is full");
+      }
+      std::shared_ptr<CacheEntry> victim = lru_.front();
+      uint64_t last_access =
+          victim->last_access.load(std::memory_order_relaxed);
+      if (last_access != victim->lru_stamp && requeues_left > 0) {
+        requeues_left--;
+        victim->lru_stamp = last_access;
+        lru_.splice(lru_.end(), lru_, victim->lru_pos);
+        continue;
+      }
+      EvictLocked(victim);
+      files_.erase(victim->fname);
+    }
+    usage_ += size;
+    entry->size = size;
+    return Status::OK();
+  }
+
+  Status CopyToLocal(const std::string& fname, const std::string& tmp_path,
+                     uint64_t size, std::string* unique_id) {
+    EnvOptions remote_options;
+    remote_options.compaction_readahead_size = kFillBufferSize;
+    std::unique_ptr<RandomAccessFile> src;
+    Status s = EnvWrapper::NewRandomAccessFile(fname, &src, remote_options);
+    if (!s.ok()) {
+      return s;
+    }
+    char id[kMaxUniqueIdSize];
+    unique_id->assign(id, src->GetUniqueId(id, sizeof(id)));
+    EnvOptions local_options;
+    local_options.use_mmap_writes = false;
+    std::unique_ptr<WritableFile> dst;
+    s = local_env_->NewWritableFile(tmp_path, &dst, local_options);
+    if (!s.ok()) {
+      return s;
+    }
+    std::unique_ptr<char[]> buffer(new char[kFillBufferSize]);
+    uint64_t offset = 0;
+    while (s.ok() && offset < size) {
+      size_t n = static_cast<size_t>(
+          std::min<uint64_t>(kFillBufferSize, size - offset));
+      Slice data;
+      s = src->Read(offset, n, &data, buffer.get());
+      if (s.ok() && data.size() != n) {
+        s = Status::Corruption("file shorter than expected", fname);
+      }
+      if (s.ok()) {
+        s = dst->Append(data);
+      }
+      offset += n;
+    }
+    if (s.ok()) {
+      s = dst->Close();
+    }
+    return s;
+  }
+
+  // Forgets fname, which is about to change or disappear in the base env.
+  void Drop(const std::string& fname) {
+    if (capacity_ == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(fname);
+    if (it == files_.end()) {
+      return;
+    }
+    if (it->second->filling) {
+      // Fill() cleans up once the copy is done.
+      it->second->dropped = true;
+    } else {
+      EvictLocked(it->second);
+    }
+    files_.erase(it);
+  }
+
+  // REQUIRES: mutex_ held and entry not filling.
+  void EvictLocked(const std::shared_ptr<CacheEntry>& entry) {
+    if (entry->ready.load(std::memory_order_relaxed)) {
+      lru_.erase(entry->lru_pos);
+    }
+    entry->ready.store(false, std::memory_order_release);
+    usage_ -= entry->size;
+    entry->size = 0;
+    // Handles that already opened the copy keep reading from it.
+    local_env_->DeleteFile(entry->local_path);
+  }
+
+  const std::string local_dir_;
+  const uint64_t capacity_;
+  Env* local_env_;
+
+  std::mutex mutex_;
+  // Keyed by path in the base env.
+  std::unordered_map<std::string, std::shared_ptr<CacheEntry>> files_;
+  // Entries whose copy is ready, least recently read first.
+  std::list<std::shared_ptr<CacheEntry>> lru_;
+  uint64_t usage_;
+
+  std::unique_ptr<ThreadPool> fill_pool_;
+};
+
+Env* NewLocalCacheEnv(Env* base_env, const LocalCacheEnvOptions& options) {
+  return new LocalCacheEnv(base_env, options);
+}
+
+}  // namespace rocksdb
+
+#endif  // !defined(ROCKSDB_LITE) && !defined(OS_WIN)
@@ -0,0 +1,42 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#if !defined(ROCKSDB_LITE) && !defined(OS_WIN)
+
+#include <string>
+
+#include "rocksdb/env.h"
+
+namespace rocksdb {
+
+struct LocalCacheEnvOptions {
+  // Directory on local storage that holds the cached copies. The cache owns
+  // its contents; whatever is left there is removed when the env is created.
+  std::string local_dir;
+
+  // Upper bound on the total size of the cached copies, in bytes.
+  uint64_t capacity = 0;
+
+  // Env used to access local_dir. nullptr means Env::Default().
+  Env* local_env = nullptr;
+
+  // Number of threads copying files into the cache.
+  int fill_threads = 1;
+};
+
+// Returns an Env that keeps local copies of the table files it reads from
+// base_env. The first time a table file is opened for random access, a
+// background thread copies it into options.local_dir; once the copy is
+// complete, reads of that file (including through already open handles) are
+// served locally. When the cache is full, the copies that were read least
+// recently are evicted. Writes, deletes and all other files go to base_env
+// only, so durability is that of base_env.
+Env* NewLocalCacheEnv(Env* base_env, const LocalCacheEnvOptions& options);
+
+}  // namespace rocksdb
+
+#endif  // !defined(ROCKSDB_LITE) && !defined(OS_WIN)
@@ -0,0 +1,251 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#if !defined(ROCKSDB_LITE) && !defined(OS_WIN)
+
+#include "env/env_local_cache.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "env/mock_env.h"
+#include "util/testharness.h"
+#include "util/testutil.h"
+
+namespace rocksdb {
+
+// Counts the reads that reach the remote env. Its files have the hash of
+// their name as unique ID.
+class ReadCountingEnv : public EnvWrapper {
+ public:
+  explicit ReadCountingEnv(Env* target) : EnvWrapper(target), reads_(0) {}
+
+  Status NewRandomAccessFile(const std::string& fname,
+                             std::unique_ptr<RandomAccessFile>* result,
+                             const EnvOptions& options) override {
+    class CountingFile : public RandomAccessFile {
+     public:
+      CountingFile(std::unique_ptr<RandomAccessFile>&& target,
+                   std::atomic<int>* reads, uint64_t id)
+          : target_(std::move(target)), reads_(reads), id_(id) {}
+      Status Read(uint64_t offset, size_t n, Slice* result,
+                  char* scratch) const override {
+        reads_->fetch_add(1);
+        return target_->Read(offset, n, result, scratch);
+      }
+      size_t GetUniqueId(char* id, size_t max_size) const override {
+        if (max_size < sizeof(id_)) {
+          return 0;
+        }
+        memcpy(id, &id_, sizeof(id_));
+        return sizeof(id_);
+      }
+
+     private:
+      std::unique_ptr<RandomAccessFile> target_;
+      std::atomic<int>* reads_;
+      uint64_t id_;
+    };
+
+    Status s = target()->NewRandomAccessFile(fname, result, options);
+    if (s.ok()) {
+      result->reset(new CountingFile(std::move(*result), &reads_,
+                                     std::hash<std::string>()(fname)));
+    }
+    return s;
+  }
+
+  int reads() const { return reads_.load(); }
+
+ private:
+  std::atomic<int> reads_;
+};
+
+class LocalCacheEnvTest : public testing::Test {
+ public:
+  static const size_t kFileSize = 100 * 1024;
+
+  LocalCacheEnvTest()
+      : remote_mock_(new MockEnv(Env::Default())),
+        remote_(new ReadCountingEnv(remote_mock_.get())),
+        local_(new MockEnv(Env::Default())) {
+    EXPECT_OK(remote_->CreateDir("/db"));
+  }
+
+  void Open(uint64_t capacity) {
+    LocalCacheEnvOptions options;
+    options.local_dir = "/cache";
+    options.capacity = capacity;
+    options.local_env = local_.get();
+    env_.reset(NewLocalCacheEnv(remote_.get(), options));
+  }
+
+  std::string WriteFile(const std::string& fname) {
+    Random rnd(static_cast<uint32_t>(std::hash<std::string>()(fname)));
+    std::string data;
+    test::RandomString(&rnd, static_cast<int>(kFileSize), &data);
+    std::unique_ptr<WritableFile> file;
+    EXPECT_OK(env_->NewWritableFile(fname, &file, soptions_));
+    EXPECT_OK(file->Append(data));
+    EXPECT_OK(file->Close());
+    return data;
+  }
+
+  std::string ReadAll(RandomAccessFile* file) {
+    std::unique_ptr<char[]> scratch(new char[kFileSize]);
+    Slice result;
+    EXPECT_OK(file->Read(0, kFileSize, &result, scratch.get()));
+    return result.ToString();
+  }
+
+  // Names of the local copies, without the path hash prefix.
+  std::vector<std::string> CachedFiles() {
+    std::vector<std::string> children;
+    std::vector<std::string> result;
+    local_->GetChildren("/cache", &children);
+    for (const auto& child : children) {
+      size_t sep = child.find('_');
+      if (sep != std::string::npos &&
+          child.compare(child.size() - 4, 4, ".tmp") != 0) {
+        result.push_back(child.substr(sep + 1));
+      }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  void WaitForCachedFiles(size_t count) {
+    for (int i = 0; i < 1000 && CachedFiles().size() != count; ++i) {
+      Env::Default()->SleepForMicroseconds(10000);
+    }
+    ASSERT_EQ(count, CachedFiles().size());
+  }
+
+  const EnvOptions soptions_;
+  std::unique_ptr<MockEnv> remote_mock_;
+  std::unique_ptr<ReadCountingEnv> remote_;
+  std::unique_ptr<MockEnv> local_;
+  std::unique_ptr<Env> env_;
+};
+
+TEST_F(LocalCacheEnvTest, ReadsMoveToLocalCopy) {
+  Open(10 * kFileSize);
+  std::string data = WriteFile("/db/000001.sst");
+
+  std::unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile("/db/000001.sst", &file, soptions_));
+  ASSERT_EQ(data, ReadAll(file.get()));
+  WaitForCachedFiles(1);
+  ASSERT_EQ("000001.sst", CachedFiles()[0]);
+
+  // Both the handle opened before the copy completed and a new one are
+  // served locally.
+  int remote_reads = remote_->reads();
+  ASSERT_EQ(data, ReadAll(file.get()));
+  std::unique_ptr<RandomAccessFile> file2;
+  ASSERT_OK(env_->NewRandomAccessFile("/db/000001.sst", &file2, soptions_));
+  ASSERT_EQ(data, ReadAll(file2.get()));
+  ASSERT_EQ(remote_reads, remote_->reads());
+}
+
+TEST_F(LocalCacheEnvTest, UniqueIdSurvivesLocalCopy) {
+  Open(10 * kFileSize);
+  WriteFile("/db/000001.sst");
+  WriteFile("/db/000002.sst");
+
+  char id[64];
+  char local_id[64];
+  std::unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile("/db/000001.sst", &file, soptions_));
+  size_t id_size = file->GetUniqueId(id, sizeof(id));
+  ASSERT_GT(id_size, 0U);
+  WaitForCachedFiles(1);
+
+  // Opened on the local copy, the file keeps the ID of the remote one.
+  std::unique_ptr<RandomAccessFile> local_file;
+  ASSERT_OK(
+      env_->NewRandomAccessFile("/db/000001.sst", &local_file, soptions_));
+  ASSERT_EQ(id_size, local_file->GetUniqueId(local_id, sizeof(local_id)));
+  ASSERT_EQ(0, memcmp(id, local_id, id_size));
+  ASSERT_EQ(0U, local_file->GetUniqueId(local_id, id_size - 1));
+
+  std::unique_ptr<RandomAccessFile> other_file;
+  ASSERT_OK(
+      env_->NewRandomAccessFile("/db/000002.sst", &other_file, soptions_));
+  WaitForCachedFiles(2);
+  other_file.reset();
+  ASSERT_OK(
+      env_->NewRandomAccessFile("/db/000002.sst", &other_file, soptions_));
+  ASSERT_EQ(id_size, other_file->GetUniqueId(local_id, sizeof(local_id)));
+  ASSERT_NE(0, memcmp(id, local_id, id_size));
+}
+
+TEST_F(LocalCacheEnvTest, OnlyTableFilesAreCached) {
+  Open(10 * kFileSize);
+  std::string data = WriteFile("/db/MANIFEST-000001");
+  std::unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile("/db/MANIFEST-000001", &file, soptions_));
+  ASSERT_EQ(data, ReadAll(file.get()));
+  env_.reset();
+  ASSERT_TRUE(CachedFiles().empty());
+}
+
+TEST_F(LocalCacheEnvTest, DeleteDropsLocalCopy) {
+  Open(10 * kFileSize);
+  WriteFile("/db/000001.sst");
+  std::unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile("/db/000001.sst", &file, soptions_));
+  WaitForCachedFiles(1);
+  file.reset();
+
+  ASSERT_OK(env_->DeleteFile("/db/000001.sst"));
+  ASSERT_TRUE(CachedFiles().empty());
+  ASSERT_TRUE(
+      env_->NewRandomAccessFile("/db/000001.sst", &file, soptions_).IsIOError());
+}
+
+TEST_F(LocalCacheEnvTest, EvictsLeastRecentlyRead) {
+  Open(2 * kFileSize + kFileSize / 2);
+  std::string data1 = WriteFile("/db/000001.sst");
+  WriteFile("/db/000002.sst");
+  std::string data3 = WriteFile("/db/000003.sst");
+
+  std::unique_ptr<RandomAccessFile> file1;
+  ASSERT_OK(env_->NewRandomAccessFile("/db/000001.sst", &file1, soptions_));
+  WaitForCachedFiles(1);
+  std::unique_ptr<RandomAccessFile> file2;
+  ASSERT_OK(env_->NewRandomAccessFile("/db/000002.sst", &file2, soptions_));
+  WaitForCachedFiles(2);
+
+  // 000002 was touched last by its fill, read 000001 to make it the newest.
+  ASSERT_EQ(data1, ReadAll(file1.get()));
+  std::unique_ptr<RandomAccessFile> file3;
+  ASSERT_OK(env_->NewRandomAccessFile("/db/000003.sst", &file3, soptions_));
+  for (int i = 0; i < 1000 && CachedFiles() != std::vector<std::string>(
+                                                   {"000001.sst", "000003.sst"});
+       ++i) {
+    Env::Default()->SleepForMicroseconds(10000);
+  }
+  ASSERT_EQ(std::vector<std::string>({"000001.sst", "000003.sst"}),
+            CachedFiles());
+  ASSERT_EQ(data3, ReadAll(file3.get()));
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "SKIPPED as LocalCacheEnv is not supported in this build\n");
+  return 0;
+}
+
+#endif  // !defined(ROCKSDB_LITE) && !defined(OS_WIN)
@@ -0,0 +1,359 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#if !defined(ROCKSDB_LITE) && !defined(OS_WIN)
+
+#include "env/env_routing.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "rocksdb/status.h"
+#include "util/file_util.h"
+#include "util/filename.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Syncs a directory on both sides. Either side may be missing, e.g. when the
+// directory was created before the routing env was put in place.
+class RoutingDirectory : public Directory {
+ public:
+  RoutingDirectory(std::unique_ptr<Directory>&& base,
+                   std::unique_ptr<Directory>&& local)
+      : base_(std::move(base)), local_(std::move(local)) {}
+
+  virtual Status Fsync() override {
+    Status s;
+    if (base_ != nullptr) {
+      s = base_->Fsync();
+    }
+    if (s.ok() && local_ != nullptr) {
+      s = local_->Fsync();
+    }
+    return s;
+  }
+
+ private:
+  std::unique_ptr<Directory> base_;
+  std::unique_ptr<Directory> local_;
+};
+
+bool IsLocalFile(const std::string& fname) {
+  size_t slash = fname.find_last_of('/');
+  std::string base =
+      (slash == std::string::npos) ? fname : fname.substr(slash + 1);
+  static const InfoLogPrefix kInfoLogPrefix(false, "");
+  uint64_t number;
+  FileType type;
+  if (!ParseFileName(base, &number, kInfoLogPrefix.prefix, &type)) {
+    return false;
+  }
+  return type != kTableFile && type != kBlobFile;
+}
+
+}  // namespace
+
+class FileTypeRoutingEnv : public EnvWrapper {
+ public:
+  FileTypeRoutingEnv(Env* base_env, const FileTypeRoutingEnvOptions& options)
+      : EnvWrapper(base_env),
+        local_env_(options.local_env != nullptr ? options.local_env
+                                                : Env::Default()),
+        local_dir_(options.local_dir) {
+    while (local_dir_.size() > 1 && local_dir_.back() == '/') {
+      local_dir_.pop_back();
+    }
+  }
+
+  virtual Status NewSequentialFile(const std::string& fname,
+                                   std::unique_ptr<SequentialFile>* result,
+                                   const EnvOptions& options) override {
+    if (IsLocalFile(fname)) {
+      return local_env_->NewSequentialFile(LocalPath(fname), result, options);
+    }
+    return EnvWrapper::NewSequentialFile(fname, result, options);
+  }
+
+  virtual Status NewRandomAccessFile(const std::string& fname,
+                                     std::unique_ptr<RandomAccessFile>* result,
+                                     const EnvOptions& options) override {
+    if (IsLocalFile(fname)) {
+      return local_env_->NewRandomAccessFile(LocalPath(fname), result,
+                                             options);
+    }
+    return EnvWrapper::NewRandomAccessFile(fname, result, options);
+  }
+
+  virtual Status NewWritableFile(const std::string& fname,
+                                 std::unique_ptr<WritableFile>* result,
+                                 const EnvOptions& options) override {
+    if (IsLocalFile(fname)) {
+      return local_env_->NewWritableFile(LocalPath(fname), result, options);
+    }
+    return EnvWrapper::NewWritableFile(fname, result, options);
+  }
+
+  virtual Status ReopenWritableFile(const std::string& fname,
+                                    std::unique_ptr<WritableFile>* result,
+                                    const EnvOptions& options) override {
+    if (IsLocalFile(fname)) {
+      return local_env_->ReopenWritableFile(LocalPath(fname), result, options);
+    }
+    return EnvWrapper::ReopenWritableFile(fname, result, options);
+  }
+
+  virtual Status ReuseWritableFile(const std::string& fname,
+                                   const std::string& old_fname,
+                                   std::unique_ptr<WritableFile>* result,
+                                   const EnvOptions& options) override {
+    bool local = IsLocalFile(fname);
+    if (local != IsLocalFile(old_fname)) {
+      return Status::NotSupported("Cannot reuse a file from the other side");
+    }
+    if (local) {
+      return local_env_->ReuseWritableFile(LocalPath(fname),
+                                           LocalPath(old_fname), result,
+                                           options);
+    }
+    return EnvWrapper::ReuseWritableFile(fname, old_fname, result, options);
+  }
+
+  virtual Status NewRandomRWFile(const std::string& fname,
+                                 std::unique_ptr<RandomRWFile>* result,
+                                 const EnvOptions& options) override {
+    if (IsLocalFile(fname)) {
+      return local_env_->NewRandomRWFile(LocalPath(fname), result, options);
+    }
+    return EnvWrapper::NewRandomRWFile(fname, result, options);
+  }
+
+  virtual Status NewDirectory(const std::string& dir,
+                              std::unique_ptr<Directory>* result) override {
+    std::unique_ptr<Directory> base;
+    std::unique_ptr<Directory> local;
+    Status s = EnvWrapper::NewDirectory(dir, &base);
+    Status local_s = local_env_->NewDirectory(LocalPath(dir), &local);
+    if (!s.ok() && !local_s.ok()) {
+      return s;
+    }
+    result->reset(new RoutingDirectory(std::move(base), std::move(local)));
+    return Status::OK();
+  }
+
+  virtual Status FileExists(const std::string& fname) override {
+    if (IsLocalFile(fname)) {
+      return local_env_->FileExists(LocalPath(fname));
+    }
+    return EnvWrapper::FileExists(fname);
+  }
+
+  // A directory's children are the union of both sides. It is enough for
+  // the directory to exist on one of them.
+  virtual Status GetChildren(const std::string& dir,
+                             std::vector<std::string>* result) override {
+    std::vector<std::string> local;
+    Status s = EnvWrapper::GetChildren(dir, result);
+    Status local_s = local_env_->GetChildren(LocalPath(dir), &local);
+    if (!local_s.ok()) {
+      return s;
+    }
+    if (!s.ok()) {
+      result->clear();
+    }
+    result->insert(result->end(), local.begin(), local.end());
+    std::sort(result->begin(), result->end());
+    result->erase(std::unique(result->begin(), result->end()), result->end());
+    return Status::OK();
+  }
+
+  // Goes through GetChildren() and GetFileSize() above instead of asking
+  // base_env alone.
+  virtual Status GetChildrenFileAttributes(
+      const std::string& dir, std::vector<FileAttributes>* result) override {
+    return Env::GetChildrenFileAttributes(dir, result);
+  }
+
+  virtual Status DeleteFile(const std::string& fname) override {
+    if (IsLocalFile(fname)) {
+      return local_env_->DeleteFile(LocalPath(fname));
+    }
+    return EnvWrapper::DeleteFile(fname);
+  }
+
+  virtual Status CreateDir(const std::string& dir) override {
+    Status s = EnvWrapper::CreateDir(dir);
+    if (s.ok()) {
+      s = CreateLocalDirs(dir);
+    }
+    return s;
+  }
+
+  virtual Status CreateDirIfMissing(const std::string& dir) override {
+    Status s = EnvWrapper::CreateDirIfMissing(dir);
+    if (s.ok()) {
+      s = CreateLocalDirs(dir);
+    }
+    return s;
+  }
+
+  virtual Status DeleteDir(const std::string& dir) override {
+    Status s = EnvWrapper::DeleteDir(dir);
+    std::string local_dir = LocalPath(dir);
+    if (s.ok() && local_env_->FileExists(local_dir).ok()) {
+      s = local_env_->DeleteDir(local_dir);
+    }
+    return s;
+  }
+
+  virtual Status GetFileSize(const std::string& fname,
+                             uint64_t* file_size) override {
+    if (IsLocalFile(fname)) {
+      return local_env_->GetFileSize(LocalPath(fname), file_size);
+    }
+    return EnvWrapper::GetFileSize(fname, file_size);
+  }
+
+  virtual Status GetFileModificationTime(const std::string& fname,
+                                         uint64_t* file_mtime) override {
+    if (IsLocalFile(fname)) {
+      return local_env_->GetFileModificationTime(LocalPath(fname), file_mtime);
+    }
+    return EnvWrapper::GetFileModificationTime(fname, file_mtime);
+  }
+
+  // RocksDB only renames within one side (e.g. a .dbtmp file into CURRENT),
+  // but a move across sides is still done correctly, by copying.
+  virtual Status RenameFile(const std::string& src,
+                            const std::string& target) override {
+    bool local = IsLocalFile(src);
+    if (local != IsLocalFile(target)) {
+      Status s = rocksdb::CopyFile(this, src, target, 0, true /* use_fsync */);
+      if (s.ok()) {
+        s = DeleteFile(src);
+      }
+      return s;
+    }
+    if (local) {
+      return local_env_->RenameFile(LocalPath(src), LocalPath(target));
+    }
+    return EnvWrapper::RenameFile(src, target);
+  }
+
+  virtual Status LinkFile(const std::string& src,
+                          const std::string& target) override {
+    bool local = IsLocalFile(src);
+    if (local != IsLocalFile(target)) {
+      return Status::NotSupported("Cannot link a file to the other side");
+    }
+    if (local) {
+      return local_env_->LinkFile(LocalPath(src), LocalPath(target));
+    }
+    return EnvWrapper::LinkFile(src, target);
+  }
+
+  virtual Status CopyFile(const std::string& src,
+                          const std::string& target) override {
+    bool local = IsLocalFile(src);
+    if (local != IsLocalFile(target)) {
+      return Status::NotSupported("Cannot copy a file to the other side");
+    }
+    if (local) {
+      return local_env_->CopyFile(LocalPath(src), LocalPath(target));
+    }
+    return EnvWrapper::CopyFile(src, target);
+  }
+
+  virtual Status NumFileLinks(const std::string& fname,
+                              uint64_t* count) override {
+    if (IsLocalFile(fname)) {
+      return local_env_->NumFileLinks(LocalPath(fname), count);
+    }
+    return EnvWrapper::NumFileLinks(fname, count);
+  }
+
+  virtual Status AreFilesSame(const std::string& first,
+                              const std::string& second, bool* res) override {
+    bool local = IsLocalFile(first);
+    if (local != IsLocalFile(second)) {
+      *res = false;
+      return Status::OK();
+    }
+    if (local) {
+      return local_env_->AreFilesSame(LocalPath(first), LocalPath(second),
+                                      res);
+    }
+    return EnvWrapper::AreFilesSame(first, second, res);
+  }
+
+  virtual Status LockFile(const std::string& fname, FileLock** lock) override {
+    if (!IsLocalFile(fname)) {
+      return EnvWrapper::LockFile(fname, lock);
+    }
+    Status s = local_env_->LockFile(LocalPath(fname), lock);
+    if (s.ok()) {
+      std::lock_guard<std::mutex> l(mutex_);
+      local_locks_.insert(*lock);
+    }
+    return s;
+  }
+
+  virtual Status UnlockFile(FileLock* lock) override {
+    {
+      std::lock_guard<std::mutex> l(mutex_);
+      if (local_locks_.erase(lock) == 0) {
+        return EnvWrapper::UnlockFile(lock);
+      }
+    }
+    return local_env_->UnlockFile(lock);
+  }
+
+  virtual Status NewLogger(const std::string& fname,
+                           std::shared_ptr<Logger>* result) override {
+    if (IsLocalFile(fname)) {
+      return local_env_->NewLogger(LocalPath(fname), result);
+    }
+    return EnvWrapper::NewLogger(fname, result);
+  }
+
+ private:
+  std::string LocalPath(const std::string& path) const {
+    if (!path.empty() && path[0] == '/') {
+      return local_dir_ + path;
+    }
+    return local_dir_ + "/" + path;
+  }
+
+  // Creates the local counterpart of dir together with any missing parents,
+  // local_dir included.
+  Status CreateLocalDirs(const std::string& dir) {
+    std::string path = LocalPath(dir);
+    for (size_t pos = path.find('/', 1); pos != std::string::npos;
+         pos = path.find('/', pos + 1)) {
+      // Parents outside local_dir may already exist and be read-only.
+      local_env_->CreateDirIfMissing(path.substr(0, pos));
+    }
+    return local_env_->CreateDirIfMissing(path);
+  }
+
+  Env* local_env_;
+  std::string local_dir_;
+  std::mutex mutex_;
+  std::unordered_set<FileLock*> local_locks_;
+};
+
+Env* NewFileTypeRoutingEnv(Env* base_env,
+                           const FileTypeRoutingEnvOptions& options) {
+  return new FileTypeRoutingEnv(base_env, options);
+}
+
+}  // namespace rocksdb
+
+#endif  // !defined(ROCKSDB_LITE) && !defined(OS_WIN)
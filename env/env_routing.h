@@ -0,0 +1,41 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#if !defined(ROCKSDB_LITE) && !defined(OS_WIN)
+
+#include <string>
+
+#include "rocksdb/env.h"
+
+namespace rocksdb {
+
+struct FileTypeRoutingEnvOptions {
+  // Directory on low-latency storage that holds the local files. A file
+  // named "/db/000003.log" is stored as local_dir + "/db/000003.log".
+  std::string local_dir;
+
+  // Env used to access local_dir. nullptr means Env::Default().
+  Env* local_env = nullptr;
+};
+
+// Returns an Env that places each file according to the FileType its name
+// parses to (see util/filename.h). Table and blob files, and any file whose
+// name is not one RocksDB generates, go to base_env. The files on the
+// latency-critical write path -- WAL, MANIFEST, CURRENT, LOCK, OPTIONS,
+// IDENTITY, the info log and the temporary files renamed into them -- are
+// kept under options.local_dir instead.
+//
+// Directories exist on both sides: creating, syncing or deleting a directory
+// is applied to both, and listing one returns the union of the two, so
+// recovery and obsolete-file purging see every file of the DB wherever it
+// lives.
+Env* NewFileTypeRoutingEnv(Env* base_env,
+                           const FileTypeRoutingEnvOptions& options);
+
+}  // namespace rocksdb
+
+#endif  // !defined(ROCKSDB_LITE) && !defined(OS_WIN)
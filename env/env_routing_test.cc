@@ -0,0 +1,132 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#if !defined(ROCKSDB_LITE) && !defined(OS_WIN)
+
+#include "env/env_routing.h"
+
+#include <algorithm>
+
+#include "env/mock_env.h"
+#include "rocksdb/db.h"
+#include "util/filename.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class FileTypeRoutingEnvTest : public testing::Test {
+ public:
+  FileTypeRoutingEnvTest()
+      : remote_(new MockEnv(Env::Default())),
+        local_(new MockEnv(Env::Default())) {
+    FileTypeRoutingEnvOptions options;
+    options.local_dir = "/local";
+    options.local_env = local_.get();
+    env_.reset(NewFileTypeRoutingEnv(remote_.get(), options));
+  }
+
+  Options DBOptions() {
+    Options options;
+    options.env = env_.get();
+    options.create_if_missing = true;
+    return options;
+  }
+
+  // Types of the files RocksDB created in dir of env.
+  std::vector<FileType> FileTypes(Env* env, const std::string& dir) {
+    std::vector<std::string> children;
+    std::vector<FileType> result;
+    env->GetChildren(dir, &children);
+    for (const auto& child : children) {
+      uint64_t number;
+      FileType type;
+      if (ParseFileName(child, &number, "LOG", &type)) {
+        result.push_back(type);
+      }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+  }
+
+  std::unique_ptr<MockEnv> remote_;
+  std::unique_ptr<MockEnv> local_;
+  std::unique_ptr<Env> env_;
+};
+
+TEST_F(FileTypeRoutingEnvTest, PlacesFilesByType) {
+  DB* db;
+  ASSERT_OK(DB::Open(DBOptions(), "/db", &db));
+  ASSERT_OK(db->Put(WriteOptions(), "flushed", "v1"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  ASSERT_OK(db->Put(WriteOptions(), "in_wal", "v2"));
+
+  ASSERT_EQ(std::vector<FileType>({kTableFile}),
+            FileTypes(remote_.get(), "/db"));
+  ASSERT_EQ(std::vector<FileType>({kLogFile, kDBLockFile, kDescriptorFile,
+                                   kCurrentFile, kInfoLogFile, kIdentityFile,
+                                   kOptionsFile}),
+            FileTypes(local_.get(), "/local/db"));
+  ASSERT_EQ(std::vector<FileType>({kLogFile, kDBLockFile, kTableFile,
+                                   kDescriptorFile, kCurrentFile, kInfoLogFile,
+                                   kIdentityFile, kOptionsFile}),
+            FileTypes(env_.get(), "/db"));
+  delete db;
+
+  // Recovery finds the MANIFEST and WAL locally and the table on the remote
+  // side.
+  ASSERT_OK(DB::Open(DBOptions(), "/db", &db));
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "flushed", &value));
+  ASSERT_EQ("v1", value);
+  ASSERT_OK(db->Get(ReadOptions(), "in_wal", &value));
+  ASSERT_EQ("v2", value);
+  delete db;
+}
+
+TEST_F(FileTypeRoutingEnvTest, DestroyRemovesBothSides) {
+  DB* db;
+  ASSERT_OK(DB::Open(DBOptions(), "/db", &db));
+  ASSERT_OK(db->Put(WriteOptions(), "key", "value"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  delete db;
+
+  ASSERT_OK(DestroyDB("/db", DBOptions()));
+  ASSERT_TRUE(remote_->FileExists("/db").IsNotFound());
+  ASSERT_TRUE(local_->FileExists("/local/db").IsNotFound());
+}
+
+TEST_F(FileTypeRoutingEnvTest, RenameAcrossSides) {
+  const EnvOptions soptions;
+  std::unique_ptr<WritableFile> file;
+  ASSERT_OK(env_->CreateDirIfMissing("/db"));
+  ASSERT_OK(env_->NewWritableFile("/db/000001.dbtmp", &file, soptions));
+  ASSERT_OK(file->Append("contents"));
+  ASSERT_OK(file->Close());
+
+  ASSERT_OK(env_->RenameFile("/db/000001.dbtmp", "/db/000001.sst"));
+  ASSERT_TRUE(local_->FileExists("/local/db/000001.dbtmp").IsNotFound());
+  uint64_t size;
+  ASSERT_OK(remote_->GetFileSize("/db/000001.sst", &size));
+  ASSERT_EQ(8U, size);
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as FileTypeRoutingEnv is not supported in this build\n");
+  return 0;
+}
+
+#endif  // !defined(ROCKSDB_LITE) && !defined(OS_WIN)
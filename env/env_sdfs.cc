@@ -7,13 +7,22 @@
 #define ROCKSDB_SDFS_FILE_C
 
 #include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <condition_variable>
 #include <stdio.h>
 #include <sys/time.h>
 #include <time.h>
 #include <strings.h>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include "monitoring/histogram.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
+#include "rocksdb/utilities/object_registry.h"
+#include "util/aligned_buffer.h"
 #include "util/string_util.h"
 #include "util/logging.h"
 
@@ -29,19 +38,73 @@ static Status IOError(const std::string& context, int err_number) {
 
 static Logger* mylog = nullptr;
 
+// Write buffer size used when EnvOptions::writable_file_max_buffer_size is
+// not set. Matches the default SDFS net block size.
+static const size_t kSdfsDefaultWriteBufferSize = 2 * 1024 * 1024;
+
+// Largest length passed to a single sdfsWrite, which takes a 32-bit size.
+static const size_t kSdfsMaxWriteSize = 64 * 1024 * 1024;
+
+// Times one SDFS call and records it in io_stats, which may be null.
+class SdfsOpTimer {
+ public:
+  SdfsOpTimer(SdfsIOStats* io_stats, SdfsIOStats::Op op)
+      : io_stats_(io_stats), op_(op),
+        start_(io_stats != nullptr ? io_stats->NowMicros() : 0),
+        bytes_(0), failed_(false) {}
+
+  ~SdfsOpTimer() {
+      if (io_stats_ != nullptr) {
+          io_stats_->Record(op_, io_stats_->NowMicros() - start_, bytes_,
+                            failed_);
+      }
+  }
+
+  void SetBytes(uint64_t bytes) { bytes_ = bytes; }
+  void SetFailed() { failed_ = true; }
+
+ private:
+  SdfsIOStats* io_stats_;
+  const SdfsIOStats::Op op_;
+  const uint64_t start_;
+  uint64_t bytes_;
+  bool failed_;
+};
+
 class SdfsReadableFile : virtual public SequentialFile,
     virtual public RandomAccessFile {
      private:
       sdfsFS fileSys_;
       std::string filename_;
       sdfsFile hfile_;
+      // Provides the thread pool for MultiRead(), null for sequential files.
+      SdfsEnv* env_;
+      SdfsMetadataCache* metadata_cache_;
+      SdfsIOStats* io_stats_;
+      // errno of a failed sdfsOpenFile.
+      int open_errno_;
 
      public:
-      SdfsReadableFile(sdfsFS fileSys, const std::string& fname)
-          : fileSys_(fileSys), filename_(fname), hfile_(0) {
+      SdfsReadableFile(sdfsFS fileSys, const std::string& fname,
+                       SdfsEnv* env = nullptr,
+                       SdfsMetadataCache* metadata_cache = nullptr,
+                       SdfsIOStats* io_stats = nullptr)
+          : fileSys_(fileSys), filename_(fname), hfile_(0),
+            env_(env),
+            metadata_cache_(metadata_cache),
+            io_stats_(io_stats),
+            open_errno_(0) {
               ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsReadableFile opening file %s\n",
                               filename_.c_str());
-              hfile_ = sdfsOpenFile(fileSys_, filename_.c_str(), O_RDONLY, 0, 0, 0);
+              {
+                  SdfsOpTimer timer(io_stats_, SdfsIOStats::kOpen);
+                  hfile_ = sdfsOpenFile(fileSys_, filename_.c_str(), O_RDONLY,
+                                        0, 0, 0);
+                  if (hfile_ == 0) {
+                      open_errno_ = errno;
+                      timer.SetFailed();
+                  }
+              }
               ROCKS_LOG_DEBUG(mylog,
                               "[sdfs] SdfsReadableFile opened file %s hfile_=0x%p\n",
                               filename_.c_str(), hfile_);
@@ -60,6 +123,8 @@ class SdfsReadableFile : virtual public SequentialFile,
           return hfile_ != 0;
       }
 
+      int open_errno() const { return open_errno_; }
+
       virtual Status Read(size_t n, Slice* result, char* scratch) {
           Status s;
           ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsReadableFile reading %s %ld\n",
@@ -69,10 +134,13 @@ class SdfsReadableFile : virtual public SequentialFile,
           size_t total_bytes_read = 0;
           tSize bytes_read = 0;
           tSize remaining_bytes = (tSize)n;
+          int err = 0;
 
+          SdfsOpTimer timer(io_stats_, SdfsIOStats::kRead);
           while (remaining_bytes > 0) {
               bytes_read = sdfsRead(fileSys_, hfile_, buffer, remaining_bytes);
               if (bytes_read <= 0) {
+                  err = errno;
                   break;
               }
               assert(bytes_read <= remaining_bytes);
@@ -82,12 +150,16 @@ class SdfsReadableFile : virtual public SequentialFile,
               buffer += bytes_read;
           }
           assert(total_bytes_read <= n);
+          timer.SetBytes(total_bytes_read);
+          if (bytes_read < 0) {
+              timer.SetFailed();
+          }
 
           ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsReadableFile read %s\n",
                           filename_.c_str());
 
           if (bytes_read < 0) {
-              s = IOError(filename_, errno);
+              s = IOError(filename_, err);
           } else {
               *result = Slice(scratch, total_bytes_read);
           }
@@ -97,19 +169,52 @@ class SdfsReadableFile : virtual public SequentialFile,
 
       virtual Status Read(uint64_t offset, size_t n, Slice* result,
                           char* scratch) const {
-          Status s;
-          ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsReadableFile preading %s\n",
-                          filename_.c_str());
-          ssize_t bytes_read = sdfsPread(fileSys_, hfile_, offset,
-                                         (void*)scratch, (tSize)n);
-          ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsReadableFile pread %s\n",
-                          filename_.c_str());
-          *result = Slice(scratch, (bytes_read < 0) ? 0 : bytes_read);
-          if (bytes_read < 0) {
+          return PreadDirect(offset, n, result, scratch);
+      }
 
-              s = IOError(filename_, errno);
+      // Issues the requests concurrently on the env's read pool, so the
+      // whole batch costs about one SDFS round trip.
+      virtual Status MultiRead(ReadRequest* reqs, size_t num_reqs) {
+          assert(reqs != nullptr);
+          if (env_ == nullptr || num_reqs <= 1) {
+              for (size_t i = 0; i < num_reqs; ++i) {
+                  ReadRequest& req = reqs[i];
+                  req.status = PreadDirect(req.offset, req.len, &req.result,
+                                           req.scratch);
+              }
+              return Status::OK();
           }
-          return s;
+
+          ThreadPool* read_pool = env_->GetMultiReadPool();
+          std::mutex mu;
+          std::condition_variable cv;
+          size_t pending = num_reqs - 1;
+          for (size_t i = 1; i < num_reqs; ++i) {
+              read_pool->SubmitJob([this, reqs, i, &mu, &cv, &pending]() {
+                  ReadRequest& req = reqs[i];
+                  req.status = PreadDirect(req.offset, req.len, &req.result,
+                                           req.scratch);
+                  std::lock_guard<std::mutex> lock(mu);
+                  if (--pending == 0) {
+                      cv.notify_one();
+                  }
+              });
+          }
+          // The calling thread serves the first request itself.
+          reqs[0].status = PreadDirect(reqs[0].offset, reqs[0].len,
+                                       &reqs[0].result, reqs[0].scratch);
+          std::unique_lock<std::mutex> lock(mu);
+          cv.wait(lock, [&pending]() { return pending == 0; });
+          return Status::OK();
+      }
+
+      // There is no page cache to warm. Reporting NotSupported makes table
+      // iterators do the readahead in their own FilePrefetchBuffer, so the
+      // window follows each scan and is freed with the iterator.
+      virtual Status Prefetch(uint64_t offset, size_t n) {
+          (void)offset;
+          (void)n;
+          return Status::NotSupported("Prefetch", filename_);
       }
 
       virtual Status Skip(uint64_t n) {
@@ -131,6 +236,27 @@ class SdfsReadableFile : virtual public SequentialFile,
 
      private:
 
+      Status PreadDirect(uint64_t offset, size_t n, Slice* result,
+                         char* scratch) const {
+          Status s;
+          ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsReadableFile preading %s\n",
+                          filename_.c_str());
+          SdfsOpTimer timer(io_stats_, SdfsIOStats::kPread);
+          ssize_t bytes_read = sdfsPread(fileSys_, hfile_, offset,
+                                         (void*)scratch, (tSize)n);
+          int err = errno;
+          ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsReadableFile pread %s\n",
+                          filename_.c_str());
+          *result = Slice(scratch, (bytes_read < 0) ? 0 : bytes_read);
+          if (bytes_read < 0) {
+              timer.SetFailed();
+              s = IOError(filename_, err);
+          } else {
+              timer.SetBytes(bytes_read);
+          }
+          return s;
+      }
+
       bool feof() {
           ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsReadableFile feof %s\n",
                           filename_.c_str());
@@ -144,9 +270,11 @@ class SdfsReadableFile : virtual public SequentialFile,
           ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsReadableFile fileSize %s\n",
                           filename_.c_str());
           sdfsFileInfo pFileInfo;
-          int code = sdfsGetPathInfo(fileSys_, filename_.c_str(), &pFileInfo);
+          int code = metadata_cache_ != nullptr ?
+              metadata_cache_->GetPathInfo(filename_, &pFileInfo) :
+              sdfsGetPathInfo(fileSys_, filename_.c_str(), &pFileInfo);
           tOffset size = 0L;
-          if (code != 0) {
+          if (code == 0) {
               size = pFileInfo.mSize;
           } else {
               throw SdfsFatalException("fileSize on unknown file " + filename_);
@@ -161,47 +289,91 @@ class SdfsWritableFile: public WritableFile {
   std::string filename_;
   sdfsFile hfile_;
 
+  // Appends are coalesced in buf_ and handed to SDFS in net block sized
+  // writes. With pipelining enabled a full buffer is written by the env's
+  // write pool from inflight_buf_ while the caller keeps filling buf_.
+  AlignedBuffer buf_;
+  AlignedBuffer inflight_buf_;
+  ThreadPool* const write_pool_;
+  std::mutex inflight_mu_;
+  std::condition_variable inflight_cv_;
+  bool inflight_pending_;
+  Status inflight_status_;
+  // Guards the buffers so that Sync() can run concurrently with Append().
+  std::mutex buf_mutex_;
+  // Set while appended data has not been handed to SDFS completely.
+  std::atomic<bool> unflushed_;
+
+  // Cached size and mtime of the file are dropped once it is closed. While
+  // the file is open its size is tracked by the writer, not looked up.
+  SdfsMetadataCache* metadata_cache_;
+  SdfsIOStats* io_stats_;
+  // errno of a failed sdfsOpenFile.
+  int open_errno_;
+
  public:
-  SdfsWritableFile(sdfsFS fileSys, const std::string& fname)
-      : fileSys_(fileSys), filename_(fname) , hfile_(0) {
+  SdfsWritableFile(sdfsFS fileSys, const std::string& fname,
+                   size_t buffer_size = 0, ThreadPool* write_pool = nullptr,
+                   SdfsMetadataCache* metadata_cache = nullptr,
+                   SdfsIOStats* io_stats = nullptr)
+      : fileSys_(fileSys), filename_(fname) , hfile_(0),
+        write_pool_(buffer_size > 0 ? write_pool : nullptr),
+        inflight_pending_(false),
+        unflushed_(false),
+        metadata_cache_(metadata_cache),
+        io_stats_(io_stats),
+        open_errno_(0) {
           ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsWritableFile opening %s\n",
                           filename_.c_str());
-          hfile_ = sdfsOpenFile(fileSys_, filename_.c_str(), O_WRONLY, 0, 0, 0);
+          {
+              SdfsOpTimer timer(io_stats_, SdfsIOStats::kOpen);
+              hfile_ = sdfsOpenFile(fileSys_, filename_.c_str(), O_WRONLY,
+                                    0, 0, 0);
+              if (hfile_ == 0) {
+                  open_errno_ = errno;
+                  timer.SetFailed();
+              }
+          }
           ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsWritableFile opened %s\n",
                           filename_.c_str());
           assert(hfile_ != 0);
+          if (buffer_size > 0) {
+              buf_.Alignment(kDefaultPageSize);
+              buf_.AllocateNewBuffer(buffer_size);
+              if (write_pool_ != nullptr) {
+                  inflight_buf_.Alignment(kDefaultPageSize);
+                  inflight_buf_.AllocateNewBuffer(buffer_size);
+              }
+          }
       }
   virtual ~SdfsWritableFile() {
       if (hfile_ != 0) {
           ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsWritableFile closing %s\n",
                           filename_.c_str());
+          Flush();
           sdfsCloseFile(fileSys_, hfile_);
+          if (metadata_cache_ != nullptr) {
+              metadata_cache_->Invalidate(filename_);
+          }
           ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsWritableFile closed %s\n",
                           filename_.c_str());
           hfile_ = 0;
       }
+      WaitForInflightWrite();
   }
 
   bool isValid() {
       return !(hfile_ == 0);
   }
 
+  int open_errno() const { return open_errno_; }
+
   const std::string& getName() {
       return filename_;
   }
 
   virtual Status Append(const Slice& data) {
-      ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsWritableFile Append %s\n",
-                      filename_.c_str());
-      const char* src = data.data();
-      size_t left = data.size();
-      size_t ret = sdfsWrite(fileSys_, hfile_, src, left);
-      ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsWritableFile Appended %s\n",
-                      filename_.c_str());
-      if (ret != left) {
-          return IOError(filename_, errno);
-      }
-      return Status::OK();
+      return Append(data.data(), data.size());
   }
 
   virtual Status PositionedAppend(const Slice& data, uint64_t offset) {
@@ -210,28 +382,72 @@ class SdfsWritableFile: public WritableFile {
       return Status::OK();
   }
 
+  // Hands all buffered data to SDFS. It does not wait for it to be durable,
+  // that is what Sync() is for.
   virtual Status Flush() {
-      return Status::OK();
+      std::lock_guard<std::mutex> lock(buf_mutex_);
+      return FlushLocked();
   }
 
+  // Only the hand-off of buffered data is serialized with Append(), and
+  // only when there is any. The hsync runs unlocked, so appends of newer
+  // data continue while it is in flight.
   virtual Status Sync() {
       Status s;
       ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsWritableFile Sync %s\n",
                       filename_.c_str());
+      if (unflushed_.load(std::memory_order_acquire)) {
+          s = Flush();
+          if (!s.ok()) {
+              return s;
+          }
+      }
+      SdfsOpTimer timer(io_stats_, SdfsIOStats::kSync);
       if (sdfsFlush(fileSys_, hfile_) == -1) {
-          return IOError(filename_, errno);
+          int err = errno;
+          timer.SetFailed();
+          return IOError(filename_, err);
       }
       if (sdfsHSync(fileSys_, hfile_) == -1) {
-          return IOError(filename_, errno);
+          int err = errno;
+          timer.SetFailed();
+          return IOError(filename_, err);
       }
       ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsWritableFile Synced %s\n",
                       filename_.c_str());
       return Status::OK();
   }
 
+  virtual bool IsSyncThreadSafe() const {
+      return true;
+  }
+
   virtual Status Append(const char* src, size_t size) {
-      if (sdfsWrite(fileSys_, hfile_, src, size) != (tSize)size) {
-          return IOError(filename_, errno);
+      ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsWritableFile Append %s\n",
+                      filename_.c_str());
+      std::lock_guard<std::mutex> lock(buf_mutex_);
+      unflushed_.store(true, std::memory_order_relaxed);
+      if (buf_.Capacity() == 0) {
+          return WriteUnbuffered(src, size);
+      }
+      while (size > 0) {
+          if (buf_.CurrentSize() == 0 && size >= buf_.Capacity()) {
+              // Nothing to coalesce with, skip the copy for large appends.
+              Status s = WaitForInflightWrite();
+              if (!s.ok()) {
+                  return s;
+              }
+              return WriteUnbuffered(src, size);
+          }
+          size_t appended = buf_.Append(src, size);
+          src += appended;
+          size -= appended;
+          if (buf_.CurrentSize() == buf_.Capacity()) {
+              Status s = FlushBuffer();
+              if (!s.ok()) {
+                  return s;
+              }
+          }
       }
       return Status::OK();
   }
@@ -239,14 +455,87 @@ class SdfsWritableFile: public WritableFile {
   virtual Status Close() {
       ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsWritableFile closing %s\n",
                       filename_.c_str());
-      if (sdfsCloseFile(fileSys_, hfile_) != 0) {
-          return IOError(filename_, errno);
+      Status s = Flush();
+      if (sdfsCloseFile(fileSys_, hfile_) != 0 && s.ok()) {
+          s = IOError(filename_, errno);
+      }
+      if (metadata_cache_ != nullptr) {
+          metadata_cache_->Invalidate(filename_);
       }
       ROCKS_LOG_DEBUG(mylog, "[sdfs] SdfsWritableFile closed %s\n",
                       filename_.c_str());
       hfile_ = 0;
+      return s;
+  }
+
+ private:
+  // REQUIRES: buf_mutex_ held
+  Status FlushLocked() {
+      Status s = FlushBuffer();
+      Status inflight = WaitForInflightWrite();
+      if (s.ok() && inflight.ok()) {
+          unflushed_.store(false, std::memory_order_release);
+      }
+      return s.ok() ? inflight : s;
+  }
+
+  Status WriteUnbuffered(const char* src, size_t size) const {
+      while (size > 0) {
+          tSize chunk = static_cast<tSize>(
+              std::min(size, static_cast<size_t>(kSdfsMaxWriteSize)));
+          SdfsOpTimer timer(io_stats_, SdfsIOStats::kWrite);
+          if (sdfsWrite(fileSys_, hfile_, src, chunk) != chunk) {
+              int err = errno;
+              timer.SetFailed();
+              return IOError(filename_, err);
+          }
+          timer.SetBytes(chunk);
+          src += chunk;
+          size -= chunk;
+      }
       return Status::OK();
   }
+
+  // Writes out buf_, asynchronously when pipelining is enabled. At most one
+  // buffer is in flight, so ordering of writes is preserved.
+  Status FlushBuffer() {
+      if (buf_.CurrentSize() == 0) {
+          return Status::OK();
+      }
+      Status s = WaitForInflightWrite();
+      if (!s.ok()) {
+          return s;
+      }
+      if (write_pool_ == nullptr) {
+          s = WriteUnbuffered(buf_.BufferStart(), buf_.CurrentSize());
+          buf_.Size(0);
+          return s;
+      }
+      std::swap(buf_, inflight_buf_);
+      buf_.Size(0);
+      {
+          std::lock_guard<std::mutex> lock(inflight_mu_);
+          inflight_pending_ = true;
+      }
+      write_pool_->SubmitJob([this]() {
+          Status write_status = WriteUnbuffered(inflight_buf_.BufferStart(),
+                                                inflight_buf_.CurrentSize());
+          // Notify under the lock, the file may be gone once it is released.
+          std::lock_guard<std::mutex> lock(inflight_mu_);
+          inflight_status_ = write_status;
+          inflight_pending_ = false;
+          inflight_cv_.notify_all();
+      });
+      return s;
+  }
+
+  Status WaitForInflightWrite() {
+      std::unique_lock<std::mutex> lock(inflight_mu_);
+      inflight_cv_.wait(lock, [this]() { return !inflight_pending_; });
+      Status s = inflight_status_;
+      inflight_status_ = Status::OK();
+      return s;
+  }
 };
 
 class SdfsLogger : public Logger {
@@ -336,31 +625,306 @@ class SdfsLogger : public Logger {
 
 }  
 
+namespace {
+
+struct SdfsOpInfo {
+  const char* name;
+  Histograms histogram;
+  // TICKER_ENUM_MAX if the op moves no data.
+  Tickers bytes_ticker;
+};
+
+const SdfsOpInfo kSdfsOpInfo[SdfsIOStats::kNumOps] = {
+    {"open", SDFS_OPEN_MICROS, TICKER_ENUM_MAX},
+    {"read", SDFS_READ_MICROS, SDFS_BYTES_READ},
+    {"pread", SDFS_PREAD_MICROS, SDFS_BYTES_READ},
+    {"write", SDFS_WRITE_MICROS, SDFS_BYTES_WRITTEN},
+    {"sync", SDFS_SYNC_MICROS, TICKER_ENUM_MAX},
+    {"exists", SDFS_EXISTS_MICROS, TICKER_ENUM_MAX},
+    {"getpathinfo", SDFS_GET_PATH_INFO_MICROS, TICKER_ENUM_MAX},
+};
+
+}  // namespace
+
+SdfsIOStats::SdfsIOStats(Env* clock)
+    : clock_(clock), latency_(new HistogramImpl[kNumOps]) {
+    for (uint32_t i = 0; i < kNumOps; i++) {
+        bytes_[i].store(0, std::memory_order_relaxed);
+        errors_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+SdfsIOStats::~SdfsIOStats() {}
+
+void SdfsIOStats::Record(Op op, uint64_t micros, uint64_t bytes,
+                         bool failed) {
+    assert(op < kNumOps);
+    latency_[op].Add(micros);
+    if (bytes > 0) {
+        bytes_[op].fetch_add(bytes, std::memory_order_relaxed);
+    }
+    if (failed) {
+        errors_[op].fetch_add(1, std::memory_order_relaxed);
+    }
+    Statistics* stats = statistics_.get();
+    if (stats != nullptr) {
+        stats->measureTime(kSdfsOpInfo[op].histogram, micros);
+        if (bytes > 0 && kSdfsOpInfo[op].bytes_ticker != TICKER_ENUM_MAX) {
+            stats->recordTick(kSdfsOpInfo[op].bytes_ticker, bytes);
+        }
+        if (failed) {
+            stats->recordTick(SDFS_ERRORS, 1);
+        }
+    }
+}
+
+void SdfsIOStats::Reset() {
+    for (uint32_t i = 0; i < kNumOps; i++) {
+        latency_[i].Clear();
+        bytes_[i].store(0, std::memory_order_relaxed);
+        errors_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+std::string SdfsIOStats::ToString() const {
+    std::string result = "SDFS call latencies in microseconds:\n";
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%-12s %10s %8s %14s %10s %10s %10s %10s\n",
+             "op", "count", "errors", "bytes", "avg", "p50", "p99", "max");
+    result.append(buf);
+    for (uint32_t i = 0; i < kNumOps; i++) {
+        HistogramData data;
+        latency_[i].Data(&data);
+        snprintf(buf, sizeof(buf),
+                 "%-12s %10" PRIu64 " %8" PRIu64 " %14" PRIu64
+                 " %10.1f %10.1f %10.1f %10.0f\n",
+                 kSdfsOpInfo[i].name, data.count,
+                 errors_[i].load(std::memory_order_relaxed),
+                 bytes_[i].load(std::memory_order_relaxed), data.average,
+                 data.median, data.percentile99, data.max);
+        result.append(buf);
+    }
+    return result;
+}
+
+SdfsMetadataCache::SdfsMetadataCache(sdfsFS fileSys, Env* clock,
+                                     uint64_t ttl_micros,
+                                     SdfsIOStats* io_stats)
+    : fileSys_(fileSys), clock_(clock), io_stats_(io_stats),
+      ttl_micros_(ttl_micros), generation_(0) {}
+
+int SdfsMetadataCache::Exists(const std::string& path) {
+    Entry entry;
+    uint64_t generation;
+    if (Lookup(path, &entry, &generation)) {
+        return entry.exists ? SDFS_EXISTS : SDFS_DOESNT_EXIST;
+    }
+    int value;
+    {
+        SdfsOpTimer timer(io_stats_, SdfsIOStats::kExists);
+        value = sdfsExists(fileSys_, path.c_str());
+        if (value != SDFS_EXISTS && value != SDFS_DOESNT_EXIST) {
+            timer.SetFailed();
+        }
+    }
+    if (value == SDFS_EXISTS || value == SDFS_DOESNT_EXIST) {
+        entry.exists = (value == SDFS_EXISTS);
+        entry.has_info = false;
+        Insert(path, entry, generation);
+    }
+    return value;
+}
+
+int SdfsMetadataCache::GetPathInfo(const std::string& path,
+                                   sdfsFileInfo* info) {
+    Entry entry;
+    uint64_t generation;
+    if (Lookup(path, &entry, &generation)) {
+        if (!entry.exists) {
+            errno = ENOENT;
+            return -1;
+        }
+        if (entry.has_info) {
+            *info = entry.info;
+            return 0;
+        }
+    }
+    int code;
+    int err;
+    {
+        SdfsOpTimer timer(io_stats_, SdfsIOStats::kGetPathInfo);
+        code = sdfsGetPathInfo(fileSys_, path.c_str(), info);
+        err = errno;
+        if (code != 0 && err != ENOENT) {
+            timer.SetFailed();
+        }
+    }
+    if (code == 0) {
+        entry.exists = true;
+        entry.has_info = true;
+        entry.info = *info;
+        Insert(path, entry, generation);
+    } else {
+        // Callers report errno, which recording the call may have changed.
+        errno = err;
+    }
+    return code;
+}
+
+void SdfsMetadataCache::AddExisting(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (ttl_micros_ == 0 || entries_.count(path) > 0) {
+        // Never override what we already know. In particular the listing
+        // may predate a delete issued through this env.
+        return;
+    }
+    Entry entry;
+    entry.exists = true;
+    entry.has_info = false;
+    InsertLocked(path, entry);
+}
+
+void SdfsMetadataCache::AddDeleted(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mu_);
+    generation_++;
+    if (ttl_micros_ == 0) {
+        return;
+    }
+    Entry entry;
+    entry.exists = false;
+    entry.has_info = false;
+    InsertLocked(path, entry);
+}
+
+void SdfsMetadataCache::Invalidate(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mu_);
+    generation_++;
+    entries_.erase(path);
+}
+
+void SdfsMetadataCache::InvalidateTree(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mu_);
+    generation_++;
+    entries_.erase(path);
+    const std::string prefix = path + "/";
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->first.compare(0, prefix.size(), prefix) == 0) {
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void SdfsMetadataCache::SetTTL(uint64_t ttl_micros) {
+    std::lock_guard<std::mutex> lock(mu_);
+    generation_++;
+    ttl_micros_ = ttl_micros;
+    entries_.clear();
+}
+
+bool SdfsMetadataCache::Lookup(const std::string& path, Entry* entry,
+                               uint64_t* generation) {
+    std::lock_guard<std::mutex> lock(mu_);
+    *generation = generation_;
+    auto it = entries_.find(path);
+    if (it == entries_.end()) {
+        return false;
+    }
+    if (it->second.expire_micros <= clock_->NowMicros()) {
+        entries_.erase(it);
+        return false;
+    }
+    *entry = it->second;
+    return true;
+}
+
+void SdfsMetadataCache::Insert(const std::string& path, const Entry& entry,
+                               uint64_t generation) {
+    std::lock_guard<std::mutex> lock(mu_);
+    // Something was changed through this env while the name node was being
+    // asked, so the answer may already be stale.
+    if (ttl_micros_ == 0 || generation != generation_) {
+        return;
+    }
+    InsertLocked(path, entry);
+}
+
+void SdfsMetadataCache::InsertLocked(const std::string& path,
+                                     const Entry& entry) {
+    if (entries_.size() >= kMaxEntries) {
+        entries_.clear();
+    }
+    Entry& e = entries_[path];
+    e = entry;
+    e.expire_micros = clock_->NowMicros() + ttl_micros_;
+}
+
 const std::string SdfsEnv::kProto = "sdfs:";
 const std::string SdfsEnv::pathsep = "/";
 
-SdfsEnv::SdfsEnv(const std::string& fsname) {
+SdfsEnv::SdfsEnv(const std::string& fsname)
+    : multi_read_threads_(kDefaultMultiReadThreads),
+      pipelined_writes_(false) {
     (void)fsname;
     posixEnv = Env::Default();
     fileSys_ = connectToPath(fsname_);
+    io_stats_.reset(new SdfsIOStats(posixEnv));
+    metadata_cache_.reset(new SdfsMetadataCache(
+        fileSys_, posixEnv, kDefaultMetadataCacheTTLMicros, io_stats_.get()));
+#ifndef SDFS_LOCAL
     GoSdfsInit();
+#endif
 }
 
 SdfsEnv::~SdfsEnv() {
     fprintf(stderr, "Destroying HdfsEnv::Default()\n");
+    if (read_pool_ != nullptr) {
+        read_pool_->JoinAllThreads();
+    }
+    if (write_pool_ != nullptr) {
+        write_pool_->JoinAllThreads();
+    }
     sdfsDisconnect(fileSys_);
 }
 
+void SdfsEnv::SetMultiReadThreads(int num) {
+    std::lock_guard<std::mutex> lock(pool_mu_);
+    multi_read_threads_ = num;
+    if (read_pool_ != nullptr) {
+        read_pool_->SetBackgroundThreads(num);
+    }
+}
+
+ThreadPool* SdfsEnv::GetMultiReadPool() {
+    std::lock_guard<std::mutex> lock(pool_mu_);
+    if (read_pool_ == nullptr) {
+        read_pool_.reset(NewThreadPool(multi_read_threads_));
+    }
+    return read_pool_.get();
+}
+
+void SdfsEnv::SetPipelinedWrites(bool pipelined) {
+    std::lock_guard<std::mutex> lock(pool_mu_);
+    if (pipelined && write_pool_ == nullptr) {
+        write_pool_.reset(NewThreadPool(kPipelinedWriteThreads));
+    }
+    pipelined_writes_ = pipelined;
+}
+
 Status SdfsEnv::NewSequentialFile(const std::string& fname,
                                   unique_ptr<SequentialFile>* result,
                                   const EnvOptions& options) {
     (void)options;
     result->reset();
-    SdfsReadableFile* f = new SdfsReadableFile(fileSys_, fname);
+    SdfsReadableFile* f = new SdfsReadableFile(fileSys_, fname, nullptr,
+                                               metadata_cache_.get(),
+                                               io_stats_.get());
     if (f == nullptr || !f->isValid()) {
+        int err = (f != nullptr) ? f->open_errno() : ENOMEM;
         delete f;
         *result = nullptr;
-        return IOError(fname, errno);
+        return IOError(fname, err);
     }
     result->reset(dynamic_cast<SequentialFile*>(f));
     return Status::OK();
@@ -371,11 +935,14 @@ Status SdfsEnv::NewRandomAccessFile(const std::string& fname,
                                     const EnvOptions& options) {
     (void)options;
     result->reset();
-    SdfsReadableFile* f = new SdfsReadableFile(fileSys_, fname);
+    SdfsReadableFile* f = new SdfsReadableFile(fileSys_, fname, this,
+                                               metadata_cache_.get(),
+                                               io_stats_.get());
     if (f == nullptr || !f->isValid()) {
+        int err = (f != nullptr) ? f->open_errno() : ENOMEM;
         delete f;
         *result = nullptr;
-        return IOError(fname, errno);
+        return IOError(fname, err);
     }
     result->reset(dynamic_cast<RandomAccessFile*>(f));
     return Status::OK();
@@ -384,14 +951,20 @@ Status SdfsEnv::NewRandomAccessFile(const std::string& fname,
 Status SdfsEnv::NewWritableFile(const std::string& fname,
                                 unique_ptr<WritableFile>* result,
                                 const EnvOptions& options) {
-    (void)options;
     result->reset();
-    Status s;
-    SdfsWritableFile* f = new SdfsWritableFile(fileSys_, fname);
+    size_t buffer_size = options.writable_file_max_buffer_size > 0 ?
+        options.writable_file_max_buffer_size : kSdfsDefaultWriteBufferSize;
+    SdfsWritableFile* f = new SdfsWritableFile(fileSys_, fname, buffer_size,
+                                               pipelined_writes_ ?
+                                                   write_pool_.get() : nullptr,
+                                               metadata_cache_.get(),
+                                               io_stats_.get());
+    metadata_cache_->Invalidate(fname);
     if (f == nullptr || !f->isValid()) {
+        int err = (f != nullptr) ? f->open_errno() : ENOMEM;
         delete f;
         *result = nullptr;
-        return IOError(fname, errno);
+        return IOError(fname, err);
     }
     result->reset(dynamic_cast<WritableFile*>(f));
     return Status::OK();
@@ -410,7 +983,7 @@ class SdfsDirectory : public Directory {
 
 Status SdfsEnv::NewDirectory(const std::string& name,
                              unique_ptr<Directory>* result) {
-    int value = sdfsExists(fileSys_, name.c_str());
+    int value = metadata_cache_->Exists(name);
     switch (value) {
         case SDFS_EXISTS:
             result->reset(new SdfsDirectory(0));
@@ -424,7 +997,7 @@ Status SdfsEnv::NewDirectory(const std::string& name,
 }
 
 Status SdfsEnv::FileExists(const std::string& fname) {
-    int value = sdfsExists(fileSys_, fname.c_str());
+    int value = metadata_cache_->Exists(fname);
     switch (value) {
         case SDFS_EXISTS:
             return Status::OK();
@@ -439,7 +1012,8 @@ Status SdfsEnv::FileExists(const std::string& fname) {
 
 Status SdfsEnv::GetChildren(const std::string& path,
                             std::vector<std::string>* result) {
-    int value = sdfsExists(fileSys_, path.c_str());
+    result->clear();
+    int value = metadata_cache_->Exists(path);
     switch (value) {
         case SDFS_EXISTS: {  
             int numEntries;
@@ -451,14 +1025,13 @@ Status SdfsEnv::GetChildren(const std::string& path,
                     char* filename = rindex(pathname, '/');
                     if (filename != nullptr) {
                         result->push_back(filename+1);
+                        metadata_cache_->AddExisting(pathname);
                     }
                 }
                 sdfsFreeArr(inodePathArr, numEntries);
             } else {
-
-                ROCKS_LOG_FATAL(mylog, "sdfsListDirectory call failed with error ");
-                throw SdfsFatalException(
-                    "sdfsListDirectory call failed negative error.\n");
+                // E.g. path is a file rather than a directory.
+                return IOError(path, errno);
             }
             break;
         }
@@ -473,21 +1046,29 @@ Status SdfsEnv::GetChildren(const std::string& path,
 }
 
 Status SdfsEnv::DeleteFile(const std::string& fname) {
-    if (sdfsDelete(fileSys_, fname.c_str(), 1) == 0) {
+    int code = sdfsDelete(fileSys_, fname.c_str(), 1);
+    int err = errno;
+    // The delete is recursive, so drop whatever was cached below fname.
+    metadata_cache_->InvalidateTree(fname);
+    if (code == 0) {
+        metadata_cache_->AddDeleted(fname);
         return Status::OK();
     }
-    return IOError(fname, errno);
+    return IOError(fname, err);
 };
 
 Status SdfsEnv::CreateDir(const std::string& name) {
-    if (sdfsCreateDirectory(fileSys_, name.c_str()) == 0) {
+    int code = sdfsCreateDirectory(fileSys_, name.c_str());
+    int err = errno;
+    metadata_cache_->Invalidate(name);
+    if (code == 0) {
         return Status::OK();
     }
-    return IOError(name, errno);
+    return IOError(name, err);
 };
 
 Status SdfsEnv::CreateDirIfMissing(const std::string& name) {
-    const int value = sdfsExists(fileSys_, name.c_str());
+    const int value = metadata_cache_->Exists(name);
 
     switch (value) {
         case SDFS_EXISTS:
@@ -508,7 +1089,7 @@ Status SdfsEnv::DeleteDir(const std::string& name) {
 Status SdfsEnv::GetFileSize(const std::string& fname, uint64_t* size) {
     *size = 0L;
     sdfsFileInfo pFileInfo;
-    int code = sdfsGetPathInfo(fileSys_, fname.c_str(), &pFileInfo);
+    int code = metadata_cache_->GetPathInfo(fname, &pFileInfo);
     if (code == 0) {
         *size = pFileInfo.mSize;
         return Status::OK();
@@ -519,7 +1100,7 @@ Status SdfsEnv::GetFileSize(const std::string& fname, uint64_t* size) {
 Status SdfsEnv::GetFileModificationTime(const std::string& fname,
                                         uint64_t* time) {
     sdfsFileInfo pFileInfo;
-    int code = sdfsGetPathInfo(fileSys_, fname.c_str(), &pFileInfo);
+    int code = metadata_cache_->GetPathInfo(fname, &pFileInfo);
     if (code == 0) {
         *time = static_cast<uint64_t>(pFileInfo.mLastMod);
         return Status::OK();
@@ -530,10 +1111,28 @@ Status SdfsEnv::GetFileModificationTime(const std::string& fname,
 
 Status SdfsEnv::RenameFile(const std::string& src, const std::string& target) {
     sdfsDelete(fileSys_, target.c_str(), 1);
-    if (sdfsRename(fileSys_, src.c_str(), target.c_str()) == 0) {
+    int code = sdfsRename(fileSys_, src.c_str(), target.c_str());
+    int err = errno;
+    metadata_cache_->InvalidateTree(src);
+    metadata_cache_->InvalidateTree(target);
+    if (code == 0) {
+        metadata_cache_->AddDeleted(src);
         return Status::OK();
     }
-    return IOError(src, errno);
+    return IOError(src, err);
+}
+
+Status SdfsEnv::CopyFile(const std::string& src, const std::string& target) {
+    int code = sdfsCopy(fileSys_, src.c_str(), fileSys_, target.c_str());
+    int err = errno;
+    metadata_cache_->Invalidate(target);
+    if (code == 0) {
+        return Status::OK();
+    }
+    if (err == ENOTSUP) {
+        return Status::NotSupported("sdfsCopy", src);
+    }
+    return IOError(src, err);
 }
 
 Status SdfsEnv::LockFile(const std::string& fname, FileLock** lock) {
@@ -549,11 +1148,15 @@ Status SdfsEnv::UnlockFile(FileLock* lock) {
 
 Status SdfsEnv::NewLogger(const std::string& fname,
                           shared_ptr<Logger>* result) {
-    SdfsWritableFile* f = new SdfsWritableFile(fileSys_, fname);
+    SdfsWritableFile* f = new SdfsWritableFile(fileSys_, fname, 0, nullptr,
+                                               metadata_cache_.get(),
+                                               io_stats_.get());
+    metadata_cache_->Invalidate(fname);
     if (f == nullptr || !f->isValid()) {
+        int err = (f != nullptr) ? f->open_errno() : ENOMEM;
         delete f;
         *result = nullptr;
-        return IOError(fname, errno);
+        return IOError(fname, err);
     }
     SdfsLogger* h = new SdfsLogger(f, &SdfsEnv::gettid);
     result->reset(h);
@@ -567,6 +1170,16 @@ Status NewSdfsEnv(Env** sdfs_env, const std::string& fsname) {
     *sdfs_env = new SdfsEnv(fsname);
     return Status::OK();
 }
+
+#ifndef ROCKSDB_LITE
+// Lets tools select the env with --env_uri=sdfs://host:port/ and tests run
+// against it with TEST_ENV_URI.
+static Registrar<Env> sdfs_reg(
+    "sdfs://.*", [](const std::string& uri, std::unique_ptr<Env>* env_guard) {
+        env_guard->reset(new SdfsEnv(uri));
+        return env_guard->get();
+    });
+#endif  // ROCKSDB_LITE
 }  
 
 #endif 
@@ -843,6 +843,48 @@ TEST_F(EnvPosixTest, PositionedAppend) {
 }
 #endif  // !ROCKSDB_LITE
 
+TEST_F(EnvPosixTest, MultiRead) {
+  EnvOptions soptions;
+  std::string fname = test::PerThreadDBPath(env_, "testfile");
+  const size_t kFileSize = 64 * 1024;
+  std::string data;
+  Random rnd(301);
+  test::RandomString(&rnd, static_cast<int>(kFileSize), &data);
+  {
+    std::unique_ptr<WritableFile> wfile;
+    ASSERT_OK(env_->NewWritableFile(fname, &wfile, soptions));
+    ASSERT_OK(wfile->Append(data));
+    ASSERT_OK(wfile->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile(fname, &file, soptions));
+
+  // Two adjacent requests, one isolated request, and an adjacent pair that
+  // runs past the end of the file.
+  const uint64_t kOffsets[] = {0, 4096, 20000, kFileSize - 4096,
+                               kFileSize - 100};
+  const size_t kLens[] = {4096, 8192, 100, 3996, 200};
+  const size_t kNumReqs = sizeof(kOffsets) / sizeof(kOffsets[0]);
+  std::vector<std::unique_ptr<char[]>> scratches;
+  ReadRequest reqs[kNumReqs];
+  for (size_t i = 0; i < kNumReqs; ++i) {
+    scratches.emplace_back(new char[kLens[i]]);
+    reqs[i].offset = kOffsets[i];
+    reqs[i].len = kLens[i];
+    reqs[i].scratch = scratches.back().get();
+  }
+  ASSERT_OK(file->MultiRead(reqs, kNumReqs));
+  for (size_t i = 0; i < kNumReqs; ++i) {
+    ASSERT_OK(reqs[i].status);
+    size_t expected_len =
+        std::min(kLens[i], kFileSize - static_cast<size_t>(kOffsets[i]));
+    ASSERT_EQ(expected_len, reqs[i].result.size());
+    ASSERT_EQ(Slice(data.data() + kOffsets[i], expected_len), reqs[i].result);
+  }
+  ASSERT_OK(env_->DeleteFile(fname));
+}
+
 // Only works in linux platforms
 TEST_P(EnvPosixTestWithParam, RandomAccessUniqueID) {
   // Create file.
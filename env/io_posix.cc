@@ -22,6 +22,7 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #ifdef OS_LINUX
 #include <sys/statfs.h>
 #include <sys/syscall.h>
@@ -356,6 +357,61 @@ Status PosixRandomAccessFile::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+Status PosixRandomAccessFile::MultiRead(ReadRequest* reqs, size_t num_reqs) {
+#ifdef OS_LINUX
+  if (use_direct_io()) {
+    return RandomAccessFile::MultiRead(reqs, num_reqs);
+  }
+  // Requests that are adjacent in the file are served by a single preadv()
+  // call, everything else by one pread() each.
+  static const size_t kMaxIovecs = 64;
+  struct iovec iov[kMaxIovecs];
+  size_t i = 0;
+  while (i < num_reqs) {
+    size_t end = i + 1;
+    uint64_t next_offset = reqs[i].offset + reqs[i].len;
+    while (end < num_reqs && end - i < kMaxIovecs &&
+           reqs[end].offset == next_offset) {
+      next_offset += reqs[end].len;
+      ++end;
+    }
+    bool done = false;
+    if (end - i > 1) {
+      size_t total = 0;
+      for (size_t j = i; j < end; ++j) {
+        iov[j - i].iov_base = reqs[j].scratch;
+        iov[j - i].iov_len = reqs[j].len;
+        total += reqs[j].len;
+      }
+      ssize_t r;
+      do {
+        r = preadv(fd_, iov, static_cast<int>(end - i),
+                   static_cast<off_t>(reqs[i].offset));
+      } while (r == -1 && errno == EINTR);
+      if (r == static_cast<ssize_t>(total)) {
+        for (size_t j = i; j < end; ++j) {
+          reqs[j].result = Slice(reqs[j].scratch, reqs[j].len);
+          reqs[j].status = Status::OK();
+        }
+        done = true;
+      }
+      // Otherwise we hit EOF or an error; let Read() work out the result
+      // of each request.
+    }
+    if (!done) {
+      for (size_t j = i; j < end; ++j) {
+        reqs[j].status =
+            Read(reqs[j].offset, reqs[j].len, &reqs[j].result, reqs[j].scratch);
+      }
+    }
+    i = end;
+  }
+  return Status::OK();
+#else
+  return RandomAccessFile::MultiRead(reqs, num_reqs);
+#endif
+}
+
 Status PosixRandomAccessFile::Prefetch(uint64_t offset, size_t n) {
   Status s;
   if (!use_direct_io()) {
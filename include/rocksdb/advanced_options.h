@@ -271,9 +271,13 @@ struct AdvancedColumnFamilyOptions {
                                    Slice delta_value,
                                    std::string* merged_value) = nullptr;
 
-  // if prefix_extractor is set and memtable_prefix_bloom_size_ratio is not 0,
-  // create prefix bloom for memtable with the size of
+  // if prefix_extractor or memtable_whole_key_filtering is set and
+  // memtable_prefix_bloom_size_ratio is not 0, create a bloom filter for
+  // memtable with the size of
   // write_buffer_size * memtable_prefix_bloom_size_ratio.
+  // It holds the prefixes of the keys, the whole keys with
+  // memtable_whole_key_filtering, or both, and also serves Get() with the
+  // latter.
   // If it is larger than 0.25, it is sanitized to 0.25.
   //
   // Default: 0 (disable)
@@ -281,6 +285,17 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   double memtable_prefix_bloom_size_ratio = 0.0;
 
+  // Enable whole key bloom filter in memtable. Note this will only take effect
+  // if memtable_prefix_bloom_size_ratio is not 0. Enabling whole key filtering
+  // can potentially reduce CPU usage for point-look-ups, as Get() misses skip
+  // searching the memtable. It works with or without a prefix_extractor;
+  // with one, the bloom holds both the prefixes and the whole keys.
+  //
+  // Default: false (disable)
+  //
+  // Dynamically changeable through SetOptions() API
+  bool memtable_whole_key_filtering = false;
+
   // Page size for huge page for the arena used by the memtable. If <=0, it
   // won't allocate from huge page but from malloc.
   // Users are responsible to reserve huge pages for it to be allocated. For
@@ -23,8 +23,10 @@
 #pragma once
 
 #include <stdint.h>
+#include <functional>
 #include <memory>
 #include <string>
+#include "rocksdb/compression_type.h"
 #include "rocksdb/memory_allocator.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/statistics.h"
@@ -68,6 +70,33 @@ struct LRUCacheOptions {
   // internally (currently only XPRESS).
   std::shared_ptr<MemoryAllocator> memory_allocator;
 
+  // If greater than zero, entries inserted with Cache::InsertSaveable() are
+  // not dropped when evicted for lack of space. Their contents are
+  // compressed with compressed_secondary_cache_compression and kept in a
+  // secondary in-memory tier of this many bytes, from where
+  // Cache::LookupSecondary() gets them back. The block-based table inserts
+  // its data blocks this way, so the secondary tier holds several times more
+  // blocks than the same memory would hold uncompressed, while the blocks
+  // that are hit most stay uncompressed in the cache itself.
+  //
+  // The capacity of the secondary tier is in addition to capacity.
+  size_t compressed_secondary_cache_capacity = 0;
+
+  // Compression used by the secondary tier. Snappy, zlib, LZ4, LZ4HC and
+  // ZSTD are supported. With any other type, or one not linked into this
+  // build, entries are kept uncompressed.
+  CompressionType compressed_secondary_cache_compression = kLZ4Compression;
+
+  // If true, each shard keeps a small sketch of how often keys were looked
+  // up or inserted recently (TinyLFU). When an insert would evict an entry,
+  // the new entry is admitted only if its key was accessed more often than
+  // that of the entry it would evict. Otherwise it is dropped at once, or if
+  // the caller asked for a handle to it, it is inserted at the tail of the
+  // LRU list when released and so is evicted next unless it gets hit. This
+  // keeps one-off reads such as long range scans from flushing out the
+  // entries that are used over and over.
+  bool frequency_based_admission = false;
+
   LRUCacheOptions() {}
   LRUCacheOptions(size_t _capacity, int _num_shard_bits,
                   bool _strict_capacity_limit, double _high_pri_pool_ratio,
@@ -98,17 +127,38 @@ extern std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts);
 // better concurrent performance in some cases. See util/clock_cache.cc for
 // more detail.
 //
-// Return nullptr if it is not supported.
+// Return nullptr if it is not supported, i.e. in ROCKSDB_LITE builds.
 extern std::shared_ptr<Cache> NewClockCache(size_t capacity,
                                             int num_shard_bits = -1,
                                             bool strict_capacity_limit = false);
 
+// Quota of a group of cache entries, see Cache::SetQuota().
+struct CacheQuota {
+  // The entries of the group are not evicted to make room for entries of
+  // other groups while the group uses this many bytes or less.
+  size_t reservation = 0;
+
+  // The most bytes the entries of the group may use. Once it is reached,
+  // room for a new entry of the group is made by evicting the least recently
+  // used entries of the group itself. If that is not enough, because they
+  // are in use, the new entry is dropped as soon as it is released.
+  // 0 means no limit.
+  size_t limit = 0;
+
+  CacheQuota() {}
+  CacheQuota(size_t _reservation, size_t _limit)
+      : reservation(_reservation), limit(_limit) {}
+};
+
 class Cache {
  public:
   // Depending on implementation, cache entries with high priority could be less
   // likely to get evicted than low priority entries.
   enum class Priority { HIGH, LOW };
 
+  // Quota group of entries inserted without one.
+  static const uint32_t kNoQuotaGroup = 0;
+
   Cache(std::shared_ptr<MemoryAllocator> allocator = nullptr)
       : memory_allocator_(std::move(allocator)) {}
 
@@ -144,6 +194,38 @@ class Cache {
                         Handle** handle = nullptr,
                         Priority priority = Priority::LOW) = 0;
 
+  // Same as Insert(), but if the cache has a secondary tier (see
+  // LRUCacheOptions::compressed_secondary_cache_capacity) and evicts the
+  // entry for lack of space, it keeps the bytes save_cb returns for the
+  // value in that tier before calling "deleter". The bytes must be enough
+  // for the caller to rebuild the value after LookupSecondary(). save_cb may
+  // be nullptr for values that are not worth keeping.
+  //
+  // The entry is charged to quota_group, see GetQuotaGroup().
+  //
+  // The default implementation ignores save_cb and quota_group.
+  virtual Status InsertSaveable(const Slice& key, void* value, size_t charge,
+                                void (*deleter)(const Slice& key, void* value),
+                                Slice (* /*save_cb*/)(void* value),
+                                Handle** handle = nullptr,
+                                Priority priority = Priority::LOW,
+                                uint32_t /*quota_group*/ = kNoQuotaGroup) {
+    return Insert(key, value, charge, deleter, handle, priority);
+  }
+
+  // Look up "key" in the secondary tier, after Lookup() missed. On a hit,
+  // the entry leaves the secondary tier and its saved bytes, uncompressed,
+  // are returned in *data and *size. The caller is expected to rebuild the
+  // value and insert it again with InsertSaveable().
+  //
+  // The default implementation, for caches without a secondary tier, always
+  // returns false.
+  virtual bool LookupSecondary(const Slice& /*key*/,
+                               std::unique_ptr<char[]>* /*data*/,
+                               size_t* /*size*/) {
+    return false;
+  }
+
   // If the cache has no mapping for "key", returns nullptr.
   //
   // Else return a handle that corresponds to the mapping.  The caller
@@ -230,6 +312,49 @@ class Cache {
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) = 0;
 
+  // Apply callback to the key, charge and priority of all entries in the
+  // cache, with the same locking as ApplyToAllCacheEntries. The keys are only
+  // valid during the callback. The default implementation does nothing.
+  virtual void ApplyToAllCacheKeys(
+      const std::function<void(const Slice& key, size_t charge,
+                               Priority priority)>& /*callback*/,
+      bool /*thread_safe*/) {}
+
+  // Quota groups share a cache between several users, such as the column
+  // families of a DB, while keeping any of them from flushing out the
+  // entries of the others. Each group has a reservation and a limit, see
+  // CacheQuota, which are split evenly between the shards of the cache like
+  // its capacity. A group may have a parent group: its entries are then
+  // charged to the parent as well, and the quota of the parent applies to
+  // them too. When a parent reaches its limit, room is made by evicting
+  // entries of the inserting group first, then of its siblings.
+  //
+  // Returns the id of the group called "name", creating it with no
+  // reservation or limit under the given parent if it does not exist yet.
+  // parent must not have a parent itself. A group that only SetQuota() has
+  // created so far is moved under parent. Returns kNoQuotaGroup if the group
+  // exists under another parent, or if the cache does not support quotas.
+  // The default implementation does not.
+  virtual uint32_t GetQuotaGroup(const std::string& /*name*/,
+                                 uint32_t /*parent*/ = kNoQuotaGroup) {
+    return kNoQuotaGroup;
+  }
+
+  // Set the quota of the group called "name", creating it without a parent
+  // if it does not exist yet. When the limit is lowered, entries of the
+  // group that are not in use are evicted down to it.
+  virtual Status SetQuota(const std::string& /*name*/,
+                          const CacheQuota& /*quota*/) {
+    return Status::NotSupported("Quotas are not supported by this cache.");
+  }
+
+  // If a group called "name" exists, return its quota in *quota and the
+  // memory size of its entries in *usage. Otherwise return false.
+  virtual bool GetQuota(const std::string& /*name*/, CacheQuota* /*quota*/,
+                        size_t* /*usage*/) const {
+    return false;
+  }
+
   // Remove all entries.
   // Prerequisite: no entry is referenced.
   virtual void EraseUnRefEntries() = 0;
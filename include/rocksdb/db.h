@@ -628,9 +628,37 @@ class DB {
     //      entries being pinned.
     static const std::string kBlockCachePinnedUsage;
 
+    // "rocksdb.block-cache-miss-ratio-curve" - returns the estimated miss
+    //      ratio of the block cache for capacities from 1/8 to 8 times the
+    //      current one, one "<capacity> <miss ratio>" line per capacity, or
+    //      as a map from capacity to miss ratio. Only available when the
+    //      block cache is a SimCache, see SimCache::GetEstimatedMissRatio().
+    static const std::string kBlockCacheMissRatioCurve;
+
+    // "rocksdb.block-cache-quota" - returns the usage, reservation and limit
+    //      of the block cache quota groups of the column family and of its
+    //      index, filter and data blocks, one line per group. As a map, the
+    //      keys are "usage", "reservation", "limit", "index.usage",
+    //      "index.reservation" and so on. Only available when
+    //      BlockBasedTableOptions::block_cache_quota_group is set.
+    static const std::string kBlockCacheQuota;
+
+    // "rocksdb.memory-budget" - returns the memory charged to
+    //      DBOptions::memory_budget_cache, one "<name>: <bytes>" line per
+    //      entry. As a map, the keys are "memtables", "table-readers",
+    //      "iterator-blocks", "compaction-buffers", "reserved" (the charge of
+    //      the dummy entries for all but the memtables), "cache-capacity" and
+    //      "cache-usage". Only available when memory_budget_cache is set.
+    static const std::string kMemoryBudget;
+
     // "rocksdb.options-statistics" - returns multi-line string
     //      of options.statistics
     static const std::string kOptionsStatistics;
+
+    // "rocksdb.env-io-stats" - returns multi-line string summarizing the
+    //      I/O issued by the DB's Env, see Env::GetIOStats(). Not available
+    //      for Envs that do not collect such stats.
+    static const std::string kEnvIOStats;
   };
 #endif /* ROCKSDB_LITE */
 
@@ -286,6 +286,16 @@ class Env {
     return Status::NotSupported("LinkFile is not supported for this Env");
   }
 
+  // Copy file src to target without moving the data through this process,
+  // e.g. with a server-side copy on a remote file system. On success target
+  // is as durable as a synced file. Returns NotSupported if the Env cannot
+  // do better than reading and rewriting the file; callers are expected to
+  // fall back to that.
+  virtual Status CopyFile(const std::string& /*src*/,
+                          const std::string& /*target*/) {
+    return Status::NotSupported("CopyFile is not supported for this Env");
+  }
+
   virtual Status NumFileLinks(const std::string& /*fname*/,
                               uint64_t* /*count*/) {
     return Status::NotSupported(
@@ -487,6 +497,14 @@ class Env {
     return Status::NotSupported();
   }
 
+  // Returns a human-readable summary of the I/O this Env has issued to its
+  // storage, such as per-operation call counts and latencies. Envs backed
+  // by remote storage use this to tell storage latency apart from time
+  // spent in RocksDB. Exported as the "rocksdb.env-io-stats" DB property.
+  virtual Status GetIOStats(std::string* /*stats*/) {
+    return Status::NotSupported("GetIOStats is not supported for this Env");
+  }
+
  protected:
   // The pointer to an internal structure that will update the
   // status of each thread.
@@ -551,6 +569,26 @@ class SequentialFile {
   }
 };
 
+// A read IO request structure for use in MultiRead
+struct ReadRequest {
+  // File offset in bytes
+  uint64_t offset;
+
+  // Length to read in bytes
+  size_t len;
+
+  // A buffer that MultiRead() can optionally place data in. It can
+  // ignore this and allocate its own buffer
+  char* scratch;
+
+  // Output parameter set by MultiRead() to point to the data buffer, and
+  // the number of valid bytes
+  Slice result;
+
+  // Status of read
+  Status status;
+};
+
 // A file abstraction for randomly reading the contents of a file.
 class RandomAccessFile {
  public:
@@ -571,6 +609,22 @@ class RandomAccessFile {
   virtual Status Read(uint64_t offset, size_t n, Slice* result,
                       char* scratch) const = 0;
 
+  // Read a bunch of blocks as described by reqs. The blocks can
+  // optionally be read in parallel. This is a synchronous call, i.e it
+  // should return after all reads have completed. The reads will be
+  // non-overlapping. If the function return Status is not ok, status of
+  // individual requests will be ignored and return status will be assumed
+  // for all read requests. The function return status is only meant for any
+  // errors that occur before even processing specific read requests
+  virtual Status MultiRead(ReadRequest* reqs, size_t num_reqs) {
+    assert(reqs != nullptr);
+    for (size_t i = 0; i < num_reqs; ++i) {
+      ReadRequest& req = reqs[i];
+      req.status = Read(req.offset, req.len, &req.result, req.scratch);
+    }
+    return Status::OK();
+  }
+
   // Readahead the file starting from offset by n bytes for caching.
   virtual Status Prefetch(uint64_t /*offset*/, size_t /*n*/) {
     return Status::OK();
@@ -1088,6 +1142,10 @@ class EnvWrapper : public Env {
     return target_->LinkFile(s, t);
   }
 
+  Status CopyFile(const std::string& s, const std::string& t) override {
+    return target_->CopyFile(s, t);
+  }
+
   Status NumFileLinks(const std::string& fname, uint64_t* count) override {
     return target_->NumFileLinks(fname, count);
   }
@@ -1173,6 +1231,10 @@ class EnvWrapper : public Env {
     return target_->GetThreadList(thread_list);
   }
 
+  Status GetIOStats(std::string* stats) override {
+    return target_->GetIOStats(stats);
+  }
+
   ThreadStatusUpdater* GetThreadStatusUpdater() const override {
     return target_->GetThreadStatusUpdater();
   }
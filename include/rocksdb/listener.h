@@ -112,6 +112,7 @@ enum class BackgroundErrorReason {
   kCompaction,
   kWriteCallback,
   kMemTable,
+  kWALSync,
 };
 
 enum class WriteStallCondition {
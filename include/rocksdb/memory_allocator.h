@@ -74,4 +74,43 @@ extern Status NewJemallocNodumpAllocator(
     JemallocAllocatorOptions& options,
     std::shared_ptr<MemoryAllocator>* memory_allocator);
 
+struct HugePageAllocatorOptions {
+  // Memory the allocator maps up front for the blocks it serves. Once it is
+  // all in use, and for blocks larger than max_pooled_allocation_size,
+  // allocations fall back to the default allocator. Required.
+  size_t capacity = 0;
+
+  // Size of the pages backing the memory, which is carved into slabs of one
+  // page that each hold blocks of a single size class.
+  size_t page_size = 2 << 20;
+
+  // If true, each slab is first taken from the explicitly reserved huge
+  // pages (MAP_HUGETLB, see /proc/sys/vm/nr_hugepages), then from
+  // transparent huge pages once those run out. If false, only transparent
+  // huge pages are requested, with madvise(MADV_HUGEPAGE).
+  bool use_explicit_huge_pages = false;
+
+  // If true, capacity is split evenly between the NUMA nodes of the host,
+  // each part preferring the memory of its node, and a block is allocated
+  // from the part of the node of the CPU that allocates it. Requires
+  // building with NUMA.
+  bool numa_aware = false;
+
+  // Larger blocks are not pooled.
+  size_t max_pooled_allocation_size = 256 * 1024;
+};
+
+// Generate a memory allocator that serves cache blocks from memory backed
+// by huge pages, so that a large block cache needs far fewer TLB entries
+// than with 4KB pages. Blocks are rounded up to size classes eight per
+// doubling apart, so at most 1/8 of a block is wasted, and freed blocks are
+// reused for blocks of the same class. Memory is never returned to the
+// system, and a slab keeps its size class once used, so the allocator suits
+// a block cache that is kept full.
+//
+// Only available on Linux.
+extern Status NewHugePageAllocator(
+    const HugePageAllocatorOptions& options,
+    std::shared_ptr<MemoryAllocator>* memory_allocator);
+
 }  // namespace rocksdb
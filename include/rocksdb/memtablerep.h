@@ -20,6 +20,9 @@
 // Users can implement their own memtable representations. We include three
 // types built in:
 //  - SkipListRep: This is the default; it is backed by a skip list.
+//  - AdaptiveRadixTreeRep: This is backed by an adaptive radix tree over the
+//  user keys, for column families with the bytewise comparator. Point
+//  lookups take fewer cache misses than with a skip list.
 //  - HashSkipListRep: The memtable rep that is best used for keys that are
 //  structured like "prefix:suffix" where iteration within a prefix is
 //  common and iteration across different prefixes is rare. It is backed by
@@ -39,12 +42,14 @@
 #include <stdexcept>
 #include <stdint.h>
 #include <stdlib.h>
+#include <vector>
 #include <rocksdb/slice.h>
 
 namespace rocksdb {
 
 class Arena;
 class Allocator;
+class Comparator;
 class LookupKey;
 class SliceTransform;
 class Logger;
@@ -75,6 +80,10 @@ class MemTableRep {
     virtual int operator()(const char* prefix_len_key,
                            const Slice& key) const = 0;
 
+    // The comparator of the user keys, or nullptr if it is not known.
+    // Representations that order keys by their bytes check it.
+    virtual const Comparator* user_comparator() const { return nullptr; }
+
     virtual ~KeyComparator() { }
   };
 
@@ -172,6 +181,13 @@ class MemTableRep {
     return 0;
   }
 
+  // Appends about count entries of the collection, spread evenly over it, to
+  // entries in order. Used to split a flush into key ranges of similar
+  // sizes. Representations that cannot pick them without reading every
+  // entry append nothing, which is the default.
+  virtual void SampleEntries(size_t /*count*/,
+                             std::vector<const char*>* /*entries*/) const {}
+
   // Report an approximation of how much memory has been used other than memory
   // that was allocated through the allocator.  Safe to call from any thread.
   virtual size_t ApproximateMemoryUsage() = 0;
@@ -313,11 +329,17 @@ class SkipListFactory : public MemTableRepFactory {
 //   count: Passed to the constructor of the underlying std::vector of each
 //     VectorRep. On initialization, the underlying array will be at least count
 //     bytes reserved for usage.
+//   sort_threads: Maximum number of threads that sort the vector of an
+//     immutable memtable, which happens once, usually when it is flushed.
+//     Each thread sorts a chunk of the vector, then the sorted chunks are
+//     merged in parallel. Small vectors are sorted by fewer threads.
 class VectorRepFactory : public MemTableRepFactory {
   const size_t count_;
+  const size_t sort_threads_;
 
  public:
-  explicit VectorRepFactory(size_t count = 0) : count_(count) { }
+  explicit VectorRepFactory(size_t count = 0, size_t sort_threads = 1)
+      : count_(count), sort_threads_(sort_threads) { }
 
   using MemTableRepFactory::CreateMemTableRep;
   virtual MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&,
@@ -329,6 +351,28 @@ class VectorRepFactory : public MemTableRepFactory {
   }
 };
 
+// This creates MemTableReps that are backed by an adaptive radix tree over
+// the user keys, with the versions of each user key in a sorted list. It
+// supports ordered iteration and concurrent inserts, and point lookups
+// take fewer cache misses than with a skip list on large memtables. The
+// tree orders keys by their bytes: for column families with another
+// comparator, it creates a skip list instead.
+class AdaptiveRadixTreeRepFactory : public MemTableRepFactory {
+ public:
+  using MemTableRepFactory::CreateMemTableRep;
+  virtual MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&,
+                                         Allocator*, const SliceTransform*,
+                                         Logger* logger) override;
+
+  virtual const char* Name() const override {
+    return "AdaptiveRadixTreeRepFactory";
+  }
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+};
+
 // This class contains a fixed array of buckets, each
 // pointing to a skiplist (null if the bucket is empty).
 // bucket_count: number of fixed array buckets
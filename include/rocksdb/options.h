@@ -18,6 +18,7 @@
 
 #include "rocksdb/advanced_options.h"
 #include "rocksdb/comparator.h"
+#include "rocksdb/compression_type.h"
 #include "rocksdb/env.h"
 #include "rocksdb/listener.h"
 #include "rocksdb/universal_compaction.h"
@@ -49,33 +50,6 @@ class Statistics;
 class InternalKeyComparator;
 class WalFilter;
 
-// DB contents are stored in a set of blocks, each of which holds a
-// sequence of key,value pairs.  Each block may be compressed before
-// being stored in a file.  The following enum describes which
-// compression method (if any) is used to compress a block.
-enum CompressionType : unsigned char {
-  // NOTE: do not change the values of existing entries, as these are
-  // part of the persistent format on disk.
-  kNoCompression = 0x0,
-  kSnappyCompression = 0x1,
-  kZlibCompression = 0x2,
-  kBZip2Compression = 0x3,
-  kLZ4Compression = 0x4,
-  kLZ4HCCompression = 0x5,
-  kXpressCompression = 0x6,
-  kZSTD = 0x7,
-
-  // Only use kZSTDNotFinalCompression if you have to use ZSTD lib older than
-  // 0.8.0 or consider a possibility of downgrading the service or copying
-  // the database files to another service running with an older version of
-  // RocksDB that doesn't have kZSTD. Otherwise, you should use kZSTD. We will
-  // eventually remove the option from the public API.
-  kZSTDNotFinalCompression = 0x40,
-
-  // kDisableCompressionOption is used to disable some compression options.
-  kDisableCompressionOption = 0xff,
-};
-
 struct Options;
 struct DbPath;
 
@@ -551,6 +525,19 @@ struct DBOptions {
   // Default: 1 (i.e. no subcompactions)
   uint32_t max_subcompactions = 1;
 
+  // If greater than 1, a flush of memtables larger than 2MB may split their
+  // key range into up to this many partitions, which are written in
+  // parallel into L0 files that do not overlap, and are added to the LSM
+  // tree together. Each partition holds at least 1MB of memtable. The
+  // ranges are cut at keys sampled from the memtables, which only the
+  // default skip list memtable supports. Flushes of memtables that hold
+  // range deletions, atomic flushes and column families that do not use
+  // level compaction write a single file.
+  // Since each such flush adds several files to L0, level0 file number
+  // triggers may need to be raised accordingly.
+  // Default: 1 (i.e. no partitions)
+  uint32_t max_flush_partitions = 1;
+
   // NOT SUPPORTED ANYMORE: RocksDB automatically decides this based on the
   // value of max_background_jobs. For backwards compatibility we will set
   // `max_background_jobs = max_background_compactions + max_background_flushes`
@@ -857,7 +844,8 @@ struct DBOptions {
 
   // If true, allow multi-writers to update mem tables in parallel.
   // Only some memtable_factory-s support concurrent writes; currently it
-  // is implemented only for SkipListFactory.  Concurrent memtable writes
+  // is implemented for SkipListFactory, HashSkipListRepFactory and
+  // HashLinkListRepFactory.  Concurrent memtable writes
   // are not compatible with inplace_update_support or filter_deletes.
   // It is strongly recommended to set enable_write_thread_adaptive_yield
   // if you are going to use this feature.
@@ -1001,6 +989,72 @@ struct DBOptions {
   // Currently, any WAL-enabled writes after atomic flush may be replayed
   // independently if the process crashes later and tries to recover.
   bool atomic_flush = false;
+
+  // If true, the leader of a write group with WriteOptions::sync does not
+  // sync the WAL itself. Once the group is in the WAL, it hands the sync to a
+  // job on the thread pool of flushes, see max_background_flushes, and
+  // inserts the group into the memtables while the sync is in flight. A
+  // long flush on a single flush thread therefore delays the syncs. The
+  // group is only made visible to readers, and its writes only return, once
+  // the WAL is durable. This lowers the latency of synced writes when syncs
+  // are slow, e.g. on a remote file system such as SDFS.
+  //
+  // A failed background sync stops the DB with a hard background error,
+  // whether or not paranoid_checks is set. The option only applies to the
+  // default write path: it is ignored with enable_pipelined_write or
+  // two_write_queues, and when the WAL file does not support syncing
+  // concurrently with appends (see WritableFile::IsSyncThreadSafe()), in
+  // which cases the WAL is synced by the write group leader.
+  //
+  // DEFAULT: false
+  // Immutable.
+  bool background_wal_sync = false;
+
+  // If not empty, the keys of the data blocks of this DB that are in the
+  // block cache are saved to this file when the DB is closed, and every
+  // block_cache_dump_period_sec seconds if that is not 0. When the DB is
+  // opened and the file exists, a background thread reads the blocks it
+  // lists back into the block cache, so that the hit rate after a restart
+  // does not have to wait for reads to refill the cache. Only blocks of
+  // files that are still live are read. The file only lists keys, so it
+  // stays small compared to the cache.
+  //
+  // DEFAULT: ""
+  // Immutable.
+  std::string block_cache_dump_path = "";
+
+  // See block_cache_dump_path.
+  //
+  // DEFAULT: 0 (only dump on close)
+  // Immutable.
+  unsigned int block_cache_dump_period_sec = 0;
+
+  // Limits the rate at which blocks are read when warming the block cache up
+  // from block_cache_dump_path, so that the warm-up does not compete with
+  // the reads of the application for the device. 0 means no limit.
+  //
+  // DEFAULT: 0
+  // Immutable.
+  uint64_t block_cache_warmup_rate_bytes_per_sec = 0;
+
+  // If set, memory this DB allocates outside of its caches is charged to this
+  // cache as dummy entries, so that a single capacity, usually that of the
+  // block cache shared by the DB, bounds the total. The cache evicts other
+  // entries to make room for the charges; with strict_capacity_limit the
+  // charges stop growing once the cache is full, but the memory is still
+  // allocated. The charged memory is:
+  // - memtables, unless write_buffer_manager is set,
+  // - table readers of block-based tables, including the index and filter
+  //   blocks they hold when cache_index_and_filter_blocks is false,
+  // - data blocks held by iterators when they are not in the block cache,
+  //   including the ones pinned by a PinnedIteratorsManager,
+  // - an estimate of the read and write buffers of running compactions.
+  // The "rocksdb.memory-budget" property reports the breakdown.
+  //
+  // Default: nullptr (disabled)
+  // Not supported in ROCKSDB_LITE mode!
+  // Immutable.
+  std::shared_ptr<Cache> memory_budget_cache = nullptr;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -326,6 +326,17 @@ enum Tickers : uint32_t {
 
   NO_ITERATOR_CREATED,  // number of iterators created
   NO_ITERATOR_DELETED,  // number of iterators deleted
+
+  // SdfsEnv specific stats
+  // # of bytes read from SDFS.
+  SDFS_BYTES_READ,
+  // # of bytes written to SDFS.
+  SDFS_BYTES_WRITTEN,
+  // # of SDFS calls that failed.
+  SDFS_ERRORS,
+
+  // # of blocks found in the compressed secondary tier of the block cache.
+  BLOCK_CACHE_SECONDARY_HIT,
   TICKER_ENUM_MAX
 };
 
@@ -414,6 +425,22 @@ enum Histograms : uint32_t {
   // Time spent flushing memtable to disk
   FLUSH_TIME,
 
+  // SdfsEnv specific stats
+  // sdfsOpenFile latency.
+  SDFS_OPEN_MICROS,
+  // Sequential sdfsRead latency.
+  SDFS_READ_MICROS,
+  // sdfsPread latency.
+  SDFS_PREAD_MICROS,
+  // sdfsWrite latency.
+  SDFS_WRITE_MICROS,
+  // sdfsFlush + sdfsHSync latency.
+  SDFS_SYNC_MICROS,
+  // sdfsExists latency, not counting metadata cache hits.
+  SDFS_EXISTS_MICROS,
+  // sdfsGetPathInfo latency, not counting metadata cache hits.
+  SDFS_GET_PATH_INFO_MICROS,
+
   HISTOGRAM_ENUM_MAX,
 };
 
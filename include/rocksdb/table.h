@@ -142,6 +142,15 @@ struct BlockBasedTableOptions {
   //       same type of object there.
   std::shared_ptr<Cache> block_cache_compressed = nullptr;
 
+  // If not empty, the blocks of this table are charged to quota groups of
+  // block_cache, so that column families sharing the cache can each be given
+  // a reservation and a limit with Cache::SetQuota(). Index, filter and data
+  // blocks are charged to the groups "<name>.index", "<name>.filter" and
+  // "<name>.data" respectively, all three under the group "<name>". The
+  // usage and quotas of the groups are reported by the
+  // "rocksdb.block-cache-quota" property.
+  std::string block_cache_quota_group;
+
   // Approximate size of user data packed per block.  Note that the
   // block size specified here corresponds to uncompressed data.  The
   // actual size of the unit read from disk may be smaller if
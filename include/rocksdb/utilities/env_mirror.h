@@ -155,6 +155,13 @@ class EnvMirror : public EnvWrapper {
     return as;
   }
 
+  Status CopyFile(const std::string& s, const std::string& t) override {
+    Status as = a_->CopyFile(s, t);
+    Status bs = b_->CopyFile(s, t);
+    assert(as == bs);
+    return as;
+  }
+
   class FileLockMirror : public FileLock {
    public:
     FileLock* a_, *b_;
@@ -36,6 +36,15 @@ extern std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> cache,
                                              size_t sim_capacity,
                                              int num_shard_bits);
 
+// Like above, but simulates sim_cache, which is used for keys only, instead
+// of an LRU cache of sim_capacity. This makes it possible to compare hit rates
+// of different cache options, e.g. an LRUCache with
+// LRUCacheOptions::frequency_based_admission against the plain LRU cache in
+// use.
+extern std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> sim_cache,
+                                             std::shared_ptr<Cache> cache,
+                                             int num_shard_bits);
+
 class SimCache : public Cache {
  public:
   SimCache() {}
@@ -68,6 +77,14 @@ class SimCache : public Cache {
   // String representation of the statistics of the simcache
   virtual std::string ToString() const = 0;
 
+  // returns the estimated miss ratio of an LRU cache of the given capacity
+  // for the lookups since the simcache was created or its counters reset.
+  // Unlike the hit and miss counters, which are for sim capacity only, this
+  // covers any capacity, so the miss ratio curve of the workload comes from
+  // a single simcache. It is estimated from the reuse distances of a sample
+  // of at most a few thousand keys.
+  virtual double GetEstimatedMissRatio(size_t capacity) const = 0;
+
   // Start storing logs of the cache activity (Add/Lookup) into
   // a file located at activity_log_file, max_logging_size option can be used to
   // stop logging to the file automatically after reaching a specific size in
@@ -3468,6 +3468,14 @@ class TickerTypeJni {
         return -0x0B;
       case rocksdb::Tickers::TXN_SNAPSHOT_MUTEX_OVERHEAD:
         return -0x0C;
+      case rocksdb::Tickers::SDFS_BYTES_READ:
+        return -0x0D;
+      case rocksdb::Tickers::SDFS_BYTES_WRITTEN:
+        return -0x0E;
+      case rocksdb::Tickers::SDFS_ERRORS:
+        return -0x0F;
+      case rocksdb::Tickers::BLOCK_CACHE_SECONDARY_HIT:
+        return -0x10;
       case rocksdb::Tickers::TICKER_ENUM_MAX:
         // 0x5F for backwards compatibility on current minor version.
         return 0x5F;
@@ -3760,6 +3768,14 @@ class TickerTypeJni {
         return rocksdb::Tickers::TXN_DUPLICATE_KEY_OVERHEAD;
       case -0x0C:
         return rocksdb::Tickers::TXN_SNAPSHOT_MUTEX_OVERHEAD;
+      case -0x0D:
+        return rocksdb::Tickers::SDFS_BYTES_READ;
+      case -0x0E:
+        return rocksdb::Tickers::SDFS_BYTES_WRITTEN;
+      case -0x0F:
+        return rocksdb::Tickers::SDFS_ERRORS;
+      case -0x10:
+        return rocksdb::Tickers::BLOCK_CACHE_SECONDARY_HIT;
       case 0x5F:
         // 0x5F for backwards compatibility on current minor version.
         return rocksdb::Tickers::TICKER_ENUM_MAX;
@@ -3872,6 +3888,20 @@ class HistogramTypeJni {
         return 0x2D;
       case rocksdb::Histograms::BLOB_DB_DECOMPRESSION_MICROS:
         return 0x2E;
+      case rocksdb::Histograms::SDFS_OPEN_MICROS:
+        return 0x2F;
+      case rocksdb::Histograms::SDFS_READ_MICROS:
+        return 0x30;
+      case rocksdb::Histograms::SDFS_PREAD_MICROS:
+        return 0x31;
+      case rocksdb::Histograms::SDFS_WRITE_MICROS:
+        return 0x32;
+      case rocksdb::Histograms::SDFS_SYNC_MICROS:
+        return 0x33;
+      case rocksdb::Histograms::SDFS_EXISTS_MICROS:
+        return 0x34;
+      case rocksdb::Histograms::SDFS_GET_PATH_INFO_MICROS:
+        return 0x35;
       case rocksdb::Histograms::HISTOGRAM_ENUM_MAX:
         // 0x1F for backwards compatibility on current minor version.
         return 0x1F;
@@ -3979,6 +4009,20 @@ class HistogramTypeJni {
         return rocksdb::Histograms::BLOB_DB_COMPRESSION_MICROS;
       case 0x2E:
         return rocksdb::Histograms::BLOB_DB_DECOMPRESSION_MICROS;
+      case 0x2F:
+        return rocksdb::Histograms::SDFS_OPEN_MICROS;
+      case 0x30:
+        return rocksdb::Histograms::SDFS_READ_MICROS;
+      case 0x31:
+        return rocksdb::Histograms::SDFS_PREAD_MICROS;
+      case 0x32:
+        return rocksdb::Histograms::SDFS_WRITE_MICROS;
+      case 0x33:
+        return rocksdb::Histograms::SDFS_SYNC_MICROS;
+      case 0x34:
+        return rocksdb::Histograms::SDFS_EXISTS_MICROS;
+      case 0x35:
+        return rocksdb::Histograms::SDFS_GET_PATH_INFO_MICROS;
       case 0x1F:
         // 0x1F for backwards compatibility on current minor version.
         return rocksdb::Histograms::HISTOGRAM_ENUM_MAX;
@@ -159,6 +159,41 @@ public enum HistogramType {
    */
   BLOB_DB_DECOMPRESSION_MICROS((byte) 0x2E),
 
+  /**
+   * SDFS open latency.
+   */
+  SDFS_OPEN_MICROS((byte) 0x2F),
+
+  /**
+   * SDFS sequential read latency.
+   */
+  SDFS_READ_MICROS((byte) 0x30),
+
+  /**
+   * SDFS positional read latency.
+   */
+  SDFS_PREAD_MICROS((byte) 0x31),
+
+  /**
+   * SDFS write latency.
+   */
+  SDFS_WRITE_MICROS((byte) 0x32),
+
+  /**
+   * SDFS flush and sync latency.
+   */
+  SDFS_SYNC_MICROS((byte) 0x33),
+
+  /**
+   * SDFS exists latency, not counting metadata cache hits.
+   */
+  SDFS_EXISTS_MICROS((byte) 0x34),
+
+  /**
+   * SDFS path info latency, not counting metadata cache hits.
+   */
+  SDFS_GET_PATH_INFO_MICROS((byte) 0x35),
+
   // 0x1F for backwards compatibility on current minor version.
   HISTOGRAM_ENUM_MAX((byte) 0x1F);
 
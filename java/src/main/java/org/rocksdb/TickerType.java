@@ -717,6 +717,26 @@ public enum TickerType {
      */
     TXN_SNAPSHOT_MUTEX_OVERHEAD((byte) -0x0C),
 
+    /**
+     * # of bytes read from SDFS.
+     */
+    SDFS_BYTES_READ((byte) -0x0D),
+
+    /**
+     * # of bytes written to SDFS.
+     */
+    SDFS_BYTES_WRITTEN((byte) -0x0E),
+
+    /**
+     * # of SDFS calls that failed.
+     */
+    SDFS_ERRORS((byte) -0x0F),
+
+    /**
+     * # of blocks found in the compressed secondary tier of the block cache.
+     */
+    BLOCK_CACHE_SECONDARY_HIT((byte) -0x10),
+
     TICKER_ENUM_MAX((byte) 0x5F);
 
     private final byte value;
@@ -0,0 +1,1031 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#ifndef ROCKSDB_LITE
+#include "rocksdb/memtablerep.h"
+
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "db/memtable.h"
+#include "port/port.h"
+#include "rocksdb/comparator.h"
+#include "util/allocator.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+namespace {
+
+// An adaptive radix tree (Leis et al., ICDE 2013) over the user keys, for
+// bytewise-ordered column families. Each leaf holds one user key and the
+// entries of all its versions, in a sorted linked list.
+//
+// Inner nodes have room for 4, 16, 48 or 256 children, told apart by the
+// byte of the key at the depth of the node. Bytes that all keys below a
+// node share are not stored in separate nodes; instead each node keeps a
+// pointer to one key below it, whose first depth bytes are the prefix of
+// every key below. A key that ends at the depth of a node is held in the
+// terminal leaf of the node, before all the children in key order.
+//
+// Readers do not lock. Nodes are never freed or changed once published,
+// except that:
+// (1) A child is added by setting its pointer before publishing it with a
+//     release store to the child count (node 4/16), index (node 48) or
+//     slot (node 256).
+// (2) The pointer to a child is replaced, with a release store, by a new
+//     node that holds everything the child did: a larger copy of it, or a
+//     node for a shorter prefix with the child below it.
+// (3) The terminal leaf is only set once, and the entry lists only grow,
+//     through compare-and-swap.
+// A reader that holds a replaced node still sees everything inserted
+// before the node was replaced. Writers lock the nodes they change, and
+// never change a node that was replaced by a larger copy.
+
+// An entry of the memtable, behind the link to the next version of the
+// same user key.
+struct Entry {
+  Entry* Next() { return next_.load(std::memory_order_acquire); }
+
+  void NoBarrier_SetNext(Entry* x) {
+    next_.store(x, std::memory_order_relaxed);
+  }
+
+  bool CASNext(Entry* expected, Entry* x) {
+    return next_.compare_exchange_strong(expected, x);
+  }
+
+  // Needed for placement new below which is fine
+  Entry() {}
+
+ private:
+  std::atomic<Entry*> next_;
+
+  // Prohibit copying due to the below
+  Entry(const Entry&) = delete;
+  Entry& operator=(const Entry&) = delete;
+
+ public:
+  char key[1];
+};
+
+struct Leaf {
+  Leaf(const Slice& user_key, Entry* first)
+      : key(user_key.data()),
+        key_size(static_cast<uint32_t>(user_key.size())),
+        entries(first) {}
+
+  Slice user_key() const { return Slice(key, key_size); }
+
+  const char* const key;
+  const uint32_t key_size;
+  // Sorted by the memtable key comparator.
+  std::atomic<Entry*> entries;
+};
+
+enum NodeType : uint8_t {
+  kNode4,
+  kNode16,
+  kNode48,
+  kNode256,
+};
+
+struct InnerNode {
+  InnerNode(NodeType t, uint32_t d, const char* p)
+      : type(t), depth(d), prefix(p), obsolete(false), terminal(nullptr) {}
+
+  const NodeType type;
+  // Children are told apart by their byte at depth. All the keys below
+  // share their first depth bytes with prefix.
+  const uint32_t depth;
+  const char* const prefix;
+  // Held by writers changing the node.
+  SpinMutex mutex;
+  // Set once the node is replaced by a larger copy.
+  std::atomic<bool> obsolete;
+  std::atomic<Leaf*> terminal;
+};
+
+// Children are leaves when the low bit of the pointer is set.
+inline bool IsLeaf(void* child) {
+  return (reinterpret_cast<uintptr_t>(child) & 1) != 0;
+}
+
+inline Leaf* AsLeaf(void* child) {
+  return reinterpret_cast<Leaf*>(reinterpret_cast<uintptr_t>(child) - 1);
+}
+
+inline void* LeafChild(Leaf* leaf) {
+  return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(leaf) + 1);
+}
+
+template <NodeType kType, int kCapacity>
+struct SmallNode : public InnerNode {
+  SmallNode(uint32_t d, const char* p) : InnerNode(kType, d, p), count(0) {}
+
+  static const int kMaxChildren = kCapacity;
+  // The children are in insertion order.
+  std::atomic<uint8_t> count;
+  uint8_t keys[kCapacity];
+  std::atomic<void*> children[kCapacity];
+};
+
+typedef SmallNode<kNode4, 4> Node4;
+typedef SmallNode<kNode16, 16> Node16;
+
+struct Node48 : public InnerNode {
+  Node48(uint32_t d, const char* p) : InnerNode(kNode48, d, p), count(0) {
+    for (int i = 0; i < 256; i++) {
+      index[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  static const int kMaxChildren = 48;
+  // One more than the slot of the child of each byte, 0 if there is none.
+  std::atomic<uint8_t> index[256];
+  std::atomic<void*> children[48];
+  // Only used by writers.
+  uint8_t count;
+};
+
+struct Node256 : public InnerNode {
+  Node256(uint32_t d, const char* p) : InnerNode(kNode256, d, p) {
+    for (int i = 0; i < 256; i++) {
+      children[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<void*> children[256];
+};
+
+class AdaptiveRadixTreeRep : public MemTableRep {
+ public:
+  AdaptiveRadixTreeRep(const MemTableRep::KeyComparator& compare,
+                       Allocator* allocator);
+
+  virtual KeyHandle Allocate(const size_t len, char** buf) override;
+
+  virtual void Insert(KeyHandle handle) override { InsertKey(handle); }
+
+  virtual bool InsertKey(KeyHandle handle) override {
+    return InsertEntry(static_cast<Entry*>(handle));
+  }
+
+  virtual void InsertConcurrently(KeyHandle handle) override {
+    InsertKeyConcurrently(handle);
+  }
+
+  virtual bool InsertKeyConcurrently(KeyHandle handle) override {
+    return InsertEntry(static_cast<Entry*>(handle));
+  }
+
+  virtual bool Contains(const char* key) const override;
+
+  virtual size_t ApproximateMemoryUsage() override { return 0; }
+
+  virtual void Get(const LookupKey& k, void* callback_args,
+                   bool (*callback_func)(void* arg,
+                                         const char* entry)) override;
+
+  virtual ~AdaptiveRadixTreeRep() {}
+
+  virtual MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override;
+
+ private:
+  class Iterator;
+
+  static Slice UserKeyOf(const char* key) {
+    return ExtractUserKey(GetLengthPrefixedSlice(key));
+  }
+
+  template <class T>
+  T* NewNode(uint32_t depth, const char* prefix) {
+    char* mem = allocator_->AllocateAligned(sizeof(T));
+    return new (mem) T(depth, prefix);
+  }
+
+  Leaf* NewLeaf(const Slice& user_key, Entry* first) {
+    char* mem = allocator_->AllocateAligned(sizeof(Leaf));
+    return new (mem) Leaf(user_key, first);
+  }
+
+  // Returns the child of node for byte, or nullptr.
+  static void* FindChild(const InnerNode* node, uint8_t byte);
+
+  // Returns the child of node with the smallest byte greater than after,
+  // or nullptr. Sets *byte to its byte.
+  static void* NextChild(const InnerNode* node, int after, int* byte);
+
+  // Returns the child of node with the largest byte less than before, or
+  // nullptr. Sets *byte to its byte.
+  static void* PrevChild(const InnerNode* node, int before, int* byte);
+
+  // Adds a child for a byte node has no child for. Returns false if the
+  // node is full.
+  // REQUIRES: node->mutex is held or node is not published yet.
+  static bool AddChild(InnerNode* node, uint8_t byte, void* child);
+
+  // Replaces the child of node for byte.
+  // REQUIRES: node->mutex is held and node has a child for byte.
+  static void ReplaceChild(InnerNode* node, uint8_t byte, void* child);
+
+  // Returns a copy of node with room for more children.
+  // REQUIRES: node->mutex is held.
+  InnerNode* Grow(InnerNode* node);
+
+  bool InsertEntry(Entry* x);
+
+  // Links x into the entries of leaf. Returns false if an equal entry is
+  // already there.
+  bool LinkEntry(Leaf* leaf, Entry* x);
+
+  // Returns the leaf of user_key, or nullptr.
+  Leaf* FindLeaf(const Slice& user_key) const;
+
+  // Returns the first entry of leaf that is at or after internal_key.
+  Entry* FindGreaterOrEqualInLeaf(Leaf* leaf,
+                                  const Slice& internal_key) const;
+
+  const MemTableRep::KeyComparator& compare_;
+  InnerNode* const root_;
+};
+
+// Iterates with a stack of the nodes on the path to the current leaf, and
+// the byte of the path below each node: -1 for its terminal leaf, and -2
+// or 256 before or after all of its leaves. The entries of a leaf are only
+// linked forward, so a stack of the ones before the current entry serves
+// Prev() within the leaf.
+class AdaptiveRadixTreeRep::Iterator : public MemTableRep::Iterator {
+ public:
+  explicit Iterator(const AdaptiveRadixTreeRep* rep)
+      : rep_(rep),
+        leaf_(nullptr),
+        entry_(nullptr),
+        prev_entries_known_(false) {}
+
+  virtual ~Iterator() {}
+
+  virtual bool Valid() const override { return entry_ != nullptr; }
+
+  virtual const char* key() const override {
+    assert(Valid());
+    return entry_->key;
+  }
+
+  virtual void Next() override {
+    assert(Valid());
+    if (prev_entries_known_) {
+      prev_entries_.push_back(entry_);
+    }
+    entry_ = entry_->Next();
+    if (entry_ == nullptr) {
+      SetFirstEntry(NextLeaf());
+    }
+  }
+
+  virtual void Prev() override {
+    assert(Valid());
+    if (!prev_entries_known_) {
+      // Positioned by Seek() within the leaf: collect the entries before
+      // entry_ once. Entries linked in since are newer than the iterator.
+      prev_entries_.clear();
+      for (Entry* e = leaf_->entries.load(std::memory_order_acquire);
+           e != entry_; e = e->Next()) {
+        prev_entries_.push_back(e);
+      }
+      prev_entries_known_ = true;
+    }
+    if (prev_entries_.empty()) {
+      SetLastEntry(PrevLeaf());
+    } else {
+      entry_ = prev_entries_.back();
+      prev_entries_.pop_back();
+    }
+  }
+
+  virtual void Seek(const Slice& internal_key,
+                    const char* /*memtable_key*/) override;
+
+  virtual void SeekForPrev(const Slice& internal_key,
+                           const char* memtable_key) override {
+    Seek(internal_key, memtable_key);
+    if (!Valid()) {
+      SeekToLast();
+    }
+    while (Valid() && rep_->compare_(entry_->key, internal_key) > 0) {
+      Prev();
+    }
+  }
+
+  virtual void SeekToFirst() override {
+    path_.clear();
+    path_.push_back({rep_->root_, -2});
+    SetFirstEntry(NextLeaf());
+  }
+
+  virtual void SeekToLast() override {
+    path_.clear();
+    path_.push_back({rep_->root_, 256});
+    SetLastEntry(PrevLeaf());
+  }
+
+ private:
+  struct Frame {
+    const InnerNode* node;
+    int pos;
+  };
+
+  // Moves to the next leaf after the current position of path_. Returns
+  // false, with an empty path_, if there is none.
+  bool NextLeaf();
+  // Moves to the leaf before the current position of path_.
+  bool PrevLeaf();
+
+  void SetFirstEntry(bool found) {
+    entry_ = found ? leaf_->entries.load(std::memory_order_acquire) : nullptr;
+    prev_entries_.clear();
+    prev_entries_known_ = true;
+  }
+
+  void SetLastEntry(bool found) {
+    entry_ = nullptr;
+    prev_entries_.clear();
+    prev_entries_known_ = true;
+    if (found) {
+      for (Entry* e = leaf_->entries.load(std::memory_order_acquire);
+           e != nullptr; e = e->Next()) {
+        if (entry_ != nullptr) {
+          prev_entries_.push_back(entry_);
+        }
+        entry_ = e;
+      }
+    }
+  }
+
+  const AdaptiveRadixTreeRep* const rep_;
+  std::vector<Frame> path_;
+  Leaf* leaf_;
+  Entry* entry_;
+  // The entries of leaf_ before entry_, if prev_entries_known_.
+  std::vector<Entry*> prev_entries_;
+  bool prev_entries_known_;
+};
+
+AdaptiveRadixTreeRep::AdaptiveRadixTreeRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator)
+    : MemTableRep(allocator),
+      compare_(compare),
+      root_(NewNode<Node256>(0, nullptr)) {}
+
+KeyHandle AdaptiveRadixTreeRep::Allocate(const size_t len, char** buf) {
+  char* mem = allocator_->AllocateAligned(sizeof(Entry) + len);
+  Entry* x = new (mem) Entry();
+  *buf = x->key;
+  return static_cast<void*>(x);
+}
+
+void* AdaptiveRadixTreeRep::FindChild(const InnerNode* node, uint8_t byte) {
+  switch (node->type) {
+    case kNode4: {
+      auto* n = static_cast<const Node4*>(node);
+      int count = n->count.load(std::memory_order_acquire);
+      for (int i = 0; i < count; i++) {
+        if (n->keys[i] == byte) {
+          return n->children[i].load(std::memory_order_acquire);
+        }
+      }
+      return nullptr;
+    }
+    case kNode16: {
+      auto* n = static_cast<const Node16*>(node);
+      int count = n->count.load(std::memory_order_acquire);
+      for (int i = 0; i < count; i++) {
+        if (n->keys[i] == byte) {
+          return n->children[i].load(std::memory_order_acquire);
+        }
+      }
+      return nullptr;
+    }
+    case kNode48: {
+      auto* n = static_cast<const Node48*>(node);
+      int slot = n->index[byte].load(std::memory_order_acquire);
+      return slot == 0 ? nullptr
+                       : n->children[slot - 1].load(std::memory_order_acquire);
+    }
+    case kNode256: {
+      auto* n = static_cast<const Node256*>(node);
+      return n->children[byte].load(std::memory_order_acquire);
+    }
+  }
+  assert(false);
+  return nullptr;
+}
+
+void* AdaptiveRadixTreeRep::NextChild(const InnerNode* node, int after,
+                                      int* byte) {
+  switch (node->type) {
+    case kNode4:
+    case kNode16: {
+      const uint8_t* keys;
+      const std::atomic<void*>* children;
+      int count;
+      if (node->type == kNode4) {
+        auto* n = static_cast<const Node4*>(node);
+        count = n->count.load(std::memory_order_acquire);
+        keys = n->keys;
+        children = n->children;
+      } else {
+        auto* n = static_cast<const Node16*>(node);
+        count = n->count.load(std::memory_order_acquire);
+        keys = n->keys;
+        children = n->children;
+      }
+      int best = -1;
+      for (int i = 0; i < count; i++) {
+        if (keys[i] > after && (best < 0 || keys[i] < keys[best])) {
+          best = i;
+        }
+      }
+      if (best < 0) {
+        return nullptr;
+      }
+      *byte = keys[best];
+      return children[best].load(std::memory_order_acquire);
+    }
+    case kNode48: {
+      auto* n = static_cast<const Node48*>(node);
+      for (int b = after + 1; b < 256; b++) {
+        int slot = n->index[b].load(std::memory_order_acquire);
+        if (slot != 0) {
+          *byte = b;
+          return n->children[slot - 1].load(std::memory_order_acquire);
+        }
+      }
+      return nullptr;
+    }
+    case kNode256: {
+      auto* n = static_cast<const Node256*>(node);
+      for (int b = after + 1; b < 256; b++) {
+        void* child = n->children[b].load(std::memory_order_acquire);
+        if (child != nullptr) {
+          *byte = b;
+          return child;
+        }
+      }
+      return nullptr;
+    }
+  }
+  assert(false);
+  return nullptr;
+}
+
+void* AdaptiveRadixTreeRep::PrevChild(const InnerNode* node, int before,
+                                      int* byte) {
+  switch (node->type) {
+    case kNode4:
+    case kNode16: {
+      const uint8_t* keys;
+      const std::atomic<void*>* children;
+      int count;
+      if (node->type == kNode4) {
+        auto* n = static_cast<const Node4*>(node);
+        count = n->count.load(std::memory_order_acquire);
+        keys = n->keys;
+        children = n->children;
+      } else {
+        auto* n = static_cast<const Node16*>(node);
+        count = n->count.load(std::memory_order_acquire);
+        keys = n->keys;
+        children = n->children;
+      }
+      int best = -1;
+      for (int i = 0; i < count; i++) {
+        if (keys[i] < before && (best < 0 || keys[i] > keys[best])) {
+          best = i;
+        }
+      }
+      if (best < 0) {
+        return nullptr;
+      }
+      *byte = keys[best];
+      return children[best].load(std::memory_order_acquire);
+    }
+    case kNode48: {
+      auto* n = static_cast<const Node48*>(node);
+      for (int b = before - 1; b >= 0; b--) {
+        int slot = n->index[b].load(std::memory_order_acquire);
+        if (slot != 0) {
+          *byte = b;
+          return n->children[slot - 1].load(std::memory_order_acquire);
+        }
+      }
+      return nullptr;
+    }
+    case kNode256: {
+      auto* n = static_cast<const Node256*>(node);
+      for (int b = before - 1; b >= 0; b--) {
+        void* child = n->children[b].load(std::memory_order_acquire);
+        if (child != nullptr) {
+          *byte = b;
+          return child;
+        }
+      }
+      return nullptr;
+    }
+  }
+  assert(false);
+  return nullptr;
+}
+
+bool AdaptiveRadixTreeRep::AddChild(InnerNode* node, uint8_t byte,
+                                    void* child) {
+  assert(FindChild(node, byte) == nullptr);
+  switch (node->type) {
+    case kNode4: {
+      auto* n = static_cast<Node4*>(node);
+      int count = n->count.load(std::memory_order_relaxed);
+      if (count == Node4::kMaxChildren) {
+        return false;
+      }
+      n->keys[count] = byte;
+      n->children[count].store(child, std::memory_order_relaxed);
+      n->count.store(static_cast<uint8_t>(count + 1),
+                     std::memory_order_release);
+      return true;
+    }
+    case kNode16: {
+      auto* n = static_cast<Node16*>(node);
+      int count = n->count.load(std::memory_order_relaxed);
+      if (count == Node16::kMaxChildren) {
+        return false;
+      }
+      n->keys[count] = byte;
+      n->children[count].store(child, std::memory_order_relaxed);
+      n->count.store(static_cast<uint8_t>(count + 1),
+                     std::memory_order_release);
+      return true;
+    }
+    case kNode48: {
+      auto* n = static_cast<Node48*>(node);
+      if (n->count == Node48::kMaxChildren) {
+        return false;
+      }
+      n->children[n->count].store(child, std::memory_order_relaxed);
+      n->count++;
+      n->index[byte].store(n->count, std::memory_order_release);
+      return true;
+    }
+    case kNode256: {
+      auto* n = static_cast<Node256*>(node);
+      n->children[byte].store(child, std::memory_order_release);
+      return true;
+    }
+  }
+  assert(false);
+  return false;
+}
+
+void AdaptiveRadixTreeRep::ReplaceChild(InnerNode* node, uint8_t byte,
+                                        void* child) {
+  switch (node->type) {
+    case kNode4: {
+      auto* n = static_cast<Node4*>(node);
+      int count = n->count.load(std::memory_order_relaxed);
+      for (int i = 0; i < count; i++) {
+        if (n->keys[i] == byte) {
+          n->children[i].store(child, std::memory_order_release);
+          return;
+        }
+      }
+      break;
+    }
+    case kNode16: {
+      auto* n = static_cast<Node16*>(node);
+      int count = n->count.load(std::memory_order_relaxed);
+      for (int i = 0; i < count; i++) {
+        if (n->keys[i] == byte) {
+          n->children[i].store(child, std::memory_order_release);
+          return;
+        }
+      }
+      break;
+    }
+    case kNode48: {
+      auto* n = static_cast<Node48*>(node);
+      int slot = n->index[byte].load(std::memory_order_relaxed);
+      assert(slot != 0);
+      n->children[slot - 1].store(child, std::memory_order_release);
+      return;
+    }
+    case kNode256: {
+      auto* n = static_cast<Node256*>(node);
+      n->children[byte].store(child, std::memory_order_release);
+      return;
+    }
+  }
+  assert(false);
+}
+
+InnerNode* AdaptiveRadixTreeRep::Grow(InnerNode* node) {
+  InnerNode* grown;
+  switch (node->type) {
+    case kNode4:
+      grown = NewNode<Node16>(node->depth, node->prefix);
+      break;
+    case kNode16:
+      grown = NewNode<Node48>(node->depth, node->prefix);
+      break;
+    case kNode48:
+      grown = NewNode<Node256>(node->depth, node->prefix);
+      break;
+    default:
+      assert(false);
+      return nullptr;
+  }
+  grown->terminal.store(node->terminal.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+  int byte = -1;
+  void* child;
+  while ((child = NextChild(node, byte, &byte)) != nullptr) {
+    bool added = AddChild(grown, static_cast<uint8_t>(byte), child);
+    assert(added);
+    (void)added;
+  }
+  return grown;
+}
+
+bool AdaptiveRadixTreeRep::LinkEntry(Leaf* leaf, Entry* x) {
+  while (true) {
+    Entry* prev = nullptr;
+    Entry* cur = leaf->entries.load(std::memory_order_acquire);
+    int cmp = 1;
+    while (cur != nullptr && (cmp = compare_(cur->key, x->key)) < 0) {
+      prev = cur;
+      cur = cur->Next();
+    }
+    if (cur != nullptr && cmp == 0) {
+      return false;
+    }
+    x->NoBarrier_SetNext(cur);
+    if (prev != nullptr ? prev->CASNext(cur, x)
+                        : leaf->entries.compare_exchange_strong(cur, x)) {
+      return true;
+    }
+  }
+}
+
+bool AdaptiveRadixTreeRep::InsertEntry(Entry* x) {
+  const Slice key = UserKeyOf(x->key);
+  const uint32_t key_size = static_cast<uint32_t>(key.size());
+  // Allocated once, and only published if the user key is new.
+  Leaf* new_leaf = nullptr;
+  auto leaf_of_x = [&]() {
+    if (new_leaf == nullptr) {
+      x->NoBarrier_SetNext(nullptr);
+      new_leaf = NewLeaf(key, x);
+    }
+    return new_leaf;
+  };
+
+  while (true) {
+    InnerNode* parent = nullptr;
+    uint8_t parent_byte = 0;
+    InnerNode* node = root_;
+    uint32_t depth = 0;
+    bool restart = false;
+    while (!restart) {
+      // Check the prefix of node.
+      uint32_t end = node->depth;
+      uint32_t i = depth;
+      while (i < end && i < key_size && key[i] == node->prefix[i]) {
+        i++;
+      }
+      if (i < end) {
+        // The key leaves the prefix at i. Put a node for the shorter prefix
+        // between parent and node.
+        assert(parent != nullptr);
+        InnerNode* split = NewNode<Node4>(i, node->prefix);
+        AddChild(split, static_cast<uint8_t>(node->prefix[i]), node);
+        if (i == key_size) {
+          split->terminal.store(leaf_of_x(), std::memory_order_relaxed);
+        } else {
+          AddChild(split, static_cast<uint8_t>(key[i]),
+                   LeafChild(leaf_of_x()));
+        }
+        std::lock_guard<SpinMutex> l(parent->mutex);
+        if (parent->obsolete.load(std::memory_order_relaxed) ||
+            FindChild(parent, parent_byte) != node) {
+          break;
+        }
+        ReplaceChild(parent, parent_byte, split);
+        return true;
+      }
+
+      if (key_size == end) {
+        Leaf* terminal = node->terminal.load(std::memory_order_acquire);
+        if (terminal == nullptr) {
+          std::lock_guard<SpinMutex> l(node->mutex);
+          if (node->obsolete.load(std::memory_order_relaxed)) {
+            break;
+          }
+          terminal = node->terminal.load(std::memory_order_relaxed);
+          if (terminal == nullptr) {
+            node->terminal.store(leaf_of_x(), std::memory_order_release);
+            return true;
+          }
+        }
+        // A node replaced by a larger copy shares its terminal leaf with
+        // the copy, so it is fine to insert into it.
+        return LinkEntry(terminal, x);
+      }
+
+      const uint8_t byte = static_cast<uint8_t>(key[end]);
+      void* child = FindChild(node, byte);
+      if (child == nullptr) {
+        node->mutex.lock();
+        if (node->obsolete.load(std::memory_order_relaxed)) {
+          node->mutex.unlock();
+          break;
+        }
+        child = FindChild(node, byte);
+        if (child == nullptr) {
+          if (AddChild(node, byte, LeafChild(leaf_of_x()))) {
+            node->mutex.unlock();
+            return true;
+          }
+          // Replace the full node with a larger one. Locks are taken from
+          // the root down.
+          node->mutex.unlock();
+          assert(parent != nullptr);
+          std::lock_guard<SpinMutex> parent_lock(parent->mutex);
+          if (parent->obsolete.load(std::memory_order_relaxed) ||
+              FindChild(parent, parent_byte) != node) {
+            break;
+          }
+          std::lock_guard<SpinMutex> node_lock(node->mutex);
+          if (FindChild(node, byte) != nullptr) {
+            break;
+          }
+          InnerNode* grown = Grow(node);
+          AddChild(grown, byte, LeafChild(leaf_of_x()));
+          node->obsolete.store(true, std::memory_order_relaxed);
+          ReplaceChild(parent, parent_byte, grown);
+          return true;
+        }
+        node->mutex.unlock();
+      }
+
+      if (IsLeaf(child)) {
+        Leaf* leaf = AsLeaf(child);
+        const Slice leaf_key = leaf->user_key();
+        if (leaf_key == key) {
+          return LinkEntry(leaf, x);
+        }
+        // Put a node for the common prefix of the two keys in place of the
+        // leaf.
+        uint32_t j = end + 1;
+        while (j < key_size && j < leaf_key.size() && key[j] == leaf_key[j]) {
+          j++;
+        }
+        InnerNode* split = NewNode<Node4>(j, leaf->key);
+        if (j == leaf_key.size()) {
+          split->terminal.store(leaf, std::memory_order_relaxed);
+        } else {
+          AddChild(split, static_cast<uint8_t>(leaf_key[j]), child);
+        }
+        if (j == key_size) {
+          split->terminal.store(leaf_of_x(), std::memory_order_relaxed);
+        } else {
+          AddChild(split, static_cast<uint8_t>(key[j]),
+                   LeafChild(leaf_of_x()));
+        }
+        std::lock_guard<SpinMutex> l(node->mutex);
+        if (node->obsolete.load(std::memory_order_relaxed) ||
+            FindChild(node, byte) != child) {
+          break;
+        }
+        ReplaceChild(node, byte, split);
+        return true;
+      }
+
+      parent = node;
+      parent_byte = byte;
+      node = static_cast<InnerNode*>(child);
+      depth = end + 1;
+    }
+    // Another writer changed the path; start over from the root.
+  }
+}
+
+Leaf* AdaptiveRadixTreeRep::FindLeaf(const Slice& user_key) const {
+  const InnerNode* node = root_;
+  uint32_t depth = 0;
+  while (true) {
+    uint32_t end = node->depth;
+    if (user_key.size() < end ||
+        (end > depth && memcmp(user_key.data() + depth, node->prefix + depth,
+                               end - depth) != 0)) {
+      return nullptr;
+    }
+    if (user_key.size() == end) {
+      return node->terminal.load(std::memory_order_acquire);
+    }
+    void* child = FindChild(node, static_cast<uint8_t>(user_key[end]));
+    if (child == nullptr) {
+      return nullptr;
+    }
+    if (IsLeaf(child)) {
+      Leaf* leaf = AsLeaf(child);
+      return leaf->user_key() == user_key ? leaf : nullptr;
+    }
+    node = static_cast<const InnerNode*>(child);
+    depth = end + 1;
+  }
+}
+
+Entry* AdaptiveRadixTreeRep::FindGreaterOrEqualInLeaf(
+    Leaf* leaf, const Slice& internal_key) const {
+  Entry* e = leaf->entries.load(std::memory_order_acquire);
+  while (e != nullptr && compare_(e->key, internal_key) < 0) {
+    e = e->Next();
+  }
+  return e;
+}
+
+bool AdaptiveRadixTreeRep::Contains(const char* key) const {
+  Leaf* leaf = FindLeaf(UserKeyOf(key));
+  if (leaf == nullptr) {
+    return false;
+  }
+  Entry* e = FindGreaterOrEqualInLeaf(leaf, GetLengthPrefixedSlice(key));
+  return e != nullptr && compare_(e->key, key) == 0;
+}
+
+void AdaptiveRadixTreeRep::Get(const LookupKey& k, void* callback_args,
+                               bool (*callback_func)(void* arg,
+                                                     const char* entry)) {
+  Leaf* leaf = FindLeaf(k.user_key());
+  if (leaf == nullptr) {
+    return;
+  }
+  // The entries of other user keys would end the lookup anyway.
+  for (Entry* e = FindGreaterOrEqualInLeaf(leaf, k.internal_key());
+       e != nullptr && callback_func(callback_args, e->key); e = e->Next()) {
+  }
+}
+
+MemTableRep::Iterator* AdaptiveRadixTreeRep::GetIterator(Arena* arena) {
+  if (arena == nullptr) {
+    return new Iterator(this);
+  }
+  auto mem = arena->AllocateAligned(sizeof(Iterator));
+  return new (mem) Iterator(this);
+}
+
+bool AdaptiveRadixTreeRep::Iterator::NextLeaf() {
+  while (!path_.empty()) {
+    Frame& frame = path_.back();
+    if (frame.pos == -2) {
+      frame.pos = -1;
+      Leaf* terminal = frame.node->terminal.load(std::memory_order_acquire);
+      if (terminal != nullptr) {
+        leaf_ = terminal;
+        return true;
+      }
+    }
+    int byte;
+    void* child = NextChild(frame.node, frame.pos, &byte);
+    if (child == nullptr) {
+      path_.pop_back();
+      continue;
+    }
+    frame.pos = byte;
+    if (IsLeaf(child)) {
+      leaf_ = AsLeaf(child);
+      return true;
+    }
+    path_.push_back({static_cast<const InnerNode*>(child), -2});
+  }
+  return false;
+}
+
+bool AdaptiveRadixTreeRep::Iterator::PrevLeaf() {
+  while (!path_.empty()) {
+    Frame& frame = path_.back();
+    if (frame.pos >= 0) {
+      int byte;
+      void* child = PrevChild(frame.node, frame.pos, &byte);
+      if (child != nullptr) {
+        frame.pos = byte;
+        if (IsLeaf(child)) {
+          leaf_ = AsLeaf(child);
+          return true;
+        }
+        path_.push_back({static_cast<const InnerNode*>(child), 256});
+        continue;
+      }
+      frame.pos = -1;
+      Leaf* terminal = frame.node->terminal.load(std::memory_order_acquire);
+      if (terminal != nullptr) {
+        leaf_ = terminal;
+        return true;
+      }
+    }
+    path_.pop_back();
+  }
+  return false;
+}
+
+void AdaptiveRadixTreeRep::Iterator::Seek(const Slice& internal_key,
+                                          const char* /*memtable_key*/) {
+  const Slice key = ExtractUserKey(internal_key);
+  path_.clear();
+  prev_entries_known_ = false;
+  const InnerNode* node = rep_->root_;
+  uint32_t depth = 0;
+  while (true) {
+    // Compare the key with the prefix of node.
+    uint32_t end = node->depth;
+    int cmp = 0;
+    for (uint32_t i = depth; i < end && cmp == 0; i++) {
+      if (i == key.size()) {
+        cmp = -1;
+      } else if (key[i] != node->prefix[i]) {
+        cmp = static_cast<uint8_t>(key[i]) <
+                      static_cast<uint8_t>(node->prefix[i])
+                  ? -1
+                  : 1;
+      }
+    }
+    if (cmp < 0) {
+      // All of the subtree is after the key.
+      path_.push_back({node, -2});
+      SetFirstEntry(NextLeaf());
+      return;
+    }
+    if (cmp > 0) {
+      // All of the subtree is before the key; the parent is positioned on
+      // it.
+      SetFirstEntry(NextLeaf());
+      return;
+    }
+
+    path_.push_back({node, -1});
+    if (key.size() == end) {
+      leaf_ = node->terminal.load(std::memory_order_acquire);
+      entry_ = leaf_ == nullptr
+                   ? nullptr
+                   : rep_->FindGreaterOrEqualInLeaf(leaf_, internal_key);
+      if (entry_ == nullptr) {
+        SetFirstEntry(NextLeaf());
+      }
+      return;
+    }
+
+    const uint8_t byte = static_cast<uint8_t>(key[end]);
+    void* child = FindChild(node, byte);
+    path_.back().pos = byte;
+    if (child == nullptr) {
+      SetFirstEntry(NextLeaf());
+      return;
+    }
+    if (IsLeaf(child)) {
+      leaf_ = AsLeaf(child);
+      int leaf_cmp = leaf_->user_key().compare(key);
+      if (leaf_cmp == 0) {
+        entry_ = rep_->FindGreaterOrEqualInLeaf(leaf_, internal_key);
+        if (entry_ == nullptr) {
+          SetFirstEntry(NextLeaf());
+        }
+      } else if (leaf_cmp > 0) {
+        SetFirstEntry(true);
+      } else {
+        SetFirstEntry(NextLeaf());
+      }
+      return;
+    }
+    node = static_cast<const InnerNode*>(child);
+    depth = end + 1;
+  }
+}
+
+}  // namespace
+
+MemTableRep* AdaptiveRadixTreeRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* transform, Logger* logger) {
+  // The tree orders keys by their bytes.
+  const Comparator* user_comparator = compare.user_comparator();
+  if (user_comparator == nullptr ||
+      strcmp(user_comparator->Name(), BytewiseComparator()->Name()) != 0) {
+    return SkipListFactory().CreateMemTableRep(compare, allocator, transform,
+                                               logger);
+  }
+  return new AdaptiveRadixTreeRep(compare, allocator);
+}
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,301 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "db/memtable.h"
+#include "rocksdb/memtablerep.h"
+#include "util/arena.h"
+#include "util/coding.h"
+#include "util/concurrent_arena.h"
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class ArtRepTest : public testing::Test {
+ public:
+  ArtRepTest()
+      : icmp_(BytewiseComparator()),
+        key_cmp_(icmp_),
+        model_(ModelComparator{&icmp_}) {}
+
+  // Inserts the entry of user_key and seq. Returns false if it was already
+  // there.
+  bool Add(MemTableRep* rep, const std::string& user_key, SequenceNumber seq,
+           bool concurrently = false) {
+    InternalKey ikey(user_key, seq, kTypeValue);
+    Slice encoded = ikey.Encode();
+    uint32_t size = static_cast<uint32_t>(encoded.size());
+    char* buf;
+    KeyHandle handle = rep->Allocate(VarintLength(size) + size, &buf);
+    char* p = EncodeVarint32(buf, size);
+    memcpy(p, encoded.data(), size);
+    return concurrently ? rep->InsertKeyConcurrently(handle)
+                        : rep->InsertKey(handle);
+  }
+
+  static std::string InternalKeyOf(const char* entry) {
+    return GetLengthPrefixedSlice(entry).ToString();
+  }
+
+  static std::string EncodedKey(const std::string& internal_key) {
+    std::string encoded;
+    PutLengthPrefixedSlice(&encoded, internal_key);
+    return encoded;
+  }
+
+  struct ModelComparator {
+    const InternalKeyComparator* icmp;
+    bool operator()(const std::string& a, const std::string& b) const {
+      return icmp->Compare(a, b) < 0;
+    }
+  };
+
+  InternalKeyComparator icmp_;
+  MemTable::KeyComparator key_cmp_;
+  std::set<std::string, ModelComparator> model_;
+};
+
+TEST_F(ArtRepTest, Empty) {
+  Arena arena;
+  AdaptiveRadixTreeRepFactory factory;
+  std::unique_ptr<MemTableRep> rep(
+      factory.CreateMemTableRep(key_cmp_, &arena, nullptr, nullptr));
+  std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+  iter->SeekToFirst();
+  ASSERT_FALSE(iter->Valid());
+  iter->SeekToLast();
+  ASSERT_FALSE(iter->Valid());
+  InternalKey target("foo", 10, kTypeValue);
+  iter->Seek(target.Encode(), nullptr);
+  ASSERT_FALSE(iter->Valid());
+  iter->SeekForPrev(target.Encode(), nullptr);
+  ASSERT_FALSE(iter->Valid());
+}
+
+TEST_F(ArtRepTest, InsertAndLookup) {
+  Arena arena;
+  AdaptiveRadixTreeRepFactory factory;
+  std::unique_ptr<MemTableRep> rep(
+      factory.CreateMemTableRep(key_cmp_, &arena, nullptr, nullptr));
+  Random rnd(301);
+  // Short keys over a small alphabet, so that keys are often prefixes of
+  // each other and share long prefixes, and nodes of every size are used.
+  auto random_key = [&rnd]() {
+    std::string key;
+    int len = rnd.Uniform(7);
+    for (int j = 0; j < len; j++) {
+      key.push_back(static_cast<char>(rnd.OneIn(4) ? rnd.Uniform(256)
+                                                   : 'a' + rnd.Uniform(3)));
+    }
+    return key;
+  };
+  for (int i = 0; i < 5000; i++) {
+    std::string user_key = random_key();
+    SequenceNumber seq = rnd.Uniform(10);
+    bool inserted = Add(rep.get(), user_key, seq);
+    InternalKey ikey(user_key, seq, kTypeValue);
+    ASSERT_EQ(model_.insert(ikey.Encode().ToString()).second, inserted);
+  }
+  for (auto& ikey : model_) {
+    ASSERT_TRUE(rep->Contains(EncodedKey(ikey).data()));
+  }
+
+  std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+  iter->SeekToFirst();
+  for (auto& ikey : model_) {
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(ikey, InternalKeyOf(iter->key()));
+    iter->Next();
+  }
+  ASSERT_FALSE(iter->Valid());
+
+  iter->SeekToLast();
+  for (auto it = model_.rbegin(); it != model_.rend(); ++it) {
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(*it, InternalKeyOf(iter->key()));
+    iter->Prev();
+  }
+  ASSERT_FALSE(iter->Valid());
+
+  for (int i = 0; i < 2000; i++) {
+    std::string user_key = random_key();
+    SequenceNumber seq = rnd.Uniform(12);
+    InternalKey target(user_key, seq, kTypeValue);
+    std::string target_key = target.Encode().ToString();
+    std::string encoded = EncodedKey(target_key);
+
+    auto model_iter = model_.lower_bound(target_key);
+    iter->Seek(target.Encode(), encoded.data());
+    for (int j = 0; j < 3; j++) {
+      if (model_iter == model_.end()) {
+        ASSERT_FALSE(iter->Valid());
+        break;
+      }
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(*model_iter, InternalKeyOf(iter->key()));
+      ++model_iter;
+      iter->Next();
+    }
+
+    model_iter = model_.upper_bound(target_key);
+    iter->SeekForPrev(target.Encode(), encoded.data());
+    for (int j = 0; j < 3; j++) {
+      if (model_iter == model_.begin()) {
+        ASSERT_FALSE(iter->Valid());
+        break;
+      }
+      --model_iter;
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(*model_iter, InternalKeyOf(iter->key()));
+      iter->Prev();
+    }
+
+    // Get() returns the versions of the user key from the target on.
+    std::vector<std::string> found;
+    LookupKey lkey(user_key, seq);
+    rep->Get(lkey, &found, [](void* arg, const char* entry) {
+      static_cast<std::vector<std::string>*>(arg)->push_back(
+          InternalKeyOf(entry));
+      return true;
+    });
+    std::vector<std::string> expected;
+    for (model_iter = model_.lower_bound(lkey.internal_key().ToString());
+         model_iter != model_.end() &&
+         ExtractUserKey(*model_iter) == user_key;
+         ++model_iter) {
+      expected.push_back(*model_iter);
+    }
+    ASSERT_EQ(expected, found);
+  }
+}
+
+TEST_F(ArtRepTest, ChangeDirection) {
+  Arena arena;
+  AdaptiveRadixTreeRepFactory factory;
+  std::unique_ptr<MemTableRep> rep(
+      factory.CreateMemTableRep(key_cmp_, &arena, nullptr, nullptr));
+  // Few keys with many versions each, so that most steps stay in a leaf.
+  for (int k = 0; k < 5; k++) {
+    for (SequenceNumber seq = 0; seq < 50; seq++) {
+      std::string user_key(static_cast<size_t>(k), 'a');
+      ASSERT_TRUE(Add(rep.get(), user_key, seq));
+      model_.insert(InternalKey(user_key, seq, kTypeValue).Encode().ToString());
+    }
+  }
+
+  Random rnd(301);
+  std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+  std::vector<std::string> keys(model_.begin(), model_.end());
+  for (int i = 0; i < 100; i++) {
+    // Start from a Seek() into the middle of a leaf, or from either end.
+    size_t pos = rnd.Uniform(static_cast<int>(keys.size()));
+    if (i % 3 == 0) {
+      iter->SeekToFirst();
+      pos = 0;
+    } else if (i % 3 == 1) {
+      iter->SeekToLast();
+      pos = keys.size() - 1;
+    } else {
+      iter->Seek(keys[pos], EncodedKey(keys[pos]).data());
+    }
+    for (int j = 0; j < 200; j++) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(keys[pos], InternalKeyOf(iter->key()));
+      bool forward = rnd.OneIn(2);
+      if (forward && pos + 1 < keys.size()) {
+        iter->Next();
+        pos++;
+      } else if (!forward && pos > 0) {
+        iter->Prev();
+        pos--;
+      }
+    }
+  }
+}
+
+TEST_F(ArtRepTest, InsertConcurrently) {
+  const int kNumThreads = 4;
+  const int kNumKeys = 20000;
+  ConcurrentArena arena;
+  AdaptiveRadixTreeRepFactory factory;
+  ASSERT_TRUE(factory.IsInsertConcurrentlySupported());
+  std::unique_ptr<MemTableRep> rep(
+      factory.CreateMemTableRep(key_cmp_, &arena, nullptr, nullptr));
+
+  // Each entry is inserted by two threads; only one of them succeeds.
+  std::atomic<int> inserted(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumKeys; i++) {
+        int k = (i * 7919) % kNumKeys;
+        std::string user_key = ToString(k % 1000);
+        if (Add(rep.get(), user_key, k / 1000 * 2 + t / 2, true)) {
+          inserted++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(kNumKeys * kNumThreads / 2, inserted.load());
+
+  std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+  int count = 0;
+  std::string last;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    std::string ikey = InternalKeyOf(iter->key());
+    if (count > 0) {
+      ASSERT_LT(icmp_.Compare(last, ikey), 0);
+    }
+    last = ikey;
+    count++;
+  }
+  ASSERT_EQ(kNumKeys * kNumThreads / 2, count);
+}
+
+TEST_F(ArtRepTest, OtherComparator) {
+  // Keys not in bytewise order are kept in a skip list.
+  InternalKeyComparator icmp(ReverseBytewiseComparator());
+  MemTable::KeyComparator key_cmp(icmp);
+  Arena arena;
+  AdaptiveRadixTreeRepFactory factory;
+  std::unique_ptr<MemTableRep> rep(
+      factory.CreateMemTableRep(key_cmp, &arena, nullptr, nullptr));
+  ASSERT_TRUE(Add(rep.get(), "a", 1));
+  ASSERT_TRUE(Add(rep.get(), "b", 1));
+  std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("b", ExtractUserKey(GetLengthPrefixedSlice(iter->key())));
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "SKIPPED as AdaptiveRadixTreeRep is not supported in "
+                  "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // !ROCKSDB_LITE
@@ -30,9 +30,12 @@ typedef std::atomic<void*> Pointer;
 struct BucketHeader {
   Pointer next;
   std::atomic<uint32_t> num_entries;
+  // Entries counted in num_entries whose insert has completed. Only
+  // differs from num_entries during InsertConcurrently().
+  std::atomic<uint32_t> num_linked;
 
   explicit BucketHeader(void* n, uint32_t count)
-      : next(n), num_entries(count) {}
+      : next(n), num_entries(count), num_linked(count) {}
 
   bool IsSkipListBucket() {
     return next.load(std::memory_order_relaxed) == this;
@@ -47,6 +50,8 @@ struct BucketHeader {
     // Only one thread can do write at one time. No need to do atomic
     // incremental. Update it with relaxed load and store.
     num_entries.store(GetNumEntries() + 1, std::memory_order_relaxed);
+    num_linked.store(num_linked.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
   }
 };
 
@@ -82,6 +87,10 @@ struct Node {
 
   void NoBarrier_SetNext(Node* x) { next_.store(x, std::memory_order_relaxed); }
 
+  bool CASNext(Node* expected, Node* x) {
+    return next_.compare_exchange_strong(expected, x);
+  }
+
   // Needed for placement new below which is fine
   Node() {}
 
@@ -155,6 +164,13 @@ struct Node {
 //     to itself, so no matter a reader sees any stale or newer value, it will
 //     be able to correctly distinguish case 3 and 4.
 //
+// InsertConcurrently() changes cases with a compare-and-swap of the bucket
+// pointer and links nodes into a list with a compare-and-swap of the
+// predecessor's next pointer. Each insert into a list bucket first takes a
+// ticket from num_entries; the one that gets threshold_use_skiplist_ does
+// the 3->4 change once all earlier tickets are linked, and later ones wait
+// for the skip list to be published.
+//
 // The reason that we use case 2 is we want to make the format to be efficient
 // when the utilization of buckets is relatively low. If we use case 3 for
 // single entry bucket, we will need to waste 12 bytes for every entry,
@@ -172,6 +188,10 @@ class HashLinkListRep : public MemTableRep {
 
   virtual void Insert(KeyHandle handle) override;
 
+  virtual void InsertConcurrently(KeyHandle handle) override;
+
+  virtual bool InsertKeyConcurrently(KeyHandle handle) override;
+
   virtual bool Contains(const char* key) const override;
 
   virtual size_t ApproximateMemoryUsage() override;
@@ -258,6 +278,11 @@ class HashLinkListRep : public MemTableRep {
   }
 
   Node* FindGreaterOrEqualInBucket(Node* head, const Slice& key) const;
+
+  // Links x into the sorted list that header points to. Returns false if a
+  // key equal to x's is already in the list.
+  bool LinkListInsertConcurrently(BucketHeader* header, Node* x,
+                                  const Slice& internal_key);
   Node* FindLessOrEqualInBucket(Node* head, const Slice& key) const;
 
   class FullListIterator : public MemTableRep::Iterator {
@@ -548,7 +573,8 @@ SkipListBucketHeader* HashLinkListRep::GetSkipListBucketHeader(
                std::memory_order_relaxed) == header);
     return skip_list_bucket_header;
   }
-  assert(header->GetNumEntries() <= threshold_use_skiplist_);
+  // num_entries of a list may exceed threshold_use_skiplist_ while
+  // concurrent inserts wait for it to be converted to a skip list.
   return nullptr;
 }
 
@@ -563,7 +589,6 @@ Node* HashLinkListRep::GetLinkListFirstNode(Pointer* first_next_pointer) const {
   // Counting header
   BucketHeader* header = reinterpret_cast<BucketHeader*>(first_next_pointer);
   if (!header->IsSkipListBucket()) {
-    assert(header->GetNumEntries() <= threshold_use_skiplist_);
     return reinterpret_cast<Node*>(
         header->next.load(std::memory_order_acquire));
   }
@@ -693,6 +718,134 @@ void HashLinkListRep::Insert(KeyHandle handle) {
   }
 }
 
+void HashLinkListRep::InsertConcurrently(KeyHandle handle) {
+  InsertKeyConcurrently(handle);
+}
+
+bool HashLinkListRep::InsertKeyConcurrently(KeyHandle handle) {
+  Node* x = static_cast<Node*>(handle);
+  Slice internal_key = GetLengthPrefixedSlice(x->key);
+  auto transformed = GetPrefix(internal_key);
+  auto& bucket = buckets_[GetHash(transformed)];
+
+  BucketHeader* header = nullptr;
+  while (header == nullptr) {
+    void* first_next_pointer = bucket.load(std::memory_order_acquire);
+    if (first_next_pointer == nullptr) {
+      // Case 1->2.
+      x->NoBarrier_SetNext(nullptr);
+      if (bucket.compare_exchange_strong(first_next_pointer, x)) {
+        return true;
+      }
+      continue;
+    }
+    void* next =
+        static_cast<Pointer*>(first_next_pointer)->load(
+            std::memory_order_acquire);
+    // The next pointer of a single node is only set once the bucket points
+    // to a header, so if the bucket has not changed it has the right type.
+    if (bucket.load(std::memory_order_acquire) != first_next_pointer) {
+      continue;
+    }
+    if (next != nullptr) {
+      header = static_cast<BucketHeader*>(first_next_pointer);
+      break;
+    }
+    // Case 2->3.
+    Node* first = static_cast<Node*>(first_next_pointer);
+    auto* mem = allocator_->AllocateAligned(sizeof(BucketHeader));
+    auto* new_header = new (mem) BucketHeader(first, 1);
+    if (bucket.compare_exchange_strong(first_next_pointer, new_header)) {
+      header = new_header;
+    }
+  }
+
+  if (header->IsSkipListBucket()) {
+    auto* skip_list_bucket_header =
+        reinterpret_cast<SkipListBucketHeader*>(header);
+    skip_list_bucket_header->Counting_header.num_entries.fetch_add(
+        1, std::memory_order_relaxed);
+    return skip_list_bucket_header->skip_list.InsertConcurrently(x->key);
+  }
+
+  uint32_t ticket = header->num_entries.fetch_add(1, std::memory_order_relaxed);
+  if (bucket_entries_logging_threshold_ > 0 &&
+      ticket == static_cast<uint32_t>(bucket_entries_logging_threshold_)) {
+    Info(logger_, "HashLinkedList bucket %" ROCKSDB_PRIszt
+                  " has more than %d "
+                  "entries. Key to insert: %s",
+         GetHash(transformed), ticket, internal_key.ToString(true).c_str());
+  }
+
+  if (ticket < threshold_use_skiplist_) {
+    bool res = LinkListInsertConcurrently(header, x, internal_key);
+    header->num_linked.fetch_add(1, std::memory_order_release);
+    return res;
+  }
+
+  if (ticket == threshold_use_skiplist_) {
+    // Case 3->4. Once the earlier inserts are linked, nothing else changes
+    // the list, so it can be copied without synchronization.
+    while (header->num_linked.load(std::memory_order_acquire) <
+           threshold_use_skiplist_) {
+      port::AsmVolatilePause();
+    }
+    auto mem = allocator_->AllocateAligned(sizeof(SkipListBucketHeader));
+    SkipListBucketHeader* new_skip_list_header = new (mem)
+        SkipListBucketHeader(compare_, allocator_, threshold_use_skiplist_ + 1);
+    auto& skip_list = new_skip_list_header->skip_list;
+    for (Node* n = reinterpret_cast<Node*>(
+             header->next.load(std::memory_order_acquire));
+         n != nullptr; n = n->Next()) {
+      skip_list.Insert(n->key);
+    }
+    bool res = skip_list.InsertConcurrently(x->key);
+    bucket.store(new_skip_list_header, std::memory_order_release);
+    return res;
+  }
+
+  // Wait for the insert with the threshold ticket to convert the bucket.
+  void* first_next_pointer;
+  while ((first_next_pointer = bucket.load(std::memory_order_acquire)) ==
+         header) {
+    port::AsmVolatilePause();
+  }
+  auto* skip_list_bucket_header =
+      static_cast<SkipListBucketHeader*>(first_next_pointer);
+  assert(skip_list_bucket_header->Counting_header.IsSkipListBucket());
+  skip_list_bucket_header->Counting_header.num_entries.fetch_add(
+      1, std::memory_order_relaxed);
+  return skip_list_bucket_header->skip_list.InsertConcurrently(x->key);
+}
+
+bool HashLinkListRep::LinkListInsertConcurrently(BucketHeader* header,
+                                                 Node* x,
+                                                 const Slice& internal_key) {
+  while (true) {
+    Node* prev = nullptr;
+    Node* cur = reinterpret_cast<Node*>(
+        header->next.load(std::memory_order_acquire));
+    while (KeyIsAfterNode(internal_key, cur)) {
+      prev = cur;
+      cur = cur->Next();
+    }
+    if (cur != nullptr && Equal(x->key, cur->key)) {
+      return false;
+    }
+    x->NoBarrier_SetNext(cur);
+    if (prev != nullptr) {
+      if (prev->CASNext(cur, x)) {
+        return true;
+      }
+    } else {
+      void* expected = cur;
+      if (header->next.compare_exchange_strong(expected, x)) {
+        return true;
+      }
+    }
+  }
+}
+
 bool HashLinkListRep::Contains(const char* key) const {
   Slice internal_key = GetLengthPrefixedSlice(key);
 
@@ -7,6 +7,7 @@
 #ifndef ROCKSDB_LITE
 #include "memtable/hash_skiplist_rep.h"
 
+#include <algorithm>
 #include <atomic>
 
 #include "rocksdb/memtablerep.h"
@@ -30,6 +31,10 @@ class HashSkipListRep : public MemTableRep {
 
   virtual void Insert(KeyHandle handle) override;
 
+  virtual void InsertConcurrently(KeyHandle handle) override;
+
+  virtual bool InsertKeyConcurrently(KeyHandle handle) override;
+
   virtual bool Contains(const char* key) const override;
 
   virtual size_t ApproximateMemoryUsage() override;
@@ -237,7 +242,9 @@ HashSkipListRep::HashSkipListRep(const MemTableRep::KeyComparator& compare,
                                  int32_t skiplist_branching_factor)
     : MemTableRep(allocator),
       bucket_size_(bucket_size),
-      skiplist_height_(skiplist_height),
+      // Clamped like in the buckets, which cannot be any higher.
+      skiplist_height_(
+          std::min<int32_t>(skiplist_height, Bucket::kMaxPossibleHeight)),
       skiplist_branching_factor_(skiplist_branching_factor),
       transform_(transform),
       compare_(compare),
@@ -260,9 +267,15 @@ HashSkipListRep::Bucket* HashSkipListRep::GetInitializedBucket(
   auto bucket = GetBucket(hash);
   if (bucket == nullptr) {
     auto addr = allocator_->AllocateAligned(sizeof(Bucket));
-    bucket = new (addr) Bucket(compare_, allocator_, skiplist_height_,
-                               skiplist_branching_factor_);
-    buckets_[hash].store(bucket, std::memory_order_release);
+    auto new_bucket = new (addr) Bucket(compare_, allocator_, skiplist_height_,
+                                        skiplist_branching_factor_);
+    // A concurrent insert may initialize the bucket first, in which case
+    // its list is used and ours is left in the allocator.
+    if (buckets_[hash].compare_exchange_strong(bucket, new_bucket,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+      bucket = new_bucket;
+    }
   }
   return bucket;
 }
@@ -275,6 +288,17 @@ void HashSkipListRep::Insert(KeyHandle handle) {
   bucket->Insert(key);
 }
 
+void HashSkipListRep::InsertConcurrently(KeyHandle handle) {
+  InsertKeyConcurrently(handle);
+}
+
+bool HashSkipListRep::InsertKeyConcurrently(KeyHandle handle) {
+  auto* key = static_cast<char*>(handle);
+  auto transformed = transform_->Transform(UserKey(key));
+  auto bucket = GetInitializedBucket(transformed);
+  return bucket->InsertConcurrently(key);
+}
+
 bool HashSkipListRep::Contains(const char* key) const {
   auto transformed = transform_->Transform(UserKey(key));
   auto bucket = GetBucket(transformed);
@@ -46,6 +46,7 @@
 #include <algorithm>
 #include <atomic>
 #include <type_traits>
+#include <vector>
 #include "port/likely.h"
 #include "port/port.h"
 #include "rocksdb/slice.h"
@@ -129,6 +130,11 @@ class InlineSkipList {
   // Return estimated number of entries smaller than `key`.
   uint64_t EstimateCount(const char* key) const;
 
+  // Appends about count keys of the list, spread evenly over it, to keys in
+  // order. Reads the keys of the highest level that has count of them, so
+  // it visits O(count) nodes however long the list is.
+  void SampleKeys(size_t count, std::vector<const char*>* keys) const;
+
   // Validate correctness of the skip-list.
   void TEST_Validate() const;
 
@@ -578,6 +584,34 @@ uint64_t InlineSkipList<Comparator>::EstimateCount(const char* key) const {
   }
 }
 
+template <class Comparator>
+void InlineSkipList<Comparator>::SampleKeys(
+    size_t count, std::vector<const char*>* keys) const {
+  if (count == 0) {
+    return;
+  }
+  // A node reaches each level above the bottom with probability
+  // 1/kBranching_, so the nodes of a level are an even sample of the list.
+  std::vector<const char*> level_keys;
+  for (int level = GetMaxHeight() - 1; level >= 0; level--) {
+    level_keys.clear();
+    for (Node* x = head_->Next(level); x != nullptr; x = x->Next(level)) {
+      level_keys.push_back(x->Key());
+    }
+    if (level_keys.size() >= count) {
+      break;
+    }
+  }
+  size_t n = level_keys.size();
+  if (n <= count) {
+    keys->insert(keys->end(), level_keys.begin(), level_keys.end());
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      keys->push_back(level_keys[i * n / count]);
+    }
+  }
+}
+
 template <class Comparator>
 InlineSkipList<Comparator>::InlineSkipList(const Comparator cmp,
                                            Allocator* allocator,
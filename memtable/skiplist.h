@@ -10,10 +10,11 @@
 // Thread safety
 // -------------
 //
-// Writes require external synchronization, most likely a mutex.
-// Reads require a guarantee that the SkipList will not be destroyed
-// while the read is in progress.  Apart from that, reads progress
-// without any internal locking or synchronization.
+// Writes require external synchronization, most likely a mutex, except
+// that InsertConcurrently() may be called concurrently with other calls to
+// InsertConcurrently().  Reads require a guarantee that the SkipList will
+// not be destroyed while the read is in progress.  Apart from that, reads
+// progress without any internal locking or synchronization.
 //
 // Invariants:
 //
@@ -32,6 +33,7 @@
 
 #pragma once
 #include <assert.h>
+#include <algorithm>
 #include <atomic>
 #include <stdlib.h>
 #include "port/port.h"
@@ -46,6 +48,10 @@ class SkipList {
   struct Node;
 
  public:
+  // Bound on the height of lists used with InsertConcurrently(). A larger
+  // max_height is clamped to it.
+  static const uint16_t kMaxPossibleHeight = 32;
+
   // Create a new SkipList object that will use "cmp" for comparing keys,
   // and will allocate memory using "*allocator".  Objects allocated in the
   // allocator must remain allocated for the lifetime of the skiplist object.
@@ -56,6 +62,11 @@ class SkipList {
   // REQUIRES: nothing that compares equal to key is currently in the list.
   void Insert(const Key& key);
 
+  // Like Insert, but external synchronization is not required. Returns
+  // false, without inserting, if a key that compares equal to key is
+  // already in the list.
+  bool InsertConcurrently(const Key& key);
+
   // Returns true iff an entry that compares equal to key is in the list.
   bool Contains(const Key& key) const;
 
@@ -130,6 +141,9 @@ class SkipList {
   // insertion, in which case max_height_ and prev_height_ are 1.
   Node** prev_;
   int32_t prev_height_;
+  // False once InsertConcurrently() has run, as it does not maintain prev_.
+  // The next Insert() then recomputes prev_ from scratch.
+  std::atomic<bool> prev_valid_;
 
   inline int GetMaxHeight() const {
     return max_height_.load(std::memory_order_relaxed);
@@ -155,6 +169,11 @@ class SkipList {
   // level in [0..max_height_-1], if prev is non-null.
   Node* FindLessThan(const Key& key, Node** prev = nullptr) const;
 
+  // Traverses a single level of the list, starting from before, and sets
+  // *out_prev and *out_next to the nodes between which key belongs.
+  void FindSpliceForLevel(const Key& key, Node* before, int level,
+                          Node** out_prev, Node** out_next) const;
+
   // Return the last node in the list.
   // Return head_ if list is empty.
   Node* FindLast() const;
@@ -196,6 +215,11 @@ struct SkipList<Key, Comparator>::Node {
     next_[n].store(x, std::memory_order_relaxed);
   }
 
+  bool CASNext(int n, Node* expected, Node* x) {
+    assert(n >= 0);
+    return next_[n].compare_exchange_strong(expected, x);
+  }
+
  private:
   // Array of length equal to the node height.  next_[0] is lowest level link.
   std::atomic<Node*> next_[1];
@@ -361,6 +385,25 @@ SkipList<Key, Comparator>::FindLessThan(const Key& key, Node** prev) const {
   }
 }
 
+template <typename Key, class Comparator>
+void SkipList<Key, Comparator>::FindSpliceForLevel(const Key& key,
+                                                   Node* before, int level,
+                                                   Node** out_prev,
+                                                   Node** out_next) const {
+  while (true) {
+    Node* next = before->Next(level);
+    assert(before == head_ || next == nullptr ||
+           KeyIsAfterNode(next->key, before));
+    assert(before == head_ || KeyIsAfterNode(key, before));
+    if (!KeyIsAfterNode(key, next)) {
+      *out_prev = before;
+      *out_next = next;
+      return;
+    }
+    before = next;
+  }
+}
+
 template<typename Key, class Comparator>
 typename SkipList<Key, Comparator>::Node* SkipList<Key, Comparator>::FindLast()
     const {
@@ -409,15 +452,17 @@ template <typename Key, class Comparator>
 SkipList<Key, Comparator>::SkipList(const Comparator cmp, Allocator* allocator,
                                     int32_t max_height,
                                     int32_t branching_factor)
-    : kMaxHeight_(static_cast<uint16_t>(max_height)),
+    : kMaxHeight_(static_cast<uint16_t>(
+          std::min<int32_t>(max_height, kMaxPossibleHeight))),
       kBranching_(static_cast<uint16_t>(branching_factor)),
       kScaledInverseBranching_((Random::kMaxNext + 1) / kBranching_),
       compare_(cmp),
       allocator_(allocator),
-      head_(NewNode(0 /* any key will do */, max_height)),
+      head_(NewNode(0 /* any key will do */, kMaxHeight_)),
       max_height_(1),
-      prev_height_(1) {
-  assert(max_height > 0 && kMaxHeight_ == static_cast<uint32_t>(max_height));
+      prev_height_(1),
+      prev_valid_(true) {
+  assert(max_height > 0 && kMaxHeight_ <= kMaxPossibleHeight);
   assert(branching_factor > 0 &&
          kBranching_ == static_cast<uint32_t>(branching_factor));
   assert(kScaledInverseBranching_ > 0);
@@ -435,7 +480,8 @@ SkipList<Key, Comparator>::SkipList(const Comparator cmp, Allocator* allocator,
 template<typename Key, class Comparator>
 void SkipList<Key, Comparator>::Insert(const Key& key) {
   // fast path for sequential insertion
-  if (!KeyIsAfterNode(key, prev_[0]->NoBarrier_Next(0)) &&
+  if (prev_valid_.load(std::memory_order_relaxed) &&
+      !KeyIsAfterNode(key, prev_[0]->NoBarrier_Next(0)) &&
       (prev_[0] == head_ || KeyIsAfterNode(key, prev_[0]))) {
     assert(prev_[0] != head_ || (prev_height_ == 1 && GetMaxHeight() == 1));
 
@@ -451,6 +497,7 @@ void SkipList<Key, Comparator>::Insert(const Key& key) {
     // optimization for architectures where memory_order_acquire needs
     // a synchronization instruction.  Doesn't matter on x86
     FindLessThan(key, prev_);
+    prev_valid_.store(true, std::memory_order_relaxed);
   }
 
   // Our data structure does not allow duplicate insertion
@@ -484,6 +531,55 @@ void SkipList<Key, Comparator>::Insert(const Key& key) {
   prev_height_ = height;
 }
 
+template <typename Key, class Comparator>
+bool SkipList<Key, Comparator>::InsertConcurrently(const Key& key) {
+  assert(kMaxHeight_ <= kMaxPossibleHeight);
+  if (prev_valid_.load(std::memory_order_relaxed)) {
+    prev_valid_.store(false, std::memory_order_relaxed);
+  }
+
+  int height = RandomHeight();
+  int max_height = max_height_.load(std::memory_order_relaxed);
+  while (height > max_height) {
+    // Readers that see the new height but not the new node drop down a
+    // level through head_, as in Insert().
+    if (max_height_.compare_exchange_weak(max_height, height)) {
+      max_height = height;
+      break;
+    }
+  }
+
+  // prev[i] and next[i] bracket key on level i.
+  Node* prev[kMaxPossibleHeight];
+  Node* next[kMaxPossibleHeight];
+  Node* before = head_;
+  for (int i = max_height - 1; i >= 0; i--) {
+    FindSpliceForLevel(key, before, i, &prev[i], &next[i]);
+    before = prev[i];
+  }
+  if (next[0] != nullptr && Equal(key, next[0]->key)) {
+    return false;
+  }
+
+  Node* x = NewNode(key, height);
+  for (int i = 0; i < height; i++) {
+    while (true) {
+      // Checking for duplicate keys on level 0 is sufficient.
+      if (i == 0 && next[0] != nullptr && !LessThan(key, next[0]->key)) {
+        return false;
+      }
+      x->NoBarrier_SetNext(i, next[i]);
+      if (prev[i]->CASNext(i, next[i], x)) {
+        break;
+      }
+      // Another insert got between prev[i] and next[i]; nodes are never
+      // removed, so the new position is still after prev[i].
+      FindSpliceForLevel(key, prev[i], i, &prev[i], &next[i]);
+    }
+  }
+  return true;
+}
+
 template<typename Key, class Comparator>
 bool SkipList<Key, Comparator>::Contains(const Key& key) const {
   Node* x = FindGreaterOrEqual(key);
@@ -9,8 +9,11 @@
 
 #include "memtable/skiplist.h"
 #include <set>
+#include <thread>
+#include <vector>
 #include "rocksdb/env.h"
 #include "util/arena.h"
+#include "util/concurrent_arena.h"
 #include "util/hash.h"
 #include "util/random.h"
 #include "util/testharness.h"
@@ -136,6 +139,60 @@ TEST_F(SkipTest, InsertAndLookup) {
   }
 }
 
+TEST_F(SkipTest, InsertConcurrently) {
+  const int kNumThreads = 4;
+  const int N = 5000;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  SkipList<Key, TestComparator> list(cmp, &arena);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      // Each key is inserted by two threads; only one of them succeeds.
+      for (int i = 0; i < N; i++) {
+        list.InsertConcurrently(static_cast<Key>(i * kNumThreads / 2 + t / 2));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_FALSE(list.InsertConcurrently(0));
+
+  // Sequential inserts after concurrent ones keep the list sorted.
+  Key max_key = static_cast<Key>(N * kNumThreads / 2);
+  list.Insert(max_key + 2);
+  list.Insert(max_key + 1);
+  list.Insert(max_key + 3);
+
+  SkipList<Key, TestComparator>::Iterator iter(&list);
+  Key expected = 0;
+  for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+    ASSERT_EQ(expected, iter.key());
+    expected++;
+    if (expected == max_key) {
+      expected++;
+    }
+  }
+  ASSERT_EQ(max_key + 4, expected);
+}
+
+TEST_F(SkipTest, HeightAboveMaxPossible) {
+  // InsertConcurrently() keeps its splice on the stack, so the height is
+  // clamped to kMaxPossibleHeight.
+  ConcurrentArena arena;
+  TestComparator cmp;
+  SkipList<Key, TestComparator> list(
+      cmp, &arena, SkipList<Key, TestComparator>::kMaxPossibleHeight * 2, 2);
+  for (Key i = 0; i < 1000; i++) {
+    ASSERT_TRUE(list.InsertConcurrently(i));
+  }
+  for (Key i = 0; i < 1000; i++) {
+    ASSERT_TRUE(list.Contains(i));
+  }
+}
+
 // We want to make sure that with a single writer and multiple
 // concurrent readers (with no synchronization other than when a
 // reader's iterator is created), the reader always observes all the
@@ -88,6 +88,11 @@ public:
     return (end_count >= start_count) ? (end_count - start_count) : 0;
   }
 
+  virtual void SampleEntries(size_t count,
+                             std::vector<const char*>* entries) const override {
+    skip_list_.SampleKeys(count, entries);
+  }
+
   virtual ~SkipListRep() override { }
 
   // Iteration over the contents of a skip list
@@ -11,11 +11,13 @@
 #include <memory>
 #include <algorithm>
 #include <type_traits>
+#include <vector>
 
 #include "util/arena.h"
 #include "db/memtable.h"
 #include "memtable/stl_wrappers.h"
 #include "port/port.h"
+#include "util/heap.h"
 #include "util/mutexlock.h"
 
 namespace rocksdb {
@@ -25,7 +27,8 @@ using namespace stl_wrappers;
 
 class VectorRep : public MemTableRep {
  public:
-  VectorRep(const KeyComparator& compare, Allocator* allocator, size_t count);
+  VectorRep(const KeyComparator& compare, Allocator* allocator, size_t count,
+            size_t sort_threads);
 
   // Insert key into the collection. (The caller will pack key and value into a
   // single buffer and pass that in as the parameter to Insert)
@@ -106,8 +109,106 @@ class VectorRep : public MemTableRep {
   bool immutable_;
   bool sorted_;
   const KeyComparator& compare_;
+  const size_t sort_threads_;
 };
 
+// Buckets smaller than this many entries per thread are sorted by fewer
+// threads, so that small memtables do not pay for starting threads.
+const size_t kMinEntriesPerSortThread = 8192;
+
+// Runs fn(0), ..., fn(n - 1) in parallel, fn(0) on the calling thread.
+template <typename Fn>
+void RunInParallel(size_t n, const Fn& fn) {
+  std::vector<port::Thread> threads;
+  threads.reserve(n - 1);
+  for (size_t i = 1; i < n; i++) {
+    threads.emplace_back(fn, i);
+  }
+  fn(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// Sorts the bucket with up to max_threads threads. Each thread sorts one
+// chunk of a copy of the bucket into a sorted run. The runs are then cut
+// into ranges at keys sampled from them, and each thread merges the runs
+// within one range straight into its place in the bucket. The bucket keeps
+// its storage, so iterators that point into it stay valid.
+void SortBucket(std::vector<const char*>* bucket, const Compare& cmp,
+                size_t max_threads) {
+  typedef std::vector<const char*>::iterator Cursor;
+  size_t n = bucket->size();
+  size_t num_threads = std::min(max_threads, n / kMinEntriesPerSortThread);
+  if (num_threads <= 1) {
+    std::sort(bucket->begin(), bucket->end(), cmp);
+    return;
+  }
+
+  std::vector<const char*> runs(*bucket);
+  std::vector<Cursor> run_begin(num_threads + 1);
+  for (size_t i = 0; i <= num_threads; i++) {
+    run_begin[i] = runs.begin() + n * i / num_threads;
+  }
+  RunInParallel(num_threads, [&](size_t i) {
+    std::sort(run_begin[i], run_begin[i + 1], cmp);
+  });
+
+  // Take num_threads evenly spaced keys of every run, and cut at every
+  // num_threads-th of them, so each range holds about n / num_threads keys.
+  std::vector<const char*> samples;
+  samples.reserve(num_threads * num_threads);
+  for (size_t i = 0; i < num_threads; i++) {
+    size_t run_size = run_begin[i + 1] - run_begin[i];
+    for (size_t j = 0; j < num_threads; j++) {
+      samples.push_back(*(run_begin[i] + run_size * j / num_threads));
+    }
+  }
+  std::sort(samples.begin(), samples.end(), cmp);
+  // bounds[j][i] is where range j starts in run i. Keys are unique, so each
+  // key falls in exactly one range.
+  std::vector<std::vector<Cursor>> bounds(num_threads + 1);
+  for (size_t j = 0; j <= num_threads; j++) {
+    for (size_t i = 0; i < num_threads; i++) {
+      if (j == 0) {
+        bounds[j].push_back(run_begin[i]);
+      } else if (j == num_threads) {
+        bounds[j].push_back(run_begin[i + 1]);
+      } else {
+        bounds[j].push_back(std::lower_bound(run_begin[i], run_begin[i + 1],
+                                             samples[j * num_threads], cmp));
+      }
+    }
+  }
+
+  RunInParallel(num_threads, [&](size_t j) {
+    auto out = bucket->begin();
+    for (size_t i = 0; i < num_threads; i++) {
+      out += bounds[j][i] - run_begin[i];
+    }
+    typedef std::pair<Cursor, Cursor> Range;
+    // BinaryHeap keeps the largest element on top.
+    auto greater = [&cmp](const Range& a, const Range& b) {
+      return cmp(*b.first, *a.first);
+    };
+    BinaryHeap<Range, decltype(greater)> heap(greater);
+    for (size_t i = 0; i < num_threads; i++) {
+      if (bounds[j][i] != bounds[j + 1][i]) {
+        heap.push(Range(bounds[j][i], bounds[j + 1][i]));
+      }
+    }
+    while (!heap.empty()) {
+      Range top = heap.top();
+      *out++ = *top.first++;
+      if (top.first != top.second) {
+        heap.replace_top(top);
+      } else {
+        heap.pop();
+      }
+    }
+  });
+}
+
 void VectorRep::Insert(KeyHandle handle) {
   auto* key = static_cast<char*>(handle);
   WriteLock l(&rwlock_);
@@ -136,12 +237,13 @@ size_t VectorRep::ApproximateMemoryUsage() {
 }
 
 VectorRep::VectorRep(const KeyComparator& compare, Allocator* allocator,
-                     size_t count)
+                     size_t count, size_t sort_threads)
     : MemTableRep(allocator),
       bucket_(new Bucket()),
       immutable_(false),
       sorted_(false),
-      compare_(compare) {
+      compare_(compare),
+      sort_threads_(sort_threads) {
   bucket_.get()->reserve(count);
 }
 
@@ -159,7 +261,9 @@ void VectorRep::Iterator::DoSort() const {
   if (!sorted_ && vrep_ != nullptr) {
     WriteLock l(&vrep_->rwlock_);
     if (!vrep_->sorted_) {
-      std::sort(bucket_->begin(), bucket_->end(), Compare(compare_));
+      // The bucket of an immutable memtable is sorted only once, usually
+      // by the flush, so it is worth sorting with several threads.
+      SortBucket(bucket_.get(), Compare(compare_), vrep_->sort_threads_);
       cit_ = bucket_->begin();
       vrep_->sorted_ = true;
     }
@@ -297,7 +401,7 @@ MemTableRep::Iterator* VectorRep::GetIterator(Arena* arena) {
 MemTableRep* VectorRepFactory::CreateMemTableRep(
     const MemTableRep::KeyComparator& compare, Allocator* allocator,
     const SliceTransform*, Logger* /*logger*/) {
-  return new VectorRep(compare, allocator, count_);
+  return new VectorRep(compare, allocator, count_, sort_threads_);
 }
 } // namespace rocksdb
 #endif  // ROCKSDB_LITE
@@ -168,6 +168,10 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {NUMBER_MULTIGET_KEYS_FOUND, "rocksdb.number.multiget.keys.found"},
     {NO_ITERATOR_CREATED, "rocksdb.num.iterator.created"},
     {NO_ITERATOR_DELETED, "rocksdb.num.iterator.deleted"},
+    {SDFS_BYTES_READ, "rocksdb.sdfs.bytes.read"},
+    {SDFS_BYTES_WRITTEN, "rocksdb.sdfs.bytes.written"},
+    {SDFS_ERRORS, "rocksdb.sdfs.errors"},
+    {BLOCK_CACHE_SECONDARY_HIT, "rocksdb.block.cache.secondary.hit"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -217,6 +221,13 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {BLOB_DB_COMPRESSION_MICROS, "rocksdb.blobdb.compression.micros"},
     {BLOB_DB_DECOMPRESSION_MICROS, "rocksdb.blobdb.decompression.micros"},
     {FLUSH_TIME, "rocksdb.db.flush.micros"},
+    {SDFS_OPEN_MICROS, "rocksdb.sdfs.open.micros"},
+    {SDFS_READ_MICROS, "rocksdb.sdfs.read.micros"},
+    {SDFS_PREAD_MICROS, "rocksdb.sdfs.pread.micros"},
+    {SDFS_WRITE_MICROS, "rocksdb.sdfs.write.micros"},
+    {SDFS_SYNC_MICROS, "rocksdb.sdfs.sync.micros"},
+    {SDFS_EXISTS_MICROS, "rocksdb.sdfs.exists.micros"},
+    {SDFS_GET_PATH_INFO_MICROS, "rocksdb.sdfs.get.path.info.micros"},
 };
 
 std::shared_ptr<Statistics> CreateDBStatistics() {
@@ -39,6 +39,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       db_log_dir(options.db_log_dir),
       wal_dir(options.wal_dir),
       max_subcompactions(options.max_subcompactions),
+      max_flush_partitions(options.max_flush_partitions),
       max_background_flushes(options.max_background_flushes),
       max_log_file_size(options.max_log_file_size),
       log_file_time_to_roll(options.log_file_time_to_roll),
@@ -86,7 +87,18 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       preserve_deletes(options.preserve_deletes),
       two_write_queues(options.two_write_queues),
       manual_wal_flush(options.manual_wal_flush),
-      atomic_flush(options.atomic_flush) {
+      atomic_flush(options.atomic_flush),
+      background_wal_sync(options.background_wal_sync),
+      block_cache_dump_path(options.block_cache_dump_path),
+      block_cache_dump_period_sec(options.block_cache_dump_period_sec),
+      block_cache_warmup_rate_bytes_per_sec(
+          options.block_cache_warmup_rate_bytes_per_sec),
+      memory_budget_cache(options.memory_budget_cache) {}
+
+ImmutableDBOptions::ImmutableDBOptions(
+    const DBOptions& options, std::shared_ptr<MemoryBudget> _memory_budget)
+    : ImmutableDBOptions(options) {
+  memory_budget = std::move(_memory_budget);
 }
 
 void ImmutableDBOptions::Dump(Logger* log) const {
@@ -144,6 +156,9 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(log,
                    "                     Options.max_subcompactions: %" PRIu32,
                    max_subcompactions);
+  ROCKS_LOG_HEADER(log,
+                   "                   Options.max_flush_partitions: %" PRIu32,
+                   max_flush_partitions);
   ROCKS_LOG_HEADER(log, "                 Options.max_background_flushes: %d",
                    max_background_flushes);
   ROCKS_LOG_HEADER(log,
@@ -217,6 +232,22 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    two_write_queues);
   ROCKS_LOG_HEADER(log, "            Options.manual_wal_flush: %d",
                    manual_wal_flush);
+  ROCKS_LOG_HEADER(log, "            Options.background_wal_sync: %d",
+                   background_wal_sync);
+  ROCKS_LOG_HEADER(log, "            Options.block_cache_dump_path: %s",
+                   block_cache_dump_path.c_str());
+  ROCKS_LOG_HEADER(log, "            Options.block_cache_dump_period_sec: %u",
+                   block_cache_dump_period_sec);
+  ROCKS_LOG_HEADER(
+      log, "            Options.block_cache_warmup_rate_bytes_per_sec: %" PRIu64,
+      block_cache_warmup_rate_bytes_per_sec);
+  if (memory_budget_cache) {
+    ROCKS_LOG_HEADER(
+        log, "            Options.memory_budget_cache: %" PRIu64,
+        static_cast<uint64_t>(memory_budget_cache->GetCapacity()));
+  } else {
+    ROCKS_LOG_HEADER(log, "            Options.memory_budget_cache: None");
+  }
 }
 
 MutableDBOptions::MutableDBOptions()
@@ -12,9 +12,15 @@
 
 namespace rocksdb {
 
+class MemoryBudget;
+
 struct ImmutableDBOptions {
   ImmutableDBOptions();
   explicit ImmutableDBOptions(const DBOptions& options);
+  // Only the options of an open DB have a memory budget, which DBImpl builds
+  // once and which copies of the options share.
+  ImmutableDBOptions(const DBOptions& options,
+                     std::shared_ptr<MemoryBudget> _memory_budget);
 
   void Dump(Logger* log) const;
 
@@ -34,6 +40,7 @@ struct ImmutableDBOptions {
   std::string db_log_dir;
   std::string wal_dir;
   uint32_t max_subcompactions;
+  uint32_t max_flush_partitions;
   int max_background_flushes;
   size_t max_log_file_size;
   size_t log_file_time_to_roll;
@@ -79,6 +86,14 @@ struct ImmutableDBOptions {
   bool two_write_queues;
   bool manual_wal_flush;
   bool atomic_flush;
+  bool background_wal_sync;
+  std::string block_cache_dump_path;
+  unsigned int block_cache_dump_period_sec;
+  uint64_t block_cache_warmup_rate_bytes_per_sec;
+  std::shared_ptr<Cache> memory_budget_cache;
+  // Created from memory_budget_cache, shared by the column families.
+  // Null unless passed to the constructor.
+  std::shared_ptr<MemoryBudget> memory_budget;
 };
 
 struct MutableDBOptions {
@@ -59,6 +59,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.bytes_per_sync = mutable_db_options.bytes_per_sync;
   options.wal_bytes_per_sync = mutable_db_options.wal_bytes_per_sync;
   options.max_subcompactions = immutable_db_options.max_subcompactions;
+  options.max_flush_partitions = immutable_db_options.max_flush_partitions;
   options.max_background_flushes = immutable_db_options.max_background_flushes;
   options.max_log_file_size = immutable_db_options.max_log_file_size;
   options.log_file_time_to_roll = immutable_db_options.log_file_time_to_roll;
@@ -127,6 +128,13 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.two_write_queues = immutable_db_options.two_write_queues;
   options.manual_wal_flush = immutable_db_options.manual_wal_flush;
   options.atomic_flush = immutable_db_options.atomic_flush;
+  options.background_wal_sync = immutable_db_options.background_wal_sync;
+  options.block_cache_dump_path = immutable_db_options.block_cache_dump_path;
+  options.block_cache_dump_period_sec =
+      immutable_db_options.block_cache_dump_period_sec;
+  options.block_cache_warmup_rate_bytes_per_sec =
+      immutable_db_options.block_cache_warmup_rate_bytes_per_sec;
+  options.memory_budget_cache = immutable_db_options.memory_budget_cache;
 
   return options;
 }
@@ -142,6 +150,8 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
   cf_opts.arena_block_size = mutable_cf_options.arena_block_size;
   cf_opts.memtable_prefix_bloom_size_ratio =
       mutable_cf_options.memtable_prefix_bloom_size_ratio;
+  cf_opts.memtable_whole_key_filtering =
+      mutable_cf_options.memtable_whole_key_filtering;
   cf_opts.memtable_huge_page_size = mutable_cf_options.memtable_huge_page_size;
   cf_opts.max_successive_merges = mutable_cf_options.max_successive_merges;
   cf_opts.inplace_update_num_locks =
@@ -1327,6 +1337,7 @@ std::unordered_map<std::string, OptionTypeInfo>
          // not yet supported
           Env* env;
           std::shared_ptr<Cache> row_cache;
+          std::shared_ptr<Cache> memory_budget_cache;
           std::shared_ptr<DeleteScheduler> delete_scheduler;
           std::shared_ptr<Logger> info_log;
           std::shared_ptr<RateLimiter> rate_limiter;
@@ -1459,6 +1470,9 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"max_subcompactions",
          {offsetof(struct DBOptions, max_subcompactions), OptionType::kUInt32T,
           OptionVerificationType::kNormal, false, 0}},
+        {"max_flush_partitions",
+         {offsetof(struct DBOptions, max_flush_partitions),
+          OptionType::kUInt32T, OptionVerificationType::kNormal, false, 0}},
         {"WAL_size_limit_MB",
          {offsetof(struct DBOptions, WAL_size_limit_MB), OptionType::kUInt64T,
           OptionVerificationType::kNormal, false, 0}},
@@ -1560,7 +1574,24 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"atomic_flush",
          {offsetof(struct DBOptions, atomic_flush), OptionType::kBoolean,
           OptionVerificationType::kNormal, false,
-          offsetof(struct ImmutableDBOptions, atomic_flush)}}};
+          offsetof(struct ImmutableDBOptions, atomic_flush)}},
+        {"background_wal_sync",
+         {offsetof(struct DBOptions, background_wal_sync), OptionType::kBoolean,
+          OptionVerificationType::kNormal, false,
+          offsetof(struct ImmutableDBOptions, background_wal_sync)}},
+        {"block_cache_dump_path",
+         {offsetof(struct DBOptions, block_cache_dump_path), OptionType::kString,
+          OptionVerificationType::kNormal, false,
+          offsetof(struct ImmutableDBOptions, block_cache_dump_path)}},
+        {"block_cache_dump_period_sec",
+         {offsetof(struct DBOptions, block_cache_dump_period_sec),
+          OptionType::kUInt, OptionVerificationType::kNormal, false,
+          offsetof(struct ImmutableDBOptions, block_cache_dump_period_sec)}},
+        {"block_cache_warmup_rate_bytes_per_sec",
+         {offsetof(struct DBOptions, block_cache_warmup_rate_bytes_per_sec),
+          OptionType::kUInt64T, OptionVerificationType::kNormal, false,
+          offsetof(struct ImmutableDBOptions,
+                   block_cache_warmup_rate_bytes_per_sec)}}};
 
 std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
     OptionsHelper::block_base_table_index_type_string_map = {
@@ -1798,6 +1829,10 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offset_of(&ColumnFamilyOptions::memtable_prefix_bloom_size_ratio),
           OptionType::kDouble, OptionVerificationType::kNormal, true,
           offsetof(struct MutableCFOptions, memtable_prefix_bloom_size_ratio)}},
+        {"memtable_whole_key_filtering",
+         {offset_of(&ColumnFamilyOptions::memtable_whole_key_filtering),
+          OptionType::kBoolean, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, memtable_whole_key_filtering)}},
         {"memtable_prefix_bloom_probes",
          {0, OptionType::kUInt32T, OptionVerificationType::kDeprecated, true,
           0}},
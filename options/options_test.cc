@@ -703,6 +703,11 @@ TEST_F(OptionsTest, GetMemTableRepFactoryFromString) {
   ASSERT_NOK(GetMemTableRepFactoryFromString("vector:1024:invalid_opt",
                                              &new_mem_factory));
 
+  ASSERT_OK(GetMemTableRepFactoryFromString("art", &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()),
+            "AdaptiveRadixTreeRepFactory");
+  ASSERT_NOK(GetMemTableRepFactoryFromString("art:1024", &new_mem_factory));
+
   ASSERT_NOK(GetMemTableRepFactoryFromString("cuckoo", &new_mem_factory));
   ASSERT_OK(GetMemTableRepFactoryFromString("cuckoo:1024", &new_mem_factory));
   ASSERT_EQ(std::string(new_mem_factory->Name()), "HashCuckooRepFactory");
@@ -2,13 +2,21 @@
 #include <algorithm>
 #include <stdio.h>
 #include <time.h>
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "port/sys_time.h"
 #include "rocksdb/env.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
+#include "rocksdb/threadpool.h"
 
 #ifdef USE_SDFS
+#ifndef SDFS_LOCAL
 #include <libsdfs.h>
+#endif
 #include "sdfs/sdfs.h"
 
 #define SDFS_EXISTS 0
@@ -17,6 +25,8 @@
 
 namespace rocksdb {
 
+class HistogramImpl;
+
 class SdfsUsageException : public std::exception { };
 
 class SdfsFatalException : public std::exception {
@@ -30,6 +40,109 @@ class SdfsFatalException : public std::exception {
   const std::string what_;
 };
 
+// Latency, byte and error counts of the calls SdfsEnv makes into SDFS. They
+// are always collected, at the cost of two clock reads per call, and are
+// reported by SdfsEnv::GetIOStats(). If a Statistics object is attached the
+// same numbers also go to its SDFS_* tickers and histograms. Thread-safe.
+class SdfsIOStats {
+ public:
+  enum Op : uint32_t {
+    kOpen = 0,
+    // Sequential sdfsRead
+    kRead,
+    kPread,
+    kWrite,
+    // sdfsFlush followed by sdfsHSync
+    kSync,
+    kExists,
+    kGetPathInfo,
+    kNumOps
+  };
+
+  explicit SdfsIOStats(Env* clock);
+  ~SdfsIOStats();
+
+  uint64_t NowMicros() { return clock_->NowMicros(); }
+
+  void Record(Op op, uint64_t micros, uint64_t bytes, bool failed);
+
+  // Not synchronized with Record(), call it before the env is in use.
+  void SetStatistics(const std::shared_ptr<Statistics>& statistics) {
+      statistics_ = statistics;
+  }
+
+  void Reset();
+
+  std::string ToString() const;
+
+ private:
+  Env* clock_;
+  std::shared_ptr<Statistics> statistics_;
+  // kNumOps histograms, indexed by Op.
+  std::unique_ptr<HistogramImpl[]> latency_;
+  std::atomic<uint64_t> bytes_[kNumOps];
+  std::atomic<uint64_t> errors_[kNumOps];
+};
+
+// Caches the answers of sdfsExists and sdfsGetPathInfo so that DB open,
+// table cache misses and obsolete file scans do not each cost a name node
+// round trip. Paths changed through the owning SdfsEnv are invalidated
+// right away; changes made by other clients become visible once the entry
+// is older than the TTL. A TTL of 0 disables caching. Thread-safe.
+class SdfsMetadataCache {
+ public:
+  SdfsMetadataCache(sdfsFS fileSys, Env* clock, uint64_t ttl_micros,
+                    SdfsIOStats* io_stats = nullptr);
+
+  // Same contract as sdfsExists().
+  int Exists(const std::string& path);
+
+  // Same contract as sdfsGetPathInfo().
+  int GetPathInfo(const std::string& path, sdfsFileInfo* info);
+
+  // Records that path exists, e.g. because a directory listing returned it.
+  void AddExisting(const std::string& path);
+
+  // Records that path no longer exists.
+  void AddDeleted(const std::string& path);
+
+  void Invalidate(const std::string& path);
+
+  // Drops path and every entry below it.
+  void InvalidateTree(const std::string& path);
+
+  void SetTTL(uint64_t ttl_micros);
+
+ private:
+  struct Entry {
+    bool exists;
+    // True if size and mtime are known, not only existence.
+    bool has_info;
+    sdfsFileInfo info;
+    uint64_t expire_micros;
+  };
+
+  // Beyond this many entries the cache is reset rather than evicting
+  // entries one at a time.
+  static const size_t kMaxEntries = 1 << 20;
+
+  // Returns the generation observed by the lookup. Insert() drops the entry
+  // if anything was invalidated since, as the answer may predate it.
+  bool Lookup(const std::string& path, Entry* entry, uint64_t* generation);
+  void Insert(const std::string& path, const Entry& entry,
+              uint64_t generation);
+  // REQUIRES: mu_ held
+  void InsertLocked(const std::string& path, const Entry& entry);
+
+  sdfsFS fileSys_;
+  Env* clock_;
+  SdfsIOStats* io_stats_;
+  std::mutex mu_;
+  uint64_t ttl_micros_;
+  uint64_t generation_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
 class SdfsEnv : public Env {
 
  public:
@@ -72,12 +185,16 @@ class SdfsEnv : public Env {
 
   virtual Status RenameFile(const std::string& src, const std::string& target);
 
+  // SDFS has no hard links. Callers fall back to CopyFile() or to copying
+  // the data through the client.
   virtual Status LinkFile(const std::string& src, const std::string& target) {
       (void)src;
       (void)target;
-      return Status::NotSupported(); 
+      return Status::NotSupported();
   }
 
+  virtual Status CopyFile(const std::string& src, const std::string& target);
+
   virtual Status LockFile(const std::string& fname, FileLock** lock);
 
   virtual Status UnlockFile(FileLock* lock);
@@ -155,10 +272,58 @@ class SdfsEnv : public Env {
       return SdfsEnv::gettid();
   }
 
+  // If true, writable files created afterwards write out a full buffer in
+  // the background while the next one is being filled. The writes of all
+  // such files share a pool of kPipelinedWriteThreads threads.
+  // Default: false
+  void SetPipelinedWrites(bool pipelined);
+
+  static const int kPipelinedWriteThreads = 4;
+
+  // Number of threads serving RandomAccessFile::MultiRead requests. They
+  // are started by the first MultiRead of more than one request.
+  // Default: kDefaultMultiReadThreads
+  void SetMultiReadThreads(int num);
+
+  // Returns the pool serving MultiRead requests, creating it on first use.
+  ThreadPool* GetMultiReadPool();
+
+  static const int kDefaultMultiReadThreads = 8;
+
+  // How long metadata of files not changed through this env may be served
+  // from the cache. 0 disables the cache.
+  // Default: kDefaultMetadataCacheTTLMicros
+  void SetMetadataCacheTTL(uint64_t ttl_micros) {
+      metadata_cache_->SetTTL(ttl_micros);
+  }
+
+  static const uint64_t kDefaultMetadataCacheTTLMicros = 1000000;
+
+  // Also report the SDFS call latencies and byte counts to statistics,
+  // typically the DB's Options::statistics. Call before opening a DB.
+  void SetStatistics(const std::shared_ptr<Statistics>& statistics) {
+      io_stats_->SetStatistics(statistics);
+  }
+
+  virtual Status GetIOStats(std::string* stats) override {
+      *stats = io_stats_->ToString();
+      return Status::OK();
+  }
+
+  void ResetIOStats() { io_stats_->Reset(); }
+
  private:
   std::string fsname_;  
   sdfsFS fileSys_;      
   Env*  posixEnv;       
+  std::unique_ptr<SdfsIOStats> io_stats_;
+  std::unique_ptr<SdfsMetadataCache> metadata_cache_;
+  // Guards creation of the thread pools.
+  std::mutex pool_mu_;
+  int multi_read_threads_;
+  std::unique_ptr<ThreadPool> read_pool_;
+  std::unique_ptr<ThreadPool> write_pool_;
+  std::atomic<bool> pipelined_writes_;
 
   static const std::string kProto;
   static const std::string pathsep;
@@ -291,6 +456,11 @@ class SdfsEnv : public Env {
       return sdfsNotSup;
   }
 
+  virtual Status CopyFile(const std::string& src,
+                          const std::string& target) override {
+      return sdfsNotSup;
+  }
+
   virtual Status LockFile(const std::string& fname, FileLock** lock) override {
       return sdfsNotSup;
   }
@@ -343,6 +513,18 @@ class SdfsEnv : public Env {
   virtual uint64_t GetThreadID() const override {
       return 0;
   }
+
+  void SetPipelinedWrites(bool pipelined) {}
+
+  void SetMultiReadThreads(int num) {}
+
+  void SetMetadataCacheTTL(uint64_t ttl_micros) {}
+
+  static const uint64_t kDefaultMetadataCacheTTLMicros = 0;
+
+  void SetStatistics(const std::shared_ptr<Statistics>& statistics) {}
+
+  void ResetIOStats() {}
 };
 }
 
@@ -1,5 +1,9 @@
 #include "sdfs/env_sdfs.h"
 
+// Binding of the sdfs.h API to the Go SDFS client. Built with USE_SDFS
+// unless SDFS_LOCAL selects the local stand-in in sdfs_local.cc instead.
+#if defined(USE_SDFS) && !defined(SDFS_LOCAL)
+
 sdfsFS sdfsConnectNewInstance(const char* nn, tPort port) {
     (void)nn;
     (void)port;
@@ -116,9 +120,10 @@ int sdfsCopy(sdfsFS srcFS, const char* src, sdfsFS dstFS, const char* dst) {
     (void)src;
     (void)dstFS;
     (void)dst;
-    LOG("sdfsCopy");
-    exit(0);
-    return 0;
+    // The Go client does not export a server-side copy yet. Report it as
+    // unsupported so callers fall back to copying through the client.
+    errno = ENOTSUP;
+    return -1;
 }
 
 int sdfsDelete(sdfsFS fs, const char* path, int recursive) {
@@ -158,3 +163,5 @@ int sdfsHSync(sdfsFS fs, sdfsFile file) {
     int ret = GoSdfsHSyncINode(file);
     return ret;
 }
+
+#endif  // defined(USE_SDFS) && !defined(SDFS_LOCAL)
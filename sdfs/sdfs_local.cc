@@ -0,0 +1,461 @@
+// Local stand-in for the SDFS client library, enabled by building with
+// USE_SDFS and SDFS_LOCAL. It implements the sdfs.h API on top of a
+// directory of the local filesystem and delays every call to mimic a
+// remote file system, so SdfsEnv and db_bench can be measured on a single
+// machine without a name node.
+//
+// Configured through environment variables read on the first connect:
+//   SDFS_LOCAL_ROOT          directory backing "/", default /tmp/sdfs_local
+//   SDFS_LOCAL_LATENCY_US    fixed delay added to every call, default 0
+//   SDFS_LOCAL_SYNC_LATENCY_US  fixed delay of sdfsHSync, which waits for
+//                            all replicas, default SDFS_LOCAL_LATENCY_US
+//   SDFS_LOCAL_JITTER_US     uniformly distributed extra delay in
+//                            [0, jitter], default 0
+//   SDFS_LOCAL_BANDWIDTH_MB  bandwidth in MB/s shared by all reads and
+//                            writes, 0 (the default) means unlimited
+
+#include "sdfs/env_sdfs.h"
+
+#if defined(USE_SDFS) && defined(SDFS_LOCAL)
+
+#include <dirent.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "util/random.h"
+
+namespace {
+
+struct LocalFile {
+  int fd;
+  std::string path;
+};
+
+class LocalSdfs {
+ public:
+  static LocalSdfs* Instance() {
+    static LocalSdfs* instance = new LocalSdfs();
+    return instance;
+  }
+
+  // Maps an SDFS path to the backing local path.
+  std::string LocalPath(const char* path) const {
+    std::string p(path);
+    if (p.empty() || p[0] != '/') {
+      p = "/" + p;
+    }
+    return root_ + p;
+  }
+
+  // Sleeps for the configured per-call latency plus the time needed to
+  // move bytes at the configured bandwidth. Bandwidth is reserved in
+  // arrival order, so concurrent transfers queue behind each other.
+  void Delay(uint64_t bytes, bool sync = false) {
+    rocksdb::Env* env = rocksdb::Env::Default();
+    uint64_t delay = sync ? sync_latency_micros_ : latency_micros_;
+    if (jitter_micros_ > 0) {
+      delay += rocksdb::Random::GetTLSInstance()->Uniform(
+          static_cast<int>(jitter_micros_ + 1));
+    }
+    uint64_t now = env->NowMicros();
+    uint64_t done = now + delay;
+    if (bytes_per_sec_ > 0 && bytes > 0) {
+      std::lock_guard<std::mutex> lock(mu_);
+      uint64_t start = std::max(now, next_transfer_micros_);
+      next_transfer_micros_ = start + bytes * 1000000 / bytes_per_sec_;
+      done = std::max(done, next_transfer_micros_);
+    }
+    if (done > now) {
+      env->SleepForMicroseconds(static_cast<int>(done - now));
+    }
+  }
+
+  sdfsFile Open(const std::string& path, int fd) {
+    std::lock_guard<std::mutex> lock(mu_);
+    sdfsFile handle = ++last_handle_;
+    files_[handle] = LocalFile{fd, path};
+    return handle;
+  }
+
+  // Returns -1 and sets errno if file is not open.
+  int GetFd(sdfsFile file) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = files_.find(file);
+    if (it == files_.end()) {
+      errno = EBADF;
+      return -1;
+    }
+    return it->second.fd;
+  }
+
+  int Close(sdfsFile file) {
+    int fd;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      auto it = files_.find(file);
+      if (it == files_.end()) {
+        errno = EBADF;
+        return -1;
+      }
+      fd = it->second.fd;
+      files_.erase(it);
+    }
+    return close(fd);
+  }
+
+  sdfsFS fs() { return &fs_; }
+
+ private:
+  LocalSdfs()
+      : latency_micros_(GetEnvUint64("SDFS_LOCAL_LATENCY_US", 0)),
+        sync_latency_micros_(
+            GetEnvUint64("SDFS_LOCAL_SYNC_LATENCY_US", latency_micros_)),
+        jitter_micros_(GetEnvUint64("SDFS_LOCAL_JITTER_US", 0)),
+        bytes_per_sec_(GetEnvUint64("SDFS_LOCAL_BANDWIDTH_MB", 0) << 20),
+        next_transfer_micros_(0),
+        last_handle_(0) {
+    const char* root = getenv("SDFS_LOCAL_ROOT");
+    root_ = (root != nullptr && root[0] != '\0') ? root : "/tmp/sdfs_local";
+    while (root_.size() > 1 && root_.back() == '/') {
+      root_.pop_back();
+    }
+    rocksdb::Env::Default()->CreateDirIfMissing(root_);
+    fprintf(stderr,
+            "sdfs: using local stand-in at %s, latency %" PRIu64
+            "us, sync latency %" PRIu64 "us, jitter %" PRIu64
+            "us, bandwidth %" PRIu64 "MB/s\n",
+            root_.c_str(), latency_micros_, sync_latency_micros_,
+            jitter_micros_, bytes_per_sec_ >> 20);
+  }
+
+  static uint64_t GetEnvUint64(const char* name, uint64_t default_value) {
+    const char* value = getenv(name);
+    if (value == nullptr || value[0] == '\0') {
+      return default_value;
+    }
+    return strtoull(value, nullptr, 10);
+  }
+
+  std::string root_;
+  const uint64_t latency_micros_;
+  const uint64_t sync_latency_micros_;
+  const uint64_t jitter_micros_;
+  const uint64_t bytes_per_sec_;
+  SdfsInternal fs_;
+
+  std::mutex mu_;
+  uint64_t next_transfer_micros_;
+  sdfsFile last_handle_;
+  std::unordered_map<sdfsFile, LocalFile> files_;
+};
+
+// Creates the missing parents of path, then path itself, which must not
+// exist yet.
+int MakeDirs(const std::string& path) {
+  size_t pos = 0;
+  while ((pos = path.find('/', pos + 1)) != std::string::npos) {
+    if (mkdir(path.substr(0, pos).c_str(), 0755) != 0 && errno != EEXIST) {
+      return -1;
+    }
+  }
+  return mkdir(path.c_str(), 0755);
+}
+
+int RemoveTree(const std::string& path) {
+  struct stat st;
+  if (lstat(path.c_str(), &st) != 0) {
+    return -1;
+  }
+  if (!S_ISDIR(st.st_mode)) {
+    return unlink(path.c_str());
+  }
+  DIR* dir = opendir(path.c_str());
+  if (dir == nullptr) {
+    return -1;
+  }
+  int ret = 0;
+  struct dirent* entry;
+  while (ret == 0 && (entry = readdir(dir)) != nullptr) {
+    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+      ret = RemoveTree(path + "/" + entry->d_name);
+    }
+  }
+  closedir(dir);
+  return ret == 0 ? rmdir(path.c_str()) : ret;
+}
+
+}  // namespace
+
+sdfsFS sdfsConnectNewInstance(const char* nn, tPort port) {
+  (void)nn;
+  (void)port;
+  return LocalSdfs::Instance()->fs();
+}
+
+int sdfsDisconnect(sdfsFS fs) {
+  (void)fs;
+  return 0;
+}
+
+int sdfsGetPathInfo(sdfsFS fs, const char* path, sdfsFileInfo* pFileInfo) {
+  (void)fs;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  sdfs->Delay(0);
+  struct stat st;
+  if (stat(sdfs->LocalPath(path).c_str(), &st) != 0) {
+    return -1;
+  }
+  pFileInfo->mSize = st.st_size;
+  pFileInfo->mLastMod = st.st_mtime;
+  return 0;
+}
+
+int sdfsCreateDirectory(sdfsFS fs, const char* path) {
+  (void)fs;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  sdfs->Delay(0);
+  return MakeDirs(sdfs->LocalPath(path));
+}
+
+// inodePathArr actually points to a void**, which receives an array of the
+// full SDFS paths of the children. Like the real client, the paths are
+// malloc()ed and released with sdfsFreeArr(); the array itself stays valid
+// until the next listing from the same thread.
+void sdfsListDirectory(sdfsFS fs, const char* path, void** inodePathArr,
+                       int* numEntries) {
+  (void)fs;
+  static thread_local std::vector<void*> entries;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  sdfs->Delay(0);
+  entries.clear();
+  *numEntries = -1;
+  DIR* dir = opendir(sdfs->LocalPath(path).c_str());
+  if (dir == nullptr) {
+    return;
+  }
+  std::string prefix(path);
+  if (prefix.empty() || prefix.back() != '/') {
+    prefix.push_back('/');
+  }
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+      entries.push_back(strdup((prefix + entry->d_name).c_str()));
+    }
+  }
+  closedir(dir);
+  *reinterpret_cast<void***>(inodePathArr) = entries.data();
+  *numEntries = static_cast<int>(entries.size());
+}
+
+sdfsFile sdfsOpenFile(sdfsFS fs, const char* path, int flags, int bufferSize,
+                      short replication, tSize blocksize) {
+  (void)fs;
+  (void)bufferSize;
+  (void)replication;
+  (void)blocksize;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  sdfs->Delay(0);
+  std::string local_path = sdfs->LocalPath(path);
+  // Like HDFS, opening for write creates the file or truncates it.
+  int fd = (flags & O_WRONLY)
+               ? open(local_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)
+               : open(local_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  return sdfs->Open(local_path, fd);
+}
+
+tOffset sdfsTell(sdfsFS fs, sdfsFile file) {
+  (void)fs;
+  int fd = LocalSdfs::Instance()->GetFd(file);
+  if (fd < 0) {
+    return -1;
+  }
+  return lseek(fd, 0, SEEK_CUR);
+}
+
+int sdfsSeek(sdfsFS fs, sdfsFile file, tOffset desiredPos) {
+  (void)fs;
+  int fd = LocalSdfs::Instance()->GetFd(file);
+  if (fd < 0 || lseek(fd, desiredPos, SEEK_SET) < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+tSize sdfsPread(sdfsFS fs, sdfsFile file, tOffset position, void* buffer,
+                tSize length) {
+  (void)fs;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  int fd = sdfs->GetFd(file);
+  if (fd < 0) {
+    return -1;
+  }
+  sdfs->Delay(length);
+  char* dst = static_cast<char*>(buffer);
+  tSize total = 0;
+  while (total < length) {
+    ssize_t n = pread(fd, dst + total, length - total, position + total);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    if (n == 0) {
+      break;
+    }
+    total += static_cast<tSize>(n);
+  }
+  return total;
+}
+
+tSize sdfsRead(sdfsFS fs, sdfsFile file, void* buffer, tSize length) {
+  (void)fs;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  int fd = sdfs->GetFd(file);
+  if (fd < 0) {
+    return -1;
+  }
+  sdfs->Delay(length);
+  ssize_t n;
+  do {
+    n = read(fd, buffer, length);
+  } while (n < 0 && errno == EINTR);
+  return static_cast<tSize>(n);
+}
+
+tSize sdfsWrite(sdfsFS fs, sdfsFile file, const void* buffer, tSize length) {
+  (void)fs;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  int fd = sdfs->GetFd(file);
+  if (fd < 0) {
+    return -1;
+  }
+  sdfs->Delay(length);
+  const char* src = static_cast<const char*>(buffer);
+  tSize total = 0;
+  while (total < length) {
+    ssize_t n = write(fd, src + total, length - total);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    total += static_cast<tSize>(n);
+  }
+  return total;
+}
+
+int sdfsExists(sdfsFS fs, const char* path) {
+  (void)fs;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  sdfs->Delay(0);
+  struct stat st;
+  return stat(sdfs->LocalPath(path).c_str(), &st) == 0 ? SDFS_EXISTS
+                                                       : SDFS_DOESNT_EXIST;
+}
+
+// Emulates a server-side copy: one round trip, no client bandwidth used.
+int sdfsCopy(sdfsFS srcFS, const char* src, sdfsFS dstFS, const char* dst) {
+  (void)srcFS;
+  (void)dstFS;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  sdfs->Delay(0);
+  rocksdb::Env* env = rocksdb::Env::Default();
+  std::string src_path = sdfs->LocalPath(src);
+  std::string dst_path = sdfs->LocalPath(dst);
+  std::unique_ptr<rocksdb::SequentialFile> in;
+  std::unique_ptr<rocksdb::WritableFile> out;
+  rocksdb::EnvOptions options;
+  rocksdb::Status s = env->NewSequentialFile(src_path, &in, options);
+  if (s.ok()) {
+    s = env->NewWritableFile(dst_path, &out, options);
+  }
+  std::unique_ptr<char[]> buf(new char[1 << 20]);
+  while (s.ok()) {
+    rocksdb::Slice data;
+    s = in->Read(1 << 20, &data, buf.get());
+    if (!s.ok() || data.empty()) {
+      break;
+    }
+    s = out->Append(data);
+  }
+  // The copy must be as durable as a file written and synced by a client.
+  if (s.ok()) {
+    s = out->Sync();
+  }
+  if (s.ok()) {
+    s = out->Close();
+  }
+  if (!s.ok()) {
+    errno = s.IsNotFound() ? ENOENT : EIO;
+    return -1;
+  }
+  return 0;
+}
+
+int sdfsDelete(sdfsFS fs, const char* path, int recursive) {
+  (void)fs;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  sdfs->Delay(0);
+  std::string local_path = sdfs->LocalPath(path);
+  if (recursive) {
+    return RemoveTree(local_path);
+  }
+  return remove(local_path.c_str());
+}
+
+int sdfsRename(sdfsFS fs, const char* oldPath, const char* newPath) {
+  (void)fs;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  sdfs->Delay(0);
+  return rename(sdfs->LocalPath(oldPath).c_str(),
+                sdfs->LocalPath(newPath).c_str());
+}
+
+int sdfsCloseFile(sdfsFS fs, sdfsFile file) {
+  (void)fs;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  sdfs->Delay(0);
+  return sdfs->Close(file);
+}
+
+// Written data is handed to the kernel right away, so there is nothing to
+// flush on the client side.
+int sdfsFlush(sdfsFS fs, sdfsFile file) {
+  (void)fs;
+  return LocalSdfs::Instance()->GetFd(file) < 0 ? -1 : 0;
+}
+
+int sdfsHFlush(sdfsFS fs, sdfsFile file) {
+  (void)fs;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  sdfs->Delay(0);
+  return sdfs->GetFd(file) < 0 ? -1 : 0;
+}
+
+int sdfsHSync(sdfsFS fs, sdfsFile file) {
+  (void)fs;
+  LocalSdfs* sdfs = LocalSdfs::Instance();
+  int fd = sdfs->GetFd(file);
+  if (fd < 0) {
+    return -1;
+  }
+  sdfs->Delay(0, true /* sync */);
+  return fdatasync(fd);
+}
+
+#endif  // defined(USE_SDFS) && defined(SDFS_LOCAL)
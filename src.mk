@@ -1,7 +1,10 @@
 # These are the sources from which librocksdb.a is built:
 LIB_SOURCES =                                                   \
+  cache/cache_reservation_manager.cc                            \
   cache/clock_cache.cc                                          \
+  cache/compressed_secondary_cache.cc                           \
   cache/lru_cache.cc                                            \
+  cache/memory_budget.cc                                        \
   cache/sharded_cache.cc                                        \
   db/builder.cc                                                 \
   db/c.cc                                                       \
@@ -16,6 +19,7 @@ LIB_SOURCES =                                                   \
   db/convenience.cc                                             \
   db/db_filesnapshot.cc                                         \
   db/db_impl.cc                                                 \
+  db/db_impl_block_cache.cc                                     \
   db/db_impl_compaction_flush.cc                                \
   db/db_impl_debug.cc                                           \
   db/db_impl_experimental.cc                                    \
@@ -62,12 +66,16 @@ LIB_SOURCES =                                                   \
   env/env_chroot.cc                                             \
   env/env_encryption.cc                                         \
   env/env_hdfs.cc                                               \
+  env/env_local_cache.cc                                        \
+  env/env_routing.cc                                            \
   sdfs/sdfs.cc                                               \
+  sdfs/sdfs_local.cc                                         \
   env/env_sdfs.cc                                               \
   env/env_posix.cc                                              \
   env/io_posix.cc                                               \
   env/mock_env.cc                                               \
   memtable/alloc_tracker.cc                                     \
+  memtable/art_rep.cc                                           \
   memtable/hash_cuckoo_rep.cc                                   \
   memtable/hash_linklist_rep.cc                                 \
   memtable/hash_skiplist_rep.cc                                 \
@@ -148,6 +156,7 @@ LIB_SOURCES =                                                   \
   util/filename.cc                                              \
   util/filter_policy.cc                                         \
   util/hash.cc                                                  \
+  util/huge_page_allocator.cc                                   \
   util/jemalloc_nodump_allocator.cc                             \
   util/log_buffer.cc                                            \
   util/murmurhash.cc                                            \
@@ -204,6 +213,7 @@ LIB_SOURCES =                                                   \
   utilities/persistent_cache/persistent_cache_tier.cc           \
   utilities/persistent_cache/volatile_tier_impl.cc              \
   utilities/redis/redis_lists.cc                                \
+  utilities/simulator_cache/miss_ratio_curve.cc                 \
   utilities/simulator_cache/sim_cache.cc                        \
   utilities/spatialdb/spatial_db.cc                             \
   utilities/table_properties_collectors/compact_on_deletion_collector.cc \
@@ -347,8 +357,11 @@ MAIN_SOURCES =                                                          \
   db/write_callback_test.cc                                             \
   db/write_controller_test.cc                                           \
   env/env_basic_test.cc                                                 \
+  env/env_local_cache_test.cc                                           \
+  env/env_routing_test.cc                                               \
   env/env_test.cc                                                       \
   env/mock_env_test.cc                                                  \
+  memtable/art_rep_test.cc                                              \
   memtable/inlineskiplist_test.cc                                       \
   memtable/memtablerep_bench.cc                                         \
   memtable/skiplist_test.cc                                             \
@@ -385,6 +398,7 @@ MAIN_SOURCES =                                                          \
   util/dynamic_bloom_test.cc                                            \
   util/event_logger_test.cc                                             \
   util/filelock_test.cc                                                 \
+  util/huge_page_allocator_test.cc                                      \
   util/log_write_bench.cc                                               \
   util/rate_limiter_test.cc                                             \
   util/repeatable_thread_test.cc                                        \
@@ -331,6 +331,9 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
     ret.append("  block_cache_compressed_options:\n");
     ret.append(table_options_.block_cache_compressed->GetPrintableOptions());
   }
+  snprintf(buffer, kBufferSize, "  block_cache_quota_group: %s\n",
+           table_options_.block_cache_quota_group.c_str());
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  persistent_cache: %p\n",
            static_cast<void*>(table_options_.persistent_cache.get()));
   ret.append(buffer);
@@ -138,6 +138,9 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"no_block_cache",
          {offsetof(struct BlockBasedTableOptions, no_block_cache),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"block_cache_quota_group",
+         {offsetof(struct BlockBasedTableOptions, block_cache_quota_group),
+          OptionType::kString, OptionVerificationType::kNormal, false, 0}},
         {"block_size",
          {offsetof(struct BlockBasedTableOptions, block_size),
           OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}},
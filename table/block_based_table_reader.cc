@@ -15,6 +15,7 @@
 #include <utility>
 #include <vector>
 
+#include "cache/memory_budget.h"
 #include "db/dbformat.h"
 #include "db/pinned_iterators_manager.h"
 
@@ -62,6 +63,10 @@ typedef BlockBasedTable::IndexReader IndexReader;
 
 BlockBasedTable::~BlockBasedTable() {
   Close();
+  if (rep_->memory_budget_charge > 0) {
+    rep_->memory_budget->Release(MemoryBudget::kTableReaders,
+                                 rep_->memory_budget_charge);
+  }
   delete rep_;
 }
 
@@ -125,6 +130,13 @@ void DeleteCachedEntry(const Slice& /*key*/, void* value) {
 void DeleteCachedFilterEntry(const Slice& key, void* value);
 void DeleteCachedIndexEntry(const Slice& key, void* value);
 
+// Return what the block cache's secondary tier keeps of an evicted block:
+// its uncompressed contents, from which GetDataBlockFromCache() rebuilds it.
+Slice SaveCachedBlock(void* value) {
+  Block* block = reinterpret_cast<Block*>(value);
+  return Slice(block->data(), block->size());
+}
+
 // Release the cached entry and decrement its ref count.
 void ReleaseCachedEntry(void* arg, void* h) {
   Cache* cache = reinterpret_cast<Cache*>(arg);
@@ -630,6 +642,20 @@ void BlockBasedTable::SetupCacheKeyPrefix(Rep* rep, uint64_t file_size) {
     // Create dummy offset of index reader which is beyond the file size.
     rep->dummy_index_reader_offset =
         file_size + rep->table_options.block_cache->NewId();
+    const std::string& quota_group =
+        rep->table_options.block_cache_quota_group;
+    if (!quota_group.empty()) {
+      Cache* block_cache = rep->table_options.block_cache.get();
+      uint32_t parent = block_cache->GetQuotaGroup(quota_group);
+      if (parent != Cache::kNoQuotaGroup) {
+        rep->index_quota_group =
+            block_cache->GetQuotaGroup(quota_group + ".index", parent);
+        rep->filter_quota_group =
+            block_cache->GetQuotaGroup(quota_group + ".filter", parent);
+        rep->data_quota_group =
+            block_cache->GetQuotaGroup(quota_group + ".data", parent);
+      }
+    }
   }
   if (rep->table_options.persistent_cache != nullptr) {
     GenerateCachePrefix(/*cache=*/nullptr, rep->file->file(),
@@ -839,6 +865,7 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
                              std::string(rep->persistent_cache_key_prefix,
                                          rep->persistent_cache_key_prefix_size),
                              rep->ioptions.statistics);
+  rep->memory_budget = ioptions.memory_budget;
 
   // Read metaindex
   std::unique_ptr<Block> meta;
@@ -875,6 +902,16 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
           static_cast<size_t>(file_size) - prefetch_buffer->min_offset_read());
     }
 
+    if (rep->memory_budget) {
+      // Index and filter blocks that are not in the block cache are held by
+      // the reader until it is closed.
+      rep->memory_budget_charge =
+          sizeof(BlockBasedTable) + sizeof(Rep) +
+          new_table->ApproximateMemoryUsage();
+      rep->memory_budget->Charge(MemoryBudget::kTableReaders,
+                                 rep->memory_budget_charge);
+    }
+
     *table_reader = std::move(new_table);
   }
 
@@ -915,12 +952,16 @@ Status BlockBasedTable::PrefetchTail(
   Status s;
   // TODO should not have this special logic in the future.
   if (!file->use_direct_io()) {
-    prefetch_buffer->reset(new FilePrefetchBuffer(nullptr, 0, 0, false, true));
     s = file->Prefetch(prefetch_off, prefetch_len);
-  } else {
-    prefetch_buffer->reset(new FilePrefetchBuffer(nullptr, 0, 0, true, true));
-    s = (*prefetch_buffer)->Prefetch(file, prefetch_off, prefetch_len);
+    if (!s.IsNotSupported()) {
+      prefetch_buffer->reset(
+          new FilePrefetchBuffer(nullptr, 0, 0, false, true));
+      return s;
+    }
   }
+  // Direct IO, or a file without a cache to warm: buffer the tail here.
+  prefetch_buffer->reset(new FilePrefetchBuffer(nullptr, 0, 0, true, true));
+  s = (*prefetch_buffer)->Prefetch(file, prefetch_off, prefetch_len);
   return s;
 }
 
@@ -1308,37 +1349,52 @@ Status BlockBasedTable::GetDataBlockFromCache(
     }
   }
 
-  // If not found, search from the compressed block cache.
+  // If not found, search from the secondary tier of the block cache, and
+  // then from the compressed block cache. A hit in the secondary tier moves
+  // the block out of it, so only look there if the block is going to be put
+  // back into the block cache.
   assert(block->cache_handle == nullptr && block->value == nullptr);
 
-  if (block_cache_compressed == nullptr) {
-    return s;
-  }
+  BlockContents contents;
+  std::unique_ptr<char[]> saved_data;
+  size_t saved_size = 0;
+  if (block_cache != nullptr && read_options.fill_cache &&
+      block_cache->LookupSecondary(block_cache_key, &saved_data,
+                                   &saved_size)) {
+    RecordTick(statistics, BLOCK_CACHE_SECONDARY_HIT);
+    contents = BlockContents(std::move(saved_data), saved_size);
+  } else {
+    if (block_cache_compressed == nullptr) {
+      return s;
+    }
 
-  assert(!compressed_block_cache_key.empty());
-  block_cache_compressed_handle =
-      block_cache_compressed->Lookup(compressed_block_cache_key);
-  // if we found in the compressed cache, then uncompress and insert into
-  // uncompressed cache
-  if (block_cache_compressed_handle == nullptr) {
-    RecordTick(statistics, BLOCK_CACHE_COMPRESSED_MISS);
-    return s;
-  }
+    assert(!compressed_block_cache_key.empty());
+    block_cache_compressed_handle =
+        block_cache_compressed->Lookup(compressed_block_cache_key);
+    // if we found in the compressed cache, then uncompress and insert into
+    // uncompressed cache
+    if (block_cache_compressed_handle == nullptr) {
+      RecordTick(statistics, BLOCK_CACHE_COMPRESSED_MISS);
+      return s;
+    }
 
-  // found compressed block
-  RecordTick(statistics, BLOCK_CACHE_COMPRESSED_HIT);
-  compressed_block = reinterpret_cast<BlockContents*>(
-      block_cache_compressed->Value(block_cache_compressed_handle));
-  CompressionType compression_type = compressed_block->get_compression_type();
-  assert(compression_type != kNoCompression);
+    // found compressed block
+    RecordTick(statistics, BLOCK_CACHE_COMPRESSED_HIT);
+    compressed_block = reinterpret_cast<BlockContents*>(
+        block_cache_compressed->Value(block_cache_compressed_handle));
+    CompressionType compression_type =
+        compressed_block->get_compression_type();
+    assert(compression_type != kNoCompression);
 
-  // Retrieve the uncompressed contents into a new buffer
-  BlockContents contents;
-  UncompressionContext uncompresssion_ctx(compression_type, compression_dict);
-  s = UncompressBlockContents(uncompresssion_ctx, compressed_block->data.data(),
-                              compressed_block->data.size(), &contents,
-                              rep->table_options.format_version, rep->ioptions,
-                              GetMemoryAllocator(rep->table_options));
+    // Retrieve the uncompressed contents into a new buffer
+    UncompressionContext uncompresssion_ctx(compression_type,
+                                            compression_dict);
+    s = UncompressBlockContents(
+        uncompresssion_ctx, compressed_block->data.data(),
+        compressed_block->data.size(), &contents,
+        rep->table_options.format_version, rep->ioptions,
+        GetMemoryAllocator(rep->table_options));
+  }
 
   // Insert uncompressed block into block cache
   if (s.ok()) {
@@ -1349,9 +1405,10 @@ Status BlockBasedTable::GetDataBlockFromCache(
     if (block_cache != nullptr && block->value->own_bytes() &&
         read_options.fill_cache) {
       size_t charge = block->value->ApproximateMemoryUsage();
-      s = block_cache->Insert(block_cache_key, block->value, charge,
-                              &DeleteCachedEntry<Block>,
-                              &(block->cache_handle));
+      s = block_cache->InsertSaveable(
+          block_cache_key, block->value, charge, &DeleteCachedEntry<Block>,
+          &SaveCachedBlock, &(block->cache_handle), Cache::Priority::LOW,
+          is_index ? rep->index_quota_group : rep->data_quota_group);
 #ifndef NDEBUG
       block_cache->TEST_mark_as_data_block(block_cache_key, charge);
 #endif  // NDEBUG
@@ -1391,7 +1448,9 @@ Status BlockBasedTable::GetDataBlockFromCache(
   }
 
   // Release hold on compressed cache entry
-  block_cache_compressed->Release(block_cache_compressed_handle);
+  if (block_cache_compressed_handle != nullptr) {
+    block_cache_compressed->Release(block_cache_compressed_handle);
+  }
   return s;
 }
 
@@ -1403,7 +1462,8 @@ Status BlockBasedTable::PutDataBlockToCache(
     CompressionType raw_block_comp_type, uint32_t format_version,
     const Slice& compression_dict, SequenceNumber seq_no,
     size_t read_amp_bytes_per_bit, MemoryAllocator* memory_allocator,
-    bool is_index, Cache::Priority priority, GetContext* get_context) {
+    bool is_index, Cache::Priority priority, GetContext* get_context,
+    uint32_t quota_group) {
   assert(raw_block_comp_type == kNoCompression ||
          block_cache_compressed != nullptr);
 
@@ -1462,9 +1522,10 @@ Status BlockBasedTable::PutDataBlockToCache(
   // insert into uncompressed block cache
   if (block_cache != nullptr && cached_block->value->own_bytes()) {
     size_t charge = cached_block->value->ApproximateMemoryUsage();
-    s = block_cache->Insert(block_cache_key, cached_block->value, charge,
-                            &DeleteCachedEntry<Block>,
-                            &(cached_block->cache_handle), priority);
+    s = block_cache->InsertSaveable(
+        block_cache_key, cached_block->value, charge,
+        &DeleteCachedEntry<Block>, &SaveCachedBlock,
+        &(cached_block->cache_handle), priority, quota_group);
 #ifndef NDEBUG
     block_cache->TEST_mark_as_data_block(block_cache_key, charge);
 #endif  // NDEBUG
@@ -1639,11 +1700,13 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
                         is_a_filter_partition, prefix_extractor);
     if (filter != nullptr) {
       size_t usage = filter->ApproximateMemoryUsage();
-      Status s = block_cache->Insert(
-          key, filter, usage, &DeleteCachedFilterEntry, &cache_handle,
+      Status s = block_cache->InsertSaveable(
+          key, filter, usage, &DeleteCachedFilterEntry, nullptr /* save_cb */,
+          &cache_handle,
           rep_->table_options.cache_index_and_filter_blocks_with_high_priority
               ? Cache::Priority::HIGH
-              : Cache::Priority::LOW);
+              : Cache::Priority::LOW,
+          rep_->filter_quota_group);
       if (s.ok()) {
         PERF_COUNTER_ADD(filter_block_read_count, 1);
         if (get_context != nullptr) {
@@ -1737,11 +1800,13 @@ InternalIteratorBase<BlockHandle>* BlockBasedTable::NewIndexIterator(
     if (s.ok()) {
       assert(index_reader != nullptr);
       charge = index_reader->ApproximateMemoryUsage();
-      s = block_cache->Insert(
-          key, index_reader, charge, &DeleteCachedIndexEntry, &cache_handle,
+      s = block_cache->InsertSaveable(
+          key, index_reader, charge, &DeleteCachedIndexEntry,
+          nullptr /* save_cb */, &cache_handle,
           rep_->table_options.cache_index_and_filter_blocks_with_high_priority
               ? Cache::Priority::HIGH
-              : Cache::Priority::LOW);
+              : Cache::Priority::LOW,
+          rep_->index_quota_group);
     }
 
     if (s.ok()) {
@@ -1866,7 +1931,15 @@ TBlockIter* BlockBasedTable::NewDataBlockIterator(
       iter->RegisterCleanup(&ReleaseCachedEntry, block_cache,
                             block.cache_handle);
     } else {
-      if (!ro.fill_cache && rep->cache_key_prefix_size != 0) {
+      if (rep->memory_budget) {
+        // The block lives as long as the iterator, or as long as the
+        // PinnedIteratorsManager holding the iterator when it is pinned.
+        size_t charge = block.value->ApproximateMemoryUsage();
+        rep->memory_budget->Charge(MemoryBudget::kIteratorBlocks, charge);
+        iter->RegisterCleanup(&MemoryBudget::ReleaseIteratorBlock,
+                              rep->memory_budget.get(),
+                              reinterpret_cast<void*>(charge));
+      } else if (!ro.fill_cache && rep->cache_key_prefix_size != 0) {
         // insert a dummy record to block cache to track the memory usage
         Cache::Handle* cache_handle;
         // There are two other types of cache keys: 1) SST cache key added in
@@ -1887,9 +1960,10 @@ TBlockIter* BlockBasedTable::NewDataBlockIterator(
                static_cast<int>(kExtraCacheKeyPrefix + kMaxVarint64Length));
         Slice unique_key =
             Slice(cache_key, static_cast<size_t>(end - cache_key));
-        s = block_cache->Insert(unique_key, nullptr,
-                                block.value->ApproximateMemoryUsage(), nullptr,
-                                &cache_handle);
+        s = block_cache->InsertSaveable(
+            unique_key, nullptr, block.value->ApproximateMemoryUsage(),
+            nullptr, nullptr /* save_cb */, &cache_handle, Cache::Priority::LOW,
+            is_index ? rep->index_quota_group : rep->data_quota_group);
         if (s.ok()) {
           if (cache_handle != nullptr) {
             iter->RegisterCleanup(&ForceReleaseCachedEntry, block_cache,
@@ -1980,7 +2054,8 @@ Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
                             .cache_index_and_filter_blocks_with_high_priority
                 ? Cache::Priority::HIGH
                 : Cache::Priority::LOW,
-            get_context);
+            get_context,
+            is_index ? rep->index_quota_group : rep->data_quota_group);
       }
     }
   }
@@ -2289,7 +2364,7 @@ void BlockBasedTableIterator<TBlockIter, TValue>::InitDataBlock() {
     if (!for_compaction_ && read_options_.readahead_size == 0) {
       num_file_reads_++;
       if (num_file_reads_ > 2) {
-        if (!rep->file->use_direct_io() &&
+        if (!rep->file->use_direct_io() && !prefetch_buffer_ &&
             (data_block_handle.offset() +
                  static_cast<size_t>(data_block_handle.size()) +
                  kBlockTrailerSize >
@@ -2297,7 +2372,14 @@ void BlockBasedTableIterator<TBlockIter, TValue>::InitDataBlock() {
           // Buffered I/O
           // Discarding the return status of Prefetch calls intentionally, as we
           // can fallback to reading from disk if Prefetch fails.
-          rep->file->Prefetch(data_block_handle.offset(), readahead_size_);
+          Status s =
+              rep->file->Prefetch(data_block_handle.offset(), readahead_size_);
+          if (s.IsNotSupported()) {
+            // The file has no cache to warm, e.g. it is on remote storage.
+            // Keep the readahead in this iterator instead.
+            prefetch_buffer_.reset(new FilePrefetchBuffer(
+                rep->file.get(), kInitReadaheadSize, kMaxReadaheadSize));
+          }
           readahead_limit_ =
               static_cast<size_t>(data_block_handle.offset() + readahead_size_);
           // Keep exponentially increasing readahead size until
@@ -2717,6 +2799,69 @@ Status BlockBasedTable::VerifyChecksumInBlocks(
   return s;
 }
 
+Slice BlockBasedTable::GetBlockCacheKeyPrefix() const {
+  if (rep_->table_options.block_cache == nullptr) {
+    return Slice();
+  }
+  return Slice(rep_->cache_key_prefix, rep_->cache_key_prefix_size);
+}
+
+Status BlockBasedTable::LoadDataBlocksIntoCache(
+    const std::vector<uint64_t>& offsets,
+    const std::function<bool(uint64_t)>& before_read) {
+  Cache* block_cache = rep_->table_options.block_cache.get();
+  if (block_cache == nullptr || offsets.empty()) {
+    return Status::OK();
+  }
+  ReadOptions ro;
+  Slice compression_dict;
+  if (rep_->compression_dict_block) {
+    compression_dict = rep_->compression_dict_block->data;
+  }
+  IndexBlockIter iiter_on_stack;
+  InternalIteratorBase<BlockHandle>* iiter =
+      NewIndexIterator(ro, false, &iiter_on_stack);
+  std::unique_ptr<InternalIteratorBase<BlockHandle>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr =
+        std::unique_ptr<InternalIteratorBase<BlockHandle>>(iiter);
+  }
+  Status s = iiter->status();
+  // Data blocks are laid out in the order of the index.
+  auto next = offsets.begin();
+  for (iiter->SeekToFirst(); s.ok() && iiter->Valid() && next != offsets.end();
+       iiter->Next()) {
+    BlockHandle handle = iiter->value();
+    next = std::lower_bound(next, offsets.end(), handle.offset());
+    if (next == offsets.end() || *next != handle.offset()) {
+      continue;
+    }
+    char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+    Slice key = GetCacheKey(rep_->cache_key_prefix, rep_->cache_key_prefix_size,
+                            handle, cache_key);
+    Cache::Handle* cache_handle = block_cache->Lookup(key);
+    if (cache_handle != nullptr) {
+      block_cache->Release(cache_handle);
+      continue;
+    }
+    if (!before_read(handle.size())) {
+      break;
+    }
+    CachableEntry<Block> block;
+    s = MaybeReadBlockAndLoadToCache(nullptr /* prefetch_buffer */, rep_, ro,
+                                     handle, compression_dict, &block);
+    if (block.cache_handle != nullptr) {
+      ReleaseCachedEntry(block_cache, block.cache_handle);
+    } else {
+      delete block.value;
+    }
+  }
+  if (s.ok()) {
+    s = iiter->status();
+  }
+  return s;
+}
+
 bool BlockBasedTable::TEST_KeyInCache(const ReadOptions& options,
                                       const Slice& key) {
   std::unique_ptr<InternalIteratorBase<BlockHandle>> iiter(
@@ -153,6 +153,12 @@ class BlockBasedTable : public TableReader {
 
   Status VerifyChecksum() override;
 
+  Slice GetBlockCacheKeyPrefix() const override;
+
+  Status LoadDataBlocksIntoCache(
+      const std::vector<uint64_t>& offsets,
+      const std::function<bool(uint64_t)>& before_read) override;
+
   void Close() override;
 
   ~BlockBasedTable();
@@ -324,7 +330,8 @@ class BlockBasedTable : public TableReader {
       const Slice& compression_dict, SequenceNumber seq_no,
       size_t read_amp_bytes_per_bit, MemoryAllocator* memory_allocator,
       bool is_index = false, Cache::Priority pri = Cache::Priority::LOW,
-      GetContext* get_context = nullptr);
+      GetContext* get_context = nullptr,
+      uint32_t quota_group = Cache::kNoQuotaGroup);
 
   // Calls (*handle_result)(arg, ...) repeatedly, starting with the entry found
   // after a call to Seek(key), until handle_result returns false.
@@ -484,6 +491,11 @@ struct BlockBasedTable::Rep {
   size_t compressed_cache_key_prefix_size = 0;
   uint64_t dummy_index_reader_offset =
       0;  // ID that is unique for the block cache.
+  // Quota groups of block_cache the blocks are charged to, see
+  // BlockBasedTableOptions::block_cache_quota_group.
+  uint32_t index_quota_group = Cache::kNoQuotaGroup;
+  uint32_t filter_quota_group = Cache::kNoQuotaGroup;
+  uint32_t data_quota_group = Cache::kNoQuotaGroup;
   PersistentCacheOptions persistent_cache_options;
 
   // Footer contains the fixed table information
@@ -545,6 +557,11 @@ struct BlockBasedTable::Rep {
   // before reading individual blocks enables certain optimizations.
   bool blocks_maybe_compressed = true;
 
+  // Memory budget the table reader and the blocks its iterators read outside
+  // of the block cache are charged to, see DBOptions::memory_budget_cache.
+  std::shared_ptr<MemoryBudget> memory_budget;
+  size_t memory_budget_charge = 0;
+
   bool closed = false;
   const bool immortal_table;
 
@@ -145,6 +145,15 @@ Status GetMemTableRepFactoryFromString(
     } else if (1 == len) {
       mem_factory = new VectorRepFactory();
     }
+  } else if (opts_list[0] == "art") {
+    // Expecting format
+    // art
+    if (1 == len) {
+      mem_factory = new AdaptiveRadixTreeRepFactory();
+    } else {
+      return Status::InvalidArgument("Can't parse memtable_factory option ",
+                                     opts_str);
+    }
   } else if (opts_list[0] == "cuckoo") {
     // Expecting format
     // cuckoo:<write_buffer_size>
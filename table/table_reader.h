@@ -8,7 +8,9 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #pragma once
+#include <functional>
 #include <memory>
+#include <vector>
 #include "db/range_tombstone_fragmenter.h"
 #include "rocksdb/slice_transform.h"
 #include "table/internal_iterator.h"
@@ -109,6 +111,21 @@ class TableReader {
     return Status::NotSupported("VerifyChecksum() not supported");
   }
 
+  // The prefix of the keys of this table's blocks in the block cache, or
+  // empty if they are not cached. A block's key is the prefix followed by
+  // the varint64 encoding of the block's offset in the file.
+  virtual Slice GetBlockCacheKeyPrefix() const { return Slice(); }
+
+  // Read the data blocks starting at the given offsets, sorted in increasing
+  // order, into the block cache unless they are already there. Offsets that
+  // do not start a data block are ignored. before_read is called with the
+  // size of each block before it is read; loading stops if it returns false.
+  virtual Status LoadDataBlocksIntoCache(
+      const std::vector<uint64_t>& /*offsets*/,
+      const std::function<bool(uint64_t)>& /*before_read*/) {
+    return Status::NotSupported("LoadDataBlocksIntoCache() not supported");
+  }
+
   virtual void Close() {}
 };
 
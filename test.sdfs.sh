@@ -1,4 +1,7 @@
 #!/bin/bash
+# Without an SDFS cluster, build with USE_SDFS_LOCAL=1 and export
+# SDFS_LOCAL_LATENCY_US / SDFS_LOCAL_JITTER_US / SDFS_LOCAL_BANDWIDTH_MB to
+# run the commands below against the local stand-in, see sdfs/README.
 # ./db_bench --benchmarks=fillseq --num=1000000 --compression_type=none
 # ./db_bench -sdfs --env_uri localost:123 --benchmarks=fillseq --num=1000000 --compression_type=none
 # ./db_bench -sdfs --env_uri localost:123 --benchmarks=fillseq --num=100 --compression_type=none
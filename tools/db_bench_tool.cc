@@ -35,6 +35,7 @@
 #include "db/db_impl.h"
 #include "db/malloc_stats.h"
 #include "db/version_set.h"
+#include "env/env_routing.h"
 #include "hdfs/env_hdfs.h"
 #include "sdfs/sdfs.h"
 #include "sdfs/env_sdfs.h"
@@ -192,6 +193,7 @@ DEFINE_string(
     "\tresetstats  -- Reset DB stats\n"
     "\tlevelstats  -- Print the number of files and bytes per level\n"
     "\tsstables    -- Print sstable info\n"
+    "\tenviostats  -- Print I/O stats of the Env, if it collects them\n"
     "\theapprofile -- Dump a heap profile (if supported by this port)\n"
     "\treplay      -- replay the trace file specified with trace_file\n");
 
@@ -366,6 +368,11 @@ static const bool FLAGS_subcompactions_dummy
     __attribute__((__unused__)) = RegisterFlagValidator(&FLAGS_subcompactions,
                                                     &ValidateUint32Range);
 
+DEFINE_uint64(max_flush_partitions, rocksdb::Options().max_flush_partitions,
+              "Maximum number of L0 files that one flush writes in parallel.");
+static const bool FLAGS_max_flush_partitions_dummy __attribute__((__unused__)) =
+    RegisterFlagValidator(&FLAGS_max_flush_partitions, &ValidateUint32Range);
+
 DEFINE_int32(max_background_flushes,
              rocksdb::Options().max_background_flushes,
              "The maximum number of concurrent background flushes"
@@ -415,10 +422,30 @@ DEFINE_double(cache_high_pri_pool_ratio, 0.0,
 DEFINE_bool(use_clock_cache, false,
             "Replace default LRU block cache with clock cache.");
 
+DEFINE_bool(cache_huge_page_allocator, false,
+            "Allocate the blocks of the LRU block caches from huge pages, "
+            "see NewHugePageAllocator().");
+
+DEFINE_bool(cache_explicit_huge_pages, false,
+            "With --cache_huge_page_allocator, use the reserved huge pages "
+            "(vm.nr_hugepages) before transparent ones.");
+
+DEFINE_bool(cache_numa_aware_allocator, false,
+            "With --cache_huge_page_allocator, allocate blocks from the "
+            "memory of the NUMA node of the reading thread.");
+
+DEFINE_bool(cache_frequency_based_admission, false,
+            "Use TinyLFU admission in the LRU block cache, see "
+            "LRUCacheOptions::frequency_based_admission.");
+
 DEFINE_int64(simcache_size, -1,
              "Number of bytes to use as a simcache of "
              "uncompressed data. Nagative value disables simcache.");
 
+DEFINE_bool(simcache_frequency_based_admission, false,
+            "Simulate an LRU cache with TinyLFU admission, to compare its "
+            "hit rate against the block cache in use.");
+
 DEFINE_bool(cache_index_and_filter_blocks, false,
             "Cache index/filter blocks in block cache.");
 
@@ -486,6 +513,14 @@ DEFINE_double(data_block_hash_table_util_ratio, 0.75,
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
+DEFINE_int64(compressed_secondary_cache_size, 0,
+             "If positive, blocks evicted from the LRU block cache are kept "
+             "compressed in a secondary tier of this many bytes.");
+
+DEFINE_string(compressed_secondary_cache_compression, "lz4",
+              "Algorithm used by the compressed secondary tier of the block "
+              "cache.");
+
 DEFINE_int64(row_cache_size, 0,
              "Number of bytes to use as a cache of individual rows"
              " (0 = disabled).");
@@ -514,6 +549,9 @@ DEFINE_int32(bloom_bits, -1, "Bloom filter bits per key. Negative means"
 DEFINE_double(memtable_bloom_size_ratio, 0,
               "Ratio of memtable size used for bloom filter. 0 means no bloom "
               "filter.");
+DEFINE_bool(memtable_whole_key_filtering, false,
+            "Add whole keys to the memtable bloom filter, see "
+            "--memtable_bloom_size_ratio.");
 DEFINE_bool(memtable_use_huge_page, false,
             "Try to use huge page in memtables.");
 
@@ -827,6 +865,15 @@ DEFINE_string(hdfs, "", "Name of hdfs environment. Mutually exclusive with"
               " --env_uri.");
 DEFINE_string(sdfs, "", "Name of sdfs environment. Mutually exclusive with"
                             " --env_uri.");
+DEFINE_bool(sdfs_pipelined_writes, false, "With --sdfs, write out a full "
+            "file buffer in the background while filling the next one.");
+DEFINE_uint64(sdfs_metadata_cache_ttl_micros,
+              rocksdb::SdfsEnv::kDefaultMetadataCacheTTLMicros,
+              "With --sdfs, how long file metadata may be served from the "
+              "client-side cache. 0 disables the cache.");
+DEFINE_string(sdfs_local_dir, "", "With --sdfs, keep WAL, MANIFEST and the "
+              "other non-table files of the DB under this local directory "
+              "and only table and blob files on sdfs.");
 static rocksdb::Env* FLAGS_env = rocksdb::Env::Default();
 
 DEFINE_int64(stats_interval, 0, "Stats are reported every N operations when "
@@ -878,6 +925,24 @@ DEFINE_uint64(delayed_write_rate, 8388608u,
 DEFINE_bool(enable_pipelined_write, true,
             "Allow WAL and memtable writes to be pipelined");
 
+DEFINE_bool(background_wal_sync, false,
+            "Sync the WAL for synced writes in a background job that "
+            "overlaps with the memtable inserts of the write group. "
+            "Only used with --enable_pipelined_write=false.");
+
+DEFINE_string(block_cache_dump_path, "",
+              "If not empty, save the keys of the cached blocks to this file "
+              "on close and warm the block cache up from it on open.");
+
+DEFINE_uint64(block_cache_dump_period_sec,
+              rocksdb::Options().block_cache_dump_period_sec,
+              "Also save the cached block keys this often. 0 to only save "
+              "them on close.");
+
+DEFINE_uint64(block_cache_warmup_rate_bytes_per_sec, 0,
+              "Limit on the read rate of the block cache warm-up. 0 for no "
+              "limit.");
+
 DEFINE_bool(allow_concurrent_memtable_write, true,
             "Allow multi-writers to update mem tables in parallel.");
 
@@ -1055,7 +1120,8 @@ enum RepFactory {
   kPrefixHash,
   kVectorRep,
   kHashLinkedList,
-  kCuckoo
+  kCuckoo,
+  kAdaptiveRadixTree
 };
 
 static enum RepFactory StringToRepFactory(const char* ctype) {
@@ -1071,6 +1137,8 @@ static enum RepFactory StringToRepFactory(const char* ctype) {
     return kHashLinkedList;
   else if (!strcasecmp(ctype, "cuckoo"))
     return kCuckoo;
+  else if (!strcasecmp(ctype, "art"))
+    return kAdaptiveRadixTree;
 
   fprintf(stdout, "Cannot parse memreptable %s\n", ctype);
   return kSkipList;
@@ -1079,6 +1147,8 @@ static enum RepFactory StringToRepFactory(const char* ctype) {
 static enum RepFactory FLAGS_rep_factory;
 DEFINE_string(memtablerep, "skip_list", "");
 DEFINE_int64(hash_bucket_count, 1024 * 1024, "hash bucket count");
+DEFINE_uint64(vector_sort_threads, 1,
+              "Number of threads that sort an immutable vector memtable");
 DEFINE_bool(use_plain_table, false, "if use plain table "
             "instead of block-based table format");
 DEFINE_bool(use_cuckoo_table, false, "if use cuckoo table format");
@@ -2145,6 +2215,9 @@ class Benchmark {
       case kCuckoo:
         fprintf(stdout, "Memtablerep: cuckoo\n");
         break;
+      case kAdaptiveRadixTree:
+        fprintf(stdout, "Memtablerep: art\n");
+        break;
     }
     fprintf(stdout, "Perf Level: %d\n", FLAGS_perf_level);
 
@@ -2280,7 +2353,8 @@ class Benchmark {
     virtual const char* Name() const override { return "KeepFilter"; }
   };
 
-  std::shared_ptr<Cache> NewCache(int64_t capacity) {
+  std::shared_ptr<Cache> NewCache(int64_t capacity,
+                                  int64_t secondary_capacity = 0) {
     if (capacity <= 0) {
       return nullptr;
     }
@@ -2292,15 +2366,40 @@ class Benchmark {
       }
       return cache;
     } else {
-      return NewLRUCache((size_t)capacity, FLAGS_cache_numshardbits,
-                         false /*strict_capacity_limit*/,
-                         FLAGS_cache_high_pri_pool_ratio);
+      LRUCacheOptions cache_options(
+          (size_t)capacity, FLAGS_cache_numshardbits,
+          false /*strict_capacity_limit*/, FLAGS_cache_high_pri_pool_ratio);
+      cache_options.frequency_based_admission =
+          FLAGS_cache_frequency_based_admission;
+      if (secondary_capacity > 0) {
+        cache_options.compressed_secondary_cache_capacity =
+            (size_t)secondary_capacity;
+        cache_options.compressed_secondary_cache_compression =
+            StringToCompressionType(
+                FLAGS_compressed_secondary_cache_compression.c_str());
+      }
+      if (FLAGS_cache_huge_page_allocator) {
+        HugePageAllocatorOptions allocator_options;
+        // Room for the rounding up to size classes and for pinned blocks.
+        allocator_options.capacity = (size_t)(capacity + capacity / 4);
+        allocator_options.use_explicit_huge_pages =
+            FLAGS_cache_explicit_huge_pages;
+        allocator_options.numa_aware = FLAGS_cache_numa_aware_allocator;
+        Status s = NewHugePageAllocator(allocator_options,
+                                        &cache_options.memory_allocator);
+        if (!s.ok()) {
+          fprintf(stderr, "Huge page allocator: %s\n", s.ToString().c_str());
+          exit(1);
+        }
+      }
+      return NewLRUCache(cache_options);
     }
   }
 
  public:
   Benchmark()
-      : cache_(NewCache(FLAGS_cache_size)),
+      : cache_(NewCache(FLAGS_cache_size,
+                        FLAGS_compressed_secondary_cache_size)),
         compressed_cache_(NewCache(FLAGS_compressed_cache_size)),
         filter_policy_(FLAGS_bloom_bits >= 0
                            ? NewBloomFilterPolicy(FLAGS_bloom_bits,
@@ -2330,12 +2429,14 @@ class Benchmark {
   {
     // use simcache instead of cache
     if (FLAGS_simcache_size >= 0) {
-      if (FLAGS_cache_numshardbits >= 1) {
-        cache_ =
-            NewSimCache(cache_, FLAGS_simcache_size, FLAGS_cache_numshardbits);
-      } else {
-        cache_ = NewSimCache(cache_, FLAGS_simcache_size, 0);
-      }
+      int num_shard_bits =
+          FLAGS_cache_numshardbits >= 1 ? FLAGS_cache_numshardbits : 0;
+      LRUCacheOptions sim_options(FLAGS_simcache_size, num_shard_bits,
+                                  false /*strict_capacity_limit*/,
+                                  0.0 /*high_pri_pool_ratio*/);
+      sim_options.frequency_based_admission =
+          FLAGS_simcache_frequency_based_admission;
+      cache_ = NewSimCache(NewLRUCache(sim_options), cache_, num_shard_bits);
     }
 
     if (report_file_operations_) {
@@ -2729,6 +2830,8 @@ void VerifyDBFromDB(std::string& truth_db_name) {
         PrintStats("rocksdb.levelstats");
       } else if (name == "sstables") {
         PrintStats("rocksdb.sstables");
+      } else if (name == "enviostats") {
+        PrintStats("rocksdb.env-io-stats");
       } else if (name == "replay") {
         if (num_threads > 1) {
           fprintf(stderr, "Multi-threaded replay is not yet supported\n");
@@ -2835,10 +2938,16 @@ void VerifyDBFromDB(std::string& truth_db_name) {
       fprintf(stdout, "STATISTICS:\n%s\n", dbstats->ToString().c_str());
     }
     if (FLAGS_simcache_size >= 0) {
+      SimCache* sim_cache =
+          static_cast_with_check<SimCache, Cache>(cache_.get());
       fprintf(stdout, "SIMULATOR CACHE STATISTICS:\n%s\n",
-              static_cast_with_check<SimCache, Cache>(cache_.get())
-                  ->ToString()
-                  .c_str());
+              sim_cache->ToString().c_str());
+      fprintf(stdout, "Estimated miss ratio by block cache capacity:\n");
+      for (double ratio : {0.25, 0.5, 1.0, 2.0, 4.0}) {
+        size_t capacity = static_cast<size_t>(FLAGS_cache_size * ratio);
+        fprintf(stdout, "%" ROCKSDB_PRIszt " %.4f\n", capacity,
+                sim_cache->GetEstimatedMissRatio(capacity));
+      }
     }
   }
 
@@ -3163,6 +3272,8 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     options.max_background_jobs = FLAGS_max_background_jobs;
     options.max_background_compactions = FLAGS_max_background_compactions;
     options.max_subcompactions = static_cast<uint32_t>(FLAGS_subcompactions);
+    options.max_flush_partitions =
+        static_cast<uint32_t>(FLAGS_max_flush_partitions);
     options.max_background_flushes = FLAGS_max_background_flushes;
     options.compaction_style = FLAGS_compaction_style_e;
     options.compaction_pri = FLAGS_compaction_pri_e;
@@ -3192,6 +3303,7 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     }
     options.memtable_huge_page_size = FLAGS_memtable_use_huge_page ? 2048 : 0;
     options.memtable_prefix_bloom_size_ratio = FLAGS_memtable_bloom_size_ratio;
+    options.memtable_whole_key_filtering = FLAGS_memtable_whole_key_filtering;
     if (FLAGS_memtable_insert_with_hint_prefix_size > 0) {
       options.memtable_insert_with_hint_prefix_extractor.reset(
           NewCappedPrefixTransform(
@@ -3235,13 +3347,16 @@ void VerifyDBFromDB(std::string& truth_db_name) {
         break;
       case kVectorRep:
         options.memtable_factory.reset(
-          new VectorRepFactory
+          new VectorRepFactory(0, FLAGS_vector_sort_threads)
         );
         break;
       case kCuckoo:
         options.memtable_factory.reset(NewHashCuckooRepFactory(
             options.write_buffer_size, FLAGS_key_size + FLAGS_value_size));
         break;
+      case kAdaptiveRadixTree:
+        options.memtable_factory.reset(new AdaptiveRadixTreeRepFactory);
+        break;
 #else
       default:
         fprintf(stderr, "Only skip list is supported in lite mode\n");
@@ -3438,6 +3553,12 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     options.enable_write_thread_adaptive_yield =
         FLAGS_enable_write_thread_adaptive_yield;
     options.enable_pipelined_write = FLAGS_enable_pipelined_write;
+    options.background_wal_sync = FLAGS_background_wal_sync;
+    options.block_cache_dump_path = FLAGS_block_cache_dump_path;
+    options.block_cache_dump_period_sec =
+        static_cast<unsigned int>(FLAGS_block_cache_dump_period_sec);
+    options.block_cache_warmup_rate_bytes_per_sec =
+        FLAGS_block_cache_warmup_rate_bytes_per_sec;
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
     options.rate_limit_delay_max_milliseconds =
@@ -5803,7 +5924,18 @@ int db_bench_tool(int argc, char** argv) {
       FLAGS_env  = new rocksdb::HdfsEnv(FLAGS_hdfs);
   }
   if (!FLAGS_sdfs.empty()) {
-      FLAGS_env  = new rocksdb::SdfsEnv(FLAGS_sdfs);
+      rocksdb::SdfsEnv* sdfs_env = new rocksdb::SdfsEnv(FLAGS_sdfs);
+      sdfs_env->SetPipelinedWrites(FLAGS_sdfs_pipelined_writes);
+      sdfs_env->SetMetadataCacheTTL(FLAGS_sdfs_metadata_cache_ttl_micros);
+      sdfs_env->SetStatistics(dbstats);
+      FLAGS_env = sdfs_env;
+#if !defined(ROCKSDB_LITE) && !defined(OS_WIN)
+      if (!FLAGS_sdfs_local_dir.empty()) {
+        rocksdb::FileTypeRoutingEnvOptions routing_options;
+        routing_options.local_dir = FLAGS_sdfs_local_dir;
+        FLAGS_env = rocksdb::NewFileTypeRoutingEnv(sdfs_env, routing_options);
+      }
+#endif  // !defined(ROCKSDB_LITE) && !defined(OS_WIN)
   }
 
   if (!strcasecmp(FLAGS_compaction_fadvice.c_str(), "NONE"))
@@ -181,6 +181,48 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+Status RandomAccessFileReader::MultiRead(ReadRequest* read_reqs,
+                                         size_t num_reqs) const {
+  if (use_direct_io() || (for_compaction_ && rate_limiter_ != nullptr)) {
+    // Alignment and rate limiting are handled request by request in Read()
+    for (size_t i = 0; i < num_reqs; ++i) {
+      ReadRequest& req = read_reqs[i];
+      req.status = Read(req.offset, req.len, &req.result, req.scratch);
+    }
+    return Status::OK();
+  }
+  Status s;
+  uint64_t elapsed = 0;
+  {
+    StopWatch sw(env_, stats_, hist_type_,
+                 (stats_ != nullptr) ? &elapsed : nullptr, true /*overwrite*/,
+                 true /*delay_enabled*/);
+    IOSTATS_TIMER_GUARD(read_nanos);
+#ifndef ROCKSDB_LITE
+    time_t start_ts = 0;
+    if (ShouldNotifyListeners()) {
+      start_ts = std::chrono::system_clock::to_time_t(
+          std::chrono::system_clock::now());
+    }
+#endif
+    s = file_->MultiRead(read_reqs, num_reqs);
+    for (size_t i = 0; i < num_reqs; ++i) {
+#ifndef ROCKSDB_LITE
+      if (ShouldNotifyListeners()) {
+        NotifyOnFileReadFinish(read_reqs[i].offset,
+                               read_reqs[i].result.size(), start_ts,
+                               s.ok() ? read_reqs[i].status : s);
+      }
+#endif
+      IOSTATS_ADD_IF_POSITIVE(bytes_read, read_reqs[i].result.size());
+    }
+  }
+  if (stats_ != nullptr && file_read_hist_ != nullptr) {
+    file_read_hist_->Add(elapsed);
+  }
+  return s;
+}
+
 Status WritableFileWriter::Append(const Slice& data) {
   const char* src = data.data();
   size_t left = data.size();
@@ -219,6 +219,39 @@ TEST_F(WritableFileWriterTest, AppendStatusReturn) {
 }
 #endif
 
+class RandomAccessFileReaderTest : public testing::Test {};
+
+TEST_F(RandomAccessFileReaderTest, MultiRead) {
+  std::string contents = "0123456789abcdefghij";
+  RandomAccessFileReader reader(
+      std::unique_ptr<RandomAccessFile>(new test::StringSource(contents)),
+      "multi_read", Env::Default());
+
+  // Out of order and overlapping requests. The one starting past the end of
+  // the file is rejected by the source, which must not affect the others.
+  const uint64_t kOffsets[] = {10, 0, 100, 5, 18};
+  const size_t kLens[] = {5, 4, 1, 10, 10};
+  const size_t kNumReqs = sizeof(kOffsets) / sizeof(kOffsets[0]);
+  char scratch[kNumReqs][10];
+  ReadRequest reqs[kNumReqs];
+  for (size_t i = 0; i < kNumReqs; ++i) {
+    reqs[i].offset = kOffsets[i];
+    reqs[i].len = kLens[i];
+    reqs[i].scratch = scratch[i];
+  }
+  ASSERT_OK(reader.MultiRead(reqs, kNumReqs));
+
+  ASSERT_OK(reqs[0].status);
+  ASSERT_EQ("abcde", reqs[0].result.ToString());
+  ASSERT_OK(reqs[1].status);
+  ASSERT_EQ("0123", reqs[1].result.ToString());
+  ASSERT_TRUE(reqs[2].status.IsInvalidArgument());
+  ASSERT_OK(reqs[3].status);
+  ASSERT_EQ("56789abcde", reqs[3].result.ToString());
+  ASSERT_OK(reqs[4].status);
+  ASSERT_EQ("ij", reqs[4].result.ToString());
+}
+
 class ReadaheadRandomAccessFileTest
     : public testing::Test,
       public testing::WithParamInterface<size_t> {
@@ -0,0 +1,312 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/huge_page_allocator.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+#ifdef ROCKSDB_HUGE_PAGE_ALLOCATOR
+#include <sched.h>
+#include <sys/mman.h>
+#ifdef NUMA
+#include <numa.h>
+#include <numaif.h>
+#endif  // NUMA
+#endif  // ROCKSDB_HUGE_PAGE_ALLOCATOR
+
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+#ifdef ROCKSDB_HUGE_PAGE_ALLOCATOR
+
+namespace {
+// Blocks are aligned to kMinClassSize. Classes are kMinClassSize apart up to
+// kMinClassSize * kClassesPerDoubling, then kClassesPerDoubling per doubling.
+const size_t kMinClassSize = 16;
+const size_t kClassesPerDoubling = 8;
+
+void PreferNode(char* addr, size_t size, int node) {
+#ifdef NUMA
+  if (node >= 0) {
+    std::vector<unsigned long> mask(
+        static_cast<size_t>(node) / (8 * sizeof(unsigned long)) + 1, 0);
+    mask[node / (8 * sizeof(unsigned long))] |=
+        1ul << (node % (8 * sizeof(unsigned long)));
+    // Best effort: without it the pages come from the node that touches
+    // them first, which is usually the allocating one anyway.
+    mbind(addr, size, MPOL_PREFERRED, mask.data(),
+          mask.size() * 8 * sizeof(unsigned long) + 1, 0);
+  }
+#else
+  (void)addr;
+  (void)size;
+  (void)node;
+#endif  // NUMA
+}
+
+void AdviseHugePages(char* addr, size_t size) {
+#ifdef MADV_HUGEPAGE
+  // Fails harmlessly if transparent huge pages are disabled.
+  madvise(addr, size, MADV_HUGEPAGE);
+#else
+  (void)addr;
+  (void)size;
+#endif
+}
+}  // namespace
+
+HugePageAllocator::HugePageAllocator(const HugePageAllocatorOptions& options)
+    : options_(options),
+      arena_size_(0),
+      mapping_(nullptr),
+      mapping_size_(0) {
+  for (size_t size = kMinClassSize; size < kMinClassSize * kClassesPerDoubling;
+       size += kMinClassSize) {
+    class_sizes_.push_back(size);
+  }
+  for (size_t base = kMinClassSize * kClassesPerDoubling;
+       class_sizes_.back() < options_.max_pooled_allocation_size; base *= 2) {
+    for (size_t i = 0; i < kClassesPerDoubling; i++) {
+      class_sizes_.push_back(base + i * (base / kClassesPerDoubling));
+    }
+  }
+  while (class_sizes_.back() > options_.page_size) {
+    class_sizes_.pop_back();
+  }
+}
+
+Status HugePageAllocator::Init() {
+  // The node of each arena.
+  std::vector<int> nodes;
+  if (options_.numa_aware) {
+#ifdef NUMA
+    if (numa_available() < 0) {
+      return Status::NotSupported("NUMA is not supported by the system.");
+    }
+    int max_node = numa_max_node();
+    std::vector<size_t> node_arenas(max_node + 1, 0);
+    for (int node = 0; node <= max_node; node++) {
+      if (numa_bitmask_isbitset(numa_all_nodes_ptr, node)) {
+        node_arenas[node] = nodes.size();
+        nodes.push_back(node);
+      }
+    }
+    if (nodes.size() > 1) {
+      int num_cpus = numa_num_configured_cpus();
+      for (int cpu = 0; cpu < num_cpus; cpu++) {
+        int node = numa_node_of_cpu(cpu);
+        cpu_arenas_.push_back(node >= 0 && node <= max_node ? node_arenas[node]
+                                                            : 0);
+      }
+    }
+#else
+    return Status::NotSupported(
+        "NUMA-aware HugePageAllocator requires building with NUMA.");
+#endif  // NUMA
+  }
+  if (nodes.empty()) {
+    nodes.push_back(-1);
+  }
+
+  const size_t page_size = options_.page_size;
+  size_t slabs_per_arena = options_.capacity / page_size / nodes.size();
+  if (slabs_per_arena == 0) {
+    return Status::InvalidArgument(
+        "HugePageAllocator capacity is less than one page per NUMA node.");
+  }
+  arena_size_ = slabs_per_arena * page_size;
+
+  // Reserve the address space, with room to align it to page_size. The
+  // slabs are only backed by memory once they are touched.
+  mapping_size_ = arena_size_ * nodes.size() + page_size;
+  int prot = options_.use_explicit_huge_pages ? PROT_NONE
+                                              : PROT_READ | PROT_WRITE;
+  void* mapping = mmap(nullptr, mapping_size_, prot,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapping == MAP_FAILED) {
+    Status s = Status::IOError("HugePageAllocator failed to map " +
+                               ToString(mapping_size_) + " bytes");
+    mapping_size_ = 0;
+    return s;
+  }
+  mapping_ = static_cast<char*>(mapping);
+  uintptr_t aligned = reinterpret_cast<uintptr_t>(mapping_);
+  aligned = (aligned + page_size - 1) / page_size * page_size;
+  char* base = reinterpret_cast<char*>(aligned);
+  if (!options_.use_explicit_huge_pages) {
+    AdviseHugePages(base, arena_size_ * nodes.size());
+  }
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    std::unique_ptr<Arena> arena(new Arena());
+    arena->base = base + i * arena_size_;
+    arena->num_slabs = slabs_per_arena;
+    arena->node = nodes[i];
+    arena->slabs_used.store(0, std::memory_order_relaxed);
+    arena->slab_classes.reset(new uint8_t[slabs_per_arena]);
+    arena->classes.reset(new SizeClass[class_sizes_.size()]);
+    PreferNode(arena->base, arena_size_, arena->node);
+    arenas_.push_back(std::move(arena));
+  }
+  return Status::OK();
+}
+
+HugePageAllocator::~HugePageAllocator() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+}
+
+bool HugePageAllocator::NewSlab(Arena* arena, size_t class_index) {
+  size_t index = arena->slabs_used.load(std::memory_order_relaxed);
+  do {
+    if (index >= arena->num_slabs) {
+      return false;
+    }
+  } while (!arena->slabs_used.compare_exchange_weak(
+      index, index + 1, std::memory_order_relaxed));
+
+  const size_t page_size = options_.page_size;
+  char* slab = arena->base + index * page_size;
+  if (options_.use_explicit_huge_pages) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED;
+    int huge_flags = flags | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+    int page_shift = 0;
+    while ((size_t{1} << page_shift) < page_size) {
+      page_shift++;
+    }
+    huge_flags |= page_shift << MAP_HUGE_SHIFT;
+#endif
+    if (mmap(slab, page_size, PROT_READ | PROT_WRITE, huge_flags, -1, 0) ==
+        MAP_FAILED) {
+      // No reserved huge page left.
+      if (mmap(slab, page_size, PROT_READ | PROT_WRITE, flags, -1, 0) ==
+          MAP_FAILED) {
+        // Leave the slab unused; it is still in the reserved range.
+        mmap(slab, page_size, PROT_NONE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+        return false;
+      }
+      AdviseHugePages(slab, page_size);
+    }
+    // The new mapping does not inherit the policy of the arena.
+    PreferNode(slab, page_size, arena->node);
+  }
+
+  arena->slab_classes[index] = static_cast<uint8_t>(class_index);
+  SizeClass& size_class = arena->classes[class_index];
+  size_class.next = slab;
+  size_class.end = slab + page_size;
+  return true;
+}
+
+size_t HugePageAllocator::ClassIndex(size_t size) const {
+  return std::lower_bound(class_sizes_.begin(), class_sizes_.end(), size) -
+         class_sizes_.begin();
+}
+
+HugePageAllocator::Arena* HugePageAllocator::ArenaOf(void* p) const {
+  char* c = static_cast<char*>(p);
+  char* base = arenas_.front()->base;
+  if (c < base || c >= base + arena_size_ * arenas_.size()) {
+    return nullptr;
+  }
+  return arenas_[static_cast<size_t>(c - base) / arena_size_].get();
+}
+
+size_t HugePageAllocator::LocalArenaIndex() const {
+  if (cpu_arenas_.empty()) {
+    return 0;
+  }
+  int cpu = sched_getcpu();
+  if (cpu < 0 || static_cast<size_t>(cpu) >= cpu_arenas_.size()) {
+    return 0;
+  }
+  return cpu_arenas_[cpu];
+}
+
+void* HugePageAllocator::Allocate(size_t size) {
+  size_t class_index = ClassIndex(std::max<size_t>(size, 1));
+  if (class_index < class_sizes_.size() &&
+      class_sizes_[class_index] <= options_.max_pooled_allocation_size) {
+    const size_t class_size = class_sizes_[class_index];
+    size_t local = LocalArenaIndex();
+    // Prefer the local node, then any node with room.
+    for (size_t i = 0; i < arenas_.size(); i++) {
+      Arena* arena = arenas_[(local + i) % arenas_.size()].get();
+      SizeClass& size_class = arena->classes[class_index];
+      MutexLock l(&size_class.mutex);
+      if (size_class.free_list != nullptr) {
+        void* p = size_class.free_list;
+        size_class.free_list = *static_cast<void**>(p);
+        return p;
+      }
+      if (size_class.next + class_size <= size_class.end ||
+          NewSlab(arena, class_index)) {
+        void* p = size_class.next;
+        size_class.next += class_size;
+        return p;
+      }
+    }
+  }
+  return malloc(size);
+}
+
+void HugePageAllocator::Deallocate(void* p) {
+  Arena* arena = ArenaOf(p);
+  if (arena == nullptr) {
+    free(p);
+    return;
+  }
+  size_t slab = static_cast<size_t>(static_cast<char*>(p) - arena->base) /
+                options_.page_size;
+  SizeClass& size_class = arena->classes[arena->slab_classes[slab]];
+  MutexLock l(&size_class.mutex);
+  *static_cast<void**>(p) = size_class.free_list;
+  size_class.free_list = p;
+}
+
+size_t HugePageAllocator::UsableSize(void* p, size_t allocation_size) const {
+  Arena* arena = ArenaOf(p);
+  if (arena == nullptr) {
+    return allocation_size;
+  }
+  size_t slab = static_cast<size_t>(static_cast<char*>(p) - arena->base) /
+                options_.page_size;
+  return class_sizes_[arena->slab_classes[slab]];
+}
+#endif  // ROCKSDB_HUGE_PAGE_ALLOCATOR
+
+Status NewHugePageAllocator(
+    const HugePageAllocatorOptions& options,
+    std::shared_ptr<MemoryAllocator>* memory_allocator) {
+#ifndef ROCKSDB_HUGE_PAGE_ALLOCATOR
+  (void)options;
+  (void)memory_allocator;
+  return Status::NotSupported("HugePageAllocator is only available on Linux.");
+#else
+  if (memory_allocator == nullptr) {
+    return Status::InvalidArgument("memory_allocator must be non-null.");
+  }
+  *memory_allocator = nullptr;
+  const size_t page_size = options.page_size;
+  if (page_size < 4096 || (page_size & (page_size - 1)) != 0) {
+    return Status::InvalidArgument(
+        "HugePageAllocator page_size must be a power of two of at least 4KB.");
+  }
+  std::unique_ptr<HugePageAllocator> allocator(new HugePageAllocator(options));
+  Status s = allocator->Init();
+  if (s.ok()) {
+    memory_allocator->reset(allocator.release());
+  }
+  return s;
+#endif  // ROCKSDB_HUGE_PAGE_ALLOCATOR
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,86 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/memory_allocator.h"
+
+#ifdef OS_LINUX
+#define ROCKSDB_HUGE_PAGE_ALLOCATOR
+
+namespace rocksdb {
+
+class HugePageAllocator : public MemoryAllocator {
+ public:
+  ~HugePageAllocator();
+
+  const char* Name() const override { return "HugePageAllocator"; }
+  void* Allocate(size_t size) override;
+  void Deallocate(void* p) override;
+  size_t UsableSize(void* p, size_t allocation_size) const override;
+
+ private:
+  friend Status NewHugePageAllocator(
+      const HugePageAllocatorOptions& options,
+      std::shared_ptr<MemoryAllocator>* memory_allocator);
+
+  // The blocks of one size class in one arena.
+  struct SizeClass {
+    port::Mutex mutex;
+    // Freed blocks, linked through their first bytes.
+    void* free_list = nullptr;
+    // The part of the last slab taken for the class that was never used.
+    char* next = nullptr;
+    char* end = nullptr;
+  };
+
+  // The memory of one NUMA node, slabs_used slabs of which are in use.
+  struct Arena {
+    char* base;
+    size_t num_slabs;
+    int node;
+    std::atomic<size_t> slabs_used;
+    // Size class of each slab in use.
+    std::unique_ptr<uint8_t[]> slab_classes;
+    std::unique_ptr<SizeClass[]> classes;
+  };
+
+  explicit HugePageAllocator(const HugePageAllocatorOptions& options);
+
+  Status Init();
+
+  // Takes the next slab of arena for the class and makes it its current
+  // slab. Returns false if the arena is full.
+  // REQUIRES: the mutex of the class is held.
+  bool NewSlab(Arena* arena, size_t class_index);
+
+  // Index of the smallest class that fits size.
+  size_t ClassIndex(size_t size) const;
+
+  // The arena holding p, or nullptr if p was not pooled.
+  Arena* ArenaOf(void* p) const;
+
+  // Index of the arena of the node of the calling thread's CPU.
+  size_t LocalArenaIndex() const;
+
+  const HugePageAllocatorOptions options_;
+  std::vector<size_t> class_sizes_;
+  // Consecutive slices of arena_size_ bytes of the mapping.
+  std::vector<std::unique_ptr<Arena>> arenas_;
+  size_t arena_size_;
+  char* mapping_;
+  size_t mapping_size_;
+  // Arena of the node of each CPU, when there are several.
+  std::vector<size_t> cpu_arenas_;
+};
+
+}  // namespace rocksdb
+#endif  // OS_LINUX
@@ -0,0 +1,171 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/huge_page_allocator.h"
+
+#include <stdio.h>
+
+#ifdef ROCKSDB_HUGE_PAGE_ALLOCATOR
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "util/random.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class HugePageAllocatorTest : public testing::Test {
+ public:
+  std::shared_ptr<MemoryAllocator> NewAllocator(size_t capacity,
+                                                size_t page_size) {
+    HugePageAllocatorOptions options;
+    options.capacity = capacity;
+    options.page_size = page_size;
+    options.max_pooled_allocation_size = 16 * 1024;
+    std::shared_ptr<MemoryAllocator> allocator;
+    EXPECT_OK(NewHugePageAllocator(options, &allocator));
+    return allocator;
+  }
+
+  // Blocks served by the default allocator report the size they were
+  // allocated with.
+  static bool Pooled(MemoryAllocator* allocator, void* p) {
+    return allocator->UsableSize(p, 1) != 1;
+  }
+};
+
+TEST_F(HugePageAllocatorTest, InvalidOptions) {
+  std::shared_ptr<MemoryAllocator> allocator;
+  HugePageAllocatorOptions options;
+  ASSERT_TRUE(NewHugePageAllocator(options, &allocator).IsInvalidArgument());
+  options.capacity = 4 << 20;
+  options.page_size = 3 << 20;
+  ASSERT_TRUE(NewHugePageAllocator(options, &allocator).IsInvalidArgument());
+  ASSERT_EQ(nullptr, allocator);
+  options.page_size = 2 << 20;
+  ASSERT_OK(NewHugePageAllocator(options, &allocator));
+  ASSERT_STREQ("HugePageAllocator", allocator->Name());
+}
+
+TEST_F(HugePageAllocatorTest, SizeClasses) {
+  auto allocator = NewAllocator(8 << 20, 2 << 20);
+  void* p = allocator->Allocate(1000);
+  ASSERT_TRUE(Pooled(allocator.get(), p));
+  // 1024 is the smallest class that fits, 1/8 of 1024 above 896.
+  ASSERT_EQ(1024, allocator->UsableSize(p, 1000));
+  memset(p, 'x', 1024);
+
+  void* q = allocator->Allocate(1);
+  ASSERT_EQ(16, allocator->UsableSize(q, 1));
+  void* r = allocator->Allocate(9000);
+  ASSERT_EQ(9216, allocator->UsableSize(r, 9000));
+
+  // Freed blocks are reused for the same class.
+  allocator->Deallocate(p);
+  ASSERT_EQ(p, allocator->Allocate(1010));
+  allocator->Deallocate(p);
+  allocator->Deallocate(q);
+  allocator->Deallocate(r);
+
+  // Larger blocks are not pooled.
+  void* large = allocator->Allocate(100 * 1024);
+  ASSERT_FALSE(Pooled(allocator.get(), large));
+  memset(large, 'x', 100 * 1024);
+  allocator->Deallocate(large);
+}
+
+TEST_F(HugePageAllocatorTest, FallBackWhenFull) {
+  // Two slabs of four 16KB blocks.
+  auto allocator = NewAllocator(128 * 1024, 64 * 1024);
+  std::vector<void*> blocks;
+  for (int i = 0; i < 10; i++) {
+    blocks.push_back(allocator->Allocate(16 * 1024));
+    memset(blocks.back(), 'x', 16 * 1024);
+  }
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(i < 8, Pooled(allocator.get(), blocks[i]));
+  }
+  // Every slab belongs to the 16KB class now.
+  void* small = allocator->Allocate(100);
+  ASSERT_FALSE(Pooled(allocator.get(), small));
+  allocator->Deallocate(small);
+
+  allocator->Deallocate(blocks[3]);
+  allocator->Deallocate(blocks[9]);
+  ASSERT_EQ(blocks[3], allocator->Allocate(16 * 1024));
+  for (int i = 0; i < 9; i++) {
+    allocator->Deallocate(blocks[i]);
+  }
+}
+
+TEST_F(HugePageAllocatorTest, ExplicitHugePages) {
+  // Without reserved huge pages, the slabs use regular mappings.
+  HugePageAllocatorOptions options;
+  options.capacity = 16 << 20;
+  options.use_explicit_huge_pages = true;
+  std::shared_ptr<MemoryAllocator> allocator;
+  ASSERT_OK(NewHugePageAllocator(options, &allocator));
+  std::vector<void*> blocks;
+  for (int i = 0; i < 1000; i++) {
+    blocks.push_back(allocator->Allocate(4096 + i));
+    memset(blocks.back(), 'x', 4096 + i);
+    ASSERT_TRUE(Pooled(allocator.get(), blocks.back()));
+  }
+  for (void* p : blocks) {
+    allocator->Deallocate(p);
+  }
+}
+
+TEST_F(HugePageAllocatorTest, MultiThreaded) {
+  auto allocator = NewAllocator(16 << 20, 2 << 20);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&allocator, t]() {
+      Random rnd(301 + t);
+      std::vector<std::pair<char*, size_t>> blocks;
+      for (int i = 0; i < 20000; i++) {
+        if (!blocks.empty() && rnd.OneIn(2)) {
+          size_t index = rnd.Uniform(static_cast<int>(blocks.size()));
+          auto block = blocks[index];
+          for (size_t j = 0; j < block.second; j++) {
+            ASSERT_EQ(static_cast<char>(t), block.first[j]);
+          }
+          allocator->Deallocate(block.first);
+          blocks[index] = blocks.back();
+          blocks.pop_back();
+        } else {
+          size_t size = 1 + rnd.Uniform(8192);
+          char* p = static_cast<char*>(allocator->Allocate(size));
+          memset(p, t, size);
+          blocks.emplace_back(p, size);
+        }
+      }
+      for (auto& block : blocks) {
+        allocator->Deallocate(block.first);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "SKIPPED as HugePageAllocator is only supported on Linux\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_HUGE_PAGE_ALLOCATOR
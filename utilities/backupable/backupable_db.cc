@@ -1232,6 +1232,31 @@ Status BackupEngineImpl::CopyOrCreateFile(
     *checksum_value = 0;
   }
 
+  if (!src.empty() && src_env == dst_env && rate_limiter == nullptr &&
+      size_limit == 0) {
+    // Whole-file copy within one Env: let it copy on the storage side. The
+    // checksum still needs the data, but it only has to be read, not written
+    // back through us.
+    s = dst_env->CopyFile(src, dst);
+    if (s.ok()) {
+      if (size != nullptr) {
+        s = src_env->GetFileSize(src, size);
+      }
+      if (s.ok() && checksum_value != nullptr) {
+        s = CalculateChecksum(src, src_env, src_env_options, 0 /* size_limit */,
+                              checksum_value);
+      }
+      if (s.ok()) {
+        std::lock_guard<std::mutex> lock(byte_report_mutex_);
+        progress_callback();
+      }
+      return s;
+    } else if (!s.IsNotSupported()) {
+      return s;
+    }
+    s = Status::OK();
+  }
+
   // Check if size limit is set. if not, set it to very big number
   if (size_limit == 0) {
     size_limit = std::numeric_limits<uint64_t>::max();
@@ -24,6 +24,7 @@
 #include "rocksdb/utilities/checkpoint.h"
 #include "rocksdb/utilities/transaction_db.h"
 #include "util/fault_injection_test_env.h"
+#include "util/file_util.h"
 #include "util/sync_point.h"
 #include "util/testharness.h"
 
@@ -622,6 +623,54 @@ TEST_F(CheckpointTest, CheckpointWithUnsyncedDataDropped) {
   db_ = nullptr;
 }
 
+TEST_F(CheckpointTest, CheckpointWithEnvCopyFile) {
+  // An Env without hard links that can copy whole files on its own, like
+  // SdfsEnv with a server-side copy.
+  class CopyOnlyEnv : public EnvWrapper {
+   public:
+    explicit CopyOnlyEnv(Env* t) : EnvWrapper(t), num_copies(0) {}
+
+    Status LinkFile(const std::string& /*s*/,
+                    const std::string& /*t*/) override {
+      return Status::NotSupported();
+    }
+
+    Status CopyFile(const std::string& s, const std::string& t) override {
+      num_copies++;
+      return rocksdb::CopyFile(target(), s, t, 0 /* size */,
+                               false /* use_fsync */);
+    }
+
+    std::atomic<int> num_copies;
+  };
+
+  Options options = CurrentOptions();
+  std::unique_ptr<CopyOnlyEnv> env(new CopyOnlyEnv(env_));
+  options.env = env.get();
+  Reopen(options);
+  ASSERT_OK(Put("key1", "val1"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("key2", "val2"));
+  Checkpoint* checkpoint;
+  ASSERT_OK(Checkpoint::Create(db_, &checkpoint));
+  ASSERT_OK(checkpoint->CreateCheckpoint(snapshot_name_));
+  delete checkpoint;
+  // The table file went through Env::CopyFile rather than a streamed copy.
+  ASSERT_GE(env->num_copies.load(), 1);
+  Close();
+
+  options.env = env_;
+  DB* snapshot_db;
+  ASSERT_OK(DB::Open(options, snapshot_name_, &snapshot_db));
+  ReadOptions read_opts;
+  std::string get_result;
+  ASSERT_OK(snapshot_db->Get(read_opts, "key1", &get_result));
+  ASSERT_EQ("val1", get_result);
+  ASSERT_OK(snapshot_db->Get(read_opts, "key2", &get_result));
+  ASSERT_EQ("val2", get_result);
+  delete snapshot_db;
+}
+
 TEST_F(CheckpointTest, CheckpointReadOnlyDB) {
   ASSERT_OK(Put("foo", "foo_value"));
   ASSERT_OK(Flush());
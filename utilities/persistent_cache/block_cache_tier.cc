@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "port/port.h"
+#include "util/hash.h"
 #include "util/logging.h"
 #include "util/stop_watch.h"
 #include "util/sync_point.h"
@@ -57,20 +58,27 @@ Status BlockCacheTier::Open() {
     }
   }
 
-  // create a new file
-  assert(!cache_file_);
-  status = NewCacheFile();
-  if (!status.ok()) {
-    Error(opt_.log, "Error creating new file %s. %s", opt_.path.c_str(),
-          status.ToString().c_str());
-    return status;
+  // create a new file for each insert slot
+  assert(!insert_slots_);
+  insert_slots_.reset(new InsertSlot[opt_.insert_threads]);
+  for (size_t i = 0; i < opt_.insert_threads; ++i) {
+    InsertSlot* slot = &insert_slots_[i];
+    MutexLock l(&slot->lock_);
+    status = NewCacheFile(slot);
+    if (!status.ok()) {
+      Error(opt_.log, "Error creating new file %s. %s", opt_.path.c_str(),
+            status.ToString().c_str());
+      return status;
+    }
+    assert(slot->cache_file_);
   }
 
-  assert(cache_file_);
-
   if (opt_.pipeline_writes) {
-    assert(!insert_th_.joinable());
-    insert_th_ = port::Thread(&BlockCacheTier::InsertMain, this);
+    assert(insert_th_.empty());
+    for (size_t i = 0; i < opt_.insert_threads; ++i) {
+      insert_th_.emplace_back(&BlockCacheTier::InsertMain, this,
+                              &insert_slots_[i]);
+    }
   }
 
   return Status::OK();
@@ -117,11 +125,24 @@ Status BlockCacheTier::CleanupCacheFolder(const std::string& folder) {
 }
 
 Status BlockCacheTier::Close() {
-  // stop the insert thread
-  if (opt_.pipeline_writes && insert_th_.joinable()) {
+  // stop the insert threads
+  for (size_t i = 0; i < insert_th_.size(); ++i) {
     InsertOp op(/*quit=*/true);
     insert_ops_.Push(std::move(op));
-    insert_th_.join();
+  }
+  for (auto& th : insert_th_) {
+    th.join();
+  }
+  insert_th_.clear();
+
+  // release the files being filled
+  if (insert_slots_) {
+    for (size_t i = 0; i < opt_.insert_threads; ++i) {
+      InsertSlot* slot = &insert_slots_[i];
+      MutexLock l(&slot->lock_);
+      ReleaseCacheFile(slot);
+    }
+    insert_slots_.reset();
   }
 
   // stop the writer before
@@ -177,92 +198,129 @@ Status BlockCacheTier::Insert(const Slice& key, const char* data,
   stats_.bytes_pipelined_.Add(size);
 
   if (opt_.pipeline_writes) {
-    // off load the write to the write thread
-    insert_ops_.Push(
-        InsertOp(key.ToString(), std::move(std::string(data, size))));
+    // off load the write to the insert threads
+    pending_inserts_++;
+    if (!insert_ops_.Push(
+            InsertOp(key.ToString(), std::move(std::string(data, size))))) {
+      pending_inserts_--;
+      stats_.insert_dropped_++;
+    }
     return Status::OK();
   }
 
   assert(!opt_.pipeline_writes);
-  return InsertImpl(key, Slice(data, size));
+  // spread the inserts over the slots by key
+  InsertSlot* slot =
+      &insert_slots_[GetSliceHash(key) % opt_.insert_threads];
+  MutexLock _(&slot->lock_);
+  Status s = InsertImpl(slot, key, Slice(data, size));
+  FlushBlockInfos(slot);
+  return s;
 }
 
-void BlockCacheTier::InsertMain() {
-  while (true) {
-    InsertOp op(insert_ops_.Pop());
-
-    if (op.signal_) {
-      // that is a secret signal to exit
-      break;
-    }
+void BlockCacheTier::InsertMain(InsertSlot* slot) {
+  std::vector<InsertOp> ops;
+  bool quit = false;
+  while (!quit) {
+    ops.clear();
+    insert_ops_.Pop(kMaxInsertBatch, &ops);
+
+    MutexLock _(&slot->lock_);
+    for (auto& op : ops) {
+      if (op.signal_) {
+        // that is a secret signal to exit. The other threads need theirs
+        if (quit) {
+          insert_ops_.Push(InsertOp(/*quit=*/true));
+        }
+        quit = true;
+        continue;
+      }
 
-    size_t retry = 0;
-    Status s;
-    while ((s = InsertImpl(Slice(op.key_), Slice(op.data_))).IsTryAgain()) {
-      if (retry > kMaxRetry) {
-        break;
+      size_t retry = 0;
+      Status s;
+      while ((s = InsertImpl(slot, Slice(op.key_), Slice(op.data_)))
+                 .IsTryAgain()) {
+        if (retry > kMaxRetry) {
+          break;
+        }
+
+        // this can happen when the buffers are full, we wait till some
+        // buffers are free. Why don't we wait inside the code. This is
+        // because we want to support both pipelined and non-pipelined mode
+        buffer_allocator_.WaitUntilUsable();
+        retry++;
       }
 
-      // this can happen when the buffers are full, we wait till some buffers
-      // are free. Why don't we wait inside the code. This is because we want
-      // to support both pipelined and non-pipelined mode
-      buffer_allocator_.WaitUntilUsable();
-      retry++;
+      if (!s.ok()) {
+        stats_.insert_dropped_++;
+      }
     }
 
-    if (!s.ok()) {
-      stats_.insert_dropped_++;
+    // the block information of the batch is added to the files at once
+    FlushBlockInfos(slot);
+    for (auto& op : ops) {
+      if (!op.signal_) {
+        pending_inserts_--;
+      }
     }
   }
 }
 
-Status BlockCacheTier::InsertImpl(const Slice& key, const Slice& data) {
+Status BlockCacheTier::InsertImpl(InsertSlot* slot, const Slice& key,
+                                  const Slice& data) {
   // pre-condition
   assert(key.size());
   assert(data.size());
-  assert(cache_file_);
+  slot->lock_.AssertHeld();
+  assert(slot->cache_file_);
 
   StopWatchNano timer(opt_.env, /*auto_start=*/ true);
 
-  WriteLock _(&lock_);
-
   LBA lba;
   if (metadata_.Lookup(key, &lba)) {
     // the key already exists, this is duplicate insert
     return Status::OK();
   }
 
-  while (!cache_file_->Append(key, data, &lba)) {
-    if (!cache_file_->Eof()) {
+  WriteableCacheFile* cache_file = slot->cache_file_;
+  while (!cache_file->Append(key, data, &lba)) {
+    if (!cache_file->Eof()) {
       ROCKS_LOG_DEBUG(opt_.log, "Error inserting to cache file %d",
-                      cache_file_->cacheid());
+                      cache_file->cacheid());
       stats_.write_latency_.Add(timer.ElapsedNanos() / 1000);
       return Status::TryAgain();
     }
 
-    assert(cache_file_->Eof());
-    Status status = NewCacheFile();
+    assert(cache_file->Eof());
+    Status status = NewCacheFile(slot);
     if (!status.ok()) {
       return status;
     }
+    cache_file = slot->cache_file_;
   }
 
-  // Insert into lookup index
+  // Insert into lookup index. This fails if another slot inserted the same
+  // key in the meantime, in which case the record is left unreferenced.
   BlockInfo* info = metadata_.Insert(key, lba);
-  assert(info);
-  if (!info) {
-    return Status::IOError("Unexpected error inserting to index");
+  if (info) {
+    // insert to cache file reverse mapping on the next flush
+    slot->block_infos_.push_back(info);
   }
 
-  // insert to cache file reverse mapping
-  cache_file_->Add(info);
-
   // update stats
   stats_.bytes_written_.Add(data.size());
   stats_.write_latency_.Add(timer.ElapsedNanos() / 1000);
   return Status::OK();
 }
 
+void BlockCacheTier::FlushBlockInfos(InsertSlot* slot) {
+  slot->lock_.AssertHeld();
+  if (!slot->block_infos_.empty()) {
+    slot->cache_file_->Add(slot->block_infos_);
+    slot->block_infos_.clear();
+  }
+}
+
 Status BlockCacheTier::Lookup(const Slice& key, std::unique_ptr<char[]>* val,
                               size_t* size) {
   StopWatchNano timer(opt_.env, /*auto_start=*/ true);
@@ -302,9 +360,10 @@ Status BlockCacheTier::Lookup(const Slice& key, std::unique_ptr<char[]>* val,
 
   assert(blk_key == key);
 
-  val->reset(new char[blk_val.size()]);
-  memcpy(val->get(), blk_val.data(), blk_val.size());
+  // return the record buffer, with the value moved to its front
+  memmove(scratch.get(), blk_val.data(), blk_val.size());
   *size = blk_val.size();
+  *val = std::move(scratch);
 
   stats_.bytes_read_.Add(*size);
   stats_.cache_hits_++;
@@ -321,15 +380,16 @@ bool BlockCacheTier::Erase(const Slice& key) {
   return true;
 }
 
-Status BlockCacheTier::NewCacheFile() {
-  lock_.AssertHeld();
+Status BlockCacheTier::NewCacheFile(InsertSlot* slot) {
+  slot->lock_.AssertHeld();
 
   TEST_SYNC_POINT_CALLBACK("BlockCacheTier::NewCacheFile:DeleteDir",
                            (void*)(GetCachePath().c_str()));
 
+  const uint32_t cache_id = writer_cache_id_++;
   std::unique_ptr<WriteableCacheFile> f(
     new WriteableCacheFile(opt_.env, &buffer_allocator_, &writer_,
-                           GetCachePath(), writer_cache_id_,
+                           GetCachePath(), cache_id,
                            opt_.cache_file_size, opt_.log));
 
   bool status = f->Create(opt_.enable_direct_writes, opt_.enable_direct_reads);
@@ -337,57 +397,76 @@ Status BlockCacheTier::NewCacheFile() {
     return Status::IOError("Error creating file");
   }
 
-  Info(opt_.log, "Created cache file %d", writer_cache_id_);
+  Info(opt_.log, "Created cache file %d", cache_id);
 
-  writer_cache_id_++;
-  cache_file_ = f.release();
+  // the slot's reference keeps the file from being evicted while it is filled
+  ++f->refs_;
 
   // insert to cache files tree
-  status = metadata_.Insert(cache_file_);
+  status = metadata_.Insert(f.get());
   assert(status);
   if (!status) {
     Error(opt_.log, "Error inserting to metadata");
+    --f->refs_;
     return Status::IOError("Error inserting to metadata");
   }
 
+  ReleaseCacheFile(slot);
+  slot->cache_file_ = f.release();
   return Status::OK();
 }
 
-bool BlockCacheTier::Reserve(const size_t size) {
-  WriteLock _(&lock_);
-  assert(size_ <= opt_.cache_size);
+void BlockCacheTier::ReleaseCacheFile(InsertSlot* slot) {
+  slot->lock_.AssertHeld();
+  if (slot->cache_file_) {
+    FlushBlockInfos(slot);
+    --slot->cache_file_->refs_;
+    slot->cache_file_ = nullptr;
+  }
+}
 
-  if (size + size_ <= opt_.cache_size) {
-    // there is enough space to write
-    size_ += size;
-    return true;
+bool BlockCacheTier::Reserve(const size_t size) {
+  // there is usually enough space to write, which needs no lock
+  uint64_t used = size_;
+  while (size + used <= opt_.cache_size) {
+    if (size_.compare_exchange_weak(used, used + size)) {
+      return true;
+    }
   }
 
-  assert(size + size_ >= opt_.cache_size);
-  // there is not enough space to fit the requested data
-  // we can clear some space by evicting cold data
+  WriteLock _(&lock_);
+  assert(size_ <= opt_.cache_size);
 
   const double retain_fac = (100 - kEvictPct) / static_cast<double>(100);
-  while (size + size_ > opt_.cache_size * retain_fac) {
-    std::unique_ptr<BlockCacheFile> f(metadata_.Evict());
-    if (!f) {
-      // nothing is evictable
-      return false;
-    }
-    assert(!f->refs_);
-    uint64_t file_size;
-    if (!f->Delete(&file_size).ok()) {
-      // unable to delete file
-      return false;
+  while (true) {
+    // the writers reserve without the lock, so the space is claimed with the
+    // same compare-and-swap and evicted for again if they took it first
+    used = size_;
+    while (size + used <= opt_.cache_size) {
+      if (size_.compare_exchange_weak(used, used + size)) {
+        return true;
+      }
     }
 
-    assert(file_size <= size_);
-    size_ -= file_size;
-  }
+    // there is not enough space to fit the requested data
+    // we can clear some space by evicting cold data
+    while (size + size_ > opt_.cache_size * retain_fac) {
+      std::unique_ptr<BlockCacheFile> f(metadata_.Evict());
+      if (!f) {
+        // nothing is evictable
+        return false;
+      }
+      assert(!f->refs_);
+      uint64_t file_size;
+      if (!f->Delete(&file_size).ok()) {
+        // unable to delete file
+        return false;
+      }
 
-  size_ += size;
-  assert(size_ <= opt_.cache_size * 0.9);
-  return true;
+      assert(file_size <= size_);
+      size_ -= file_size;
+    }
+  }
 }
 
 Status NewPersistentCache(Env* const env, const std::string& path,
@@ -407,6 +486,7 @@ Status NewPersistentCache(Env* const env, const std::string& path,
     opt.enable_direct_writes = true;
     opt.writer_qdepth = 4;
     opt.writer_dispatch_size = 4 * 1024;
+    opt.insert_threads = 2;
   }
 
   auto pcache = std::make_shared<BlockCacheTier>(opt);
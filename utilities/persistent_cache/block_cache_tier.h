@@ -18,6 +18,7 @@
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "rocksdb/cache.h"
 #include "rocksdb/comparator.h"
@@ -54,7 +55,7 @@ class BlockCacheTier : public PersistentCacheTier {
   virtual ~BlockCacheTier() {
     // Close is re-entrant so we can call close even if it is already closed
     Close();
-    assert(!insert_th_.joinable());
+    assert(insert_th_.empty());
   }
 
   Status Insert(const Slice& key, const char* data, const size_t size) override;
@@ -72,9 +73,9 @@ class BlockCacheTier : public PersistentCacheTier {
   PersistentCache::StatsType Stats() override;
 
   void TEST_Flush() override {
-    while (insert_ops_.Size()) {
+    while (pending_inserts_) {
       /* sleep override */
-      Env::Default()->SleepForMicroseconds(1000000);
+      Env::Default()->SleepForMicroseconds(1000);
     }
   }
 
@@ -83,6 +84,8 @@ class BlockCacheTier : public PersistentCacheTier {
   static const size_t kEvictPct = 10;
   // Max attempts to insert key, value to cache in pipelined mode
   static const size_t kMaxRetry = 3;
+  // Max number of ops an insert thread takes from the queue at a time
+  static const size_t kMaxInsertBatch = 64;
 
   // Pipelined operation
   struct InsertOp {
@@ -103,12 +106,30 @@ class BlockCacheTier : public PersistentCacheTier {
     const bool signal_ = false;  // signal to request processing thread to exit
   };
 
+  // A cache file being filled. Each insert thread has one of its own.
+  struct InsertSlot {
+    port::Mutex lock_;
+    // Current cache file. The slot holds a reference to it, so that it is not
+    // evicted before all its block information has been added to it.
+    WriteableCacheFile* cache_file_ = nullptr;
+    // Block information of the records appended since the last flush
+    std::vector<BlockInfo*> block_infos_;
+  };
+
   // entry point for insert thread
-  void InsertMain();
+  void InsertMain(InsertSlot* slot);
   // insert implementation
-  Status InsertImpl(const Slice& key, const Slice& data);
-  // Create a new cache file
-  Status NewCacheFile();
+  // REQUIRES: slot->lock_ is held
+  Status InsertImpl(InsertSlot* slot, const Slice& key, const Slice& data);
+  // Add the pending block information of the slot to its cache file
+  // REQUIRES: slot->lock_ is held
+  void FlushBlockInfos(InsertSlot* slot);
+  // Replace the cache file of the slot with a new one
+  // REQUIRES: slot->lock_ is held
+  Status NewCacheFile(InsertSlot* slot);
+  // Release the cache file of the slot
+  // REQUIRES: slot->lock_ is held
+  void ReleaseCacheFile(InsertSlot* slot);
   // Get cache directory path
   std::string GetCachePath() const { return opt_.path + "/cache"; }
   // Cleanup folder
@@ -138,17 +159,18 @@ class BlockCacheTier : public PersistentCacheTier {
     }
   };
 
-  port::RWMutex lock_;                          // Synchronization
+  port::RWMutex lock_;                          // Synchronizes eviction
   const PersistentCacheConfig opt_;             // BlockCache options
   BoundedQueue<InsertOp> insert_ops_;           // Ops waiting for insert
-  rocksdb::port::Thread insert_th_;                       // Insert thread
-  uint32_t writer_cache_id_ = 0;                // Current cache file identifier
-  WriteableCacheFile* cache_file_ = nullptr;    // Current cache file reference
+  std::atomic<uint64_t> pending_inserts_{0};    // Ops queued or being inserted
+  std::vector<port::Thread> insert_th_;         // Insert threads
+  std::unique_ptr<InsertSlot[]> insert_slots_;  // Cache files being filled
+  std::atomic<uint32_t> writer_cache_id_{0};    // Next cache file identifier
   CacheWriteBufferAllocator buffer_allocator_;  // Buffer provider
   ThreadedWriter writer_;                       // Writer threads
   BlockCacheTierMetadata metadata_;             // Cache meta data manager
   std::atomic<uint64_t> size_{0};               // Size of the cache
-  Statistics stats_;                                 // Statistics
+  Statistics stats_;                            // Statistics
 };
 
 }  // namespace rocksdb
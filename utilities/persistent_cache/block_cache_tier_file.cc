@@ -278,7 +278,7 @@ WriteableCacheFile::~WriteableCacheFile() {
   ClearBuffers();
 }
 
-bool WriteableCacheFile::Create(const bool /*enable_direct_writes*/,
+bool WriteableCacheFile::Create(const bool enable_direct_writes,
                                 const bool enable_direct_reads) {
   WriteLock _(&rwlock_);
 
@@ -293,7 +293,9 @@ bool WriteableCacheFile::Create(const bool /*enable_direct_writes*/,
                    s.ToString().c_str());
   }
 
-  s = NewWritableCacheFile(env_, Path(), &file_);
+  // The buffers are aligned and written whole, so they can bypass the page
+  // cache
+  s = NewWritableCacheFile(env_, Path(), &file_, enable_direct_writes);
   if (!s.ok()) {
     ROCKS_LOG_WARN(log_, "Unable to create file %s. %s", Path().c_str(),
                    s.ToString().c_str());
@@ -128,6 +128,11 @@ class BlockCacheFile : public LRUElement<BlockCacheFile> {
     WriteLock _(&rwlock_);
     block_infos_.push_back(binfo);
   }
+  // Add a batch of block information to file data
+  void Add(const std::vector<BlockInfo*>& binfos) {
+    WriteLock _(&rwlock_);
+    block_infos_.insert(block_infos_.end(), binfos.begin(), binfos.end());
+  }
   // get block information
   std::list<BlockInfo*>& block_infos() { return block_infos_; }
   // delete file and return the size of the file
@@ -38,6 +38,8 @@ DEFINE_int32(iosize, 4 * 1024, "Read IO size");
 DEFINE_int32(writer_iosize, 4 * 1024, "File writer IO size");
 DEFINE_int32(writer_qdepth, 1, "File writer qdepth");
 DEFINE_bool(enable_pipelined_writes, false, "Enable async writes");
+DEFINE_int32(insert_threads, 1, "Cache files filled in parallel");
+DEFINE_bool(enable_direct_writes, false, "Write cache files with direct IO");
 DEFINE_string(cache_type, "block_cache",
               "Cache type. (block_cache, volatile, tiered)");
 DEFINE_bool(benchmark, false, "Benchmark mode");
@@ -63,6 +65,8 @@ std::unique_ptr<PersistentCacheTier> NewBlockCache() {
   opt.writer_dispatch_size = FLAGS_writer_iosize;
   opt.writer_qdepth = FLAGS_writer_qdepth;
   opt.pipeline_writes = FLAGS_enable_pipelined_writes;
+  opt.insert_threads = FLAGS_insert_threads;
+  opt.enable_direct_writes = FLAGS_enable_direct_writes;
   opt.max_write_pipeline_backlog_size = std::numeric_limits<uint64_t>::max();
   std::unique_ptr<PersistentCacheTier> cache(new BlockCacheTier(opt));
   Status status = cache->Open();
@@ -101,6 +105,8 @@ std::unique_ptr<PersistentTieredCache> NewTieredCache() {
   opt.writer_dispatch_size = FLAGS_writer_iosize;
   opt.writer_qdepth = FLAGS_writer_qdepth;
   opt.pipeline_writes = FLAGS_enable_pipelined_writes;
+  opt.insert_threads = FLAGS_insert_threads;
+  opt.enable_direct_writes = FLAGS_enable_direct_writes;
   opt.max_write_pipeline_backlog_size = std::numeric_limits<uint64_t>::max();
   return NewTieredCache(FLAGS_cache_size * pct, opt);
 }
@@ -323,6 +329,8 @@ int main(int argc, char** argv) {
       << "* writer_qdepth=" << FLAGS_writer_qdepth << std::endl
       << "* enable_pipelined_writes=" << FLAGS_enable_pipelined_writes
       << std::endl
+      << "* insert_threads=" << FLAGS_insert_threads << std::endl
+      << "* enable_direct_writes=" << FLAGS_enable_direct_writes << std::endl
       << "* cache_type=" << FLAGS_cache_type << std::endl
       << "* benchmark=" << FLAGS_benchmark << std::endl
       << "* volatile_cache_pct=" << FLAGS_volatile_cache_pct << std::endl;
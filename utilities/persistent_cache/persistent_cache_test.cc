@@ -103,13 +103,15 @@ std::unique_ptr<PersistentTieredCache> NewTieredCache(
 std::unique_ptr<PersistentCacheTier> NewBlockCache(
     Env* env, const std::string& path,
     const uint64_t max_size = std::numeric_limits<uint64_t>::max(),
-    const bool enable_direct_writes = false) {
+    const bool enable_direct_writes = false,
+    const uint32_t insert_threads = 1) {
   const uint32_t max_file_size = static_cast<uint32_t>(12 * 1024 * 1024 * kStressFactor);
   auto log = std::make_shared<ConsoleLogger>();
   PersistentCacheConfig opt(env, path, max_size, log);
   opt.cache_file_size = max_file_size;
   opt.max_write_pipeline_backlog_size = std::numeric_limits<uint64_t>::max();
   opt.enable_direct_writes = enable_direct_writes;
+  opt.insert_threads = insert_threads;
   std::unique_ptr<PersistentCacheTier> scache(new BlockCacheTier(opt));
   Status s = scache->Open();
   assert(s.ok());
@@ -211,6 +213,18 @@ TEST_F(PersistentCacheTierTest, BlockCacheInsert) {
   }
 }
 
+TEST_F(PersistentCacheTierTest, BlockCacheInsertWithInsertThreads) {
+  for (auto direct_writes : {true, false}) {
+    for (auto nthreads : {1, 5}) {
+      cache_ = NewBlockCache(Env::Default(), path_,
+                             /*size=*/std::numeric_limits<uint64_t>::max(),
+                             direct_writes, /*insert_threads=*/4);
+      RunInsertTest(nthreads,
+                    static_cast<size_t>(1 * 1024 * 1024 * kStressFactor));
+    }
+  }
+}
+
 TEST_F(PersistentCacheTierTest, BlockCacheInsertWithEviction) {
   for (auto nthreads : {1, 5}) {
     for (auto max_keys : {1 * 1024 * 1024 * kStressFactor}) {
@@ -221,6 +235,17 @@ TEST_F(PersistentCacheTierTest, BlockCacheInsertWithEviction) {
   }
 }
 
+TEST_F(PersistentCacheTierTest, BlockCacheInsertWithEvictionAndInsertThreads) {
+  for (auto nthreads : {1, 5}) {
+    cache_ = NewBlockCache(
+        Env::Default(), path_,
+        /*max_size=*/static_cast<size_t>(200 * 1024 * 1024 * kStressFactor),
+        /*direct_writes=*/false, /*insert_threads=*/4);
+    RunInsertTestWithEviction(
+        nthreads, static_cast<size_t>(1 * 1024 * 1024 * kStressFactor));
+  }
+}
+
 // Tiered cache tests
 TEST_F(PersistentCacheTierTest, TieredCacheInsert) {
   for (auto nthreads : {1, 5}) {
@@ -40,6 +40,9 @@ std::string PersistentCacheConfig::ToString() const {
   snprintf(buffer, kBufferSize, "    writer_qdepth: %" PRIu32 "\n",
            writer_qdepth);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    insert_threads: %" PRIu32 "\n",
+           insert_threads);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "    pipeline_writes: %d\n", pipeline_writes);
   ret.append(buffer);
   snprintf(buffer, kBufferSize,
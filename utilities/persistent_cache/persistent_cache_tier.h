@@ -115,8 +115,11 @@ struct PersistentCacheConfig {
     // - Queue depth cannot be 0
     // - writer_dispatch_size cannot be greater than writer_buffer_size
     // - dispatch size and buffer size need to be aligned
+    // - Insert threads cannot be 0
+    // - direct writes need the dispatch size to be aligned to 4K
     if (!writer_qdepth || writer_dispatch_size > write_buffer_size ||
-        write_buffer_size % writer_dispatch_size) {
+        write_buffer_size % writer_dispatch_size || !insert_threads ||
+        (enable_direct_writes && writer_dispatch_size % (4 * 1024))) {
       return Status::InvalidArgument("invalid writer settings");
     }
 
@@ -170,6 +173,15 @@ struct PersistentCacheConfig {
   // default :1
   uint32_t writer_qdepth = 1;
 
+  // insert-threads
+  //
+  // The inserts are appended to this many cache files at a time, each of them
+  // filled by its own thread in pipelined mode. This lets the inserts and the
+  // IOs of the writers proceed in parallel.
+  //
+  // default: 1
+  uint32_t insert_threads = 1;
+
   // pipeline-writes
   //
   // The write optionally follow pipelined architecture. This helps
@@ -197,11 +209,16 @@ struct PersistentCacheConfig {
   // write-buffer-count
   //
   // This is the total number of buffer slabs. This is calculated as a factor of
-  // file size in order to avoid dead lock.
+  // file size in order to avoid dead lock. Each of the files being filled can
+  // hold all the buffers it needs to reach its end, including the one its last
+  // record spills into, whatever the other files hold.
   size_t write_buffer_count() const {
     assert(write_buffer_size);
-    return static_cast<size_t>((writer_qdepth + 1.2) * cache_file_size /
-                               write_buffer_size);
+    const size_t buffers_per_file =
+        (cache_file_size + write_buffer_size - 1) / write_buffer_size + 1;
+    return static_cast<size_t>((writer_qdepth + 0.2) * cache_file_size /
+                               write_buffer_size) +
+           insert_threads * buffers_per_file;
   }
 
   // writer-dispatch-size
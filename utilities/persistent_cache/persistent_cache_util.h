@@ -6,6 +6,7 @@
 
 #include <limits>
 #include <list>
+#include <vector>
 
 #include "util/mutexlock.h"
 
@@ -26,17 +27,19 @@ class BoundedQueue {
 
   virtual ~BoundedQueue() {}
 
-  void Push(T&& t) {
+  // Returns false if the element was discarded
+  bool Push(T&& t) {
     MutexLock _(&lock_);
     if (max_size_ != std::numeric_limits<size_t>::max() &&
         size_ + t.Size() >= max_size_) {
       // overflow
-      return;
+      return false;
     }
 
     size_ += t.Size();
     q_.push_back(std::move(t));
     cond_empty_.SignalAll();
+    return true;
   }
 
   T Pop() {
@@ -51,6 +54,21 @@ class BoundedQueue {
     return std::move(t);
   }
 
+  // Pop up to max_count elements into out, waiting for the first one
+  void Pop(const size_t max_count, std::vector<T>* out) {
+    assert(max_count);
+    MutexLock _(&lock_);
+    while (q_.empty()) {
+      cond_empty_.Wait();
+    }
+
+    while (!q_.empty() && out->size() < max_count) {
+      size_ -= q_.front().Size();
+      out->push_back(std::move(q_.front()));
+      q_.pop_front();
+    }
+  }
+
   size_t Size() const {
     MutexLock _(&lock_);
     return size_;
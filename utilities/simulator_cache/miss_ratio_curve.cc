@@ -0,0 +1,225 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "utilities/simulator_cache/miss_ratio_curve.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "util/hash.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+namespace {
+// Sampling decisions use the top kValueBits bits of a key's hash.
+const int kValueBits = 24;
+const uint32_t kAllSampled = 1u << kValueBits;
+
+// Reuse distances are counted in buckets: one per byte up to 16 bytes, then
+// eight per doubling.
+const size_t kNumBuckets = 16 + 8 * 64;
+}  // namespace
+
+MissRatioCurveEstimator::MissRatioCurveEstimator(size_t max_sampled_keys)
+    : max_sampled_keys_(std::max<size_t>(max_sampled_keys, 1)),
+      threshold_(kAllSampled),
+      // Room for the times of the tracked keys and as many later uses before
+      // the times need to be renumbered.
+      charge_tree_(2 * max_sampled_keys_ + 2, 0),
+      total_charge_(0),
+      time_(0),
+      lookups_(0),
+      hits_(kNumBuckets, 0) {}
+
+bool MissRatioCurveEstimator::Sample(const Slice& key, uint64_t* hash,
+                                     uint32_t* value) const {
+  uint32_t high = Hash(key.data(), key.size(), 0x8a5bd9c1);
+  *value = high >> (32 - kValueBits);
+  if (*value >= threshold_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  *hash = (static_cast<uint64_t>(high) << 32) |
+          Hash(key.data(), key.size(), 0x2f9e4b63);
+  return true;
+}
+
+void MissRatioCurveEstimator::Lookup(const Slice& key) {
+  uint64_t hash;
+  uint32_t value;
+  if (!Sample(key, &hash, &value)) {
+    return;
+  }
+  MutexLock l(&mutex_);
+  if (value >= threshold_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  lookups_ += 1;
+  auto it = entries_.find(hash);
+  if (it == entries_.end()) {
+    // Its charge comes with the following insert.
+    Track(hash, value, 0);
+    return;
+  }
+  Entry& entry = it->second;
+  double rate =
+      static_cast<double>(threshold_.load(std::memory_order_relaxed)) /
+      kAllSampled;
+  uint64_t others = total_charge_ - ChargeUntil(entry.time);
+  hits_[BucketIndex(others / rate + entry.charge)] += 1;
+
+  NextTime();
+  AddCharge(entry.time, 0 - static_cast<uint64_t>(entry.charge));
+  entry.time = time_++;
+  AddCharge(entry.time, entry.charge);
+}
+
+void MissRatioCurveEstimator::Insert(const Slice& key, size_t charge) {
+  uint64_t hash;
+  uint32_t value;
+  if (!Sample(key, &hash, &value)) {
+    return;
+  }
+  MutexLock l(&mutex_);
+  if (value >= threshold_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  auto it = entries_.find(hash);
+  if (it == entries_.end()) {
+    Track(hash, value, charge);
+    return;
+  }
+  Entry& entry = it->second;
+  AddCharge(entry.time, static_cast<uint64_t>(charge) - entry.charge);
+  total_charge_ += static_cast<uint64_t>(charge) - entry.charge;
+  entry.charge = charge;
+}
+
+double MissRatioCurveEstimator::MissRatio(size_t capacity) const {
+  MutexLock l(&mutex_);
+  if (lookups_ <= 0) {
+    return 0.0;
+  }
+  double hits = 0;
+  double lower = 0;
+  for (size_t i = 0; i < kNumBuckets && lower < capacity; i++) {
+    double limit = BucketLimit(i);
+    if (limit <= capacity) {
+      hits += hits_[i];
+    } else {
+      // Assume the distances are spread evenly within the bucket.
+      hits += hits_[i] * (capacity - lower) / (limit - lower);
+    }
+    lower = limit;
+  }
+  return std::max(0.0, 1.0 - hits / lookups_);
+}
+
+void MissRatioCurveEstimator::Reset() {
+  MutexLock l(&mutex_);
+  threshold_.store(kAllSampled, std::memory_order_relaxed);
+  entries_.clear();
+  by_value_ = std::priority_queue<std::pair<uint32_t, uint64_t>>();
+  std::fill(charge_tree_.begin(), charge_tree_.end(), 0);
+  total_charge_ = 0;
+  time_ = 0;
+  lookups_ = 0;
+  std::fill(hits_.begin(), hits_.end(), 0);
+}
+
+void MissRatioCurveEstimator::Track(uint64_t hash, uint32_t value,
+                                    size_t charge) {
+  mutex_.AssertHeld();
+  NextTime();
+  entries_[hash] = Entry{time_, charge};
+  AddCharge(time_++, charge);
+  total_charge_ += charge;
+  by_value_.emplace(value, hash);
+  if (entries_.size() > max_sampled_keys_) {
+    LowerThreshold();
+  }
+}
+
+void MissRatioCurveEstimator::Untrack(uint64_t hash) {
+  auto it = entries_.find(hash);
+  if (it != entries_.end()) {
+    AddCharge(it->second.time, 0 - static_cast<uint64_t>(it->second.charge));
+    total_charge_ -= it->second.charge;
+    entries_.erase(it);
+  }
+}
+
+void MissRatioCurveEstimator::NextTime() {
+  if (time_ + 1 < charge_tree_.size()) {
+    return;
+  }
+  // Out of positions: renumber the tracked keys in order of last use.
+  std::vector<std::pair<uint64_t, Entry*>> order;
+  order.reserve(entries_.size());
+  for (auto& entry : entries_) {
+    order.emplace_back(entry.second.time, &entry.second);
+  }
+  std::sort(order.begin(), order.end(),
+            [](const std::pair<uint64_t, Entry*>& a,
+               const std::pair<uint64_t, Entry*>& b) {
+              return a.first < b.first;
+            });
+  std::fill(charge_tree_.begin(), charge_tree_.end(), 0);
+  time_ = 0;
+  for (auto& item : order) {
+    item.second->time = time_++;
+    AddCharge(item.second->time, item.second->charge);
+  }
+}
+
+void MissRatioCurveEstimator::LowerThreshold() {
+  uint32_t old_threshold = threshold_.load(std::memory_order_relaxed);
+  uint32_t new_threshold = by_value_.top().first;
+  while (!by_value_.empty() && by_value_.top().first >= new_threshold) {
+    Untrack(by_value_.top().second);
+    by_value_.pop();
+  }
+  threshold_.store(new_threshold, std::memory_order_relaxed);
+  // Keep the lookups counted so far in proportion to those sampled from now
+  // on.
+  double scale = static_cast<double>(new_threshold) / old_threshold;
+  lookups_ *= scale;
+  for (auto& hits : hits_) {
+    hits *= scale;
+  }
+}
+
+void MissRatioCurveEstimator::AddCharge(uint64_t time, uint64_t delta) {
+  for (size_t i = static_cast<size_t>(time) + 1; i < charge_tree_.size();
+       i += i & (0 - i)) {
+    charge_tree_[i] += delta;
+  }
+}
+
+uint64_t MissRatioCurveEstimator::ChargeUntil(uint64_t time) const {
+  uint64_t sum = 0;
+  for (size_t i = static_cast<size_t>(time) + 1; i > 0; i -= i & (0 - i)) {
+    sum += charge_tree_[i];
+  }
+  return sum;
+}
+
+size_t MissRatioCurveEstimator::BucketIndex(double distance) {
+  if (distance <= 16) {
+    return distance <= 1 ? 0 : static_cast<size_t>(std::ceil(distance)) - 1;
+  }
+  size_t index =
+      15 + static_cast<size_t>(std::ceil(8 * std::log2(distance / 16)));
+  return std::min(index, kNumBuckets - 1);
+}
+
+double MissRatioCurveEstimator::BucketLimit(size_t index) {
+  if (index < 16) {
+    return static_cast<double>(index + 1);
+  }
+  return 16 * std::exp2((index - 15) / 8.0);
+}
+
+}  // namespace rocksdb
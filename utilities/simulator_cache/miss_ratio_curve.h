@@ -0,0 +1,95 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+
+// Estimates the miss ratio curve of an LRU cache, i.e. its miss ratio as a
+// function of its capacity, from a single stream of lookups. A lookup hits
+// in an LRU cache of capacity C iff the total charge of the distinct keys
+// used since the previous lookup of the same key, plus its own charge, is at
+// most C. This reuse distance is computed for a sample of the keys, chosen
+// by hash so that either all or none of the lookups of a key are sampled,
+// and scaled by the sampling rate (SHARDS, Waldspurger et al., FAST '15).
+//
+// The sampling rate starts at 1. Whenever more than max_sampled_keys keys
+// are tracked, it is lowered to drop the keys with the largest hashes, so
+// memory stays bounded whatever the number of distinct keys.
+//
+// Thread safe.
+class MissRatioCurveEstimator {
+ public:
+  explicit MissRatioCurveEstimator(size_t max_sampled_keys = 8192);
+
+  // Record a lookup of key, whether it hits or not.
+  void Lookup(const Slice& key);
+
+  // Record the charge of key when it is inserted. A key inserted without
+  // a lookup first is tracked from then on, but the insert is not counted
+  // as a lookup.
+  void Insert(const Slice& key, size_t charge);
+
+  // Fraction of the lookups recorded so far that would have missed in an
+  // LRU cache of the given capacity. 0 if nothing was recorded.
+  double MissRatio(size_t capacity) const;
+
+  // Forget all lookups and keys, and go back to sampling every key.
+  void Reset();
+
+ private:
+  struct Entry {
+    uint64_t time;
+    size_t charge;
+  };
+
+  // Returns whether key is sampled; if so, sets *hash and *value, the part
+  // of the hash compared against threshold_.
+  bool Sample(const Slice& key, uint64_t* hash, uint32_t* value) const;
+
+  void Track(uint64_t hash, uint32_t value, size_t charge);
+  void Untrack(uint64_t hash);
+  void NextTime();
+  void LowerThreshold();
+
+  // Fenwick tree over time_ positions holding the charge of the key last
+  // used at each.
+  void AddCharge(uint64_t time, uint64_t delta);
+  uint64_t ChargeUntil(uint64_t time) const;
+
+  static size_t BucketIndex(double distance);
+  static double BucketLimit(size_t index);
+
+  const size_t max_sampled_keys_;
+
+  mutable port::Mutex mutex_;
+  // Keys whose value is below threshold_ are sampled. Read without mutex_
+  // to skip most keys cheaply once the rate is low.
+  std::atomic<uint32_t> threshold_;
+
+  std::unordered_map<uint64_t, Entry> entries_;
+  // (value, hash) of the tracked keys, largest value first.
+  std::priority_queue<std::pair<uint32_t, uint64_t>> by_value_;
+  std::vector<uint64_t> charge_tree_;
+  uint64_t total_charge_;
+  uint64_t time_;
+
+  // Sampled lookups, and the sampled hits in an LRU cache of at most
+  // BucketLimit(i) bytes for each i, scaled down by later rate changes.
+  double lookups_;
+  std::vector<double> hits_;
+};
+
+}  // namespace rocksdb
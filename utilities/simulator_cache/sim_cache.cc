@@ -11,6 +11,7 @@
 #include "util/file_reader_writer.h"
 #include "util/mutexlock.h"
 #include "util/string_util.h"
+#include "utilities/simulator_cache/miss_ratio_curve.h"
 
 namespace rocksdb {
 
@@ -150,12 +151,10 @@ class CacheActivityLogger {
 // SimCacheImpl definition
 class SimCacheImpl : public SimCache {
  public:
-  // capacity for real cache (ShardedLRUCache)
-  // test_capacity for key only cache
-  SimCacheImpl(std::shared_ptr<Cache> cache, size_t sim_capacity,
-               int num_shard_bits)
+  // cache is the real cache, sim_cache the key only cache
+  SimCacheImpl(std::shared_ptr<Cache> sim_cache, std::shared_ptr<Cache> cache)
       : cache_(cache),
-        key_only_cache_(NewLRUCache(sim_capacity, num_shard_bits)),
+        key_only_cache_(sim_cache),
         miss_times_(0),
         hit_times_(0),
         stats_(nullptr) {}
@@ -172,23 +171,23 @@ class SimCacheImpl : public SimCache {
   virtual Status Insert(const Slice& key, void* value, size_t charge,
                         void (*deleter)(const Slice& key, void* value),
                         Handle** handle, Priority priority) override {
-    // The handle and value passed in are for real cache, so we pass nullptr
-    // to key_only_cache_ for both instead. Also, the deleter function pointer
-    // will be called by user to perform some external operation which should
-    // be applied only once. Thus key_only_cache accepts an empty function.
-    // *Lambda function without capture can be assgined to a function pointer
-    Handle* h = key_only_cache_->Lookup(key);
-    if (h == nullptr) {
-      key_only_cache_->Insert(key, nullptr, charge,
-                              [](const Slice& /*k*/, void* /*v*/) {}, nullptr,
-                              priority);
-    } else {
-      key_only_cache_->Release(h);
-    }
+    SimInsert(key, charge, priority);
+    return cache_->Insert(key, value, charge, deleter, handle, priority);
+  }
 
-    cache_activity_logger_.ReportAdd(key, charge);
+  virtual Status InsertSaveable(const Slice& key, void* value, size_t charge,
+                                void (*deleter)(const Slice& key, void* value),
+                                Slice (*save_cb)(void* value), Handle** handle,
+                                Priority priority,
+                                uint32_t quota_group) override {
+    SimInsert(key, charge, priority);
+    return cache_->InsertSaveable(key, value, charge, deleter, save_cb, handle,
+                                  priority, quota_group);
+  }
 
-    return cache_->Insert(key, value, charge, deleter, handle, priority);
+  virtual bool LookupSecondary(const Slice& key, std::unique_ptr<char[]>* data,
+                               size_t* size) override {
+    return cache_->LookupSecondary(key, data, size);
   }
 
   virtual Handle* Lookup(const Slice& key, Statistics* stats) override {
@@ -203,6 +202,7 @@ class SimCacheImpl : public SimCache {
     }
 
     cache_activity_logger_.ReportLookup(key);
+    miss_ratio_curve_.Lookup(key);
 
     return cache_->Lookup(key, stats);
   }
@@ -249,11 +249,34 @@ class SimCacheImpl : public SimCache {
     cache_->ApplyToAllCacheEntries(callback, thread_safe);
   }
 
+  virtual void ApplyToAllCacheKeys(
+      const std::function<void(const Slice&, size_t, Priority)>& callback,
+      bool thread_safe) override {
+    cache_->ApplyToAllCacheKeys(callback, thread_safe);
+  }
+
   virtual void EraseUnRefEntries() override {
     cache_->EraseUnRefEntries();
     key_only_cache_->EraseUnRefEntries();
   }
 
+  // Quotas only apply to the real cache, the key only cache simulates a
+  // cache without them.
+  virtual uint32_t GetQuotaGroup(const std::string& name,
+                                 uint32_t parent) override {
+    return cache_->GetQuotaGroup(name, parent);
+  }
+
+  virtual Status SetQuota(const std::string& name,
+                          const CacheQuota& quota) override {
+    return cache_->SetQuota(name, quota);
+  }
+
+  virtual bool GetQuota(const std::string& name, CacheQuota* quota,
+                        size_t* usage) const override {
+    return cache_->GetQuota(name, quota, usage);
+  }
+
   virtual size_t GetSimCapacity() const override {
     return key_only_cache_->GetCapacity();
   }
@@ -277,6 +300,11 @@ class SimCacheImpl : public SimCache {
     hit_times_.store(0, std::memory_order_relaxed);
     SetTickerCount(stats_, SIM_BLOCK_CACHE_HIT, 0);
     SetTickerCount(stats_, SIM_BLOCK_CACHE_MISS, 0);
+    miss_ratio_curve_.Reset();
+  }
+
+  virtual double GetEstimatedMissRatio(size_t capacity) const override {
+    return miss_ratio_curve_.MissRatio(capacity);
   }
 
   virtual std::string ToString() const override {
@@ -323,11 +351,31 @@ class SimCacheImpl : public SimCache {
   std::atomic<uint64_t> hit_times_;
   Statistics* stats_;
   CacheActivityLogger cache_activity_logger_;
+  MissRatioCurveEstimator miss_ratio_curve_;
 
   void inc_miss_counter() {
     miss_times_.fetch_add(1, std::memory_order_relaxed);
   }
   void inc_hit_counter() { hit_times_.fetch_add(1, std::memory_order_relaxed); }
+
+  void SimInsert(const Slice& key, size_t charge, Priority priority) {
+    // The handle and value passed in are for real cache, so we pass nullptr
+    // to key_only_cache_ for both instead. Also, the deleter function pointer
+    // will be called by user to perform some external operation which should
+    // be applied only once. Thus key_only_cache accepts an empty function.
+    // *Lambda function without capture can be assgined to a function pointer
+    Handle* h = key_only_cache_->Lookup(key);
+    if (h == nullptr) {
+      key_only_cache_->Insert(key, nullptr, charge,
+                              [](const Slice& /*k*/, void* /*v*/) {}, nullptr,
+                              priority);
+    } else {
+      key_only_cache_->Release(h);
+    }
+
+    cache_activity_logger_.ReportAdd(key, charge);
+    miss_ratio_curve_.Insert(key, charge);
+  }
 };
 
 }  // end anonymous namespace
@@ -338,7 +386,17 @@ std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> cache,
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
-  return std::make_shared<SimCacheImpl>(cache, sim_capacity, num_shard_bits);
+  return NewSimCache(NewLRUCache(sim_capacity, num_shard_bits), cache,
+                     num_shard_bits);
+}
+
+std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> sim_cache,
+                                      std::shared_ptr<Cache> cache,
+                                      int num_shard_bits) {
+  if (num_shard_bits >= 20 || sim_cache == nullptr) {
+    return nullptr;  // the cache cannot be sharded into too many fine pieces
+  }
+  return std::make_shared<SimCacheImpl>(sim_cache, cache);
 }
 
 }  // end namespace rocksdb
@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #include "rocksdb/utilities/sim_cache.h"
+#include <algorithm>
 #include <cstdlib>
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
@@ -210,6 +211,120 @@ TEST_F(SimCacheTest, SimCacheLogging) {
 	ASSERT_GT(fsize, max_size - 100);
 }
 
+TEST_F(SimCacheTest, SimulateFrequencyBasedAdmission) {
+  LRUCacheOptions sim_options(3, 0, false, 0.0);
+  sim_options.frequency_based_admission = true;
+  std::shared_ptr<SimCache> sim_cache =
+      NewSimCache(NewLRUCache(sim_options), NewLRUCache(3, 0), 0);
+  ASSERT_NE(nullptr, sim_cache);
+
+  // Two hot keys are read after every three keys of a scan. Plain LRU evicts
+  // them before they are read again, while the admission filter keeps them.
+  uint64_t hits = 0;
+  auto read = [&](const std::string& key) {
+    Cache::Handle* handle = sim_cache->Lookup(key);
+    if (handle != nullptr) {
+      hits++;
+      sim_cache->Release(handle);
+    } else {
+      ASSERT_OK(sim_cache->Insert(key, nullptr, 1, nullptr));
+    }
+  };
+  const int kRounds = 20;
+  for (int i = 0; i < kRounds; i++) {
+    for (int j = 0; j < 3; j++) {
+      read("scan" + ToString(i * 3 + j));
+    }
+    read("hot1");
+    read("hot2");
+  }
+  ASSERT_EQ(0, hits);
+  ASSERT_GT(sim_cache->get_hit_counter(), 2 * (kRounds - 3));
+}
+
+TEST_F(SimCacheTest, Quota) {
+  std::shared_ptr<Cache> cache = NewLRUCache(10, 0);
+  std::shared_ptr<SimCache> sim_cache = NewSimCache(cache, 10, 0);
+  ASSERT_NE(nullptr, sim_cache);
+  uint32_t group = sim_cache->GetQuotaGroup("scan");
+  ASSERT_NE(Cache::kNoQuotaGroup, group);
+  ASSERT_EQ(group, cache->GetQuotaGroup("scan"));
+  ASSERT_OK(sim_cache->SetQuota("scan", CacheQuota(0, 2)));
+  for (int i = 0; i < 4; i++) {
+    ASSERT_OK(sim_cache->InsertSaveable("s" + ToString(i), nullptr, 1, nullptr,
+                                        nullptr, nullptr, Cache::Priority::LOW,
+                                        group));
+  }
+  // The real cache applies the quota, the simulated one keeps every key.
+  CacheQuota quota;
+  size_t usage = 0;
+  ASSERT_TRUE(sim_cache->GetQuota("scan", &quota, &usage));
+  ASSERT_EQ(2, quota.limit);
+  ASSERT_EQ(2, usage);
+  ASSERT_EQ(4, sim_cache->GetSimUsage());
+}
+
+TEST_F(SimCacheTest, EstimatedMissRatio) {
+  std::shared_ptr<SimCache> sim_cache = NewSimCache(NewLRUCache(1000), 1000, 0);
+  ASSERT_EQ(0.0, sim_cache->GetEstimatedMissRatio(1000));
+
+  // Read num_keys keys of charge 1 in a loop, three times over. An LRU cache
+  // holding all of them only misses on the first pass, a smaller one misses
+  // every time.
+  auto loop = [&](int num_keys) {
+    sim_cache->reset_counter();
+    for (int pass = 0; pass < 3; pass++) {
+      for (int i = 0; i < num_keys; i++) {
+        std::string key = Key(i);
+        Cache::Handle* handle = sim_cache->Lookup(key);
+        if (handle != nullptr) {
+          sim_cache->Release(handle);
+        } else {
+          ASSERT_OK(sim_cache->Insert(key, nullptr, 1, nullptr));
+        }
+      }
+    }
+  };
+
+  // Few enough keys to track them all.
+  loop(100);
+  ASSERT_NEAR(1.0 / 3, sim_cache->GetEstimatedMissRatio(200), 0.001);
+  ASSERT_NEAR(1.0, sim_cache->GetEstimatedMissRatio(50), 0.001);
+
+  // Too many keys to track, so only a sample of them is.
+  loop(50000);
+  ASSERT_NEAR(1.0 / 3, sim_cache->GetEstimatedMissRatio(100000), 0.05);
+  ASSERT_NEAR(1.0, sim_cache->GetEstimatedMissRatio(25000), 0.05);
+}
+
+TEST_F(SimCacheTest, MissRatioCurveProperty) {
+  auto table_options = GetTableOptions();
+  auto options = GetOptions(table_options);
+  Reopen(options);
+  std::string curve;
+  ASSERT_FALSE(
+      db_->GetProperty(DB::Properties::kBlockCacheMissRatioCurve, &curve));
+
+  table_options.block_cache = NewSimCache(NewLRUCache(1 << 20), 1 << 20, 0);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+  InitTable(options);
+  ASSERT_OK(Flush());
+  for (size_t i = 0; i < kNumBlocks * 2; i++) {
+    ASSERT_EQ(std::string(kValueSize, 'a'), Get(ToString(i)));
+  }
+
+  std::map<std::string, std::string> points;
+  ASSERT_TRUE(
+      db_->GetMapProperty(DB::Properties::kBlockCacheMissRatioCurve, &points));
+  ASSERT_EQ(10, points.size());
+  ASSERT_EQ("1.0000", points[ToString(1 << 20)]);
+  ASSERT_TRUE(
+      db_->GetProperty(DB::Properties::kBlockCacheMissRatioCurve, &curve));
+  ASSERT_EQ(10, std::count(curve.begin(), curve.end(), '\n'));
+  ASSERT_EQ(0, curve.find(ToString((1 << 20) / 8) + " 1.0000\n"));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {